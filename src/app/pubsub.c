@@ -0,0 +1,394 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file pubsub.c
+ * @brief Topic publish/subscribe over shared immutable message buffers
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/app/pubsub.h>
+#include <string.h>
+#include <sys/uio.h>
+
+/******************************************************************************
+ * messages
+ */
+zps_msg_t *zps_msg_create(const char *data, int len, uint64_t key){
+    zps_msg_t *msg;
+
+    if(len < 0 || (len && !data)){
+        zerrno(ZEPARAM_INVALID);
+        return NULL;
+    }
+    if(!(msg = (zps_msg_t*)malloc(sizeof(zps_msg_t) + len))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    msg->ref = 1;
+    msg->len = len;
+    msg->key = key;
+    memcpy(msg->data, data, len);
+    return msg;
+}
+
+/******************************************************************************
+ * topics
+ */
+static uint32_t zps_hash(const char *name, int len){
+    uint32_t h = 2166136261u;
+    while(len--){
+        h = (h ^ (uint8_t)*name++) * 16777619u;
+    }
+    return h;
+}
+
+static zps_topic_t *zps_topic(zps_t *ps, const char *name, int len, zbool_t create){
+    zps_topic_t **bucket = &ps->buckets[zps_hash(name, len) & (ZPS_BUCKETS - 1)];
+    zps_topic_t *topic;
+
+    for(topic = *bucket; topic; topic = topic->next){
+        if(topic->nlen == len && 0 == memcmp(topic->name, name, len)){
+            return topic;
+        }
+    }
+    if(!create || !(topic = (zps_topic_t*)calloc(1, sizeof(zps_topic_t) + len))){
+        return NULL;
+    }
+    topic->name = (char*)(topic + 1);
+    memcpy(topic->name, name, len);
+    topic->nlen = len;
+    topic->next = *bucket;
+    *bucket = topic;
+    ++ps->ntopics;
+    return topic;
+}
+
+static void zps_topic_remove(zps_topic_t *topic, zps_conn_t *conn){
+    int i;
+    for(i = 0; i < topic->nconns; ++i){
+        if(topic->conns[i] == conn){
+            topic->conns[i] = topic->conns[--topic->nconns];
+            return;
+        }
+    }
+}
+
+zps_t *zps_create(void){
+    zps_t *ps = (zps_t*)calloc(1, sizeof(zps_t));
+    if(!ps){
+        zerrno(ZEMEM_INSUFFICIENT);
+    }
+    return ps;
+}
+
+void zps_destroy(zps_t *ps){
+    zps_topic_t *topic;
+    int i;
+
+    if(!ps){
+        return;
+    }
+    for(i = 0; i < ZPS_BUCKETS; ++i){
+        while((topic = ps->buckets[i])){
+            ps->buckets[i] = topic->next;
+            free(topic->conns);
+            free(topic);
+        }
+    }
+    zdbg("pubsub published:%llu deliveries:%llu",
+         (unsigned long long)ps->published, (unsigned long long)ps->deliveries);
+    free(ps);
+}
+
+/******************************************************************************
+ * connections
+ */
+zinline int zps_depth(zps_conn_t *conn){
+    return (int)(conn->tail - conn->head);
+}
+
+static void zps_drop_oldest(zps_conn_t *conn){
+    zps_msg_t *msg = conn->queue[conn->head++ & conn->mask];
+    conn->bytes -= msg->len;
+    ++conn->dropped;
+    zps_msg_unref(msg);
+}
+
+static void zps_close(zps_conn_t *conn, zerr_t reason){
+    if(conn->closed){
+        return;
+    }
+    conn->closed = 1;
+    if(conn->waiting){
+        st_cond_signal(conn->cond);
+    }
+    if(conn->on_close){
+        conn->on_close(conn, reason, conn->hint);
+    }
+}
+
+static zptr_t zps_writer(zptr_t arg){
+    zps_conn_t *conn = (zps_conn_t*)arg;
+    zps_msg_t *batch[ZPS_BATCH];
+    struct iovec iov[ZPS_BATCH];
+    int cnt, i;
+
+    while(!conn->stop && !conn->closed){
+        if(!zps_depth(conn)){
+            conn->waiting = 1;
+            st_cond_wait(conn->cond);
+            conn->waiting = 0;
+            continue;
+        }
+        /* the batch leaves the queue, publishers may refill it meanwhile */
+        for(cnt = 0; cnt < ZPS_BATCH && zps_depth(conn); ++cnt){
+            batch[cnt] = conn->queue[conn->head++ & conn->mask];
+            conn->bytes -= batch[cnt]->len;
+            iov[cnt].iov_base = batch[cnt]->data;
+            iov[cnt].iov_len = batch[cnt]->len;
+        }
+        ++conn->writes;
+        if(st_writev(conn->stfd, iov, cnt, ST_UTIME_NO_TIMEOUT) < 0){
+            if(!conn->stop){
+                zps_close(conn, ZEFAIL);
+            }
+        }else{
+            conn->sent += cnt;
+        }
+        for(i = 0; i < cnt; ++i){
+            zps_msg_unref(batch[i]);
+        }
+    }
+    return NULL;
+}
+
+zps_conn_t *zps_conn_create(zps_t *ps, zsock_t sock, int policy, int max_msgs,
+                            int max_bytes, zps_close_t on_close, zptr_t hint){
+    zps_conn_t *conn = NULL;
+    uint32_t size = 1;
+
+    if(!ps || ZINVALID_SOCKET == sock || policy < ZPS_DROP || policy > ZPS_CONFLATE){
+        zerrno(ZEPARAM_INVALID);
+        return NULL;
+    }
+    if(!(conn = (zps_conn_t*)calloc(1, sizeof(zps_conn_t)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    conn->ps = ps;
+    conn->policy = policy;
+    conn->max_msgs = max_msgs <= 0 ? 1024 : max_msgs;
+    conn->max_bytes = max_bytes <= 0 ? 16 * 1024 * 1024 : max_bytes;
+    conn->on_close = on_close;
+    conn->hint = hint;
+    while(size < (uint32_t)conn->max_msgs){
+        size <<= 1;
+    }
+    conn->mask = size - 1;
+
+    do{
+        if(!(conn->queue = (zps_msg_t**)malloc(size * sizeof(zps_msg_t*))) ||
+           !(conn->cond = st_cond_new()) ||
+           !(conn->stfd = zst_socket(sock))){
+            break;
+        }
+        if(!(conn->writer = zst_thread_create(zps_writer, conn, ztrue, 0))){
+            break;
+        }
+        return conn;
+    }while(0);
+
+    if(conn->stfd){
+        st_netfd_free(conn->stfd);
+    }
+    if(conn->cond){
+        st_cond_destroy(conn->cond);
+    }
+    free(conn->queue);
+    free(conn);
+    zerrno(ZEFAIL);
+    return NULL;
+}
+
+void zps_conn_destroy(zps_conn_t *conn){
+    int i;
+
+    if(!conn){
+        return;
+    }
+    for(i = 0; i < conn->ntopics; ++i){
+        zps_topic_remove(conn->topics[i], conn);
+    }
+    conn->stop = 1;
+    st_thread_interrupt(conn->writer);
+    zst_thread_join(conn->writer);
+    while(zps_depth(conn)){
+        zps_msg_unref(conn->queue[conn->head++ & conn->mask]);
+    }
+    zdbg("pubsub conn queued:%llu sent:%llu dropped:%llu conflated:%llu "
+         "writes:%llu max_depth:%d",
+         (unsigned long long)conn->queued, (unsigned long long)conn->sent,
+         (unsigned long long)conn->dropped, (unsigned long long)conn->conflated,
+         (unsigned long long)conn->writes, conn->max_depth);
+    st_netfd_close(conn->stfd);
+    st_cond_destroy(conn->cond);
+    free(conn->topics);
+    free(conn->queue);
+    free(conn);
+}
+
+zerr_t zps_subscribe(zps_conn_t *conn, const char *name, int len){
+    zps_topic_t *topic;
+    int i;
+
+    if(!conn || !name || len <= 0){
+        return ZEPARAM_INVALID;
+    }
+    if(!(topic = zps_topic(conn->ps, name, len, ztrue))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    for(i = 0; i < conn->ntopics; ++i){
+        if(conn->topics[i] == topic){
+            return ZEOK;
+        }
+    }
+    if(topic->nconns == topic->cap){
+        int cap = topic->cap ? topic->cap * 2 : 8;
+        zps_conn_t **conns = (zps_conn_t**)realloc(topic->conns, cap * sizeof(zps_conn_t*));
+        if(!conns){
+            return ZEMEM_INSUFFICIENT;
+        }
+        topic->conns = conns;
+        topic->cap = cap;
+    }
+    if(conn->ntopics == conn->tcap){
+        int cap = conn->tcap ? conn->tcap * 2 : 4;
+        zps_topic_t **topics = (zps_topic_t**)realloc(conn->topics, cap * sizeof(zps_topic_t*));
+        if(!topics){
+            return ZEMEM_INSUFFICIENT;
+        }
+        conn->topics = topics;
+        conn->tcap = cap;
+    }
+    topic->conns[topic->nconns++] = conn;
+    conn->topics[conn->ntopics++] = topic;
+    return ZEOK;
+}
+
+zerr_t zps_unsubscribe(zps_conn_t *conn, const char *name, int len){
+    zps_topic_t *topic;
+    int i;
+
+    if(!conn || !name || len <= 0){
+        return ZEPARAM_INVALID;
+    }
+    if(!(topic = zps_topic(conn->ps, name, len, zfalse))){
+        return ZEOK;
+    }
+    zps_topic_remove(topic, conn);
+    for(i = 0; i < conn->ntopics; ++i){
+        if(conn->topics[i] == topic){
+            conn->topics[i] = conn->topics[--conn->ntopics];
+            break;
+        }
+    }
+    return ZEOK;
+}
+
+/******************************************************************************
+ * publish
+ */
+/** @return 1 queued, 0 dropped by policy */
+static int zps_enqueue(zps_conn_t *conn, zps_msg_t *msg){
+    uint32_t i;
+
+    if(ZPS_CONFLATE == conn->policy && msg->key){
+        for(i = conn->head; i != conn->tail; ++i){
+            zps_msg_t **slot = &conn->queue[i & conn->mask];
+            if((*slot)->key == msg->key){
+                conn->bytes += msg->len - (*slot)->len;
+                zps_msg_unref(*slot);
+                *slot = zps_msg_ref(msg);
+                ++conn->conflated;
+                return 1;
+            }
+        }
+    }
+    while(zps_depth(conn) && (zps_depth(conn) >= conn->max_msgs ||
+                              conn->bytes + msg->len > conn->max_bytes)){
+        if(ZPS_DISCONNECT == conn->policy){
+            zinf("pubsub slow subscriber disconnected, depth<%d> bytes<%d>",
+                 zps_depth(conn), conn->bytes);
+            zps_close(conn, ZEAGAIN);
+            return 0;
+        }
+        zps_drop_oldest(conn);
+    }
+    conn->queue[conn->tail++ & conn->mask] = zps_msg_ref(msg);
+    conn->bytes += msg->len;
+    ++conn->queued;
+    if(zps_depth(conn) > conn->max_depth){
+        conn->max_depth = zps_depth(conn);
+    }
+    if(conn->waiting){
+        st_cond_signal(conn->cond);
+    }
+    return 1;
+}
+
+int zps_publish_msg(zps_t *ps, const char *name, int len, zps_msg_t *msg){
+    zps_topic_t *topic;
+    int cnt = 0;
+    int i;
+
+    if(!ps || !name || !msg || !(topic = zps_topic(ps, name, len, zfalse))){
+        return 0;
+    }
+    ++ps->published;
+    for(i = 0; i < topic->nconns; ++i){
+        if(!topic->conns[i]->closed){
+            cnt += zps_enqueue(topic->conns[i], msg);
+        }
+    }
+    ps->deliveries += cnt;
+    return cnt;
+}
+
+int zps_publish(zps_t *ps, const char *name, int len, const char *data, int dlen,
+                uint64_t key){
+    zps_msg_t *msg;
+    int cnt;
+
+    if(!(msg = zps_msg_create(data, dlen, key))){
+        return 0;
+    }
+    cnt = zps_publish_msg(ps, name, len, msg);
+    zps_msg_unref(msg);
+    return cnt;
+}
@@ -0,0 +1,410 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file rpc.c
+ * @brief Pipelined request/response RPC over one connection
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/app/rpc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <endian.h>
+
+#define ZRPC_RBUF_SIZE (64 * 1024)
+#define ZRPC_LINGER_US 1000000 /** destroy waits this long to flush replies */
+#define ZRPC_CALL_OF(node) ((zrpc_call_t*)((char*)(node) - offsetof(zrpc_call_t, deadline)))
+
+static void zrpc_encode(char *buf, const zrpc_hdr_t *hdr){
+    uint32_t u32;
+    uint16_t u16;
+
+    u32 = htole32(hdr->len);
+    memcpy(buf, &u32, 4);
+    u32 = htole32(hdr->id);
+    memcpy(buf + 4, &u32, 4);
+    u16 = htole16(hdr->method);
+    memcpy(buf + 8, &u16, 2);
+    buf[10] = (char)hdr->type;
+    buf[11] = (char)hdr->rsv;
+    u32 = htole32((uint32_t)hdr->status);
+    memcpy(buf + 12, &u32, 4);
+}
+
+static void zrpc_decode(const char *buf, zrpc_hdr_t *hdr){
+    uint32_t u32;
+    uint16_t u16;
+
+    memcpy(&u32, buf, 4);
+    hdr->len = le32toh(u32);
+    memcpy(&u32, buf + 4, 4);
+    hdr->id = le32toh(u32);
+    memcpy(&u16, buf + 8, 2);
+    hdr->method = le16toh(u16);
+    hdr->type = (uint8_t)buf[10];
+    hdr->rsv = (uint8_t)buf[11];
+    memcpy(&u32, buf + 12, 4);
+    hdr->status = (int32_t)le32toh(u32);
+}
+
+/**
+ * @brief queue one frame, header and payload in a single cork write
+ * @note the cork keeps frames of concurrent callers whole, a frame written
+ *       through owns the socket until it is out; a failed cork left part of
+ *       a frame on the wire, the connection is shut down
+ */
+static zerr_t zrpc_send_frame(zrpc_conn_t *conn, const zrpc_hdr_t *hdr, const char *payload){
+    char head[ZRPC_HDR_SIZE];
+    struct iovec iov[2];
+    zerr_t ret;
+
+    zrpc_encode(head, hdr);
+    iov[0].iov_base = head;
+    iov[0].iov_len = ZRPC_HDR_SIZE;
+    iov[1].iov_base = (void*)payload;
+    iov[1].iov_len = hdr->len;
+    while(ZEAGAIN == (ret = zcork_writev(&conn->cork, iov, hdr->len ? 2 : 1, 0))){
+        if(conn->closed || 0 != st_netfd_poll(conn->stfd, POLLOUT, ST_UTIME_NO_TIMEOUT)){
+            return ZEFAIL;
+        }
+    }
+    if(ZEOK == ret && !conn->cork.tick){
+        /* no end-of-tick flusher, flush per frame */
+        while(ZEAGAIN == (ret = zcork_flush(&conn->cork))){
+            if(conn->closed || 0 != st_netfd_poll(conn->stfd, POLLOUT, ST_UTIME_NO_TIMEOUT)){
+                return ZEFAIL;
+            }
+        }
+    }
+    if(ZEFAIL == ret && conn->cork.failed && !conn->closed){
+        /* the reader sees EOF and fails the pending calls */
+        conn->closed = 1;
+        shutdown(conn->sock, SHUT_RDWR);
+    }
+    return ret;
+}
+
+/******************************************************************************
+ * pending calls
+ */
+static void zrpc_pending_add(zrpc_conn_t *conn, zrpc_call_t *call){
+    zrpc_call_t **bucket = &conn->pending[call->id & (ZRPC_BUCKETS - 1)];
+    call->next = *bucket;
+    *bucket = call;
+    if(++conn->inflight > conn->max_inflight){
+        conn->max_inflight = conn->inflight;
+    }
+}
+
+static zrpc_call_t *zrpc_pending_take(zrpc_conn_t *conn, uint32_t id){
+    zrpc_call_t **pp = &conn->pending[id & (ZRPC_BUCKETS - 1)];
+    zrpc_call_t *call;
+
+    for(; (call = *pp); pp = &call->next){
+        if(call->id == id){
+            *pp = call->next;
+            call->next = NULL;
+            --conn->inflight;
+            return call;
+        }
+    }
+    return NULL;
+}
+
+static void zrpc_complete(zrpc_conn_t *conn, zrpc_call_t *call, zerr_t ret){
+    if(conn->timer){
+        ztimer_del(conn->timer, &call->deadline);
+    }
+    call->ret = ret;
+    call->done(call, call->hint);
+}
+
+static void zrpc_fail_all(zrpc_conn_t *conn){
+    zrpc_call_t *call;
+    int i;
+
+    for(i = 0; i < ZRPC_BUCKETS; ++i){
+        while((call = conn->pending[i])){
+            zrpc_pending_take(conn, call->id);
+            zrpc_complete(conn, call, ZEFAIL);
+        }
+    }
+}
+
+static void zrpc_on_deadline(ztimer_node_t *node, zptr_t hint){
+    zrpc_conn_t *conn = (zrpc_conn_t*)hint;
+    zrpc_call_t *call = ZRPC_CALL_OF(node);
+
+    if(zrpc_pending_take(conn, call->id)){
+        ++conn->timeouts;
+        zrpc_complete(conn, call, ZETIMEOUT);
+    }
+}
+
+/******************************************************************************
+ * reader
+ */
+static void zrpc_dispatch(zrpc_conn_t *conn, const zrpc_hdr_t *hdr, const char *payload){
+    zrpc_call_t *call;
+    zrpc_handler_t handler;
+
+    if(ZRPC_REP == hdr->type){
+        if(!(call = zrpc_pending_take(conn, hdr->id))){
+            /* timed out already */
+            return;
+        }
+        ++conn->replies;
+        call->rep = NULL;
+        call->rep_len = hdr->len;
+        if(hdr->len && (call->rep = (char*)malloc(hdr->len))){
+            memcpy(call->rep, payload, hdr->len);
+        }
+        zrpc_complete(conn, call, (hdr->len && !call->rep) ? ZEMEM_INSUFFICIENT : hdr->status);
+    }else if(ZRPC_REQ == hdr->type){
+        handler = (conn->service && hdr->method < ZRPC_METHOD_MAX) ?
+            conn->service->handlers[hdr->method] : NULL;
+        if(handler){
+            handler(conn, hdr, payload, conn->service->hint);
+        }else{
+            zrpc_reply(conn, hdr->id, hdr->method, ZENOT_SUPPORT, NULL, 0);
+        }
+    }
+}
+
+static zptr_t zrpc_reader_proc(zptr_t arg){
+    zrpc_conn_t *conn = (zrpc_conn_t*)arg;
+    zrpc_hdr_t hdr;
+    ssize_t n;
+    int off;
+    int need;
+
+    while(!conn->closed){
+        n = st_read(conn->stfd, conn->rbuf + conn->rbuf_len,
+                    conn->rbuf_size - conn->rbuf_len, ST_UTIME_NO_TIMEOUT);
+        if(n <= 0){
+            break;
+        }
+        ++conn->reads;
+        conn->rbuf_len += n;
+
+        /* decode every complete frame of this read */
+        need = 0;
+        for(off = 0; conn->rbuf_len - off >= ZRPC_HDR_SIZE; off += ZRPC_HDR_SIZE + hdr.len){
+            zrpc_decode(conn->rbuf + off, &hdr);
+            if(hdr.len > ZRPC_FRAME_MAX){
+                zerrno(ZEFAIL);
+                conn->closed = 1;
+                break;
+            }
+            if(conn->rbuf_len - off < ZRPC_HDR_SIZE + (int)hdr.len){
+                need = ZRPC_HDR_SIZE + hdr.len;
+                break;
+            }
+            ++conn->frames;
+            zrpc_dispatch(conn, &hdr, conn->rbuf + off + ZRPC_HDR_SIZE);
+        }
+        if(off){
+            memmove(conn->rbuf, conn->rbuf + off, conn->rbuf_len - off);
+            conn->rbuf_len -= off;
+        }
+        if(need > conn->rbuf_size){
+            char *buf = (char*)realloc(conn->rbuf, need);
+            if(!buf){
+                zerrno(ZEMEM_INSUFFICIENT);
+                break;
+            }
+            conn->rbuf = buf;
+            conn->rbuf_size = need;
+        }
+    }
+    conn->closed = 1;
+    zrpc_fail_all(conn);
+    return NULL;
+}
+
+/******************************************************************************
+ * connection
+ */
+zrpc_conn_t *zrpc_conn_create(zsock_t sock, zrpc_service_t *service,
+                              ztimer_t *timer, zcork_tick_t *tick){
+    zrpc_conn_t *conn = (zrpc_conn_t*)calloc(1, sizeof(zrpc_conn_t));
+
+    if(!conn){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    conn->sock = sock;
+    conn->service = service;
+    conn->timer = timer;
+    conn->rbuf_size = ZRPC_RBUF_SIZE;
+    if(!(conn->rbuf = (char*)malloc(conn->rbuf_size)) ||
+       ZEOK != zcork_init(&conn->cork, sock, tick, 0, 0, 0)){
+        free(conn->rbuf);
+        free(conn);
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    if(!(conn->stfd = zst_socket(sock)) ||
+       !(conn->reader = zst_thread_create(zrpc_reader_proc, conn, ztrue, 0))){
+        if(conn->stfd){
+            st_netfd_free(conn->stfd);
+        }
+        zcork_fini(&conn->cork);
+        free(conn->rbuf);
+        free(conn);
+        return NULL;
+    }
+    return conn;
+}
+
+void zrpc_conn_destroy(zrpc_conn_t *conn){
+    if(!conn){
+        return;
+    }
+    /* queued replies go out before the cork is dropped */
+    while(!conn->closed && ZEAGAIN == zcork_flush(&conn->cork) &&
+          0 == st_netfd_poll(conn->stfd, POLLOUT, ZRPC_LINGER_US)){
+    }
+    conn->closed = 1;
+    st_thread_interrupt(conn->reader);
+    zst_thread_join(conn->reader);
+    zrpc_fail_all(conn);
+    zdbg("rpc<fd:%d> calls:%llu replies:%llu timeouts:%llu max_inflight:%d frames_per_read:%.2f",
+         conn->sock, (unsigned long long)conn->calls, (unsigned long long)conn->replies,
+         (unsigned long long)conn->timeouts, conn->max_inflight,
+         conn->reads ? (double)conn->frames / conn->reads : .0);
+    zcork_fini(&conn->cork);
+    st_netfd_close(conn->stfd);
+    free(conn->rbuf);
+    free(conn);
+}
+
+zerr_t zrpc_call_async(zrpc_conn_t *conn, zrpc_call_t *call, uint16_t method,
+                       const char *req, int len, st_utime_t timeout_us,
+                       zrpc_done_t done, zptr_t hint){
+    zrpc_hdr_t hdr;
+
+    if(conn->closed){
+        return ZEFAIL;
+    }
+    if(len < 0 || len > ZRPC_FRAME_MAX){
+        return ZEPARAM_INVALID;
+    }
+    if(0 == ++conn->next_id){
+        ++conn->next_id;
+    }
+    memset(call, 0, sizeof(zrpc_call_t));
+    call->id = conn->next_id;
+    call->method = method;
+    call->done = done;
+    call->hint = hint;
+    ztimer_node_init(&call->deadline);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.len = (uint32_t)len;
+    hdr.id = call->id;
+    hdr.method = method;
+    hdr.type = ZRPC_REQ;
+    /* register before sending, the reply may come back while we wait for POLLOUT */
+    zrpc_pending_add(conn, call);
+    if(ST_UTIME_NO_TIMEOUT != timeout_us && conn->timer){
+        ztimer_add(conn->timer, &call->deadline, timeout_us, zrpc_on_deadline, conn);
+    }
+    if(ZEOK != zrpc_send_frame(conn, &hdr, req)){
+        if(zrpc_pending_take(conn, call->id)){
+            if(conn->timer){
+                ztimer_del(conn->timer, &call->deadline);
+            }
+            return ZEFAIL;
+        }
+        /* already completed by close or deadline */
+        return ZEOK;
+    }
+    ++conn->calls;
+    return ZEOK;
+}
+
+typedef struct zrpc_sync_s{
+    st_cond_t cond;
+    int done;
+}zrpc_sync_t;
+
+static void zrpc_sync_done(zrpc_call_t *call, zptr_t hint){
+    zrpc_sync_t *sync = (zrpc_sync_t*)hint;
+    sync->done = 1;
+    st_cond_signal(sync->cond);
+}
+
+zerr_t zrpc_call(zrpc_conn_t *conn, uint16_t method, const char *req, int len,
+                 char **rep, int *rep_len, st_utime_t timeout_us){
+    zrpc_call_t call;
+    zrpc_sync_t sync;
+    zerr_t ret;
+
+    sync.done = 0;
+    if(!(sync.cond = st_cond_new())){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    if(ZEOK == (ret = zrpc_call_async(conn, &call, method, req, len, timeout_us,
+                                      zrpc_sync_done, &sync))){
+        while(!sync.done){
+            st_cond_wait(sync.cond);
+        }
+        ret = call.ret;
+        if(rep && rep_len){
+            *rep = call.rep;
+            *rep_len = call.rep_len;
+        }else{
+            free(call.rep);
+        }
+    }
+    st_cond_destroy(sync.cond);
+    return ret;
+}
+
+zerr_t zrpc_reply(zrpc_conn_t *conn, uint32_t id, uint16_t method, zerr_t status,
+                  const char *rep, int len){
+    zrpc_hdr_t hdr;
+
+    if(conn->closed){
+        return ZEFAIL;
+    }
+    if(len < 0 || len > ZRPC_FRAME_MAX){
+        return ZEPARAM_INVALID;
+    }
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.len = (uint32_t)len;
+    hdr.id = id;
+    hdr.method = method;
+    hdr.type = ZRPC_REP;
+    hdr.status = status;
+    return zrpc_send_frame(conn, &hdr, rep);
+}
@@ -0,0 +1,82 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file schema.c
+ * @brief Zero-copy binary messages with schema generated accessors
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/app/schema.h>
+#include <stdlib.h>
+
+void zschema_pool_init(zschema_pool_t *pool, uint32_t bufsize, uint32_t max_idle){
+    memset(pool, 0, sizeof(zschema_pool_t));
+    pool->bufsize = bufsize < sizeof(char*) ? sizeof(char*) : bufsize;
+    pool->max_idle = max_idle;
+}
+
+void zschema_pool_fini(zschema_pool_t *pool){
+    char *buf;
+
+    while((buf = pool->free)){
+        memcpy(&pool->free, buf, sizeof(char*));
+        free(buf);
+    }
+    pool->idle = 0;
+}
+
+char *zschema_pool_get(zschema_pool_t *pool){
+    char *buf;
+
+    if((buf = pool->free)){
+        memcpy(&pool->free, buf, sizeof(char*));
+        --pool->idle;
+        ++pool->reuses;
+        return buf;
+    }
+    if((buf = (char*)malloc(pool->bufsize))){
+        ++pool->allocs;
+    }else{
+        zerrno(ZEMEM_INSUFFICIENT);
+    }
+    return buf;
+}
+
+void zschema_pool_put(zschema_pool_t *pool, char *buf){
+    if(!buf){
+        return;
+    }
+    if(pool->idle >= pool->max_idle){
+        free(buf);
+        return;
+    }
+    memcpy(buf, &pool->free, sizeof(char*));
+    pool->free = buf;
+    ++pool->idle;
+}
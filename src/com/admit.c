@@ -0,0 +1,267 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file admit.c
+ * @brief Admission control and load shedding on the accept path
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/admit.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ZADMIT_HYSTERESIS 0.8
+
+void zadmit_cfg_default(zadmit_cfg_t *cfg){
+    memset(cfg, 0, sizeof(zadmit_cfg_t));
+    cfg->backlog = 1024;
+    cfg->max_lag_us = 20000;
+    cfg->max_depth = 0;
+    cfg->fd_pct = 90;
+    cfg->pause_ratio = 1.5;
+    cfg->pause_ms = 50;
+    cfg->probe_ms = 10;
+    cfg->batch = 64;
+}
+
+int zadmit_update(zadmit_t *admit){
+    double p = (double)admit->lag_us / admit->cfg.max_lag_us;
+    double r;
+    int level;
+
+    if(admit->depth && admit->cfg.max_depth > 0 &&
+       (r = (double)admit->depth(admit->hint) / admit->cfg.max_depth) > p){
+        p = r;
+    }
+    if(admit->fd_limit > 0 &&
+       (r = (double)admit->last_fd * 100 / ((double)admit->fd_limit * admit->cfg.fd_pct)) > p){
+        p = r;
+    }
+    admit->pressure = p;
+
+    if(p >= admit->cfg.pause_ratio){
+        level = ZADMIT_PAUSE;
+    }else if(p >= 1.0){
+        level = ZADMIT_SHED;
+    }else{
+        level = ZADMIT_OPEN;
+    }
+    /* leave a level only well below its threshold */
+    if(level < admit->level){
+        if(ZADMIT_PAUSE == admit->level && p >= ZADMIT_HYSTERESIS * admit->cfg.pause_ratio){
+            level = ZADMIT_PAUSE;
+        }else if(p >= ZADMIT_HYSTERESIS){
+            level = ZADMIT_SHED;
+        }
+    }
+    if(level != admit->level){
+        zinf("admit level %d -> %d, pressure<%.2f> lag<%dus> fd<%d/%d>",
+             admit->level, level, p, admit->lag_us, admit->last_fd, admit->fd_limit);
+        admit->level = level;
+    }
+    return level;
+}
+
+static zptr_t zadmit_prober(zptr_t arg){
+    zadmit_t *admit = (zadmit_t*)arg;
+    st_utime_t period = (st_utime_t)admit->cfg.probe_ms * 1000;
+    st_utime_t start;
+    int lag;
+
+    while(!admit->stop){
+        start = st_utime();
+        if(0 != st_usleep(period)){
+            continue;
+        }
+        lag = (int)(st_utime() - start - period);
+        lag = lag < 0 ? 0 : lag;
+        /* rise at once, decay slowly */
+        admit->lag_us = lag > admit->lag_us ? lag : (admit->lag_us * 7 + lag) / 8;
+        zadmit_update(admit);
+    }
+    return NULL;
+}
+
+static void zadmit_reject(zadmit_t *admit, zsock_t sock){
+    if(admit->cfg.reject){
+        send(sock, admit->cfg.reject, admit->cfg.reject_len, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+    zsockclose(sock);
+    ++admit->rejected;
+}
+
+static void zadmit_dispatch(zadmit_t *admit, zsock_t sock, const zsockaddr_in *addr){
+    int cls = admit->classify ? admit->classify(addr, admit->hint) : ZADMIT_CLIENT;
+
+    if(ZADMIT_OPEN != admit->level && ZADMIT_PEER != cls){
+        zadmit_reject(admit, sock);
+        return;
+    }
+    ++admit->admitted;
+    if(ZADMIT_PEER == cls){
+        ++admit->admitted_peers;
+    }
+    if(admit->on_accept){
+        admit->on_accept(sock, addr, cls, admit->hint);
+    }else{
+        zsockclose(sock);
+    }
+}
+
+static zptr_t zadmit_acceptor(zptr_t arg){
+    zadmit_t *admit = (zadmit_t*)arg;
+    zsock_t lsock = st_netfd_fileno(admit->listener);
+    zsock_t *socks;
+    zsockaddr_in *addrs;
+    int cnt, i;
+
+    socks = (zsock_t*)malloc(admit->cfg.batch * sizeof(zsock_t));
+    addrs = (zsockaddr_in*)malloc(admit->cfg.batch * sizeof(zsockaddr_in));
+    while(!admit->stop && socks && addrs){
+        if(ZADMIT_PAUSE == admit->level){
+            ++admit->pauses;
+            st_usleep((st_utime_t)admit->cfg.pause_ms * 1000);
+            zadmit_update(admit);
+            continue;
+        }
+        if(ZEOK != zst_wait_readable(admit->listener, ST_UTIME_NO_TIMEOUT)){
+            continue;
+        }
+        /* drain the backlog of this wakeup */
+        ++admit->wakeups;
+        cnt = 0;
+        while(!admit->stop && ZADMIT_PAUSE != admit->level &&
+              (cnt = zaccept_batch(lsock, socks, addrs, admit->cfg.batch, admit->cfg.opts)) > 0){
+            admit->accepted += cnt;
+            admit->last_fd = 0;
+            for(i = 0; i < cnt; ++i){
+                admit->last_fd = socks[i] > admit->last_fd ? socks[i] : admit->last_fd;
+            }
+            zadmit_update(admit);
+            for(i = 0; i < cnt; ++i){
+                zadmit_dispatch(admit, socks[i], &addrs[i]);
+            }
+            if(cnt < admit->cfg.batch){
+                break;
+            }
+        }
+        if(ZEFAIL == cnt && (EMFILE == errno || ENFILE == errno)){
+            /*
+             * out of descriptors, the pending connection keeps the listener
+             * readable, pause whatever the pressure says or this spins
+             */
+            admit->last_fd = admit->fd_limit;
+            zadmit_update(admit);
+            if(ZADMIT_PAUSE != admit->level){
+                zinf("admit level %d -> %d, out of descriptors", admit->level, ZADMIT_PAUSE);
+                admit->level = ZADMIT_PAUSE;
+            }
+        }
+    }
+    free(socks);
+    free(addrs);
+    return NULL;
+}
+
+zadmit_t *zadmit_create(zsock_t sock, const zadmit_cfg_t *cfg, zadmit_classify_t classify,
+                        zadmit_depth_t depth, zadmit_accept_t on_accept, zptr_t hint){
+    zadmit_t *admit;
+
+    if(ZINVALID_SOCKET == sock){
+        zerrno(ZEPARAM_INVALID);
+        return NULL;
+    }
+    if(!(admit = (zadmit_t*)calloc(1, sizeof(zadmit_t)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    if(cfg){
+        admit->cfg = *cfg;
+    }else{
+        zadmit_cfg_default(&admit->cfg);
+    }
+    if(admit->cfg.max_lag_us <= 0){
+        admit->cfg.max_lag_us = 20000;
+    }
+    if(admit->cfg.fd_pct <= 0){
+        admit->cfg.fd_pct = 90;
+    }
+    if(admit->cfg.probe_ms <= 0){
+        admit->cfg.probe_ms = 10;
+    }
+    if(admit->cfg.batch <= 0){
+        admit->cfg.batch = 64;
+    }
+    if(admit->cfg.pause_ms <= 0){
+        admit->cfg.pause_ms = 50;
+    }
+    admit->classify = classify;
+    admit->depth = depth;
+    admit->on_accept = on_accept;
+    admit->hint = hint;
+    admit->fd_limit = st_getfdlimit();
+
+    do{
+        if(ZEOK != zlisten(sock, admit->cfg.backlog > 0 ? admit->cfg.backlog : 1024) ||
+           !(admit->listener = zst_socket(sock))){
+            break;
+        }
+        if(!(admit->prober = zst_thread_create(zadmit_prober, admit, ztrue, 0)) ||
+           !(admit->acceptor = zst_thread_create(zadmit_acceptor, admit, ztrue, 0))){
+            break;
+        }
+        return admit;
+    }while(0);
+
+    zadmit_destroy(admit);
+    return NULL;
+}
+
+void zadmit_destroy(zadmit_t *admit){
+    if(!admit){
+        return;
+    }
+    admit->stop = 1;
+    if(admit->acceptor){
+        st_thread_interrupt(admit->acceptor);
+        zst_thread_join(admit->acceptor);
+    }
+    if(admit->prober){
+        st_thread_interrupt(admit->prober);
+        zst_thread_join(admit->prober);
+    }
+    zdbg("admit admitted:%llu peers:%llu rejected:%llu pauses:%llu accepted/wakeup:%.2f",
+         (unsigned long long)admit->admitted, (unsigned long long)admit->admitted_peers,
+         (unsigned long long)admit->rejected, (unsigned long long)admit->pauses,
+         admit->wakeups ? (double)admit->accepted / admit->wakeups : .0);
+    if(admit->listener){
+        st_netfd_close(admit->listener);
+    }
+    free(admit);
+}
@@ -0,0 +1,252 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file busypoll.c
+ * @brief Busy-polling event loop for latency-critical links on a dedicated core
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/busypoll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <sched.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
+#define ZBPOLL_CLOCK_MASK 63 /** read the clock every 64 empty loops */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define zbpoll_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define zbpoll_relax() __asm__ __volatile__("yield")
+#else
+#define zbpoll_relax() do{}while(0)
+#endif
+
+static uint64_t zbpoll_now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+zerr_t zbpoll_init(zbpoll_t *bp, int cpu, int busy_poll_us, uint64_t idle_us){
+    memset(bp, 0, sizeof(zbpoll_t));
+    bp->cpu = cpu;
+    bp->idle_us = idle_us;
+    bp->buf_size = ZBPOLL_BUF_SIZE;
+    zsockopt_init(&bp->opts);
+    if(busy_poll_us > 0){
+        zsockopt_add(&bp->opts, SOL_SOCKET, SO_BUSY_POLL, busy_poll_us);
+        zsockopt_add(&bp->opts, SOL_SOCKET, SO_PREFER_BUSY_POLL, 1);
+    }
+#ifdef __linux__
+    bp->wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+    bp->wakefd = -1;
+#endif
+    if(!(bp->buf = (char*)malloc(bp->buf_size))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    return ZEOK;
+}
+
+void zbpoll_fini(zbpoll_t *bp){
+    zdbg("busypoll loops:%llu busy:%llu sleeps:%llu",
+         (unsigned long long)bp->loops, (unsigned long long)bp->busy,
+         (unsigned long long)bp->sleeps);
+    if(bp->wakefd >= 0){
+        close(bp->wakefd);
+    }
+    free(bp->buf);
+    bp->buf = NULL;
+}
+
+zerr_t zbpoll_add_sock(zbpoll_t *bp, zsock_t sock, zbpoll_read_t on_read, zptr_t hint){
+    zbpoll_src_t *src;
+
+    if(bp->nsrc == ZBPOLL_SOURCES || ZINVALID_SOCKET == sock || !on_read){
+        return ZEPARAM_INVALID;
+    }
+    zsock_nonblock(sock, ztrue);
+    if(bp->opts.cnt && ZEOK != zsockopt_apply(sock, &bp->opts)){
+        /* raising SO_BUSY_POLL needs CAP_NET_ADMIN, the loop still spins in user space */
+        zdbg("busypoll socket<%d> busy poll options refused", sock);
+    }
+    src = &bp->src[bp->nsrc++];
+    src->sock = sock;
+    src->fd = sock;
+    src->on_read = on_read;
+    src->poll = NULL;
+    src->hint = hint;
+    return ZEOK;
+}
+
+zerr_t zbpoll_add(zbpoll_t *bp, zbpoll_fn_t poll, int fd, zptr_t hint){
+    zbpoll_src_t *src;
+
+    if(bp->nsrc == ZBPOLL_SOURCES || !poll){
+        return ZEPARAM_INVALID;
+    }
+    src = &bp->src[bp->nsrc++];
+    src->sock = ZINVALID_SOCKET;
+    src->fd = fd;
+    src->on_read = NULL;
+    src->poll = poll;
+    src->hint = hint;
+    return ZEOK;
+}
+
+static void zbpoll_drop(zbpoll_t *bp, int i){
+    bp->src[i] = bp->src[--bp->nsrc];
+}
+
+/** @return work done by one pass over the sources */
+static int zbpoll_pass(zbpoll_t *bp){
+    zbpoll_src_t *src;
+    int work = 0;
+    int ret;
+    int i;
+
+    for(i = 0; i < bp->nsrc; ++i){
+        src = &bp->src[i];
+        if(src->poll){
+            if((ret = src->poll(bp, src->hint)) < 0){
+                zbpoll_drop(bp, i--);
+            }else{
+                work += ret;
+            }
+            continue;
+        }
+        ret = zrecv(src->sock, bp->buf, bp->buf_size, 0);
+        if(ZEAGAIN == ret){
+            continue;
+        }
+        src->on_read(bp, src->sock, bp->buf, ret > 0 ? ret : (0 == ret ? 0 : -1), src->hint);
+        if(ret > 0){
+            ++work;
+        }else{
+            zbpoll_drop(bp, i--);
+        }
+    }
+    return work;
+}
+
+/** @brief block until a source or the doorbell is readable */
+static void zbpoll_wait(zbpoll_t *bp){
+    struct pollfd fds[ZBPOLL_SOURCES + 1];
+    int timeout = -1;
+    int cnt = 0;
+    uint64_t val;
+    int i;
+
+    for(i = 0; i < bp->nsrc; ++i){
+        if(bp->src[i].fd < 0){
+            timeout = 1;
+            continue;
+        }
+        fds[cnt].fd = bp->src[i].fd;
+        fds[cnt].events = POLLIN;
+        fds[cnt].revents = 0;
+        ++cnt;
+    }
+    if(bp->wakefd >= 0){
+        fds[cnt].fd = bp->wakefd;
+        fds[cnt].events = POLLIN;
+        fds[cnt].revents = 0;
+        ++cnt;
+    }else{
+        timeout = 1;
+    }
+    ++bp->sleeps;
+    if(poll(fds, cnt, timeout) > 0 && bp->wakefd >= 0 && (fds[cnt - 1].revents & POLLIN)){
+        if(read(bp->wakefd, &val, sizeof(val)) < 0){
+            zdbg("busypoll doorbell drain failed");
+        }
+    }
+}
+
+zerr_t zbpoll_run(zbpoll_t *bp){
+    uint64_t last_work;
+    uint64_t empty = 0;
+
+#ifdef __linux__
+    if(bp->cpu >= 0){
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(bp->cpu, &set);
+        if(0 != sched_setaffinity(0, sizeof(set), &set)){
+            zinf("busypoll pin to cpu<%d> failed", bp->cpu);
+        }
+    }
+#endif
+    last_work = zbpoll_now_us();
+    while(!__atomic_load_n(&bp->stop, __ATOMIC_ACQUIRE) && bp->nsrc){
+        ++bp->loops;
+        if(zbpoll_pass(bp)){
+            ++bp->busy;
+            empty = 0;
+            if(bp->idle_us){
+                last_work = zbpoll_now_us();
+            }
+            continue;
+        }
+        if(!bp->idle_us ||
+           (0 == (++empty & ZBPOLL_CLOCK_MASK) && zbpoll_now_us() - last_work >= bp->idle_us)){
+            /* idle link, give the core back until something arrives */
+            zbpoll_wait(bp);
+            last_work = zbpoll_now_us();
+            empty = 0;
+            continue;
+        }
+        zbpoll_relax();
+    }
+    return ZEOK;
+}
+
+void zbpoll_stop(zbpoll_t *bp){
+    uint64_t one = 1;
+
+    __atomic_store_n(&bp->stop, 1, __ATOMIC_RELEASE);
+    if(bp->wakefd >= 0 && write(bp->wakefd, &one, sizeof(one)) < 0){
+        zdbg("busypoll doorbell failed");
+    }
+}
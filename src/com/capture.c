@@ -0,0 +1,633 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file capture.c
+ * @brief Traffic capture to a memory-mapped file and timed replay
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/capture.h>
+#include <znt/com/socket.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+
+#define ZCAP_MAGIC 0x5041435a /** "ZCAP" */
+#define ZCAP_VERSION 1
+#define ZCAP_REC_MAX 21 /** kind + 3 varints */
+#define ZCAP_PEND 64 /** outstanding frames remembered per connection */
+#define ZCAP_FD_MAX (1 << 20)
+
+typedef struct zcap_hdr_s{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t wall_us; /** CLOCK_REALTIME at the start, for the record */
+    uint64_t used; /** bytes of header and records */
+}zcap_hdr_t;
+
+/** @brief replayed frames waiting for their response bytes on one connection */
+typedef struct zcap_pend_s{
+    struct{
+        uint64_t ts;
+        uint32_t need; /** response bytes still to come */
+    }q[ZCAP_PEND];
+    int head;
+    int cnt;
+}zcap_pend_t;
+
+zcap_t *zcap_active;
+static uint32_t zcap_writers; /** hooks between their check of zcap_active and return */
+
+static uint64_t zcap_now(clockid_t clk){
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int zcap_varint(char *p, uint64_t v){
+    int n = 0;
+
+    while(v >= 0x80){
+        p[n++] = (char)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (char)v;
+    return n;
+}
+
+static int zcap_unvarint(const char *p, const char *end, uint64_t *v){
+    int n = 0, shift = 0;
+
+    *v = 0;
+    while(p + n < end && shift < 64){
+        *v |= (uint64_t)(p[n] & 0x7f) << shift;
+        if(!(p[n++] & 0x80)){
+            return n;
+        }
+        shift += 7;
+    }
+    return 0;
+}
+
+zerr_t zcap_start(zcap_t *cap, const char *path, uint64_t max_bytes){
+    struct rlimit rl;
+    zcap_hdr_t *hdr;
+
+    memset(cap, 0, sizeof(*cap));
+    if(max_bytes < sizeof(zcap_hdr_t) + ZCAP_REC_MAX){
+        return ZEPARAM_INVALID;
+    }
+    cap->ids_cap = 0 == getrlimit(RLIMIT_NOFILE, &rl) && rl.rlim_cur < ZCAP_FD_MAX ?
+        (int)rl.rlim_cur : ZCAP_FD_MAX;
+    if(0 > (cap->fd = open(path, O_CREAT | O_TRUNC | O_RDWR | O_CLOEXEC, 0644))){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    /* sparse, pages are allocated as the capture fills them */
+    if(0 != ftruncate(cap->fd, max_bytes) ||
+       MAP_FAILED == (cap->map = (char*)mmap(NULL, max_bytes, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED, cap->fd, 0)) ||
+       !(cap->ids = (uint32_t*)calloc(cap->ids_cap, sizeof(uint32_t)))){
+        zerrno(errno);
+        if(MAP_FAILED != cap->map && cap->map){
+            munmap(cap->map, max_bytes);
+        }
+        close(cap->fd);
+        unlink(path);
+        return ZEFAIL;
+    }
+    cap->size = max_bytes;
+    cap->tail = sizeof(zcap_hdr_t);
+    cap->start_us = zcap_now(CLOCK_MONOTONIC);
+    hdr = (zcap_hdr_t*)cap->map;
+    hdr->magic = ZCAP_MAGIC;
+    hdr->version = ZCAP_VERSION;
+    hdr->wall_us = zcap_now(CLOCK_REALTIME);
+    __atomic_store_n(&zcap_active, cap, __ATOMIC_RELEASE);
+    zinf("capture %s started, %lluMB at most", path, (unsigned long long)(max_bytes >> 20));
+    return ZEOK;
+}
+
+zerr_t zcap_stop(zcap_t *cap){
+    uint64_t used;
+    zerr_t ret = ZEOK;
+
+    if(cap == __atomic_load_n(&zcap_active, __ATOMIC_RELAXED)){
+        __atomic_store_n(&zcap_active, NULL, __ATOMIC_SEQ_CST);
+    }
+    /* a hook that saw <cap> still writes into the mapping */
+    while(__atomic_load_n(&zcap_writers, __ATOMIC_SEQ_CST)){
+        sched_yield();
+    }
+    used = cap->tail < cap->size ? cap->tail : cap->size;
+    ((zcap_hdr_t*)cap->map)->used = used;
+    munmap(cap->map, cap->size);
+    if(0 != ftruncate(cap->fd, used)){
+        zerrno(errno);
+        ret = ZEFAIL;
+    }
+    close(cap->fd);
+    free(cap->ids);
+    zinf("capture stopped, %llu records %lluKB, %llu dropped", (unsigned long long)cap->records,
+         (unsigned long long)(used >> 10), (unsigned long long)cap->dropped);
+    return ret;
+}
+
+static void zcap_put(zcap_t *cap, int kind, uint32_t id, const char *buf, uint32_t len){
+    char head[ZCAP_REC_MAX];
+    uint64_t off;
+    int n = 1;
+
+    head[0] = (char)kind;
+    n += zcap_varint(head + n, zcap_now(CLOCK_MONOTONIC) - cap->start_us);
+    n += zcap_varint(head + n, id);
+    n += zcap_varint(head + n, len);
+    if(ZCAP_IN != kind){
+        buf = NULL;
+    }
+    off = __atomic_fetch_add(&cap->tail, n + (buf ? len : 0), __ATOMIC_RELAXED);
+    if(off + n + (buf ? len : 0) > cap->size){
+        /* a straddling record leaves zero bytes, the readers stop there */
+        __atomic_fetch_add(&cap->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if(buf){
+        memcpy(cap->map + off + n, buf, len);
+    }
+    memcpy(cap->map + off, head, n);
+    __atomic_fetch_add(&cap->records, 1, __ATOMIC_RELAXED);
+}
+
+void zcap_track(zcap_t *cap, int sock){
+    uint32_t id;
+
+    if(sock >= 0 && sock < cap->ids_cap){
+        id = __atomic_add_fetch(&cap->next_id, 1, __ATOMIC_RELAXED);
+        cap->ids[sock] = id;
+        zcap_put(cap, ZCAP_OPEN, id, NULL, 0);
+    }
+}
+
+void zcap_sock(zcap_t *cap, int kind, int sock, const char *buf, int len){
+    uint32_t id;
+
+    /* announce before the check, zcap_stop() clears before it counts */
+    __atomic_add_fetch(&zcap_writers, 1, __ATOMIC_SEQ_CST);
+    if(cap != __atomic_load_n(&zcap_active, __ATOMIC_SEQ_CST) || sock < 0 ||
+       sock >= cap->ids_cap){
+        __atomic_sub_fetch(&zcap_writers, 1, __ATOMIC_RELEASE);
+        return;
+    }
+    if(ZCAP_OPEN == kind){
+        zcap_track(cap, sock);
+    }else if((id = cap->ids[sock])){
+        if(ZCAP_CLOSE == kind){
+            cap->ids[sock] = 0;
+        }
+        zcap_put(cap, kind, id, buf, len > 0 ? len : 0);
+    }
+    __atomic_sub_fetch(&zcap_writers, 1, __ATOMIC_RELEASE);
+}
+
+zerr_t zcap_reader_open(zcap_reader_t *rd, const char *path){
+    struct stat st;
+    const zcap_hdr_t *hdr;
+
+    memset(rd, 0, sizeof(*rd));
+    if(0 > (rd->fd = open(path, O_RDONLY | O_CLOEXEC))){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    if(0 != fstat(rd->fd, &st) || st.st_size < (off_t)sizeof(zcap_hdr_t) ||
+       MAP_FAILED == (rd->map = (const char*)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED,
+                                                  rd->fd, 0))){
+        close(rd->fd);
+        return ZEFAIL;
+    }
+    rd->size = st.st_size;
+    hdr = (const zcap_hdr_t*)rd->map;
+    if(ZCAP_MAGIC != hdr->magic || ZCAP_VERSION != hdr->version){
+        zcap_reader_close(rd);
+        return ZEPARAM_INVALID;
+    }
+    /* a capture that was never stopped has used == 0, read to the zeros */
+    if(hdr->used && hdr->used < rd->size){
+        rd->size = hdr->used;
+    }
+    rd->off = sizeof(zcap_hdr_t);
+    madvise((void*)rd->map, rd->size, MADV_SEQUENTIAL);
+    return ZEOK;
+}
+
+void zcap_reader_close(zcap_reader_t *rd){
+    munmap((void*)rd->map, rd->size);
+    close(rd->fd);
+}
+
+zerr_t zcap_next(zcap_reader_t *rd, zcap_rec_t *rec){
+    const char *p = rd->map + rd->off;
+    const char *end = rd->map + rd->size;
+    uint64_t ts, conn, len;
+    int n, m, k;
+
+    if(p >= end || *p < ZCAP_OPEN || *p > ZCAP_CLOSE){
+        return ZEFAIL;
+    }
+    rec->kind = *p++;
+    if(!(n = zcap_unvarint(p, end, &ts)) || !(m = zcap_unvarint(p + n, end, &conn)) ||
+       !(k = zcap_unvarint(p + n + m, end, &len))){
+        return ZEFAIL;
+    }
+    p += n + m + k;
+    rec->ts_us = ts;
+    rec->conn = (uint32_t)conn;
+    rec->len = (uint32_t)len;
+    rec->data = NULL;
+    if(ZCAP_IN == rec->kind){
+        if(len > (uint64_t)(end - p)){
+            return ZEFAIL;
+        }
+        rec->data = p;
+        p += len;
+    }
+    rd->off = p - rd->map;
+    return ZEOK;
+}
+
+typedef struct zcap_lat_s{
+    uint64_t *v;
+    uint64_t cnt;
+    uint64_t cap;
+    uint64_t sum;
+}zcap_lat_t;
+
+static void zcap_lat_add(zcap_lat_t *lat, uint64_t us){
+    uint64_t *tmp;
+
+    if(lat->cnt == lat->cap){
+        lat->cap = lat->cap ? lat->cap * 2 : 1024;
+        if(!(tmp = (uint64_t*)realloc(lat->v, sizeof(uint64_t) * lat->cap))){
+            lat->cap = lat->cnt;
+            return;
+        }
+        lat->v = tmp;
+    }
+    lat->v[lat->cnt++] = us;
+    lat->sum += us;
+}
+
+static int zcap_u64_cmp(const void *a, const void *b){
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void zcap_lat_done(zcap_lat_t *lat, zcap_stat_t *stat){
+    stat->responses = lat->cnt;
+    if(lat->cnt){
+        qsort(lat->v, lat->cnt, sizeof(uint64_t), zcap_u64_cmp);
+        stat->lat_avg_us = lat->sum / lat->cnt;
+        stat->lat_p50_us = lat->v[lat->cnt / 2];
+        stat->lat_p99_us = lat->v[lat->cnt * 99 / 100];
+    }
+    free(lat->v);
+}
+
+/**
+ * @brief one pass over a capture
+ * @param resp [out] response bytes of each ZCAP_IN frame in file order,
+ *        the ZCAP_OUT bytes up to the next frame of the connection; NULL
+ *        to only count; free() by the caller
+ * @param lat [in,out] recorded latencies, frame to its last answer byte
+ */
+static zerr_t zcap_scan(const char *path, zcap_stat_t *stat, uint32_t **resp, zcap_lat_t *lat){
+    zcap_reader_t rd;
+    zcap_rec_t rec;
+    uint64_t *last_in = NULL, *last_out = NULL, *tmp, cap = 0, frames = 0, i;
+    uint32_t conns = 0, *r = NULL, *rtmp;
+    int64_t *at = NULL; /** conn -> index of its last frame, -1 none */
+    zerr_t ret = ZEOK;
+
+    memset(stat, 0, sizeof(*stat));
+    if(ZEOK != zcap_reader_open(&rd, path)){
+        return ZEFAIL;
+    }
+    while(ZEOK == zcap_next(&rd, &rec)){
+        if(rec.conn >= cap){
+            i = cap;
+            cap = (rec.conn + 1) * 2;
+            if(!(tmp = (uint64_t*)realloc(last_in, sizeof(uint64_t) * cap)) || !(last_in = tmp) ||
+               !(tmp = (uint64_t*)realloc(last_out, sizeof(uint64_t) * cap)) || !(last_out = tmp) ||
+               !(tmp = (uint64_t*)realloc(at, sizeof(int64_t) * cap)) || !(at = (int64_t*)tmp)){
+                ret = ZEMEM_INSUFFICIENT;
+                break;
+            }
+            for(; i < cap; ++i){
+                at[i] = -1;
+                last_out[i] = 0;
+            }
+        }
+        conns = rec.conn > conns ? rec.conn : conns;
+        stat->duration_us = rec.ts_us > stat->duration_us ? rec.ts_us : stat->duration_us;
+        if(ZCAP_IN == rec.kind || ZCAP_CLOSE == rec.kind){
+            if(at[rec.conn] >= 0 && last_out[rec.conn] && lat){
+                zcap_lat_add(lat, last_out[rec.conn] - last_in[rec.conn]);
+            }
+            at[rec.conn] = -1;
+            last_out[rec.conn] = 0;
+        }
+        if(ZCAP_IN == rec.kind){
+            if(resp && 0 == (frames & 0xffff)){
+                if(!(rtmp = (uint32_t*)realloc(r, sizeof(uint32_t) * (frames + 0x10000)))){
+                    ret = ZEMEM_INSUFFICIENT;
+                    break;
+                }
+                r = rtmp;
+            }
+            if(r){
+                r[frames] = 0;
+            }
+            at[rec.conn] = frames++;
+            last_in[rec.conn] = rec.ts_us;
+            stat->bytes += rec.len;
+        }else if(ZCAP_OUT == rec.kind && at[rec.conn] >= 0){
+            if(r){
+                r[at[rec.conn]] += rec.len;
+            }
+            last_out[rec.conn] = rec.ts_us > last_in[rec.conn] ? rec.ts_us : last_in[rec.conn];
+        }
+    }
+    for(i = 0; ZEOK == ret && lat && i < cap; ++i){
+        if(at[i] >= 0 && last_out[i]){
+            zcap_lat_add(lat, last_out[i] - last_in[i]);
+        }
+    }
+    zcap_reader_close(&rd);
+    free(last_in);
+    free(last_out);
+    free(at);
+    stat->frames = frames;
+    stat->conns = conns;
+    if(resp && ZEOK == ret){
+        *resp = r;
+    }else{
+        free(r);
+    }
+    return ret;
+}
+
+zerr_t zcap_baseline(const char *path, zcap_stat_t *stat){
+    zcap_lat_t lat;
+    zerr_t ret;
+
+    memset(&lat, 0, sizeof(lat));
+    ret = zcap_scan(path, stat, NULL, &lat);
+    zcap_lat_done(&lat, stat);
+    return ret;
+}
+
+typedef struct zcap_peer_s{
+    zsock_t sock;
+    uint64_t close_at; /** captured close, wait for the answers until then */
+    zcap_pend_t pend;
+}zcap_peer_t;
+
+typedef struct zcap_play_s{
+    zcap_peer_t *peers;
+    uint32_t conns;
+    struct pollfd *pfds;
+    uint32_t *slots; /** pfds index -> peer */
+    zcap_lat_t lat;
+    char *buf;
+}zcap_play_t;
+
+/** @brief answer bytes complete the oldest frames in order */
+static void zcap_play_answer(zcap_play_t *play, zcap_pend_t *pend, uint32_t got, uint64_t now){
+    uint32_t n;
+
+    while(got && pend->cnt){
+        n = got < pend->q[pend->head].need ? got : pend->q[pend->head].need;
+        pend->q[pend->head].need -= n;
+        got -= n;
+        if(!pend->q[pend->head].need){
+            zcap_lat_add(&play->lat, now - pend->q[pend->head].ts);
+            pend->head = (pend->head + 1) % ZCAP_PEND;
+            --pend->cnt;
+        }
+    }
+}
+
+/** @brief close the captured closes once answered or late */
+static void zcap_play_close(zcap_play_t *play, uint64_t now){
+    zcap_peer_t *peer;
+    uint32_t i;
+
+    for(i = 1; i <= play->conns; ++i){
+        peer = &play->peers[i];
+        if(peer->close_at && (!peer->pend.cnt || now >= peer->close_at)){
+            peer->close_at = 0;
+            peer->pend.cnt = 0;
+            if(ZINVALID_SOCKET != peer->sock){
+                ZSOCK_CLOSE(peer->sock);
+            }
+        }
+    }
+}
+
+/** @brief take what the target answered */
+static void zcap_play_read(zcap_play_t *play, int timeout_us){
+    struct timespec tv;
+    zcap_peer_t *peer;
+    uint64_t now;
+    uint32_t i, n = 0;
+    int len;
+
+    for(i = 1; i <= play->conns; ++i){
+        if(ZINVALID_SOCKET != play->peers[i].sock){
+            play->pfds[n].fd = play->peers[i].sock;
+            play->pfds[n].events = POLLIN;
+            play->slots[n++] = i;
+        }
+    }
+    tv.tv_sec = timeout_us / 1000000;
+    tv.tv_nsec = (timeout_us % 1000000) * 1000;
+    n = ppoll(play->pfds, n, &tv, NULL) > 0 ? n : 0;
+    now = zcap_now(CLOCK_MONOTONIC);
+    for(i = 0; i < n; ++i){
+        if(!play->pfds[i].revents){
+            continue;
+        }
+        peer = &play->peers[play->slots[i]];
+        while(0 < (len = zrecv(peer->sock, play->buf, 65536, 0))){
+            zcap_play_answer(play, &peer->pend, len, now);
+        }
+        if(ZEAGAIN != len){
+            ZSOCK_CLOSE(peer->sock);
+        }
+    }
+    zcap_play_close(play, now);
+}
+
+static int zcap_play_waiting(zcap_play_t *play){
+    uint32_t i;
+
+    for(i = 1; i <= play->conns; ++i){
+        if(ZINVALID_SOCKET != play->peers[i].sock &&
+           (play->peers[i].pend.cnt || play->peers[i].close_at)){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static zsock_t zcap_play_connect(const zsockaddr_t *addr){
+    zsock_t sock;
+
+    if(ZINVALID_SOCKET == (sock = zsocket(addr->sa.sa_family, SOCK_STREAM, 0))){
+        return sock;
+    }
+    zsock_nonblock(sock, 0);
+    if(ZEOK != zconnect(sock, &addr->sa, zsockaddr_len(addr))){
+        zsockclose(sock);
+        return ZINVALID_SOCKET;
+    }
+    zsock_nonblock(sock, 1);
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &(int){1}, sizeof(int));
+    return sock;
+}
+
+zerr_t zcap_replay(const char *path, const char *host, uint16_t port, double speed,
+                   zcap_stat_t *stat){
+    zcap_reader_t rd;
+    zcap_rec_t rec;
+    zcap_play_t play;
+    zcap_peer_t *peer;
+    zsockaddr_t addr;
+    uint64_t start, due, now, until, frame = 0;
+    uint32_t *resp = NULL, i;
+    zerr_t ret = ZEOK;
+    int len;
+
+    memset(&play, 0, sizeof(play));
+    if(ZEOK != (ret = zinet_addrx(&addr, host, port)) ||
+       ZEOK != (ret = zcap_scan(path, stat, &resp, NULL))){
+        return ret;
+    }
+    play.conns = stat->conns;
+    memset(stat, 0, sizeof(*stat));
+    if((play.peers = (zcap_peer_t*)calloc(play.conns + 1, sizeof(zcap_peer_t)))){
+        for(i = 0; i <= play.conns; ++i){
+            play.peers[i].sock = ZINVALID_SOCKET;
+        }
+    }
+    play.pfds = (struct pollfd*)calloc(play.conns + 1, sizeof(struct pollfd));
+    play.slots = (uint32_t*)calloc(play.conns + 1, sizeof(uint32_t));
+    play.buf = (char*)malloc(65536);
+    if(!play.peers || !play.pfds || !play.slots || !play.buf){
+        ret = ZEMEM_INSUFFICIENT;
+        goto out;
+    }
+    if(ZEOK != zcap_reader_open(&rd, path)){
+        ret = ZEFAIL;
+        goto out;
+    }
+    stat->conns = play.conns;
+    start = zcap_now(CLOCK_MONOTONIC);
+    while(ZEOK == zcap_next(&rd, &rec)){
+        if(ZCAP_OUT == rec.kind){
+            continue;
+        }
+        /* wait for the frame's turn, reading answers meanwhile */
+        due = start + (speed > 0 ? (uint64_t)(rec.ts_us / speed) : 0);
+        while((now = zcap_now(CLOCK_MONOTONIC)) < due){
+            zcap_play_read(&play, (int)(due - now));
+        }
+        stat->max_lag_us = now - due > stat->max_lag_us ? now - due : stat->max_lag_us;
+        peer = &play.peers[rec.conn];
+        if(ZCAP_CLOSE == rec.kind){
+            /* answers still on the way are part of the load, 100ms at most */
+            peer->close_at = now + 100000;
+            zcap_play_close(&play, now);
+            continue;
+        }
+        if(ZINVALID_SOCKET == peer->sock &&
+           ZINVALID_SOCKET == (peer->sock = zcap_play_connect(&addr))){
+            ret = ZEFAIL;
+            break;
+        }
+        if(ZCAP_IN == rec.kind){
+            if(resp[frame]){
+                if(ZCAP_PEND == peer->pend.cnt){
+                    /* too deep, forget the oldest */
+                    peer->pend.head = (peer->pend.head + 1) % ZCAP_PEND;
+                    --peer->pend.cnt;
+                }
+                i = (peer->pend.head + peer->pend.cnt++) % ZCAP_PEND;
+                peer->pend.q[i].ts = zcap_now(CLOCK_MONOTONIC);
+                peer->pend.q[i].need = resp[frame];
+            }
+            ++frame;
+            len = (int)rec.len;
+            if(ZEOK != zsend(peer->sock, rec.data, &len, 0)){
+                ZSOCK_CLOSE(peer->sock);
+                continue;
+            }
+            ++stat->frames;
+            stat->bytes += rec.len;
+        }
+    }
+    /* last answers, 1s at most */
+    until = zcap_now(CLOCK_MONOTONIC) + 1000000;
+    while(zcap_play_waiting(&play) && zcap_now(CLOCK_MONOTONIC) < until){
+        zcap_play_read(&play, 1000);
+    }
+    stat->duration_us = zcap_now(CLOCK_MONOTONIC) - start;
+    zcap_reader_close(&rd);
+ out:
+    for(i = 0; play.peers && i <= play.conns; ++i){
+        if(ZINVALID_SOCKET != play.peers[i].sock){
+            zsockclose(play.peers[i].sock);
+        }
+    }
+    zcap_lat_done(&play.lat, stat);
+    free(play.peers);
+    free(play.pfds);
+    free(play.slots);
+    free(play.buf);
+    free(resp);
+    return ret;
+}
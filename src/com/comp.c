@@ -0,0 +1,565 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file comp.c
+ * @brief Adaptive per-frame compression for node links
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/comp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <endian.h>
+#ifdef ZNT_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef ZNT_HAVE_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
+#define ZLZ_HASH_LOG 12
+#define ZLZ_HASH_SIZE (1 << ZLZ_HASH_LOG)
+#define ZLZ_MINMATCH 4
+#define ZLZ_MFLIMIT 12
+#define ZLZ_LASTLITERALS 5
+#define ZLZ_MAX_OFFSET 65535
+
+static uint64_t zcomp_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/******************************************************************************
+ * built-in LZ4 block codec
+ */
+static uint32_t zlz_read32(const uint8_t *p){
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t zlz_hash(uint32_t v){
+    return (v * 2654435761u) >> (32 - ZLZ_HASH_LOG);
+}
+
+/** @brief positions + 1 of the dictionary, later ones win */
+static void zlz_load_dict(uint32_t *table, const uint8_t *dict, int dict_len){
+    int i;
+
+    memset(table, 0, ZLZ_HASH_SIZE * sizeof(uint32_t));
+    for(i = 0; i + ZLZ_MINMATCH <= dict_len; ++i){
+        table[zlz_hash(zlz_read32(dict + i))] = i + 1;
+    }
+}
+
+static uint8_t *zlz_length(uint8_t *op, int len){
+    for(; len >= 255; len -= 255){
+        *op++ = 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+/** @return compressed length, 0 does not fit <cap> */
+static int zlz_compress(const uint8_t *src, int len, uint8_t *dst, int cap, uint32_t *table,
+                        const uint8_t *dict, int dict_len, const uint32_t *dict_table){
+    const uint8_t *ref;
+    uint8_t *op = dst;
+    uint8_t *end = dst + cap;
+    uint8_t *token;
+    uint32_t seq, h, r;
+    int ip = 0, anchor = 0;
+    int limit = len - ZLZ_MFLIMIT;
+    int mlimit = len - ZLZ_LASTLITERALS;
+    int off, ml, lit, rlimit;
+
+    memset(table, 0, ZLZ_HASH_SIZE * sizeof(uint32_t));
+    while(ip < limit){
+        seq = zlz_read32(src + ip);
+        h = zlz_hash(seq);
+        r = table[h];
+        table[h] = ip + 1;
+        ref = NULL;
+        if(r && ip - (int)(r - 1) <= ZLZ_MAX_OFFSET && zlz_read32(src + r - 1) == seq){
+            ref = src + r - 1;
+            off = ip - (int)(r - 1);
+            rlimit = mlimit - ip;
+        }else if(dict_table && (r = dict_table[h]) &&
+                 (off = ip + dict_len - (int)(r - 1)) <= ZLZ_MAX_OFFSET &&
+                 zlz_read32(dict + r - 1) == seq){
+            /* matches stop at the end of the dictionary */
+            ref = dict + r - 1;
+            rlimit = dict_len - (int)(r - 1);
+            if(rlimit > mlimit - ip){
+                rlimit = mlimit - ip;
+            }
+        }
+        if(!ref){
+            /* skip faster through incompressible data */
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+        for(ml = ZLZ_MINMATCH; ml < rlimit && src[ip + ml] == ref[ml]; ++ml);
+        lit = ip - anchor;
+        if(op + 1 + lit / 255 + 1 + lit + 2 + (ml - ZLZ_MINMATCH) / 255 + 1 > end - ZLZ_LASTLITERALS){
+            return 0;
+        }
+        token = op++;
+        *token = (uint8_t)((lit >= 15 ? 15 : lit) << 4);
+        if(lit >= 15){
+            op = zlz_length(op, lit - 15);
+        }
+        memcpy(op, src + anchor, lit);
+        op += lit;
+        *op++ = (uint8_t)off;
+        *op++ = (uint8_t)(off >> 8);
+        ml -= ZLZ_MINMATCH;
+        *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+        if(ml >= 15){
+            op = zlz_length(op, ml - 15);
+        }
+        ip += ml + ZLZ_MINMATCH;
+        anchor = ip;
+        if(ip - 2 >= 0 && ip < limit){
+            table[zlz_hash(zlz_read32(src + ip - 2))] = ip - 1;
+        }
+    }
+    /* last literals */
+    lit = len - anchor;
+    if(op + 1 + lit / 255 + 1 + lit > end){
+        return 0;
+    }
+    token = op++;
+    *token = (uint8_t)((lit >= 15 ? 15 : lit) << 4);
+    if(lit >= 15){
+        op = zlz_length(op, lit - 15);
+    }
+    memcpy(op, src + anchor, lit);
+    op += lit;
+    return (int)(op - dst);
+}
+
+/** @return decompressed length, ZEFAIL malformed */
+static int zlz_decompress(const uint8_t *src, int len, uint8_t *dst, int cap,
+                          const uint8_t *dict, int dict_len){
+    int ip = 0, op = 0;
+    int lit, ml, off, i;
+    uint8_t token, b;
+
+    while(ip < len){
+        token = src[ip++];
+        lit = token >> 4;
+        if(15 == lit){
+            do{
+                if(ip >= len){
+                    return ZEFAIL;
+                }
+                lit += b = src[ip++];
+            }while(255 == b);
+        }
+        if(lit > len - ip || lit > cap - op){
+            return ZEFAIL;
+        }
+        memcpy(dst + op, src + ip, lit);
+        ip += lit;
+        op += lit;
+        if(ip == len){
+            /* the last sequence has literals only */
+            break;
+        }
+        if(ip + 2 > len){
+            return ZEFAIL;
+        }
+        off = src[ip] | (src[ip + 1] << 8);
+        ip += 2;
+        ml = token & 15;
+        if(15 == ml){
+            do{
+                if(ip >= len){
+                    return ZEFAIL;
+                }
+                ml += b = src[ip++];
+            }while(255 == b);
+        }
+        ml += ZLZ_MINMATCH;
+        if(!off || off > op + dict_len || ml > cap - op){
+            return ZEFAIL;
+        }
+        if(off <= op){
+            if(off >= ml){
+                memcpy(dst + op, dst + op - off, ml);
+            }else{
+                /* overlapping copy repeats the pattern */
+                for(i = 0; i < ml; ++i){
+                    dst[op + i] = dst[op + i - off];
+                }
+            }
+        }else{
+            for(i = 0; i < ml; ++i){
+                int at = op + i - off;
+                dst[op + i] = at >= 0 ? dst[at] : dict[dict_len + at];
+            }
+        }
+        op += ml;
+    }
+    return op;
+}
+
+/******************************************************************************
+ * codecs
+ */
+static int zcomp_lz4_compress(zcomp_t *comp, const char *src, int len, char *dst, int cap, int dict){
+#ifdef ZNT_HAVE_LZ4
+    int accel = comp->cfg.level > 0 ? comp->cfg.level : 1;
+    if(dict){
+        LZ4_resetStream_fast((LZ4_stream_t*)comp->lz4);
+        LZ4_loadDict((LZ4_stream_t*)comp->lz4, comp->cfg.dict, comp->cfg.dict_len);
+        return LZ4_compress_fast_continue((LZ4_stream_t*)comp->lz4, src, dst, len, cap, accel);
+    }
+    return LZ4_compress_fast_extState(comp->lz4, src, dst, len, cap, accel);
+#else
+    return zlz_compress((const uint8_t*)src, len, (uint8_t*)dst, cap, comp->table,
+                        dict ? (const uint8_t*)comp->cfg.dict : NULL,
+                        dict ? comp->cfg.dict_len : 0,
+                        dict ? comp->dict_table : NULL);
+#endif
+}
+
+static int zcomp_lz4_decompress(zcomp_t *comp, const char *src, int len, char *dst, int cap, int dict){
+#ifdef ZNT_HAVE_LZ4
+    int ret = dict ? LZ4_decompress_safe_usingDict(src, dst, len, cap, comp->cfg.dict, comp->cfg.dict_len) :
+        LZ4_decompress_safe(src, dst, len, cap);
+    return ret < 0 ? ZEFAIL : ret;
+#else
+    return zlz_decompress((const uint8_t*)src, len, (uint8_t*)dst, cap,
+                          dict ? (const uint8_t*)comp->cfg.dict : NULL,
+                          dict ? comp->cfg.dict_len : 0);
+#endif
+}
+
+#ifdef ZNT_HAVE_ZSTD
+static int zcomp_zstd_compress(zcomp_t *comp, const char *src, int len, char *dst, int cap, int dict){
+    size_t ret = dict ?
+        ZSTD_compress_usingCDict((ZSTD_CCtx*)comp->zcctx, dst, cap, src, len, (ZSTD_CDict*)comp->zcdict) :
+        ZSTD_compressCCtx((ZSTD_CCtx*)comp->zcctx, dst, cap, src, len, comp->cfg.level);
+    return ZSTD_isError(ret) ? 0 : (int)ret;
+}
+
+static int zcomp_zstd_decompress(zcomp_t *comp, const char *src, int len, char *dst, int cap, int dict){
+    size_t ret = dict ?
+        ZSTD_decompress_usingDDict((ZSTD_DCtx*)comp->zdctx, dst, cap, src, len, (ZSTD_DDict*)comp->zddict) :
+        ZSTD_decompressDCtx((ZSTD_DCtx*)comp->zdctx, dst, cap, src, len);
+    return ZSTD_isError(ret) ? ZEFAIL : (int)ret;
+}
+#endif
+
+/******************************************************************************
+ * api
+ */
+void zcomp_cfg_default(zcomp_cfg_t *cfg){
+    memset(cfg, 0, sizeof(zcomp_cfg_t));
+    cfg->threshold = 512;
+    cfg->level = 1;
+    cfg->max_ratio = 0.9;
+    cfg->min_gain = 16;
+    cfg->window = 64;
+    cfg->backoff_max = 4096;
+}
+
+static uint32_t zcomp_dict_hash(const char *dict, int len){
+    uint32_t h = 2166136261u;
+    int i;
+
+    for(i = 0; i < len; ++i){
+        h ^= (uint8_t)dict[i];
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+zerr_t zcomp_init(zcomp_t *comp, const zcomp_cfg_t *cfg){
+    memset(comp, 0, sizeof(zcomp_t));
+    comp->cfg = *cfg;
+    if(!comp->cfg.dict || comp->cfg.dict_len <= 0){
+        comp->cfg.dict = NULL;
+        comp->cfg.dict_len = 0;
+    }else if(comp->cfg.dict_len > ZCOMP_DICT_MAX){
+        /* the tail, LZ4 offsets reach 64KB back */
+        comp->cfg.dict += comp->cfg.dict_len - ZCOMP_DICT_MAX;
+        comp->cfg.dict_len = ZCOMP_DICT_MAX;
+    }
+    if(comp->cfg.window <= 0){
+        comp->cfg.window = 64;
+    }
+    comp->backoff = comp->cfg.window;
+    comp->codecs = 1 << ZCOMP_LZ4;
+    comp->codec = ZCOMP_STORED;
+#ifdef ZNT_HAVE_LZ4
+    if(!(comp->lz4 = malloc(LZ4_sizeofState()))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    LZ4_initStream(comp->lz4, LZ4_sizeofState());
+#else
+    if(!(comp->table = (uint32_t*)malloc(ZLZ_HASH_SIZE * sizeof(uint32_t)))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    if(comp->cfg.dict){
+        if(!(comp->dict_table = (uint32_t*)malloc(ZLZ_HASH_SIZE * sizeof(uint32_t)))){
+            zcomp_fini(comp);
+            return ZEMEM_INSUFFICIENT;
+        }
+        zlz_load_dict(comp->dict_table, (const uint8_t*)comp->cfg.dict, comp->cfg.dict_len);
+    }
+#endif
+#ifdef ZNT_HAVE_ZSTD
+    comp->zcctx = ZSTD_createCCtx();
+    comp->zdctx = ZSTD_createDCtx();
+    if(comp->cfg.dict){
+        comp->zcdict = ZSTD_createCDict(comp->cfg.dict, comp->cfg.dict_len, comp->cfg.level);
+        comp->zddict = ZSTD_createDDict(comp->cfg.dict, comp->cfg.dict_len);
+    }
+    if(comp->zcctx && comp->zdctx && (!comp->cfg.dict || (comp->zcdict && comp->zddict))){
+        comp->codecs |= 1 << ZCOMP_ZSTD;
+    }
+#endif
+    if(comp->cfg.dict){
+        comp->dict_id = zcomp_dict_hash(comp->cfg.dict, comp->cfg.dict_len);
+    }
+    return ZEOK;
+}
+
+void zcomp_fini(zcomp_t *comp){
+    free(comp->table);
+    free(comp->dict_table);
+    free(comp->lz4);
+#ifdef ZNT_HAVE_ZSTD
+    ZSTD_freeCCtx((ZSTD_CCtx*)comp->zcctx);
+    ZSTD_freeDCtx((ZSTD_DCtx*)comp->zdctx);
+    ZSTD_freeCDict((ZSTD_CDict*)comp->zcdict);
+    ZSTD_freeDDict((ZSTD_DDict*)comp->zddict);
+#endif
+    comp->table = comp->dict_table = NULL;
+    comp->lz4 = comp->zcctx = comp->zdctx = comp->zcdict = comp->zddict = NULL;
+}
+
+int zcomp_hello(zcomp_t *comp, char *buf){
+    uint32_t id = htole32(comp->dict_id);
+
+    buf[0] = 'Z';
+    buf[1] = 'C';
+    buf[2] = 1; /* version */
+    buf[3] = (char)comp->codecs;
+    memcpy(buf + 4, &id, sizeof(id));
+    return ZCOMP_HELLO_SIZE;
+}
+
+zerr_t zcomp_accept(zcomp_t *comp, const char *hello, int len){
+    uint32_t id;
+    uint8_t common;
+
+    if(len < ZCOMP_HELLO_SIZE || 'Z' != hello[0] || 'C' != hello[1]){
+        return ZEPARAM_INVALID;
+    }
+    memcpy(&id, hello + 4, sizeof(id));
+    common = comp->codecs & (uint8_t)hello[3];
+    comp->codec = (common & (1 << ZCOMP_ZSTD)) ? ZCOMP_ZSTD :
+        ((common & (1 << ZCOMP_LZ4)) ? ZCOMP_LZ4 : ZCOMP_STORED);
+    comp->use_dict = comp->dict_id && comp->dict_id == le32toh(id);
+    zdbg("compression codec<%d> dictionary<%s>", comp->codec, comp->use_dict ? "shared" : "none");
+    return ZEOK;
+}
+
+/** @brief close an evaluation window, back off when compression is not worth it */
+static void zcomp_adapt(zcomp_t *comp){
+    uint64_t saved = comp->win_in > comp->win_out ? comp->win_in - comp->win_out : 0;
+    uint64_t us = comp->win_ns / 1000 + 1;
+
+    if((double)comp->win_out > comp->cfg.max_ratio * (double)comp->win_in ||
+       saved / us < comp->cfg.min_gain){
+        comp->skip = comp->backoff;
+        if(comp->backoff < comp->cfg.backoff_max){
+            comp->backoff <<= 1;
+        }
+        ++comp->disables;
+    }else{
+        comp->backoff = comp->cfg.window;
+    }
+    comp->win_frames = 0;
+    comp->win_in = comp->win_out = comp->win_ns = 0;
+}
+
+int zcomp_pack(zcomp_t *comp, const char *src, int len, char *dst, int cap){
+    uint32_t raw = htole32((uint32_t)len);
+    uint64_t begin;
+    int n = 0;
+
+    if(cap < ZCOMP_HDR_SIZE + len){
+        return ZEMEM_INSUFFICIENT;
+    }
+    ++comp->frames;
+    comp->bytes_in += len;
+    memcpy(dst + 1, &raw, sizeof(raw));
+    if(ZCOMP_STORED != comp->codec && len >= comp->cfg.threshold){
+        if(comp->skip > 0){
+            --comp->skip;
+        }else{
+            begin = zcomp_now();
+#ifdef ZNT_HAVE_ZSTD
+            if(ZCOMP_ZSTD == comp->codec){
+                n = zcomp_zstd_compress(comp, src, len, dst + ZCOMP_HDR_SIZE,
+                                        cap - ZCOMP_HDR_SIZE, comp->use_dict);
+            }else
+#endif
+            {
+                /* no gain unless it saves something */
+                n = zcomp_lz4_compress(comp, src, len, dst + ZCOMP_HDR_SIZE,
+                                       len - 1, comp->use_dict);
+            }
+            begin = zcomp_now() - begin;
+            comp->cpu_ns += begin;
+            comp->win_ns += begin;
+            comp->win_in += len;
+            comp->win_out += n > 0 && n < len ? n : len;
+            if(++comp->win_frames >= comp->cfg.window){
+                zcomp_adapt(comp);
+            }
+        }
+    }
+    if(n > 0 && n < len){
+        dst[0] = (char)(comp->codec | (comp->use_dict ? ZCOMP_DICT : 0));
+        ++comp->packed;
+    }else{
+        dst[0] = ZCOMP_STORED;
+        memcpy(dst + ZCOMP_HDR_SIZE, src, len);
+        n = len;
+    }
+    comp->bytes_out += ZCOMP_HDR_SIZE + n;
+    return ZCOMP_HDR_SIZE + n;
+}
+
+int zcomp_raw_len(const char *src, int len){
+    uint32_t raw;
+
+    if(len < ZCOMP_HDR_SIZE){
+        return ZEFAIL;
+    }
+    memcpy(&raw, src + 1, sizeof(raw));
+    return (int)le32toh(raw);
+}
+
+int zcomp_unpack(zcomp_t *comp, const char *src, int len, char *dst, int cap){
+    uint8_t codec;
+    uint64_t begin;
+    int raw, dict, n;
+
+    if(0 > (raw = zcomp_raw_len(src, len))){
+        return ZEFAIL;
+    }
+    if(raw > cap){
+        return ZEMEM_INSUFFICIENT;
+    }
+    codec = (uint8_t)src[0] & ~ZCOMP_DICT;
+    dict = ((uint8_t)src[0] & ZCOMP_DICT) != 0;
+    src += ZCOMP_HDR_SIZE;
+    len -= ZCOMP_HDR_SIZE;
+    if(dict && !comp->cfg.dict){
+        return ZEFAIL;
+    }
+    begin = zcomp_now();
+    switch(codec){
+    case ZCOMP_STORED:
+        n = len;
+        if(len != raw){
+            return ZEFAIL;
+        }
+        memcpy(dst, src, len);
+        break;
+    case ZCOMP_LZ4:
+        n = zcomp_lz4_decompress(comp, src, len, dst, raw, dict);
+        break;
+#ifdef ZNT_HAVE_ZSTD
+    case ZCOMP_ZSTD:
+        n = zcomp_zstd_decompress(comp, src, len, dst, raw, dict);
+        break;
+#endif
+    default:
+        return ZEFAIL;
+    }
+    comp->unpack_ns += zcomp_now() - begin;
+    return n == raw ? raw : ZEFAIL;
+}
+
+int zcomp_dict_train(const char **samples, const int *lens, int cnt, char *dict, int cap){
+    int i, n, total = 0;
+
+    if(cap > ZCOMP_DICT_MAX){
+        cap = ZCOMP_DICT_MAX;
+    }
+#ifdef ZNT_HAVE_ZSTD
+    {
+        char *flat;
+        size_t *sizes;
+        size_t ret;
+        for(i = 0; i < cnt; ++i){
+            total += lens[i];
+        }
+        flat = (char*)malloc(total ? total : 1);
+        sizes = (size_t*)malloc((cnt ? cnt : 1) * sizeof(size_t));
+        if(flat && sizes){
+            for(i = 0, total = 0; i < cnt; ++i){
+                memcpy(flat + total, samples[i], lens[i]);
+                total += lens[i];
+                sizes[i] = lens[i];
+            }
+            ret = ZDICT_trainFromBuffer(dict, cap, flat, sizes, cnt);
+            if(!ZDICT_isError(ret)){
+                free(flat);
+                free(sizes);
+                return (int)ret;
+            }
+        }
+        free(flat);
+        free(sizes);
+        total = 0;
+    }
+#endif
+    /* newest samples last, nearest to the frame in an LZ4 prefix */
+    for(i = cnt - 1; i >= 0 && total < cap; --i){
+        n = lens[i] < cap - total ? lens[i] : cap - total;
+        memmove(dict + cap - total - n, samples[i] + lens[i] - n, n);
+        total += n;
+    }
+    if(total < cap){
+        memmove(dict, dict + cap - total, total);
+    }
+    return total;
+}
@@ -0,0 +1,441 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file cork.c
+ * @brief Per-connection write coalescing, many small frames per writev()
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/cork.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ZCORK_BUF_SIZE (64 * 1024)
+#define ZCORK_RETRY_US 1000
+#define ZCORK_SEND_TIMEOUT 1000000 /** us without progress before a write-through fails */
+
+static uint64_t zcork_now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void zcork_mark_dirty(zcork_t *cork){
+    zcork_tick_t *tick = cork->tick;
+
+    if(!tick || cork->dirty){
+        return;
+    }
+    cork->dirty = 1;
+    cork->next_dirty = tick->dirty;
+    if(!tick->dirty){
+        /* the flusher runs after the st_threads already runnable */
+        st_cond_signal(tick->cond);
+    }
+    tick->dirty = cork;
+}
+
+zerr_t zcork_init(zcork_t *cork, zsock_t sock, zcork_tick_t *tick,
+                  int buf_size, int max_bytes, uint32_t max_delay_us){
+    memset(cork, 0, sizeof(zcork_t));
+    cork->sock = sock;
+    cork->tick = tick;
+    cork->buf_size = buf_size > 0 ? buf_size : ZCORK_BUF_SIZE;
+    cork->max_bytes = max_bytes > 0 ? max_bytes : cork->buf_size;
+    cork->max_delay_us = max_delay_us;
+    if(!(cork->buf = (char*)malloc(cork->buf_size))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return ZEMEM_INSUFFICIENT;
+    }
+    if(!(cork->through_cond = st_cond_new())){
+        free(cork->buf);
+        cork->buf = NULL;
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+void zcork_fini(zcork_t *cork){
+    zcork_t **pp;
+
+    if(cork->dirty){
+        for(pp = &cork->tick->dirty; *pp; pp = &(*pp)->next_dirty){
+            if(*pp == cork){
+                *pp = cork->next_dirty;
+                break;
+            }
+        }
+        cork->dirty = 0;
+    }
+#if ZTRACE_SOCKET
+    if(cork->syscalls){
+        zdbg("cork<fd:%d> frames:%llu syscalls:%llu frames_per_syscall:%.2f",
+             cork->sock, (unsigned long long)cork->frames,
+             (unsigned long long)cork->syscalls, (double)cork->frames / cork->syscalls);
+    }
+#endif
+    if(cork->through_cond){
+        st_cond_destroy(cork->through_cond);
+        cork->through_cond = NULL;
+    }
+    free(cork->buf);
+    cork->buf = NULL;
+    cork->iovcnt = cork->pending = cork->buf_used = 0;
+}
+
+/** @brief wait until no write-through owns the socket */
+static zerr_t zcork_wait_through(zcork_t *cork){
+    while(cork->through && !cork->failed){
+        if(-1 == st_cond_wait(cork->through_cond)){
+            /* interrupted, nothing queued */
+            return ZEAGAIN;
+        }
+    }
+    if(cork->failed){
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+zerr_t zcork_flush(zcork_t *cork){
+    struct msghdr msg;
+    ssize_t n;
+    int i;
+
+    if(cork->failed){
+        return ZEFAIL;
+    }
+    if(cork->through && cork->iovcnt){
+        /* queued frames go after the frame being written through */
+        return ZEAGAIN;
+    }
+    memset(&msg, 0, sizeof(msg));
+    while(cork->iovcnt > 0){
+        msg.msg_iov = cork->iov;
+        msg.msg_iovlen = cork->iovcnt;
+        n = sendmsg(cork->sock, &msg, MSG_NOSIGNAL);
+        ++cork->syscalls;
+        if(n < 0){
+            if(EINTR == errno){
+                continue;
+            }
+            if(EAGAIN == errno || EWOULDBLOCK == errno){
+                return ZEAGAIN;
+            }
+            zerrno(errno);
+            return ZEFAIL;
+        }
+        cork->bytes += n;
+        cork->pending -= n;
+        /* drop written iovecs, trim a partial one */
+        for(i = 0; i < cork->iovcnt && n >= (ssize_t)cork->iov[i].iov_len; ++i){
+            n -= cork->iov[i].iov_len;
+        }
+        if(i < cork->iovcnt && n > 0){
+            cork->iov[i].iov_base = (char*)cork->iov[i].iov_base + n;
+            cork->iov[i].iov_len -= n;
+        }
+        if(i > 0){
+            memmove(cork->iov, cork->iov + i, (cork->iovcnt - i) * sizeof(struct iovec));
+            cork->iovcnt -= i;
+        }
+    }
+    cork->buf_used = 0;
+    cork->iov_copy = 0;
+    cork->pending = 0;
+    return ZEOK;
+}
+
+/** @brief sendmsg() <iov> until all is out, parking on POLLOUT */
+static zerr_t zcork_send_through(zcork_t *cork, const struct iovec *iov, int cnt){
+    struct iovec vec[ZCORK_IOV_MAX];
+    struct msghdr msg;
+    struct pollfd pd;
+    size_t off = 0;
+    ssize_t n;
+    int i = 0, k;
+
+    memset(&msg, 0, sizeof(msg));
+    while(i < cnt){
+        for(k = 0; k < ZCORK_IOV_MAX && i + k < cnt; ++k){
+            vec[k] = iov[i + k];
+        }
+        vec[0].iov_base = (char*)vec[0].iov_base + off;
+        vec[0].iov_len -= off;
+        msg.msg_iov = vec;
+        msg.msg_iovlen = k;
+        n = sendmsg(cork->sock, &msg, MSG_NOSIGNAL);
+        ++cork->syscalls;
+        if(n < 0){
+            if(EINTR == errno){
+                continue;
+            }
+            if(EAGAIN != errno && EWOULDBLOCK != errno){
+                zerrno(errno);
+                return ZEFAIL;
+            }
+            pd.fd = cork->sock;
+            pd.events = POLLOUT;
+            pd.revents = 0;
+            if(st_poll(&pd, 1, ZCORK_SEND_TIMEOUT) <= 0){
+                zerrno(ZETIMEOUT);
+                return ZEFAIL;
+            }
+            continue;
+        }
+        cork->bytes += n;
+        for(; i < cnt && (size_t)n >= iov[i].iov_len - off; ++i){
+            n -= iov[i].iov_len - off;
+            off = 0;
+        }
+        off += n;
+    }
+    ++cork->frames;
+    return ZEOK;
+}
+
+/**
+ * @brief write a frame larger than the cork, nothing queued before it
+ * @note a partial frame can not be left behind, so the calling st_thread
+ *       waits for room instead of spinning on EAGAIN and starving the
+ *       scheduler (the reader may be on it); the socket is owned until the
+ *       frame is out, a failure fails the cork
+ */
+static zerr_t zcork_write_through(zcork_t *cork, const struct iovec *iov, int cnt){
+    zerr_t ret = ZEOK;
+
+    cork->through = 1;
+    if(ZEOK != (ret = zcork_send_through(cork, iov, cnt))){
+        cork->failed = 1;
+    }
+    cork->through = 0;
+    st_cond_broadcast(cork->through_cond);
+    return ret;
+}
+
+zerr_t zcork_write(zcork_t *cork, const char *buf, int len, int flags){
+    zerr_t ret = ZEOK;
+    struct iovec *last;
+    int is_ref = flags & ZCORK_REF;
+
+    if(len <= 0){
+        return ZEOK;
+    }
+    if(ZEOK != (ret = zcork_wait_through(cork))){
+        return ret;
+    }
+    if(ZCORK_IOV_MAX == cork->iovcnt ||
+       (!is_ref && len > cork->buf_size - cork->buf_used)){
+        ++cork->budget_flushes;
+        if(ZEOK != (ret = zcork_flush(cork))){
+            return ret;
+        }
+        if(!is_ref && len > cork->buf_size){
+            struct iovec iov;
+            iov.iov_base = (void*)buf;
+            iov.iov_len = len;
+            return zcork_write_through(cork, &iov, 1);
+        }
+    }
+
+    last = cork->iovcnt ? &cork->iov[cork->iovcnt - 1] : NULL;
+    if(is_ref){
+        cork->iov[cork->iovcnt].iov_base = (void*)buf;
+        cork->iov[cork->iovcnt].iov_len = len;
+        ++cork->iovcnt;
+        cork->iov_copy = 0;
+    }else{
+        char *dst = cork->buf + cork->buf_used;
+        memcpy(dst, buf, len);
+        cork->buf_used += len;
+        if(cork->iov_copy && (char*)last->iov_base + last->iov_len == dst){
+            last->iov_len += len;
+        }else{
+            cork->iov[cork->iovcnt].iov_base = dst;
+            cork->iov[cork->iovcnt].iov_len = len;
+            ++cork->iovcnt;
+            cork->iov_copy = 1;
+        }
+    }
+    if(0 == cork->pending){
+        cork->first_us = cork->max_delay_us ? zcork_now_us() : 0;
+        zcork_mark_dirty(cork);
+    }
+    cork->pending += len;
+    ++cork->frames;
+
+    if(cork->pending >= cork->max_bytes || ZCORK_IOV_MAX == cork->iovcnt ||
+       (cork->max_delay_us && zcork_now_us() - cork->first_us >= cork->max_delay_us)){
+        ++cork->budget_flushes;
+        if(ZEFAIL == (ret = zcork_flush(cork))){
+            return ret;
+        }
+    }
+    return ZEOK;
+}
+
+zerr_t zcork_writev(zcork_t *cork, const struct iovec *iov, int cnt, int flags){
+    zerr_t ret = ZEOK;
+    int total = 0;
+    int i;
+
+    if(ZEOK != (ret = zcork_wait_through(cork))){
+        return ret;
+    }
+    for(i = 0; i < cnt; ++i){
+        total += (int)iov[i].iov_len;
+    }
+    if(cnt > ZCORK_IOV_MAX - cork->iovcnt ||
+       (!(flags & ZCORK_REF) && total > cork->buf_size - cork->buf_used)){
+        ++cork->budget_flushes;
+        if(ZEOK != (ret = zcork_flush(cork))){
+            return ret;
+        }
+    }
+    if(cnt > ZCORK_IOV_MAX || (!(flags & ZCORK_REF) && total > cork->buf_size)){
+        /* larger than the cork, nothing queued before it, write through */
+        return zcork_write_through(cork, iov, cnt);
+    }
+    /* room is reserved, a budget flush in between can only free more */
+    for(i = 0; i < cnt && ZEFAIL != ret; ++i){
+        ret = zcork_write(cork, (const char*)iov[i].iov_base, (int)iov[i].iov_len, flags);
+    }
+    cork->frames -= cnt - 1;
+    return ZEFAIL == ret ? ZEFAIL : ZEOK;
+}
+
+/******************************************************************************
+ * end of tick flusher
+ */
+void zcork_tick_flush(zcork_tick_t *tick){
+    zcork_t *cork = tick->dirty;
+    zcork_t *next;
+
+    tick->dirty = NULL;
+    for(; cork; cork = next){
+        next = cork->next_dirty;
+        cork->dirty = 0;
+        if(cork->pending){
+            ++cork->tick_flushes;
+            if(ZEAGAIN == zcork_flush(cork)){
+                /* blocked, retry on a later tick */
+                zcork_mark_dirty(cork);
+            }
+        }
+    }
+}
+
+static zptr_t zcork_tick_proc(zptr_t arg){
+    zcork_tick_t *tick = (zcork_tick_t*)arg;
+
+    while(!tick->stop){
+        if(!tick->dirty){
+            st_cond_wait(tick->cond);
+            continue;
+        }
+        zcork_tick_flush(tick);
+        if(tick->dirty){
+            /* only blocked sockets left */
+            st_usleep(ZCORK_RETRY_US);
+        }
+    }
+    return NULL;
+}
+
+zerr_t zcork_tick_init(zcork_tick_t *tick){
+    memset(tick, 0, sizeof(zcork_tick_t));
+    if(!(tick->cond = st_cond_new())){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    if(!(tick->thr = zst_thread_create(zcork_tick_proc, tick, ztrue, 0))){
+        st_cond_destroy(tick->cond);
+        tick->cond = NULL;
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+void zcork_tick_fini(zcork_tick_t *tick){
+    if(tick->thr){
+        tick->stop = 1;
+        st_thread_interrupt(tick->thr);
+        zst_thread_join(tick->thr);
+        tick->thr = NULL;
+    }
+    zcork_tick_flush(tick);
+    if(tick->cond){
+        st_cond_destroy(tick->cond);
+        tick->cond = NULL;
+    }
+}
+
+/******************************************************************************
+ * transport binding
+ */
+static zerr_t zcork_trans_send(zptr_t ctx, const char *buf, int *len, int flags){
+    zerr_t ret = zcork_write((zcork_t*)ctx, buf, *len, flags);
+    if(ZEOK != ret){
+        *len = 0;
+    }
+    return ret;
+}
+
+static zerr_t zcork_trans_recv(zptr_t ctx, char *buf, int len, int flags){
+    return zrecv(((zcork_t*)ctx)->sock, buf, len, flags);
+}
+
+static zerr_t zcork_trans_flush(zptr_t ctx){
+    return zcork_flush((zcork_t*)ctx);
+}
+
+static int zcork_trans_fileno(zptr_t ctx){
+    return ((zcork_t*)ctx)->sock;
+}
+
+static zerr_t zcork_trans_close(zptr_t ctx){
+    zcork_t *cork = (zcork_t*)ctx;
+    zsock_t sock = cork->sock;
+
+    zcork_flush(cork);
+    zcork_fini(cork);
+    return zsockclose(sock);
+}
+
+const ztrans_ops_t zcork_trans_ops = {
+    "cork",
+    zcork_trans_send,
+    zcork_trans_recv,
+    zcork_trans_flush,
+    zcork_trans_fileno,
+    zcork_trans_close
+};
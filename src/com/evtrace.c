@@ -0,0 +1,340 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file evtrace.c
+ * @brief Binary connection lifecycle tracer, per thread lock-free rings
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/evtrace.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ZEVT_MAGIC 0x5456455a /** "ZEVT" */
+#define ZEVT_VERSION 1
+
+typedef struct zevt_hdr_s{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size; /** sizeof(zevt_t) */
+}zevt_hdr_t;
+
+typedef struct zevt_ring_s{
+    uint64_t head; /** records ever written, release stored by the owner */
+    uint32_t mask;
+    uint16_t tid;
+    zevt_t recs[];
+}zevt_ring_t;
+
+int zevtrace_on;
+static int zevtrace_records = ZEVT_RECORDS;
+static zevt_ring_t *zevtrace_rings[ZEVT_RINGS];
+static int zevtrace_nrings;
+static char zevtrace_path[256];
+static __thread zevt_ring_t *zevtrace_self;
+static __thread int zevtrace_none; /** no ring slot left for this thread */
+
+void zevtrace_init(int records){
+    int n = 64;
+
+    while(n < records){
+        n <<= 1;
+    }
+    zevtrace_records = n;
+}
+
+void zevtrace_enable(int on){
+    __atomic_store_n(&zevtrace_on, on, __ATOMIC_RELAXED);
+}
+
+static zevt_ring_t *zevtrace_ring(void){
+    zevt_ring_t *ring;
+    int slot;
+
+    if(zevtrace_none){
+        return NULL;
+    }
+    if(ZEVT_RINGS <= (slot = __atomic_fetch_add(&zevtrace_nrings, 1, __ATOMIC_RELAXED)) ||
+       !(ring = (zevt_ring_t*)calloc(1, sizeof(*ring) + sizeof(zevt_t) * zevtrace_records))){
+        zevtrace_none = 1;
+        return NULL;
+    }
+    ring->mask = zevtrace_records - 1;
+    ring->tid = slot;
+    /* rings outlive their threads, the history stays dumpable */
+    __atomic_store_n(&zevtrace_rings[slot], ring, __ATOMIC_RELEASE);
+    zevtrace_self = ring;
+    return ring;
+}
+
+void zevtrace_put(int event, int fd, uint64_t sid, uint32_t bytes, int aux){
+    zevt_ring_t *ring = zevtrace_self;
+    struct timespec ts;
+    zevt_t *evt;
+
+    if(!ring && !(ring = zevtrace_ring())){
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    evt = &ring->recs[ring->head & ring->mask];
+    evt->ts = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    evt->sid = sid;
+    evt->bytes = bytes;
+    evt->fd = fd;
+    evt->event = event;
+    evt->tid = ring->tid;
+    evt->aux = aux;
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+static int zevtrace_write(int fd, const void *buf, size_t len){
+    const char *p = (const char*)buf;
+    ssize_t n;
+
+    while(len){
+        if(0 > (n = write(fd, p, len))){
+            if(EINTR == errno){
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/** @brief async-signal-safe */
+static int zevtrace_dump_fd(int fd){
+    zevt_hdr_t hdr;
+    zevt_ring_t *ring;
+    uint64_t head, begin, cap;
+    uint32_t n, at;
+    int slot, rings;
+
+    hdr.magic = ZEVT_MAGIC;
+    hdr.version = ZEVT_VERSION;
+    hdr.size = sizeof(zevt_t);
+    if(zevtrace_write(fd, &hdr, sizeof(hdr))){
+        return -1;
+    }
+    rings = __atomic_load_n(&zevtrace_nrings, __ATOMIC_RELAXED);
+    rings = rings < ZEVT_RINGS ? rings : ZEVT_RINGS;
+    for(slot = 0; slot < rings; ++slot){
+        if(!(ring = __atomic_load_n(&zevtrace_rings[slot], __ATOMIC_ACQUIRE))){
+            continue;
+        }
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        cap = (uint64_t)ring->mask + 1;
+        /* leave the oldest sixteenth to a writer still running */
+        begin = head > cap - cap / 16 ? head - (cap - cap / 16) : 0;
+        for(; begin < head; begin += n){
+            at = begin & ring->mask;
+            n = head - begin < cap - at ? head - begin : cap - at;
+            if(zevtrace_write(fd, &ring->recs[at], sizeof(zevt_t) * n)){
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+zerr_t zevtrace_dump(const char *path){
+    int fd;
+    zerr_t ret = ZEOK;
+
+    if(0 > (fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644))){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    if(zevtrace_dump_fd(fd)){
+        ret = ZEFAIL;
+        zerrno(errno);
+    }
+    close(fd);
+    zdbg("evtrace dump %s", path);
+    return ret;
+}
+
+static void zevtrace_signal(int signo){
+    int err = errno;
+    int fd;
+
+    (void)signo;
+    if(0 <= (fd = open(zevtrace_path, O_CREAT | O_TRUNC | O_WRONLY, 0644))){
+        zevtrace_dump_fd(fd);
+        close(fd);
+    }
+    errno = err;
+}
+
+zerr_t zevtrace_dump_on(int signo, const char *path){
+    struct sigaction sa;
+
+    if(!path || strlen(path) >= sizeof(zevtrace_path)){
+        return ZEPARAM_INVALID;
+    }
+    strcpy(zevtrace_path, path);
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = zevtrace_signal;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if(0 != sigaction(signo, &sa, NULL)){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+static int zevtrace_cmp(const void *a, const void *b){
+    const zevt_t *x = (const zevt_t*)a;
+    const zevt_t *y = (const zevt_t*)b;
+
+    return x->ts < y->ts ? -1 : x->ts > y->ts;
+}
+
+zerr_t zevtrace_load(const char *path, zevt_t **evts, int *cnt){
+    FILE *fp;
+    zevt_hdr_t hdr;
+    zevt_t *buf = NULL, *tmp;
+    int n = 0, cap = 0;
+
+    if(!(fp = fopen(path, "rb"))){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    if(1 != fread(&hdr, sizeof(hdr), 1, fp) || ZEVT_MAGIC != hdr.magic ||
+       ZEVT_VERSION != hdr.version || sizeof(zevt_t) != hdr.size){
+        fclose(fp);
+        return ZEPARAM_INVALID;
+    }
+    for(;;){
+        if(n == cap){
+            cap = cap ? cap * 2 : 4096;
+            if(!(tmp = (zevt_t*)realloc(buf, sizeof(zevt_t) * cap))){
+                free(buf);
+                fclose(fp);
+                return ZEMEM_INSUFFICIENT;
+            }
+            buf = tmp;
+        }
+        if(1 != fread(&buf[n], sizeof(zevt_t), 1, fp)){
+            break;
+        }
+        ++n;
+    }
+    fclose(fp);
+    qsort(buf, n, sizeof(zevt_t), zevtrace_cmp);
+    *evts = buf;
+    *cnt = n;
+    return ZEOK;
+}
+
+static const char *zevtrace_name(int event){
+    static const char *names[] = {
+        "?", "connect", "accept", "recv", "send", "close", "timeout", "error", "session"
+    };
+    return event <= ZEVT_SESSION ? names[event] : "user";
+}
+
+zerr_t zevtrace_chrome(const char *in, const char *out){
+    FILE *fp;
+    zevt_t *evts, *e;
+    uint64_t *sids = NULL;
+    const char *ph, *name;
+    int cnt, i, maxfd = 0;
+    zerr_t ret;
+
+    if(ZEOK != (ret = zevtrace_load(in, &evts, &cnt))){
+        return ret;
+    }
+    if(!(fp = fopen(out, "w"))){
+        free(evts);
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    for(i = 0; i < cnt; ++i){
+        maxfd = evts[i].fd > maxfd ? evts[i].fd : maxfd;
+    }
+    /* fd -> sid as bound by ZEVT_SESSION, until the fd is closed */
+    sids = (uint64_t*)calloc(maxfd + 1, sizeof(uint64_t));
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for(i = 0; i < cnt; ++i){
+        e = &evts[i];
+        if(sids && e->fd >= 0){
+            if(ZEVT_SESSION == e->event){
+                sids[e->fd] = e->sid;
+            }else if(!e->sid){
+                e->sid = sids[e->fd];
+            }
+        }
+        name = "conn";
+        switch(e->event){
+        case ZEVT_CONNECT:
+        case ZEVT_ACCEPT:
+            ph = "b";
+            break;
+        case ZEVT_CLOSE:
+            ph = "e";
+            break;
+        default:
+            ph = "n";
+            name = zevtrace_name(e->event);
+        }
+        /* async events keyed by fd draw one row per connection */
+        fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"conn\",\"ph\":\"%s\",\"id\":%d,"
+                "\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"fd\":%d,\"sid\":%llu,"
+                "\"bytes\":%u,\"aux\":%d}}",
+                i ? ",\n" : "", name, ph, e->fd, (double)(e->ts - evts[0].ts) / 1000.0, e->tid, e->fd,
+                (unsigned long long)e->sid, e->bytes, e->aux);
+        if(ZEVT_CONNECT == e->event || ZEVT_ACCEPT == e->event){
+            /* the begin carries the name, keep its kind visible too */
+            fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"conn\",\"ph\":\"n\",\"id\":%d,"
+                    "\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"aux\":%d}}",
+                    zevtrace_name(e->event), e->fd, (double)(e->ts - evts[0].ts) / 1000.0,
+                    e->tid, e->aux);
+        }
+        if(sids && ZEVT_CLOSE == e->event && e->fd >= 0){
+            sids[e->fd] = 0;
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    ret = ferror(fp) ? ZEFAIL : ZEOK;
+    fclose(fp);
+    free(sids);
+    free(evts);
+    zdbg("evtrace %s -> %s, %d records", in, out, cnt);
+    return ret;
+}
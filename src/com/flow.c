@@ -0,0 +1,284 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file flow.c
+ * @brief Credit-based flow control for node-to-node message streams
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/flow.h>
+#include <stdlib.h>
+#include <string.h>
+#include <endian.h>
+#include <sys/uio.h>
+
+#define ZFLOW_DATA 1
+#define ZFLOW_CREDIT 2
+
+static void zflow_encode(char *hdr, uint32_t len, int type){
+    len = htole32(len);
+    memcpy(hdr, &len, 4);
+    hdr[4] = (char)type;
+    hdr[5] = hdr[6] = hdr[7] = 0;
+}
+
+static zerr_t zflow_write(zflow_t *flow, int type, const char *data, int len){
+    char hdr[ZFLOW_HDR_SIZE];
+    struct iovec iov[2];
+    zerr_t ret = ZEOK;
+
+    zflow_encode(hdr, (uint32_t)len, type);
+    iov[0].iov_base = hdr;
+    iov[0].iov_len = ZFLOW_HDR_SIZE;
+    iov[1].iov_base = (char*)data;
+    iov[1].iov_len = ZFLOW_DATA == type ? len : 0;
+    st_mutex_lock(flow->wlock);
+    if(st_writev(flow->stfd, iov, ZFLOW_DATA == type ? 2 : 1, ST_UTIME_NO_TIMEOUT) < 0){
+        ret = ZEFAIL;
+    }
+    st_mutex_unlock(flow->wlock);
+    return ret;
+}
+
+/** @brief wait on <cond> until <deadline> */
+static zerr_t zflow_wait(st_cond_t cond, st_utime_t timeout, st_utime_t deadline){
+    st_utime_t now;
+
+    if(ST_UTIME_NO_WAIT == timeout){
+        return ZEAGAIN;
+    }
+    if(ST_UTIME_NO_TIMEOUT == timeout){
+        return 0 == st_cond_wait(cond) ? ZEOK : ZEFAIL;
+    }
+    if((now = st_utime()) >= deadline){
+        return ZETIMEOUT;
+    }
+    if(0 != st_cond_timedwait(cond, deadline - now)){
+        return ETIME == errno ? ZETIMEOUT : ZEFAIL;
+    }
+    return ZEOK;
+}
+
+static void zflow_close(zflow_t *flow){
+    flow->closed = 1;
+    st_cond_broadcast(flow->credit_cond);
+    st_cond_broadcast(flow->recv_cond);
+}
+
+static zptr_t zflow_reader(zptr_t arg){
+    zflow_t *flow = (zflow_t*)arg;
+    char hdr[ZFLOW_HDR_SIZE];
+    zflow_msg_t *msg;
+    uint32_t len;
+
+    while(!flow->closed){
+        if(st_read_fully(flow->stfd, hdr, ZFLOW_HDR_SIZE, ST_UTIME_NO_TIMEOUT) != ZFLOW_HDR_SIZE){
+            break;
+        }
+        memcpy(&len, hdr, 4);
+        len = le32toh(len);
+        if(ZFLOW_CREDIT == hdr[4]){
+            if(!flow->peer_window){
+                flow->peer_window = (int)len;
+            }
+            flow->credits += (int)len;
+            st_cond_broadcast(flow->credit_cond);
+            continue;
+        }
+        /* unsigned, a len above INT_MAX must not wrap to a small size */
+        if(ZFLOW_DATA != hdr[4] || flow->queued + ZFLOW_HDR_SIZE > flow->window ||
+           len > (uint32_t)(flow->window - flow->queued - ZFLOW_HDR_SIZE)){
+            /* the peer ignored its credit */
+            zinf("flow peer overran the window, queued<%d> len<%u>", flow->queued, len);
+            break;
+        }
+        if(!(msg = (zflow_msg_t*)malloc(sizeof(zflow_msg_t) + len))){
+            break;
+        }
+        msg->next = NULL;
+        msg->len = (int)len;
+        if(len && st_read_fully(flow->stfd, msg->data, len, ST_UTIME_NO_TIMEOUT) != (ssize_t)len){
+            free(msg);
+            break;
+        }
+        if(flow->tail){
+            flow->tail->next = msg;
+        }else{
+            flow->head = msg;
+        }
+        flow->tail = msg;
+        flow->queued += (int)len + ZFLOW_HDR_SIZE;
+        if(flow->queued > flow->max_queued){
+            flow->max_queued = flow->queued;
+        }
+        ++flow->msgs_in;
+        st_cond_signal(flow->recv_cond);
+    }
+    zflow_close(flow);
+    return NULL;
+}
+
+zflow_t *zflow_create(zsock_t sock, int window){
+    zflow_t *flow;
+
+    if(ZINVALID_SOCKET == sock){
+        zerrno(ZEPARAM_INVALID);
+        return NULL;
+    }
+    if(!(flow = (zflow_t*)calloc(1, sizeof(zflow_t)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    flow->window = window <= 0 ? ZFLOW_WINDOW : window;
+    do{
+        if(!(flow->stfd = zst_socket(sock)) || !(flow->wlock = st_mutex_new()) ||
+           !(flow->credit_cond = st_cond_new()) || !(flow->recv_cond = st_cond_new())){
+            break;
+        }
+        if(ZEOK != zflow_write(flow, ZFLOW_CREDIT, NULL, flow->window) ||
+           !(flow->reader = zst_thread_create(zflow_reader, flow, ztrue, 0))){
+            break;
+        }
+        return flow;
+    }while(0);
+
+    zflow_destroy(flow);
+    zerrno(ZEFAIL);
+    return NULL;
+}
+
+void zflow_destroy(zflow_t *flow){
+    zflow_msg_t *msg;
+
+    if(!flow){
+        return;
+    }
+    if(flow->reader){
+        flow->closed = 1;
+        st_thread_interrupt(flow->reader);
+        zst_thread_join(flow->reader);
+    }
+    while((msg = flow->head)){
+        flow->head = msg->next;
+        free(msg);
+    }
+    zdbg("flow out:%llu in:%llu grants:%llu stalls:%llu stall_us:%llu max_queued:%d",
+         (unsigned long long)flow->msgs_out, (unsigned long long)flow->msgs_in,
+         (unsigned long long)flow->grants, (unsigned long long)flow->stalls,
+         (unsigned long long)flow->stall_us, flow->max_queued);
+    if(flow->recv_cond){
+        st_cond_destroy(flow->recv_cond);
+    }
+    if(flow->credit_cond){
+        st_cond_destroy(flow->credit_cond);
+    }
+    if(flow->wlock){
+        st_mutex_destroy(flow->wlock);
+    }
+    if(flow->stfd){
+        st_netfd_close(flow->stfd);
+    }
+    free(flow);
+}
+
+zerr_t zflow_send(zflow_t *flow, const char *data, int len, st_utime_t timeout){
+    int cost = len + ZFLOW_HDR_SIZE;
+    st_utime_t start = 0;
+    zerr_t ret = ZEOK;
+
+    if(len < 0 || (flow->peer_window && len > ZFLOW_MSG_MAX(flow->peer_window))){
+        return ZEPARAM_INVALID;
+    }
+    while(!flow->closed && flow->credits < cost){
+        if(!start){
+            start = st_utime();
+            ++flow->stalls;
+        }
+        if(ZEOK != (ret = zflow_wait(flow->credit_cond, timeout, start + timeout))){
+            break;
+        }
+        if(flow->peer_window && len > ZFLOW_MSG_MAX(flow->peer_window)){
+            ret = ZEPARAM_INVALID;
+            break;
+        }
+    }
+    if(start){
+        flow->stall_us += st_utime() - start;
+    }
+    if(flow->closed){
+        return ZEFAIL;
+    }
+    if(ZEOK != ret){
+        return ret;
+    }
+    /* charge before writing, a blocked write must not let others overdraw */
+    flow->credits -= cost;
+    if(ZEOK != zflow_write(flow, ZFLOW_DATA, data, len)){
+        return ZEFAIL;
+    }
+    ++flow->msgs_out;
+    return ZEOK;
+}
+
+int zflow_recv(zflow_t *flow, char *buf, int size, st_utime_t timeout){
+    st_utime_t deadline = st_utime() + timeout;
+    zflow_msg_t *msg;
+    zerr_t ret;
+    int len;
+
+    while(!(msg = flow->head)){
+        if(flow->closed){
+            return ZEFAIL;
+        }
+        if(ZEOK != (ret = zflow_wait(flow->recv_cond, timeout, deadline))){
+            return ret;
+        }
+    }
+    if(msg->len > size){
+        return ZEMEM_INSUFFICIENT;
+    }
+    if(!(flow->head = msg->next)){
+        flow->tail = NULL;
+    }
+    len = msg->len;
+    memcpy(buf, msg->data, len);
+    free(msg);
+    flow->queued -= len + ZFLOW_HDR_SIZE;
+
+    /* return credit in batches */
+    flow->consumed += len + ZFLOW_HDR_SIZE;
+    if(!flow->closed && flow->consumed >= flow->window / 4){
+        int grant = flow->consumed;
+        flow->consumed = 0;
+        if(ZEOK == zflow_write(flow, ZFLOW_CREDIT, NULL, grant)){
+            ++flow->grants;
+        }
+    }
+    return len;
+}
@@ -0,0 +1,406 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file hotrestart.c
+ * @brief Hot restart, listener handoff over SCM_RIGHTS and draining
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/hotrestart.h>
+#include <sys/un.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define ZHOT_MAGIC 0x544f485a /** "ZHOT" */
+#define ZHOT_RESOLV_MS 4000 /** wait for the lookup of a listener name */
+#define ZHOT_HELLO 1 /** new -> old, send me the listeners */
+#define ZHOT_FDS 2 /** old -> new, keys + SCM_RIGHTS */
+#define ZHOT_READY 3 /** new -> old, accepting */
+#define ZHOT_DRAIN 4 /** old -> new, listeners released */
+
+typedef struct zhot_msg_s{
+    uint32_t magic;
+    uint32_t type;
+    int32_t pid;
+    uint32_t cnt;
+    char keys[ZHOT_MAX][ZHOT_KEY];
+}zhot_msg_t;
+
+static uint64_t zhot_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static zerr_t zhot_addr(zhot_t *hot, struct sockaddr_un *addr){
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if(strlen(hot->path) >= sizeof(addr->sun_path)){
+        return ZEPARAM_INVALID;
+    }
+    strcpy(addr->sun_path, hot->path);
+    return ZEOK;
+}
+
+static zerr_t zhot_send(zsock_t sock, zhot_msg_t *msg, const zsock_t *fds, int nfds){
+    union{
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int) * ZHOT_MAX)];
+    }ctl;
+    struct msghdr mh;
+    struct iovec iov;
+    struct cmsghdr *cm;
+
+    msg->magic = ZHOT_MAGIC;
+    msg->pid = getpid();
+    iov.iov_base = msg;
+    iov.iov_len = sizeof(*msg);
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    if(nfds){
+        mh.msg_control = ctl.buf;
+        mh.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+        cm = CMSG_FIRSTHDR(&mh);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+        memcpy(CMSG_DATA(cm), fds, sizeof(int) * nfds);
+    }
+    if(sizeof(*msg) != sendmsg(sock, &mh, MSG_NOSIGNAL)){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+/**
+ * @retval ZEOK message in <msg>, descriptors in <fds>
+ * @retval ZEAGAIN nothing yet
+ * @retval ZEFAIL peer gone or garbage
+ */
+static zerr_t zhot_recv(zsock_t sock, zhot_msg_t *msg, zsock_t *fds, int *nfds){
+    union{
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int) * ZHOT_MAX)];
+    }ctl;
+    struct msghdr mh;
+    struct iovec iov;
+    struct cmsghdr *cm;
+    ssize_t n;
+
+    iov.iov_base = msg;
+    iov.iov_len = sizeof(*msg);
+    memset(&mh, 0, sizeof(mh));
+    mh.msg_iov = &iov;
+    mh.msg_iovlen = 1;
+    mh.msg_control = ctl.buf;
+    mh.msg_controllen = sizeof(ctl.buf);
+    *nfds = 0;
+    if(0 > (n = recvmsg(sock, &mh, MSG_DONTWAIT | MSG_CMSG_CLOEXEC))){
+        return EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno ? ZEAGAIN : ZEFAIL;
+    }
+    for(cm = CMSG_FIRSTHDR(&mh); cm; cm = CMSG_NXTHDR(&mh, cm)){
+        if(SOL_SOCKET == cm->cmsg_level && SCM_RIGHTS == cm->cmsg_type){
+            *nfds = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            memcpy(fds, CMSG_DATA(cm), sizeof(int) * *nfds);
+        }
+    }
+    if(sizeof(*msg) != n || ZHOT_MAGIC != msg->magic || (mh.msg_flags & MSG_CTRUNC)){
+        while(*nfds){
+            close(fds[--*nfds]);
+        }
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+/** @brief blocking receive for the new process side */
+static zerr_t zhot_wait(zsock_t sock, zhot_msg_t *msg, zsock_t *fds, int *nfds, int type,
+                        int timeout_ms){
+    struct pollfd pfd;
+    zerr_t ret;
+
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    if(0 >= poll(&pfd, 1, timeout_ms)){
+        return ZETIMEOUT;
+    }
+    if(ZEOK != (ret = zhot_recv(sock, msg, fds, nfds))){
+        return ZEAGAIN == ret ? ZETIMEOUT : ret;
+    }
+    if((uint32_t)type != msg->type){
+        while(*nfds){
+            close(fds[--*nfds]);
+        }
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+zerr_t zhot_init(zhot_t *hot, const char *path, int drain_ms){
+    memset(hot, 0, sizeof(*hot));
+    if(!path || strlen(path) >= ZHOT_PATH){
+        return ZEPARAM_INVALID;
+    }
+    strcpy(hot->path, path);
+    hot->server = ZINVALID_SOCKET;
+    hot->peer = ZINVALID_SOCKET;
+    hot->drain_ms = drain_ms;
+    return ZEOK;
+}
+
+void zhot_fini(zhot_t *hot){
+    int i;
+
+    if(ZINVALID_SOCKET != hot->server){
+        /* still the owner of the path, no successor took it */
+        close(hot->server);
+        unlink(hot->path);
+        hot->server = ZINVALID_SOCKET;
+    }
+    if(ZINVALID_SOCKET != hot->peer){
+        close(hot->peer);
+        hot->peer = ZINVALID_SOCKET;
+    }
+    for(i = 0; i < hot->cnt; ++i){
+        if(ZINVALID_SOCKET != hot->lsn[i].fd){
+            zsockclose(hot->lsn[i].fd);
+            hot->lsn[i].fd = ZINVALID_SOCKET;
+        }
+    }
+    hot->cnt = 0;
+}
+
+zerr_t zhot_inherit(zhot_t *hot, int timeout_ms){
+    struct sockaddr_un addr;
+    zhot_msg_t msg;
+    zsock_t fds[ZHOT_MAX];
+    zsock_t sock;
+    int nfds, i;
+    zerr_t ret;
+
+    if(ZEOK != (ret = zhot_addr(hot, &addr))){
+        return ret;
+    }
+    if(0 > (sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0))){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    if(0 != connect(sock, (ZSA*)&addr, sizeof(addr))){
+        zdbg("hot restart: no process at %s, cold start", hot->path);
+        close(sock);
+        return ZEFAIL;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.type = ZHOT_HELLO;
+    if(ZEOK != (ret = zhot_send(sock, &msg, NULL, 0)) ||
+       ZEOK != (ret = zhot_wait(sock, &msg, fds, &nfds, ZHOT_FDS, timeout_ms))){
+        close(sock);
+        zerrno(ret);
+        return ret;
+    }
+    if((uint32_t)nfds != msg.cnt || nfds > ZHOT_MAX - hot->cnt){
+        while(nfds){
+            close(fds[--nfds]);
+        }
+        close(sock);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    for(i = 0; i < nfds; ++i){
+        msg.keys[i][ZHOT_KEY - 1] = '\0';
+        strcpy(hot->lsn[hot->cnt].key, msg.keys[i]);
+        hot->lsn[hot->cnt].fd = fds[i];
+        hot->lsn[hot->cnt].inherited = 1;
+        hot->lsn[hot->cnt].used = 0;
+        ++hot->cnt;
+    }
+    hot->peer = sock;
+    hot->other = msg.pid;
+    zinf("hot restart: %d listeners from pid %d", nfds, msg.pid);
+    return ZEOK;
+}
+
+zsock_t zhot_listen(zhot_t *hot, const char *host, uint16_t port, int listenq){
+    char key[ZHOT_KEY];
+    zsock_t sock;
+    int i;
+
+    snprintf(key, sizeof(key), "%s:%u", host ? host : "*", port);
+    for(i = 0; i < hot->cnt; ++i){
+        if(ZINVALID_SOCKET != hot->lsn[i].fd && 0 == strcmp(key, hot->lsn[i].key)){
+            hot->lsn[i].used = 1;
+            return hot->lsn[i].fd;
+        }
+    }
+    if(ZHOT_MAX == hot->cnt){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return ZINVALID_SOCKET;
+    }
+    if(ZINVALID_SOCKET == (sock = zsocket(AF_INET, SOCK_STREAM, 0))){
+        return ZINVALID_SOCKET;
+    }
+    if(ZEOK != zconnectx(sock, host, port, listenq, ZHOT_RESOLV_MS)){
+        zsockclose(sock);
+        return ZINVALID_SOCKET;
+    }
+    strcpy(hot->lsn[hot->cnt].key, key);
+    hot->lsn[hot->cnt].fd = sock;
+    hot->lsn[hot->cnt].inherited = 0;
+    hot->lsn[hot->cnt].used = 1;
+    ++hot->cnt;
+    return sock;
+}
+
+zerr_t zhot_ready(zhot_t *hot, int timeout_ms){
+    zhot_msg_t msg;
+    zsock_t fds[ZHOT_MAX];
+    int nfds, i;
+    zerr_t ret;
+
+    for(i = 0; i < hot->cnt; ++i){
+        if(!hot->lsn[i].used && ZINVALID_SOCKET != hot->lsn[i].fd){
+            /* the old binary listened here, this one does not */
+            zsockclose(hot->lsn[i].fd);
+            hot->lsn[i].fd = ZINVALID_SOCKET;
+        }
+    }
+    if(ZINVALID_SOCKET == hot->peer){
+        return ZEOK;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.type = ZHOT_READY;
+    if(ZEOK == (ret = zhot_send(hot->peer, &msg, NULL, 0))){
+        ret = zhot_wait(hot->peer, &msg, fds, &nfds, ZHOT_DRAIN, timeout_ms);
+    }
+    close(hot->peer);
+    hot->peer = ZINVALID_SOCKET;
+    zinf("hot restart: pid %d %s", hot->other, ZEOK == ret ? "draining" : "did not answer");
+    return ret;
+}
+
+zerr_t zhot_serve(zhot_t *hot){
+    struct sockaddr_un addr;
+    zerr_t ret;
+
+    if(ZEOK != (ret = zhot_addr(hot, &addr))){
+        return ret;
+    }
+    if(0 > (hot->server = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0))){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    /* a stale path, or the one of the process being replaced */
+    unlink(hot->path);
+    if(0 != bind(hot->server, (ZSA*)&addr, sizeof(addr)) || 0 != listen(hot->server, 1)){
+        zerrno(errno);
+        close(hot->server);
+        hot->server = ZINVALID_SOCKET;
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+static void zhot_drain(zhot_t *hot){
+    int i;
+
+    for(i = 0; i < hot->cnt; ++i){
+        if(ZINVALID_SOCKET != hot->lsn[i].fd){
+            /* the successor holds the same socket, the queue stays open */
+            zsockclose(hot->lsn[i].fd);
+            hot->lsn[i].fd = ZINVALID_SOCKET;
+        }
+    }
+    /* the path belongs to the successor now, close without unlink */
+    close(hot->server);
+    hot->server = ZINVALID_SOCKET;
+    close(hot->peer);
+    hot->peer = ZINVALID_SOCKET;
+    hot->state = ZHOT_DRAINING;
+    hot->deadline = zhot_now() + hot->drain_ms;
+    zinf("hot restart: handed over to pid %d, draining %dms", hot->other, hot->drain_ms);
+}
+
+zerr_t zhot_poll(zhot_t *hot){
+    zhot_msg_t msg;
+    zsock_t fds[ZHOT_MAX];
+    int nfds, i;
+    zerr_t ret;
+
+    if(ZINVALID_SOCKET == hot->peer){
+        if(ZINVALID_SOCKET == hot->server ||
+           0 > (hot->peer = accept4(hot->server, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC))){
+            hot->peer = ZINVALID_SOCKET;
+            return ZEOK;
+        }
+    }
+    while(ZEOK == (ret = zhot_recv(hot->peer, &msg, fds, &nfds))){
+        while(nfds){
+            close(fds[--nfds]);
+        }
+        hot->other = msg.pid;
+        if(ZHOT_HELLO == msg.type){
+            msg.cnt = 0;
+            for(i = 0; i < hot->cnt; ++i){
+                if(ZINVALID_SOCKET != hot->lsn[i].fd){
+                    strcpy(msg.keys[msg.cnt], hot->lsn[i].key);
+                    fds[msg.cnt++] = hot->lsn[i].fd;
+                }
+            }
+            msg.type = ZHOT_FDS;
+            if(ZEOK != (ret = zhot_send(hot->peer, &msg, fds, msg.cnt))){
+                break;
+            }
+            zinf("hot restart: %u listeners sent to pid %d", msg.cnt, hot->other);
+        }else if(ZHOT_READY == msg.type){
+            memset(&msg, 0, sizeof(msg));
+            msg.type = ZHOT_DRAIN;
+            zhot_send(hot->peer, &msg, NULL, 0);
+            zhot_drain(hot);
+            return ZEOK;
+        }
+    }
+    if(ZEAGAIN == ret){
+        return ZEOK;
+    }
+    /* the new binary died before taking over, keep serving */
+    zinf("hot restart: pid %d left before taking over", hot->other);
+    close(hot->peer);
+    hot->peer = ZINVALID_SOCKET;
+    return ZEFAIL;
+}
+
+int zhot_drained(zhot_t *hot, int sessions){
+    return ZHOT_DRAINING == hot->state && (sessions <= 0 || zhot_now() >= hot->deadline);
+}
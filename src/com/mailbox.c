@@ -0,0 +1,184 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file mailbox.c
+ * @brief Bounded lock-free MPSC mailbox for cross-thread message handoff
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/mailbox.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+zmbox_t *zmbox_create(uint32_t size){
+    zmbox_t *mbox = NULL;
+    uint64_t sz = 2;
+    uint64_t i;
+
+    while(sz < size){
+        sz <<= 1;
+    }
+    if(0 != posix_memalign((void**)&mbox, ZMBOX_CACHELINE, sizeof(zmbox_t))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    memset(mbox, 0, sizeof(zmbox_t));
+    mbox->rfd = mbox->wfd = -1;
+    if(!(mbox->cells = (zmbox_cell_t*)calloc(sz, sizeof(zmbox_cell_t)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        free(mbox);
+        return NULL;
+    }
+    for(i = 0; i < sz; ++i){
+        mbox->cells[i].seq = i;
+    }
+    mbox->mask = sz - 1;
+#ifdef __linux__
+    mbox->rfd = mbox->wfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+    {
+        int fds[2];
+        if(0 == pipe(fds)){
+            fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+            fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL, 0) | O_NONBLOCK);
+            mbox->rfd = fds[0];
+            mbox->wfd = fds[1];
+        }
+    }
+#endif
+    if(-1 == mbox->rfd){
+        zerrno(errno);
+        zmbox_destroy(mbox);
+        return NULL;
+    }
+    return mbox;
+}
+
+void zmbox_destroy(zmbox_t *mbox){
+    if(!mbox){
+        return;
+    }
+    if(-1 != mbox->wfd && mbox->wfd != mbox->rfd){
+        close(mbox->wfd);
+    }
+    if(-1 != mbox->rfd){
+        close(mbox->rfd);
+    }
+    free(mbox->cells);
+    free(mbox);
+}
+
+zerr_t zmbox_push(zmbox_t *mbox, zptr_t data){
+    zmbox_cell_t *cell;
+    uint64_t pos = __atomic_load_n(&mbox->tail, __ATOMIC_RELAXED);
+    uint64_t seq;
+    int64_t dif;
+
+    for(;;){
+        cell = &mbox->cells[pos & mbox->mask];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        dif = (int64_t)(seq - pos);
+        if(0 == dif){
+            if(__atomic_compare_exchange_n(&mbox->tail, &pos, pos + 1, 1,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                break;
+            }
+        }else if(dif < 0){
+            return ZEAGAIN;
+        }else{
+            pos = __atomic_load_n(&mbox->tail, __ATOMIC_RELAXED);
+        }
+    }
+    cell->data = data;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+    /* order the publish before the idle load, pairs with zmbox_pop() */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&mbox->idle, __ATOMIC_RELAXED) &&
+       __atomic_exchange_n(&mbox->idle, 0, __ATOMIC_ACQ_REL)){
+        uint64_t one = 1;
+        if(write(mbox->wfd, &one, sizeof(one)) < 0 && EAGAIN != errno){
+            zerrno(errno);
+        }
+    }
+    return ZEOK;
+}
+
+static int zmbox_take(zmbox_t *mbox, zptr_t *items, int max){
+    zmbox_cell_t *cell;
+    uint64_t pos = mbox->head;
+    int cnt = 0;
+
+    while(cnt < max){
+        cell = &mbox->cells[pos & mbox->mask];
+        if(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1){
+            break;
+        }
+        items[cnt++] = cell->data;
+        __atomic_store_n(&cell->seq, pos + mbox->mask + 1, __ATOMIC_RELEASE);
+        ++pos;
+    }
+    mbox->head = pos;
+    return cnt;
+}
+
+int zmbox_pop(zmbox_t *mbox, zptr_t *items, int max){
+    int cnt;
+
+    if(mbox->armed){
+        /*
+         * drain whether or not <idle> was cleared: a producer that cleared
+         * it may ring only after we re-arm, the doorbell is non-blocking
+         */
+        char drain[64];
+        if(read(mbox->rfd, drain, sizeof(drain)) > 0){
+            ++mbox->wakeups;
+        }
+        mbox->armed = 0;
+    }
+    if(0 == (cnt = zmbox_take(mbox, items, max))){
+        /* announce idle, then look again so a racing push is not missed */
+        __atomic_store_n(&mbox->idle, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if(0 == (cnt = zmbox_take(mbox, items, max))){
+            mbox->armed = 1;
+            return ZEAGAIN;
+        }
+        __atomic_store_n(&mbox->idle, 0, __ATOMIC_RELAXED);
+    }
+    mbox->pops += cnt;
+    ++mbox->batches;
+    return cnt;
+}
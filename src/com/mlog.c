@@ -0,0 +1,586 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file mlog.c
+ * @brief Segmented memory-mapped append-only log with group commit
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/mlog.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+struct zmlog_s{
+    char dir[256];
+    zmlog_cfg_t cfg;
+    zmlog_seg_t *segs[ZMLOG_SEGS];
+    int nsegs; /** release stored on a roll */
+    uint64_t next; /** next offset, stored after the record is in place */
+    uint64_t appended; /** bytes ever appended */
+    uint64_t committed; /** offsets below are durable */
+    uint64_t committed_bytes;
+    uint64_t commits; /** statistic, syncs done */
+    int commit_seg; /** committer: first segment with unsynced data */
+    int idle; /** committer waits for appends */
+    int stop;
+    pthread_t thr;
+    pthread_mutex_t mtx;
+    pthread_cond_t kick; /** appender -> committer */
+    pthread_cond_t done; /** committer -> zmlog_sync() */
+    int efd; /** committer -> ST loop */
+    st_netfd_t stfd;
+    st_cond_t st_done;
+    st_thread_t st_thr;
+};
+
+static uint32_t zmlog_sum(const char *buf, uint32_t len){
+    uint32_t h = 2166136261u;
+    uint32_t i;
+
+    for(i = 0; i < len; ++i){
+        h = (h ^ (uint8_t)buf[i]) * 16777619u;
+    }
+    return h;
+}
+
+zinline uint64_t zmlog_rec_size(uint32_t len){
+    return (ZMLOG_HDR + (uint64_t)len + 7) & ~(uint64_t)7;
+}
+
+zinline uint32_t zmlog_len_at(zmlog_seg_t *seg, uint64_t pos){
+    return *(uint32_t*)(seg->map + pos);
+}
+
+static void zmlog_idx_add(zmlog_seg_t *seg, uint64_t pos){
+    if(!seg->idx_cnt || pos >= seg->idx[seg->idx_cnt - 1][1] + ZMLOG_IDX_BYTES){
+        seg->idx[seg->idx_cnt][0] = (uint32_t)seg->count;
+        seg->idx[seg->idx_cnt++][1] = (uint32_t)pos;
+    }
+}
+
+static void zmlog_seg_free(zmlog_seg_t *seg){
+    if(seg->map && MAP_FAILED != seg->map){
+        munmap(seg->map, seg->size);
+    }
+    if(seg->fd >= 0){
+        close(seg->fd);
+    }
+    free(seg->idx);
+    free(seg);
+}
+
+/** @brief make the name of a created segment durable */
+static int zmlog_sync_dir(zmlog_t *log){
+    int fd, ret;
+
+    if(0 > (fd = open(log->dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC))){
+        return -1;
+    }
+    ret = fsync(fd);
+    close(fd);
+    return ret;
+}
+
+/** @brief map a segment, <create> preallocates a new one */
+static zmlog_seg_t *zmlog_seg_open(zmlog_t *log, uint64_t base, int create){
+    zmlog_seg_t *seg;
+    char path[300];
+    struct stat st;
+
+    if(!(seg = (zmlog_seg_t*)calloc(1, sizeof(*seg)))){
+        return NULL;
+    }
+    seg->base = base;
+    snprintf(path, sizeof(path), "%s/%020llu.log", log->dir, (unsigned long long)base);
+    if(0 > (seg->fd = open(path, O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0644))){
+        zerrno(errno);
+        free(seg);
+        return NULL;
+    }
+    if(create){
+        /* blocks allocated now, a commit never changes the file metadata */
+        if((0 != posix_fallocate(seg->fd, 0, log->cfg.seg_bytes) &&
+            0 != ftruncate(seg->fd, log->cfg.seg_bytes)) ||
+           /* commits only sync data, the size and the name must be on disk first */
+           0 != fsync(seg->fd) || 0 != zmlog_sync_dir(log)){
+            zerrno(errno);
+            zmlog_seg_free(seg);
+            unlink(path);
+            return NULL;
+        }
+        seg->size = log->cfg.seg_bytes;
+    }else if(0 == fstat(seg->fd, &st)){
+        seg->size = st.st_size;
+    }
+    if(seg->size < ZMLOG_HDR + 8 || seg->size > UINT32_MAX ||
+       MAP_FAILED == (seg->map = (char*)mmap(NULL, seg->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                             seg->fd, 0)) ||
+       !(seg->idx = (uint32_t(*)[2])malloc(sizeof(uint32_t[2]) * (seg->size / ZMLOG_IDX_BYTES + 2)))){
+        zerrno(ZEFAIL);
+        zmlog_seg_free(seg);
+        return NULL;
+    }
+    return seg;
+}
+
+/**
+ * @brief recovery: keep the valid prefix, zero whatever a crash left past
+ *        it (pages may reach the disk out of order) so a later record can
+ *        never be followed by a stale one that happens to check out
+ */
+static void zmlog_seg_scan(zmlog_seg_t *seg){
+    uint64_t pos = 0, end, page, i, dirty = 0;
+    uint32_t len;
+
+    while(pos + ZMLOG_HDR <= seg->size && (len = zmlog_len_at(seg, pos)) &&
+          pos + zmlog_rec_size(len) <= seg->size &&
+          zmlog_sum(seg->map + pos + ZMLOG_HDR, len) == *(uint32_t*)(seg->map + pos + 4)){
+        zmlog_idx_add(seg, pos);
+        ++seg->count;
+        pos += zmlog_rec_size(len);
+    }
+    seg->written = pos;
+    seg->synced = pos;
+    for(end = pos; end < seg->size; end = page){
+        page = (end | (ZMLOG_IDX_BYTES - 1)) + 1;
+        if(page > seg->size){
+            page = seg->size;
+        }
+        for(i = end; i < page && !seg->map[i]; ++i){
+        }
+        if(i < page){
+            memset(seg->map + end, 0, page - end);
+            dirty = page;
+        }
+    }
+    if(dirty){
+        end = pos & ~(uint64_t)(ZMLOG_IDX_BYTES - 1);
+        msync(seg->map + end, dirty - end, MS_SYNC);
+    }
+}
+
+static void *zmlog_committer(void *arg){
+    zmlog_t *log = (zmlog_t*)arg;
+    struct timespec ts;
+    zmlog_seg_t *seg;
+    uint64_t off, bytes, written, from;
+    int s, n;
+
+    pthread_mutex_lock(&log->mtx);
+    for(;;){
+        if(__atomic_load_n(&log->next, __ATOMIC_SEQ_CST) == log->committed){
+            if(log->stop){
+                break;
+            }
+            __atomic_store_n(&log->idle, 1, __ATOMIC_SEQ_CST);
+            if(__atomic_load_n(&log->next, __ATOMIC_SEQ_CST) == log->committed){
+                pthread_cond_wait(&log->kick, &log->mtx);
+            }
+            __atomic_store_n(&log->idle, 0, __ATOMIC_SEQ_CST);
+            continue;
+        }
+        if(log->cfg.max_delay_us > 0 && !log->stop &&
+           __atomic_load_n(&log->appended, __ATOMIC_SEQ_CST) - log->committed_bytes < log->cfg.max_batch){
+            /* linger, appends arriving meanwhile ride on the same sync */
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += log->cfg.max_delay_us * 1000L;
+            ts.tv_sec += ts.tv_nsec / 1000000000;
+            ts.tv_nsec %= 1000000000;
+            pthread_cond_timedwait(&log->kick, &log->mtx, &ts);
+        }
+        pthread_mutex_unlock(&log->mtx);
+
+        off = __atomic_load_n(&log->next, __ATOMIC_ACQUIRE);
+        bytes = __atomic_load_n(&log->appended, __ATOMIC_ACQUIRE);
+        n = __atomic_load_n(&log->nsegs, __ATOMIC_ACQUIRE);
+        for(s = log->commit_seg; s < n; ++s){
+            seg = log->segs[s];
+            written = __atomic_load_n(&seg->written, __ATOMIC_ACQUIRE);
+            if(written > seg->synced){
+                from = seg->synced & ~(uint64_t)(ZMLOG_IDX_BYTES - 1);
+                if(0 != msync(seg->map + from, written - from, MS_SYNC)){
+                    zerrno(errno);
+                }
+                seg->synced = written;
+            }
+            if(s < n - 1){
+                /* rolled, nothing more will be written to it */
+                log->commit_seg = s + 1;
+            }
+        }
+
+        pthread_mutex_lock(&log->mtx);
+        __atomic_store_n(&log->committed, off, __ATOMIC_RELEASE);
+        log->committed_bytes = bytes;
+        ++log->commits;
+        pthread_cond_broadcast(&log->done);
+        if(log->efd >= 0){
+            off = 1;
+            if(sizeof(off) != write(log->efd, &off, sizeof(off))){
+                /* the counter is already non zero, the loop will see it */
+            }
+        }
+    }
+    pthread_mutex_unlock(&log->mtx);
+    return NULL;
+}
+
+static int zmlog_base_cmp(const void *a, const void *b){
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+zerr_t zmlog_open(zmlog_t **plog, const char *dir, const zmlog_cfg_t *cfg){
+    zmlog_t *log;
+    DIR *dp;
+    struct dirent *de;
+    uint64_t bases[ZMLOG_SEGS];
+    unsigned long long base;
+    char tail[8];
+    int cnt = 0, i;
+
+    if(strlen(dir) >= sizeof(log->dir) || !(log = (zmlog_t*)calloc(1, sizeof(*log)))){
+        return ZEPARAM_INVALID;
+    }
+    strcpy(log->dir, dir);
+    if(cfg){
+        log->cfg = *cfg;
+    }else{
+        zmlog_cfg_default(&log->cfg);
+    }
+    log->cfg.seg_bytes = (log->cfg.seg_bytes + ZMLOG_IDX_BYTES - 1) & ~(uint64_t)(ZMLOG_IDX_BYTES - 1);
+    log->efd = -1;
+    mkdir(dir, 0755);
+    if(!(dp = opendir(dir))){
+        zerrno(errno);
+        free(log);
+        return ZEFAIL;
+    }
+    while((de = readdir(dp)) && cnt < ZMLOG_SEGS){
+        if(2 == sscanf(de->d_name, "%20llu.%3s", &base, tail) && 0 == strcmp("log", tail)){
+            bases[cnt++] = base;
+        }
+    }
+    closedir(dp);
+    qsort(bases, cnt, sizeof(uint64_t), zmlog_base_cmp);
+    for(i = 0; i < cnt; ++i){
+        if(!(log->segs[i] = zmlog_seg_open(log, bases[i], 0))){
+            break;
+        }
+        zmlog_seg_scan(log->segs[i]);
+        log->nsegs = i + 1;
+        log->next = bases[i] + log->segs[i]->count;
+    }
+    if(!log->nsegs && (log->segs[0] = zmlog_seg_open(log, 0, 1))){
+        log->nsegs = 1;
+    }
+    if(!log->nsegs || (cnt && log->nsegs != cnt)){
+        zmlog_close(log);
+        return ZEFAIL;
+    }
+    /* what was recovered was synced by the scan or by its own commit */
+    log->committed = log->next;
+    log->commit_seg = log->nsegs - 1;
+    log->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    pthread_mutex_init(&log->mtx, NULL);
+    pthread_cond_init(&log->kick, NULL);
+    pthread_cond_init(&log->done, NULL);
+    if(0 != pthread_create(&log->thr, NULL, zmlog_committer, log)){
+        log->thr = 0;
+        zmlog_close(log);
+        return ZEFAIL;
+    }
+    zinf("mlog %s: %d segments, offsets [%llu, %llu)", dir, log->nsegs,
+         (unsigned long long)log->segs[0]->base, (unsigned long long)log->next);
+    *plog = log;
+    return ZEOK;
+}
+
+void zmlog_close(zmlog_t *log){
+    int i;
+
+    if(log->st_thr){
+        st_thread_interrupt(log->st_thr);
+        zst_thread_join(log->st_thr);
+    }
+    if(log->st_done){
+        st_cond_destroy(log->st_done);
+    }
+    if(log->stfd){
+        st_netfd_free(log->stfd);
+    }
+    if(log->thr){
+        /* the committer leaves once everything appended is durable */
+        pthread_mutex_lock(&log->mtx);
+        log->stop = 1;
+        pthread_cond_signal(&log->kick);
+        pthread_mutex_unlock(&log->mtx);
+        pthread_join(log->thr, NULL);
+        pthread_mutex_destroy(&log->mtx);
+        pthread_cond_destroy(&log->kick);
+        pthread_cond_destroy(&log->done);
+        zinf("mlog %s closed at %llu, %llu commits", log->dir,
+             (unsigned long long)log->committed, (unsigned long long)log->commits);
+    }
+    for(i = 0; i < log->nsegs; ++i){
+        zmlog_seg_free(log->segs[i]);
+    }
+    if(log->efd >= 0){
+        close(log->efd);
+    }
+    free(log);
+}
+
+zerr_t zmlog_append(zmlog_t *log, const void *buf, uint32_t len, uint64_t *offset){
+    zmlog_seg_t *seg = log->segs[log->nsegs - 1];
+    uint64_t size = zmlog_rec_size(len);
+    uint64_t next = log->next;
+    char *p;
+
+    if(!len || size > log->cfg.seg_bytes){
+        return ZEPARAM_INVALID;
+    }
+    if(seg->written + size > seg->size){
+        if(ZMLOG_SEGS == log->nsegs || !(seg = zmlog_seg_open(log, next, 1))){
+            zerrno(ZEFAIL);
+            return ZEFAIL;
+        }
+        log->segs[log->nsegs] = seg;
+        __atomic_store_n(&log->nsegs, log->nsegs + 1, __ATOMIC_RELEASE);
+    }
+    p = seg->map + seg->written;
+    memcpy(p + ZMLOG_HDR, buf, len);
+    *(uint32_t*)(p + 4) = zmlog_sum(p + ZMLOG_HDR, len);
+    *(uint32_t*)p = len;
+    zmlog_idx_add(seg, seg->written);
+    ++seg->count;
+    __atomic_store_n(&seg->written, seg->written + size, __ATOMIC_RELEASE);
+    __atomic_store_n(&log->next, next + 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&log->appended, log->appended + size, __ATOMIC_SEQ_CST);
+    if(offset){
+        *offset = next;
+    }
+    /* a lock and a signal only when the committer sleeps or a batch is full */
+    if(__atomic_load_n(&log->idle, __ATOMIC_SEQ_CST) ||
+       log->appended - __atomic_load_n(&log->committed_bytes, __ATOMIC_RELAXED) >= log->cfg.max_batch){
+        pthread_mutex_lock(&log->mtx);
+        pthread_cond_signal(&log->kick);
+        pthread_mutex_unlock(&log->mtx);
+    }
+    return ZEOK;
+}
+
+int zmlog_append_raw(zmlog_t *log, const char *buf, int len){
+    uint32_t rlen;
+    int used = 0;
+
+    while(len - used >= ZMLOG_HDR){
+        memcpy(&rlen, buf + used, 4);
+        if(!rlen || zmlog_rec_size(rlen) > log->cfg.seg_bytes){
+            return ZEFAIL;
+        }
+        if((uint64_t)(len - used) < zmlog_rec_size(rlen)){
+            break;
+        }
+        if(zmlog_sum(buf + used + ZMLOG_HDR, rlen) != *(const uint32_t*)(buf + used + 4) ||
+           ZEOK != zmlog_append(log, buf + used + ZMLOG_HDR, rlen, NULL)){
+            return ZEFAIL;
+        }
+        used += zmlog_rec_size(rlen);
+    }
+    return used;
+}
+
+uint64_t zmlog_end(zmlog_t *log){
+    return __atomic_load_n(&log->next, __ATOMIC_ACQUIRE);
+}
+
+uint64_t zmlog_committed(zmlog_t *log){
+    return __atomic_load_n(&log->committed, __ATOMIC_ACQUIRE);
+}
+
+zerr_t zmlog_sync(zmlog_t *log, uint64_t offset, int timeout_ms){
+    struct timespec ts;
+    zerr_t ret = ZEOK;
+
+    if(zmlog_committed(log) > offset){
+        return ZEOK;
+    }
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    ts.tv_sec += ts.tv_nsec / 1000000000;
+    ts.tv_nsec %= 1000000000;
+    pthread_mutex_lock(&log->mtx);
+    while(log->committed <= offset && ZEOK == ret){
+        if(ETIMEDOUT == pthread_cond_timedwait(&log->done, &log->mtx, &ts)){
+            ret = log->committed > offset ? ZEOK : ZETIMEOUT;
+        }
+    }
+    pthread_mutex_unlock(&log->mtx);
+    return ret;
+}
+
+static void *zmlog_st_proc(void *arg){
+    zmlog_t *log = (zmlog_t*)arg;
+    uint64_t cnt;
+
+    /* interrupted by zmlog_close() */
+    while(0 == st_netfd_poll(log->stfd, POLLIN, ST_UTIME_NO_TIMEOUT)){
+        if(sizeof(cnt) == read(log->efd, &cnt, sizeof(cnt))){
+            st_cond_broadcast(log->st_done);
+        }
+    }
+    return NULL;
+}
+
+zerr_t zmlog_st_start(zmlog_t *log){
+    if(log->st_thr){
+        return ZEOK;
+    }
+    if(log->efd < 0 || !(log->stfd = st_netfd_open(log->efd)) || !(log->st_done = st_cond_new()) ||
+       !(log->st_thr = zst_thread_create(zmlog_st_proc, log, ztrue, 0))){
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+zerr_t zmlog_st_wait(zmlog_t *log, uint64_t offset, st_utime_t timeout){
+    st_utime_t deadline = ST_UTIME_NO_TIMEOUT == timeout ? timeout : st_utime() + timeout;
+    st_utime_t now;
+
+    while(zmlog_committed(log) <= offset){
+        if(ST_UTIME_NO_TIMEOUT == deadline){
+            if(0 != st_cond_wait(log->st_done)){
+                return ZEFAIL;
+            }
+        }else if((now = st_utime()) >= deadline ||
+                 (0 != st_cond_timedwait(log->st_done, deadline - now) && ETIME != errno)){
+            return zmlog_committed(log) > offset ? ZEOK : (now >= deadline ? ZETIMEOUT : ZEFAIL);
+        }
+    }
+    return ZEOK;
+}
+
+/** @brief segment and byte position of record <offset> */
+static zmlog_seg_t *zmlog_lookup(zmlog_t *log, uint64_t offset, uint64_t *pos){
+    zmlog_seg_t *seg;
+    uint64_t cur;
+    int lo = 0, hi = log->nsegs - 1, mid;
+
+    if(offset >= log->next || offset < log->segs[0]->base){
+        return NULL;
+    }
+    while(lo < hi){
+        mid = (lo + hi + 1) / 2;
+        if(log->segs[mid]->base <= offset){
+            lo = mid;
+        }else{
+            hi = mid - 1;
+        }
+    }
+    seg = log->segs[lo];
+    for(lo = 0, hi = seg->idx_cnt - 1; lo < hi;){
+        mid = (lo + hi + 1) / 2;
+        if(seg->base + seg->idx[mid][0] <= offset){
+            lo = mid;
+        }else{
+            hi = mid - 1;
+        }
+    }
+    cur = seg->base + seg->idx[lo][0];
+    *pos = seg->idx[lo][1];
+    for(; cur < offset; ++cur){
+        *pos += zmlog_rec_size(zmlog_len_at(seg, *pos));
+    }
+    return seg;
+}
+
+zerr_t zmlog_read(zmlog_t *log, uint64_t offset, zmlog_rec_t *rec){
+    zmlog_seg_t *seg;
+    uint64_t pos;
+
+    if(!(seg = zmlog_lookup(log, offset, &pos))){
+        return ZEPARAM_INVALID;
+    }
+    rec->len = zmlog_len_at(seg, pos);
+    rec->data = seg->map + pos + ZMLOG_HDR;
+    rec->offset = offset;
+    return ZEOK;
+}
+
+int zmlog_sendfile(zmlog_t *log, int sock, zmlog_cursor_t *cur, int max_bytes){
+    uint64_t committed = zmlog_committed(log);
+    zmlog_seg_t *seg;
+    uint64_t pos, end, size;
+    off_t at;
+    ssize_t n;
+
+    if(cur->offset >= committed){
+        return 0;
+    }
+    if(!(seg = zmlog_lookup(log, cur->offset, &pos))){
+        return ZEFAIL;
+    }
+    if(committed >= seg->base + seg->count){
+        end = seg->written;
+    }else{
+        zmlog_lookup(log, committed, &end);
+    }
+    at = pos + cur->sent;
+    size = end - at < (uint64_t)max_bytes ? end - at : (uint64_t)max_bytes;
+    if(0 > (n = sendfile(sock, seg->fd, &at, size))){
+        if(EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno){
+            return ZEAGAIN;
+        }
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    /* move the cursor over the records sent, a partial one keeps its count */
+    size = cur->sent + n;
+    while(pos < end && size >= zmlog_rec_size(zmlog_len_at(seg, pos))){
+        size -= zmlog_rec_size(zmlog_len_at(seg, pos));
+        pos += zmlog_rec_size(zmlog_len_at(seg, pos));
+        ++cur->offset;
+    }
+    cur->sent = (uint32_t)size;
+    return (int)n;
+}
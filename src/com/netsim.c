@@ -0,0 +1,533 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file netsim.c
+ * @brief In-process network simulator behind the ztrans_t surface
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/netsim.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ZNETSIM_PORT 0
+#define ZNETSIM_STREAM 1
+
+#define ZNETSIM_EV_DATA 0
+#define ZNETSIM_EV_CLOSE 1
+#define ZNETSIM_EV_TIMER 2
+
+struct znetsim_ev_s{
+    uint64_t at;
+    uint64_t seq;
+    int type;
+    znetsim_node_t *src;
+    znetsim_ep_t *ep; /** destination */
+    znetsim_node_t *node; /** timer */
+    znetsim_timer_t cb;
+    zptr_t arg;
+    znetsim_ev_t *next; /** wire or inbox */
+    int len;
+    char data[];
+};
+
+struct znetsim_ep_s{
+    znetsim_t *sim;
+    znetsim_node_t *node; /** owner */
+    znetsim_ep_t *peer; /** stream */
+    int kind;
+    /* stream segments in flight, only the head is scheduled so a retried
+       segment holds back the ones behind it */
+    znetsim_ev_t *wire;
+    znetsim_ev_t *wire_tail;
+    znetsim_ev_t *inbox;
+    znetsim_ev_t *inbox_tail;
+    int off; /** bytes of the inbox head already read */
+    int closed; /** by its owner */
+    ztrans_t trans;
+    znetsim_ep_t *next;
+};
+
+/******************************************************************************
+ * event heap
+ */
+zinline int znetsim_before(znetsim_ev_t *a, znetsim_ev_t *b){
+    return a->at < b->at || (a->at == b->at && a->seq < b->seq);
+}
+
+static zerr_t znetsim_push(znetsim_t *sim, znetsim_ev_t *ev){
+    znetsim_ev_t **heap;
+    int i, up;
+
+    if(sim->nheap == sim->cap){
+        if(!(heap = (znetsim_ev_t**)realloc(sim->heap, (sim->cap ? sim->cap * 2 : 1024) *
+                                             sizeof(znetsim_ev_t*)))){
+            return ZEMEM_INSUFFICIENT;
+        }
+        sim->heap = heap;
+        sim->cap = sim->cap ? sim->cap * 2 : 1024;
+    }
+    ev->seq = sim->seq++;
+    for(i = sim->nheap++; i > 0 && znetsim_before(ev, sim->heap[up = (i - 1) / 2]); i = up){
+        sim->heap[i] = sim->heap[up];
+    }
+    sim->heap[i] = ev;
+    return ZEOK;
+}
+
+static znetsim_ev_t *znetsim_pop(znetsim_t *sim){
+    znetsim_ev_t *top = sim->heap[0];
+    znetsim_ev_t *last = sim->heap[--sim->nheap];
+    int i = 0, c;
+
+    while((c = 2 * i + 1) < sim->nheap){
+        if(c + 1 < sim->nheap && znetsim_before(sim->heap[c + 1], sim->heap[c])){
+            ++c;
+        }
+        if(!znetsim_before(sim->heap[c], last)){
+            break;
+        }
+        sim->heap[i] = sim->heap[c];
+        i = c;
+    }
+    sim->heap[i] = last;
+    return top;
+}
+
+uint32_t znetsim_rand(znetsim_t *sim, uint32_t n){
+    sim->rand ^= sim->rand >> 12;
+    sim->rand ^= sim->rand << 25;
+    sim->rand ^= sim->rand >> 27;
+    return n ? (uint32_t)((sim->rand * 0x2545f4914f6cdd1dULL) >> 32) % n : 0;
+}
+
+/******************************************************************************
+ * wire
+ */
+zinline znetsim_link_t *znetsim_link_of(znetsim_t *sim, znetsim_node_t *a, znetsim_node_t *b){
+    return &sim->links[a->zone][b->zone];
+}
+
+zinline uint64_t znetsim_rto(znetsim_link_t *link){
+    return ZNETSIM_RTO_US + 2 * (uint64_t)link->latency_us;
+}
+
+/** @brief serialize on the egress of <src>, cross the link to <ep> */
+static zerr_t znetsim_emit(znetsim_t *sim, znetsim_node_t *src, znetsim_ep_t *ep, int type,
+                           const char *buf, int len){
+    znetsim_link_t *link = znetsim_link_of(sim, src, ep->node);
+    znetsim_ev_t *ev;
+    uint64_t depart;
+
+    if(!(ev = (znetsim_ev_t*)malloc(sizeof(znetsim_ev_t) + len))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    if(len){
+        memcpy(ev->data, buf, len);
+    }
+    ev->len = len;
+    ev->type = type;
+    ev->src = src;
+    ev->ep = ep;
+    ev->next = NULL;
+    depart = src->tx_free > sim->now ? src->tx_free : sim->now;
+    if(src->bandwidth){
+        depart += (uint64_t)len * 1000000 / src->bandwidth;
+    }
+    src->tx_free = depart;
+    ev->at = depart + link->latency_us + znetsim_rand(sim, link->jitter_us + 1);
+    ++src->tx_msgs;
+    src->tx_bytes += len;
+    ++sim->msgs;
+    sim->bytes += len;
+    if(link->loss_ppm && znetsim_rand(sim, 1000000) < link->loss_ppm){
+        ++sim->lost;
+        if(ZNETSIM_PORT == ep->kind){
+            free(ev);
+            return ZEOK;
+        }
+        ev->at += znetsim_rto(link);
+        ++sim->retrans;
+    }
+    if(ZNETSIM_PORT == ep->kind){
+        return znetsim_push(sim, ev);
+    }
+    if(ep->wire){
+        ep->wire_tail->next = ev;
+        ep->wire_tail = ev;
+        return ZEOK;
+    }
+    ep->wire = ep->wire_tail = ev;
+    return znetsim_push(sim, ev);
+}
+
+static zerr_t znetsim_flush_node(znetsim_t *sim, znetsim_node_t *node){
+    znetsim_ep_t *ep = node->stage_ep;
+
+    if(!ep){
+        return ZEOK;
+    }
+    node->stage_ep = NULL;
+    return znetsim_emit(sim, node, ep, ZNETSIM_EV_DATA, node->stage, node->stage_len);
+}
+
+/** @brief the next stream segment may go once the head arrived */
+static void znetsim_wire_next(znetsim_t *sim, znetsim_ep_t *ep){
+    if((ep->wire = ep->wire->next)){
+        if(ep->wire->at < sim->now){
+            ep->wire->at = sim->now;
+        }
+        znetsim_push(sim, ep->wire);
+    }else{
+        ep->wire_tail = NULL;
+    }
+}
+
+static void znetsim_deliver(znetsim_t *sim, znetsim_ev_t *ev){
+    znetsim_ep_t *ep = ev->ep;
+    znetsim_node_t *dst = ep->node;
+
+    if(ev->src->group != dst->group){
+        ++sim->lost;
+        if(ZNETSIM_PORT == ep->kind){
+            free(ev);
+        }else{
+            /* the sender keeps retrying until the partition heals */
+            ev->at = sim->now + znetsim_rto(znetsim_link_of(sim, ev->src, dst));
+            ++sim->retrans;
+            znetsim_push(sim, ev);
+        }
+        return;
+    }
+    if(ZNETSIM_STREAM == ep->kind){
+        znetsim_wire_next(sim, ep);
+    }
+    if(ep->closed){
+        free(ev);
+        return;
+    }
+    ev->next = NULL;
+    if(ep->inbox){
+        ep->inbox_tail->next = ev;
+    }else{
+        ep->inbox = ev;
+    }
+    ep->inbox_tail = ev;
+    ++dst->rx_msgs;
+    dst->rx_bytes += ev->len;
+    if(dst->on_recv){
+        dst->on_recv(sim, dst, &ep->trans);
+    }
+}
+
+/******************************************************************************
+ * transport
+ */
+static zerr_t znetsim_send(zptr_t ctx, const char *buf, int *len, int flags){
+    znetsim_ep_t *ep = (znetsim_ep_t*)ctx;
+    znetsim_t *sim = ep->sim;
+    znetsim_node_t *src;
+    char *stage;
+    int cap;
+
+    if(ZNETSIM_PORT == ep->kind){
+        src = sim->cur;
+    }else{
+        src = ep->node;
+        if(ep->closed || ep->peer->closed){
+            return ZEFAIL;
+        }
+        ep = ep->peer;
+    }
+    if(!src){
+        /* a port sends on behalf of the node in znetsim_enter() */
+        return ZEFAIL;
+    }
+    if(*len <= 0){
+        return ZEOK;
+    }
+    if(src->stage_ep && src->stage_ep != ep && ZEOK != znetsim_flush_node(sim, src)){
+        return ZEFAIL;
+    }
+    if(!(flags & MSG_MORE) && !src->stage_ep){
+        return znetsim_emit(sim, src, ep, ZNETSIM_EV_DATA, buf, *len);
+    }
+    if(!src->stage_ep){
+        src->stage_ep = ep;
+        src->stage_len = 0;
+    }
+    if(src->stage_len + *len > src->stage_cap){
+        cap = (src->stage_len + *len) * 2;
+        if(!(stage = (char*)realloc(src->stage, cap))){
+            return ZEMEM_INSUFFICIENT;
+        }
+        src->stage = stage;
+        src->stage_cap = cap;
+    }
+    memcpy(src->stage + src->stage_len, buf, *len);
+    src->stage_len += *len;
+    return (flags & MSG_MORE) ? ZEOK : znetsim_flush_node(sim, src);
+}
+
+static zerr_t znetsim_recv(zptr_t ctx, char *buf, int len, int flags){
+    znetsim_ep_t *ep = (znetsim_ep_t*)ctx;
+    znetsim_ev_t *ev;
+    int got = 0, n;
+
+    while((ev = ep->inbox) && got < len && ZNETSIM_EV_DATA == ev->type){
+        n = ev->len - ep->off;
+        if(ZNETSIM_PORT == ep->kind){
+            /* one datagram, truncated to the buffer */
+            n = n < len ? n : len;
+            memcpy(buf, ev->data, n);
+            got = n;
+            n = ev->len;
+        }else{
+            n = n < len - got ? n : len - got;
+            memcpy(buf + got, ev->data + ep->off, n);
+            got += n;
+            n += ep->off;
+        }
+        if(n < ev->len){
+            ep->off = n;
+            break;
+        }
+        ep->off = 0;
+        if(!(ep->inbox = ev->next)){
+            ep->inbox_tail = NULL;
+        }
+        free(ev);
+        if(ZNETSIM_PORT == ep->kind){
+            break;
+        }
+    }
+    if(got){
+        return got;
+    }
+    return ep->inbox ? 0 : ZEAGAIN;
+}
+
+static zerr_t znetsim_flush(zptr_t ctx){
+    znetsim_ep_t *ep = (znetsim_ep_t*)ctx;
+    znetsim_node_t *node = ZNETSIM_PORT == ep->kind ? ep->sim->cur : ep->node;
+
+    return node ? znetsim_flush_node(ep->sim, node) : ZEOK;
+}
+
+static int znetsim_fileno(zptr_t ctx){
+    return -1;
+}
+
+static zerr_t znetsim_close(zptr_t ctx){
+    znetsim_ep_t *ep = (znetsim_ep_t*)ctx;
+    znetsim_ev_t *ev;
+
+    if(ZNETSIM_PORT == ep->kind || ep->closed){
+        return ZEOK;
+    }
+    if(ep->node->stage_ep == ep->peer){
+        znetsim_flush_node(ep->sim, ep->node);
+    }
+    ep->closed = 1;
+    while((ev = ep->inbox)){
+        ep->inbox = ev->next;
+        free(ev);
+    }
+    ep->inbox_tail = NULL;
+    if(!ep->peer->closed){
+        /* a FIN behind the data in flight */
+        return znetsim_emit(ep->sim, ep->node, ep->peer, ZNETSIM_EV_CLOSE, NULL, 0);
+    }
+    return ZEOK;
+}
+
+static const ztrans_ops_t znetsim_ops = {
+    "netsim",
+    znetsim_send,
+    znetsim_recv,
+    znetsim_flush,
+    znetsim_fileno,
+    znetsim_close
+};
+
+static znetsim_ep_t *znetsim_ep(znetsim_t *sim, znetsim_node_t *node, int kind){
+    znetsim_ep_t *ep;
+
+    if(!(ep = (znetsim_ep_t*)calloc(1, sizeof(znetsim_ep_t)))){
+        return NULL;
+    }
+    ep->sim = sim;
+    ep->node = node;
+    ep->kind = kind;
+    ep->trans.ops = &znetsim_ops;
+    ep->trans.ctx = (zptr_t)ep;
+    ep->next = sim->eps;
+    sim->eps = ep;
+    return ep;
+}
+
+/******************************************************************************
+ * api
+ */
+zerr_t znetsim_init(znetsim_t *sim, int nodes, uint32_t latency_us, uint64_t seed){
+    znetsim_link_t link;
+    int i, j;
+
+    if(!sim || nodes <= 0){
+        return ZEPARAM_INVALID;
+    }
+    memset(sim, 0, sizeof(znetsim_t));
+    if(!(sim->nodes = (znetsim_node_t*)calloc(nodes, sizeof(znetsim_node_t)))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    sim->nnodes = nodes;
+    sim->rand = seed ? seed : 0x9e3779b97f4a7c15ULL;
+    memset(&link, 0, sizeof(link));
+    link.latency_us = latency_us;
+    for(i = 0; i < ZNETSIM_ZONES; ++i){
+        for(j = 0; j < ZNETSIM_ZONES; ++j){
+            sim->links[i][j] = link;
+        }
+    }
+    for(i = 0; i < nodes; ++i){
+        sim->nodes[i].id = i;
+        if(!(sim->nodes[i].port = znetsim_ep(sim, &sim->nodes[i], ZNETSIM_PORT))){
+            znetsim_fini(sim);
+            return ZEMEM_INSUFFICIENT;
+        }
+    }
+    return ZEOK;
+}
+
+void znetsim_fini(znetsim_t *sim){
+    znetsim_ep_t *ep;
+    znetsim_ev_t *ev;
+    int i;
+
+    for(i = 0; i < sim->nheap; ++i){
+        /* stream segments are freed with their wire */
+        ev = sim->heap[i];
+        if(ZNETSIM_EV_TIMER == ev->type || ZNETSIM_PORT == ev->ep->kind){
+            free(ev);
+        }
+    }
+    while((ep = sim->eps)){
+        sim->eps = ep->next;
+        while((ev = ep->wire)){
+            ep->wire = ev->next;
+            free(ev);
+        }
+        while((ev = ep->inbox)){
+            ep->inbox = ev->next;
+            free(ev);
+        }
+        free(ep);
+    }
+    for(i = 0; i < sim->nnodes; ++i){
+        free(sim->nodes[i].stage);
+    }
+    free(sim->nodes);
+    free(sim->heap);
+    memset(sim, 0, sizeof(znetsim_t));
+}
+
+void znetsim_link(znetsim_t *sim, int a, int b, const znetsim_link_t *link){
+    if(a >= 0 && a < ZNETSIM_ZONES && b >= 0 && b < ZNETSIM_ZONES){
+        sim->links[a][b] = *link;
+        sim->links[b][a] = *link;
+    }
+}
+
+void znetsim_heal(znetsim_t *sim){
+    int i;
+
+    for(i = 0; i < sim->nnodes; ++i){
+        sim->nodes[i].group = 0;
+    }
+}
+
+ztrans_t *znetsim_port(znetsim_t *sim, int node){
+    return node >= 0 && node < sim->nnodes ? &sim->nodes[node].port->trans : NULL;
+}
+
+zerr_t znetsim_pair(znetsim_t *sim, int a, int b, ztrans_t *ta, ztrans_t *tb){
+    znetsim_ep_t *ea, *eb;
+
+    if(a < 0 || a >= sim->nnodes || b < 0 || b >= sim->nnodes){
+        return ZEPARAM_INVALID;
+    }
+    if(!(ea = znetsim_ep(sim, &sim->nodes[a], ZNETSIM_STREAM)) ||
+       !(eb = znetsim_ep(sim, &sim->nodes[b], ZNETSIM_STREAM))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    ea->peer = eb;
+    eb->peer = ea;
+    *ta = ea->trans;
+    *tb = eb->trans;
+    return ZEOK;
+}
+
+zerr_t znetsim_timer(znetsim_t *sim, int node, uint64_t delay_us, znetsim_timer_t cb, zptr_t arg){
+    znetsim_ev_t *ev;
+
+    if(node < 0 || node >= sim->nnodes || !cb ||
+       !(ev = (znetsim_ev_t*)calloc(1, sizeof(znetsim_ev_t)))){
+        return ZEPARAM_INVALID;
+    }
+    ev->at = sim->now + delay_us;
+    ev->type = ZNETSIM_EV_TIMER;
+    ev->node = &sim->nodes[node];
+    ev->cb = cb;
+    ev->arg = arg;
+    return znetsim_push(sim, ev);
+}
+
+int znetsim_run(znetsim_t *sim, uint64_t until){
+    znetsim_ev_t *ev;
+
+    while(sim->nheap && sim->heap[0]->at <= until){
+        ev = znetsim_pop(sim);
+        sim->now = ev->at;
+        ++sim->events;
+        if(ZNETSIM_EV_TIMER == ev->type){
+            sim->cur = ev->node;
+            ev->cb(sim, ev->node, ev->arg);
+            free(ev);
+        }else{
+            sim->cur = ev->ep->node;
+            znetsim_deliver(sim, ev);
+        }
+        /* what the handler staged leaves with it */
+        if(sim->cur){
+            znetsim_flush_node(sim, sim->cur);
+        }
+    }
+    sim->cur = NULL;
+    return sim->nheap;
+}
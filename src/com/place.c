@@ -0,0 +1,382 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file place.c
+ * @brief NUMA- and core-aware placement of event loops, buffers and sockets
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/place.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
+
+#ifndef SO_INCOMING_CPU
+#define SO_INCOMING_CPU 49
+#endif
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+#define ZPLACE_MPOL_PREFERRED 1
+
+/******************************************************************************
+ * topology
+ */
+/** @brief mark the cpus of a "0-3,8,10-11" list as members of <node> */
+static void zplace_parse_cpulist(zplace_t *place, const char *list, int node){
+    const char *p = list;
+    char *end;
+    long lo, hi;
+
+    while(*p){
+        lo = strtol(p, &end, 10);
+        if(end == p){
+            break;
+        }
+        hi = lo;
+        if('-' == *end){
+            p = end + 1;
+            hi = strtol(p, &end, 10);
+        }
+        for(; lo <= hi && lo < ZPLACE_CPUS; ++lo){
+            if(place->cpu_node[lo] >= 0){
+                place->cpu_node[lo] = (int16_t)node;
+            }
+        }
+        p = ',' == *end ? end + 1 : end;
+        if('\n' == *p){
+            break;
+        }
+    }
+}
+
+static void zplace_topology(zplace_t *place){
+    char path[64];
+    char list[1024];
+    FILE *fp;
+    int node;
+
+    for(node = 0; node < ZPLACE_NODES; ++node){
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        if(!(fp = fopen(path, "r"))){
+            continue;
+        }
+        if(fgets(list, sizeof(list), fp)){
+            zplace_parse_cpulist(place, list, node);
+            if(node >= place->nnodes){
+                place->nnodes = node + 1;
+            }
+        }
+        fclose(fp);
+    }
+    if(!place->nnodes){
+        place->nnodes = 1;
+    }
+}
+
+zerr_t zplace_init(zplace_t *place, const int *cpus, int cnt){
+    cpu_set_t set;
+    int i, c, same, pick;
+
+    memset(place, 0, sizeof(zplace_t));
+    for(c = 0; c < ZPLACE_CPUS; ++c){
+        place->cpu_node[c] = -1;
+        place->cpu_loop[c] = -1;
+    }
+    CPU_ZERO(&set);
+    if(0 != sched_getaffinity(0, sizeof(set), &set)){
+        CPU_SET(0, &set);
+    }
+    for(c = 0; c < ZPLACE_CPUS && c < CPU_SETSIZE; ++c){
+        if(CPU_ISSET(c, &set)){
+            /* node 0 until the topology says otherwise */
+            place->cpu_node[c] = 0;
+            place->ncpus = c + 1;
+        }
+    }
+    zplace_topology(place);
+
+    if(!cpus){
+        cnt = CPU_COUNT(&set);
+    }
+    if(cnt <= 0 || !(place->loops = (zplace_loop_t*)calloc(cnt, sizeof(zplace_loop_t)))){
+        return ZEPARAM_INVALID;
+    }
+    for(i = 0, c = 0; place->nloops < cnt && c < place->ncpus; ++i){
+        int cpu;
+        if(cpus){
+            if(i >= cnt){
+                break;
+            }
+            cpu = cpus[i];
+            if(cpu < 0 || cpu >= place->ncpus || place->cpu_node[cpu] < 0){
+                zinf("place cpu<%d> is not available", cpu);
+                continue;
+            }
+        }else{
+            for(; c < place->ncpus && place->cpu_node[c] < 0; ++c);
+            cpu = c++;
+        }
+        place->loops[place->nloops].index = place->nloops;
+        place->loops[place->nloops].cpu = cpu;
+        place->loops[place->nloops].node = place->cpu_node[cpu];
+        place->loops[place->nloops].listener = ZINVALID_SOCKET;
+        place->loops[place->nloops].place = place;
+        place->cpu_loop[cpu] = (int16_t)place->nloops;
+        ++place->nloops;
+    }
+    if(!place->nloops){
+        free(place->loops);
+        place->loops = NULL;
+        return ZEPARAM_INVALID;
+    }
+    /* cpus without a loop are served by a loop of their node, spread round robin */
+    for(c = 0; c < place->ncpus; ++c){
+        if(place->cpu_node[c] < 0 || place->cpu_loop[c] >= 0){
+            continue;
+        }
+        for(i = same = 0; i < place->nloops; ++i){
+            same += place->loops[i].node == place->cpu_node[c];
+        }
+        pick = same ? c % same : c % place->nloops;
+        for(i = 0; i < place->nloops; ++i){
+            if(!same || place->loops[i].node == place->cpu_node[c]){
+                if(0 == pick--){
+                    place->cpu_loop[c] = (int16_t)i;
+                    break;
+                }
+            }
+        }
+    }
+    zdbg("place cpus:%d nodes:%d loops:%d", place->ncpus, place->nnodes, place->nloops);
+    return ZEOK;
+}
+
+void zplace_fini(zplace_t *place){
+    int i;
+
+    for(i = 0; i < place->nloops; ++i){
+        if(ZINVALID_SOCKET != place->loops[i].listener){
+            zsockclose(place->loops[i].listener);
+        }
+    }
+    free(place->loops);
+    place->loops = NULL;
+    place->nloops = 0;
+}
+
+/******************************************************************************
+ * steering
+ */
+#ifdef __linux__
+/** @brief reuseport program: A = receiving cpu; return the index of its loop */
+static zerr_t zplace_attach_cbpf(zplace_t *place, zsock_t sock){
+    struct sock_filter *code;
+    struct sock_fprog prog;
+    int cnt = 0;
+    int c, ret;
+
+    if(!(code = (struct sock_filter*)calloc(2 * place->ncpus + 2, sizeof(struct sock_filter)))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    code[cnt++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, SKF_AD_OFF + SKF_AD_CPU);
+    for(c = 0; c < place->ncpus; ++c){
+        if(place->cpu_loop[c] < 0){
+            continue;
+        }
+        code[cnt++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, c, 0, 1);
+        code[cnt++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, place->cpu_loop[c]);
+    }
+    /* out of range, the kernel falls back to the reuseport hash */
+    code[cnt++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xffffffff);
+    prog.len = (unsigned short)cnt;
+    prog.filter = code;
+    ret = setsockopt(sock, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog));
+    free(code);
+    if(0 != ret){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+#endif
+
+zerr_t zplace_listen(zplace_t *place, const char *host, uint16_t port, int backlog){
+    zsockaddr_in addr;
+    zsock_t sock;
+    zerr_t ret;
+    int one = 1;
+    int i;
+
+    if(ZEOK != (ret = zinet_addr(&addr, host, port))){
+        return ret;
+    }
+    /* group index = bind order = loop index */
+    for(i = 0; i < place->nloops; ++i){
+        if(ZINVALID_SOCKET == (sock = zsocket(AF_INET, SOCK_STREAM, 0))){
+            return ZEFAIL;
+        }
+        place->loops[i].listener = sock;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+        if(0 != setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one))){
+            zerrno(errno);
+            return ZEFAIL;
+        }
+#endif
+        if(ZEOK != (ret = zbind(sock, (ZSA*)&addr, sizeof(addr)))){
+            return ret;
+        }
+#ifdef __linux__
+        if(0 == i && place->nloops > 1 && ZEOK != zplace_attach_cbpf(place, sock)){
+            /* still balanced by the reuseport hash, just not cpu-local */
+            zinf("place cpu steering program refused, hashing connections");
+        }
+#endif
+        if(ZEOK != (ret = zlisten(sock, backlog > 0 ? backlog : 1024))){
+            return ret;
+        }
+    }
+    return ZEOK;
+}
+
+zplace_loop_t *zplace_steer(zplace_t *place, zsock_t sock){
+    socklen_t len = sizeof(int);
+    int cpu = -1;
+    zplace_loop_t *loop;
+
+    if(0 != getsockopt(sock, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) ||
+       cpu < 0 || cpu >= place->ncpus || place->cpu_loop[cpu] < 0){
+        return NULL;
+    }
+    loop = &place->loops[place->cpu_loop[cpu]];
+    if(loop->cpu == cpu){
+        ++place->steered_local;
+    }else{
+        ++place->steered_remote;
+    }
+    return loop;
+}
+
+/******************************************************************************
+ * loops
+ */
+static void *zplace_loop_proc(void *arg){
+    zplace_loop_t *loop = (zplace_loop_t*)arg;
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(loop->cpu, &set);
+    if(0 != pthread_setaffinity_np(pthread_self(), sizeof(set), &set)){
+        zinf("place loop<%d> pin to cpu<%d> failed", loop->index, loop->cpu);
+    }
+    loop->place->entry(loop, loop->place->hint);
+    return NULL;
+}
+
+zerr_t zplace_start(zplace_t *place, zplace_entry_t entry, zptr_t hint){
+    int i;
+
+    if(!entry){
+        return ZEPARAM_INVALID;
+    }
+    place->entry = entry;
+    place->hint = hint;
+    for(i = 0; i < place->nloops; ++i){
+        if(0 != pthread_create(&place->loops[i].thr, NULL, zplace_loop_proc, &place->loops[i])){
+            zerrno(errno);
+            return ZEFAIL;
+        }
+        place->loops[i].started = 1;
+    }
+    return ZEOK;
+}
+
+void zplace_join(zplace_t *place){
+    int i;
+
+    for(i = 0; i < place->nloops; ++i){
+        if(place->loops[i].started){
+            pthread_join(place->loops[i].thr, NULL);
+            place->loops[i].started = 0;
+        }
+    }
+}
+
+/******************************************************************************
+ * memory
+ */
+void *zplace_alloc(int node, size_t size){
+    void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(MAP_FAILED == ptr){
+        zerrno(errno);
+        return NULL;
+    }
+#if defined(__linux__) && defined(SYS_mbind)
+    if(node >= 0 && node < ZPLACE_NODES){
+        unsigned long mask[ZPLACE_NODES / (8 * sizeof(unsigned long))];
+        memset(mask, 0, sizeof(mask));
+        mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+        if(0 != syscall(SYS_mbind, ptr, size, ZPLACE_MPOL_PREFERRED, mask,
+                        (unsigned long)ZPLACE_NODES + 1, 0)){
+            zdbg("place mbind node<%d> failed, relying on first touch", node);
+        }
+    }
+#endif
+    /* first touch from the calling loop */
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void zplace_free(void *ptr, size_t size){
+    if(ptr){
+        munmap(ptr, size);
+    }
+}
+
+int zplace_node_of(const void *ptr){
+#if defined(__linux__) && defined(SYS_move_pages)
+    void *page = (void*)ptr;
+    int status = -1;
+    if(0 == syscall(SYS_move_pages, 0, 1UL, &page, NULL, &status, 0) && status >= 0){
+        return status;
+    }
+#endif
+    return -1;
+}
@@ -0,0 +1,584 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file resolv.c
+ * @brief Asynchronous, cached hostname resolution
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/resolv.h>
+#include <znt/com/state_threads.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <sched.h>
+#include <netdb.h>
+#include <sys/stat.h>
+
+#define ZRESOLV_PENDING 0
+#define ZRESOLV_OK 1
+#define ZRESOLV_FAIL 2
+
+static zresolv_t *zresolv_dft;
+
+static uint64_t zresolv_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t zresolv_hash(const char *name){
+    uint32_t h = 2166136261u;
+    while(*name){
+        h ^= (uint8_t)tolower((uint8_t)*name++);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/******************************************************************************
+ * /etc/hosts
+ */
+static void zresolv_hosts_load(zresolv_t *rs){
+    char line[1024];
+    char *tok, *save;
+    zsockaddr_t addr;
+    zresolv_host_t *hosts;
+    struct stat st;
+    FILE *fp;
+
+    if(0 != stat(ZRESOLV_HOSTS, &st) || st.st_mtime == rs->hosts_mtime){
+        return;
+    }
+    if(!(fp = fopen(ZRESOLV_HOSTS, "r"))){
+        return;
+    }
+    rs->hosts_mtime = st.st_mtime;
+    rs->nhosts = 0;
+    while(fgets(line, sizeof(line), fp)){
+        if((tok = strchr(line, '#'))){
+            *tok = '\0';
+        }
+        if(!(tok = strtok_r(line, " \t\r\n", &save)) || ZEOK != zinet_addrx(&addr, tok, 0)){
+            continue;
+        }
+        while((tok = strtok_r(NULL, " \t\r\n", &save))){
+            if(strlen(tok) >= ZRESOLV_NAME){
+                continue;
+            }
+            if(!(rs->nhosts & (rs->nhosts + 1)) || !rs->hosts){
+                /* grow at 0, 1, 3, 7 ... */
+                hosts = (zresolv_host_t*)realloc(rs->hosts, (rs->nhosts * 2 + 2) * sizeof(zresolv_host_t));
+                if(!hosts){
+                    break;
+                }
+                rs->hosts = hosts;
+            }
+            strcpy(rs->hosts[rs->nhosts].name, tok);
+            rs->hosts[rs->nhosts].addr = addr;
+            ++rs->nhosts;
+        }
+    }
+    fclose(fp);
+    zdbg("resolver loaded %d names from %s", rs->nhosts, ZRESOLV_HOSTS);
+}
+
+/** @brief every address of <host>, locked */
+static int zresolv_hosts_find(zresolv_t *rs, const char *host, zsockaddr_t *addrs, int max, uint64_t now){
+    int i, n = 0;
+
+    if(now >= rs->hosts_check){
+        rs->hosts_check = now + 1000000;
+        zresolv_hosts_load(rs);
+    }
+    for(i = 0; i < rs->nhosts && n < max; ++i){
+        if(0 == strcasecmp(rs->hosts[i].name, host)){
+            addrs[n++] = rs->hosts[i].addr;
+        }
+    }
+    return n;
+}
+
+/******************************************************************************
+ * cache
+ */
+static void zresolv_unlink(zresolv_t *rs, zresolv_ent_t *ent){
+    zresolv_ent_t **pp = &rs->buckets[zresolv_hash(ent->name) & rs->mask];
+
+    for(; *pp; pp = &(*pp)->next){
+        if(*pp == ent){
+            *pp = ent->next;
+            --rs->count;
+            break;
+        }
+    }
+    free(ent);
+}
+
+/** @brief drop settled entries, expired ones only unless <all> */
+static void zresolv_sweep(zresolv_t *rs, uint64_t now, int all){
+    zresolv_ent_t **pp, *ent;
+    uint32_t i;
+
+    for(i = 0; i <= rs->mask; ++i){
+        for(pp = &rs->buckets[i]; (ent = *pp);){
+            if(ZRESOLV_PENDING != ent->state && (all || now >= ent->expire)){
+                *pp = ent->next;
+                --rs->count;
+                free(ent);
+            }else{
+                pp = &ent->next;
+            }
+        }
+    }
+}
+
+static void zresolv_answer(zresolv_ent_t *ent, zresolv_req_t *req){
+    memset(&req->addr, 0, sizeof(req->addr));
+    if(ZRESOLV_OK == ent->state){
+        req->addr = ent->addrs[ent->rr++ % ent->cnt];
+        zsockaddr_set_port(&req->addr, req->port);
+        req->ret = ZEOK;
+    }else{
+        req->ret = ZEFAIL;
+    }
+}
+
+/** @brief hand answered waiters back to their loops, unlocked */
+static void zresolv_reply(zresolv_req_t *req){
+    zresolv_req_t *next;
+
+    for(; req; req = next){
+        next = req->next;
+        req->next = NULL;
+        while(ZEAGAIN == zmbox_push(req->reply, req)){
+            /* the loop drains its mailbox, never blocks on us */
+            sched_yield();
+        }
+    }
+}
+
+/******************************************************************************
+ * lookup threads
+ */
+static void zresolv_lookup(zresolv_ent_t *ent){
+    struct addrinfo hints, *res = NULL, *ai;
+    int i, dup;
+
+    memset(&hints, 0, sizeof(hints));
+    /* both families, in the RFC 6724 order getaddrinfo() sorts them */
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_ADDRCONFIG;
+    ent->cnt = 0;
+    if(0 == getaddrinfo(ent->name, NULL, &hints, &res)){
+        for(ai = res; ai && ent->cnt < ZRESOLV_ADDRS; ai = ai->ai_next){
+            if((AF_INET != ai->ai_family && AF_INET6 != ai->ai_family) ||
+               ai->ai_addrlen > sizeof(zsockaddr_t)){
+                continue;
+            }
+            for(i = dup = 0; i < ent->cnt; ++i){
+                dup |= 0 == memcmp(&ent->addrs[i], ai->ai_addr, ai->ai_addrlen);
+            }
+            if(!dup){
+                memset(&ent->addrs[ent->cnt], 0, sizeof(zsockaddr_t));
+                memcpy(&ent->addrs[ent->cnt++], ai->ai_addr, ai->ai_addrlen);
+            }
+        }
+        freeaddrinfo(res);
+    }
+}
+
+static void *zresolv_proc(void *arg){
+    zresolv_t *rs = (zresolv_t*)arg;
+    zresolv_ent_t *ent;
+    zresolv_req_t *waiters;
+    zresolv_req_t *req;
+
+    pthread_mutex_lock(&rs->mtx);
+    for(;;){
+        while(!rs->stop && !rs->job_head){
+            pthread_cond_wait(&rs->cond, &rs->mtx);
+        }
+        if(rs->stop){
+            break;
+        }
+        ent = rs->job_head;
+        if(!(rs->job_head = ent->job)){
+            rs->job_tail = NULL;
+        }
+        ++rs->lookups;
+        pthread_mutex_unlock(&rs->mtx);
+
+        /* the entry is pending, nobody else touches its answer */
+        zresolv_lookup(ent);
+
+        pthread_mutex_lock(&rs->mtx);
+        ent->state = ent->cnt ? ZRESOLV_OK : ZRESOLV_FAIL;
+        ent->expire = zresolv_now() + (uint64_t)(ent->cnt ? rs->ttl : rs->neg_ttl) * 1000000;
+        if(!ent->cnt){
+            ++rs->failures;
+            zdbg("resolve <%s> failed", ent->name);
+        }
+        for(req = waiters = ent->waiters; req; req = req->next){
+            zresolv_answer(ent, req);
+        }
+        ent->waiters = NULL;
+        if(rs->count > rs->max_entries){
+            zresolv_unlink(rs, ent);
+        }
+        pthread_mutex_unlock(&rs->mtx);
+        zresolv_reply(waiters);
+        pthread_mutex_lock(&rs->mtx);
+    }
+    pthread_mutex_unlock(&rs->mtx);
+    return NULL;
+}
+
+/******************************************************************************
+ * api
+ */
+zresolv_t *zresolv_create(int threads, uint32_t ttl, uint32_t neg_ttl, int max_entries){
+    zresolv_t *rs;
+    uint32_t size = 16;
+    int i;
+
+    if(!(rs = (zresolv_t*)calloc(1, sizeof(zresolv_t)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    rs->ttl = ttl ? ttl : 60;
+    rs->neg_ttl = neg_ttl ? neg_ttl : 5;
+    rs->max_entries = max_entries > 0 ? max_entries : 4096;
+    while(size < (uint32_t)rs->max_entries){
+        size <<= 1;
+    }
+    rs->mask = size - 1;
+    rs->nthrs = threads > 0 ? threads : 2;
+    if(!(rs->buckets = (zresolv_ent_t**)calloc(size, sizeof(zresolv_ent_t*))) ||
+       !(rs->thrs = (pthread_t*)calloc(rs->nthrs, sizeof(pthread_t)))){
+        free(rs->buckets);
+        free(rs);
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    pthread_mutex_init(&rs->mtx, NULL);
+    pthread_cond_init(&rs->cond, NULL);
+    for(i = 0; i < rs->nthrs; ++i){
+        if(0 != pthread_create(&rs->thrs[i], NULL, zresolv_proc, rs)){
+            rs->nthrs = i;
+            zresolv_destroy(rs);
+            zerrno(ZEFAIL);
+            return NULL;
+        }
+    }
+    return rs;
+}
+
+void zresolv_destroy(zresolv_t *rs){
+    zresolv_ent_t *ent;
+    zresolv_req_t *failed = NULL;
+    zresolv_req_t *req;
+    uint32_t i;
+
+    if(!rs){
+        return;
+    }
+    if(zresolv_dft == rs){
+        zresolv_dft = NULL;
+    }
+    pthread_mutex_lock(&rs->mtx);
+    rs->stop = 1;
+    pthread_cond_broadcast(&rs->cond);
+    pthread_mutex_unlock(&rs->mtx);
+    for(i = 0; i < (uint32_t)rs->nthrs; ++i){
+        pthread_join(rs->thrs[i], NULL);
+    }
+    /* lookups that never ran */
+    for(i = 0; i <= rs->mask; ++i){
+        for(ent = rs->buckets[i]; ent; ent = ent->next){
+            while((req = ent->waiters)){
+                ent->waiters = req->next;
+                ent->state = ZRESOLV_FAIL;
+                zresolv_answer(ent, req);
+                req->next = failed;
+                failed = req;
+            }
+        }
+    }
+    zresolv_reply(failed);
+    zresolv_sweep(rs, 0, 1);
+    pthread_cond_destroy(&rs->cond);
+    pthread_mutex_destroy(&rs->mtx);
+    free(rs->hosts);
+    free(rs->buckets);
+    free(rs->thrs);
+    free(rs);
+}
+
+/**
+ * @brief addresses of <host>, <waiter> joins the lookup on a miss
+ * @return addresses copied (round robin first), ZEAGAIN pending, ZEFAIL unknown
+ */
+static int zresolv_find(zresolv_t *rs, const char *host, zsockaddr_t *addrs, int max,
+                        zresolv_req_t *waiter){
+    zresolv_ent_t *ent;
+    uint64_t now;
+    uint32_t slot;
+    int i, n;
+
+    if(!host || strlen(host) >= ZRESOLV_NAME || max <= 0){
+        return ZEPARAM_INVALID;
+    }
+    if(ZEOK == zinet_addrx(addrs, host, 0)){
+        return 1;
+    }
+    now = zresolv_now();
+    slot = zresolv_hash(host) & rs->mask;
+    pthread_mutex_lock(&rs->mtx);
+    if((n = zresolv_hosts_find(rs, host, addrs, max, now))){
+        ++rs->hits;
+        pthread_mutex_unlock(&rs->mtx);
+        return n;
+    }
+    for(ent = rs->buckets[slot]; ent; ent = ent->next){
+        if(0 == strcasecmp(ent->name, host)){
+            break;
+        }
+    }
+    if(ent && ZRESOLV_PENDING != ent->state && now >= ent->expire){
+        zresolv_unlink(rs, ent);
+        ent = NULL;
+    }
+    if(ent && ZRESOLV_PENDING != ent->state){
+        ++rs->hits;
+        n = ZEFAIL;
+        if(ZRESOLV_OK == ent->state){
+            for(i = 0, n = 0; i < ent->cnt && n < max; ++i){
+                addrs[n++] = ent->addrs[(ent->rr + i) % ent->cnt];
+            }
+            ++ent->rr;
+        }
+        pthread_mutex_unlock(&rs->mtx);
+        return n;
+    }
+    if(ent){
+        ++rs->coalesced;
+    }else{
+        if(rs->count >= rs->max_entries){
+            zresolv_sweep(rs, now, 0);
+        }
+        if(!(ent = (zresolv_ent_t*)calloc(1, sizeof(zresolv_ent_t)))){
+            pthread_mutex_unlock(&rs->mtx);
+            return ZEMEM_INSUFFICIENT;
+        }
+        strcpy(ent->name, host);
+        ent->state = ZRESOLV_PENDING;
+        ent->next = rs->buckets[slot];
+        rs->buckets[slot] = ent;
+        ++rs->count;
+        if(rs->job_tail){
+            rs->job_tail->job = ent;
+        }else{
+            rs->job_head = ent;
+        }
+        rs->job_tail = ent;
+        pthread_cond_signal(&rs->cond);
+    }
+    if(waiter){
+        waiter->next = ent->waiters;
+        ent->waiters = waiter;
+    }
+    pthread_mutex_unlock(&rs->mtx);
+    return ZEAGAIN;
+}
+
+zerr_t zresolv_query(zresolv_t *rs, const char *host, zresolv_req_t *req){
+    zsockaddr_t addr;
+    int n;
+
+    n = zresolv_find(rs, host, &addr, 1, req && req->reply ? req : NULL);
+    if(n > 0){
+        if(req){
+            req->addr = addr;
+            zsockaddr_set_port(&req->addr, req->port);
+            req->ret = ZEOK;
+        }
+        return ZEOK;
+    }
+    if(ZEFAIL == n && req){
+        req->ret = ZEFAIL;
+    }
+    return n;
+}
+
+/**
+ * @brief take <req> back from the waiters of <host>
+ * @retval ZEOK removed, it will never be pushed
+ * @retval ZEFAIL already answered, it is on its way to req->reply
+ */
+static zerr_t zresolv_cancel(zresolv_t *rs, const char *host, zresolv_req_t *req){
+    zresolv_ent_t *ent;
+    zresolv_req_t **pp;
+    zerr_t ret = ZEFAIL;
+
+    pthread_mutex_lock(&rs->mtx);
+    for(ent = rs->buckets[zresolv_hash(host) & rs->mask]; ent; ent = ent->next){
+        if(0 == strcasecmp(ent->name, host)){
+            break;
+        }
+    }
+    for(pp = ent ? &ent->waiters : NULL; pp && *pp; pp = &(*pp)->next){
+        if(*pp == req){
+            *pp = req->next;
+            ret = ZEOK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&rs->mtx);
+    return ret;
+}
+
+int zresolv_addrs(zresolv_t *rs, const char *host, uint16_t port, zsockaddr_t *addrs, int max){
+    int i, n;
+
+    if(!rs){
+        return ZEOK == zinet_addrx(addrs, host, port) ? 1 : ZEFAIL;
+    }
+    for(i = 0, n = zresolv_find(rs, host, addrs, max, NULL); i < n; ++i){
+        zsockaddr_set_port(&addrs[i], port);
+    }
+    return n;
+}
+
+zerr_t zresolv_addr(zresolv_t *rs, const char *host, uint16_t port, zsockaddr_in *addr){
+    zsockaddr_t addrs[ZRESOLV_ADDRS];
+    int i, n;
+
+    if(!rs || !host){
+        return zinet_addr(addr, host, port);
+    }
+    /* answered now, or the lookup just warms the cache */
+    if((n = zresolv_addrs(rs, host, port, addrs, ZRESOLV_ADDRS)) <= 0){
+        return n;
+    }
+    for(i = 0; i < n; ++i){
+        if(AF_INET == addrs[i].sa.sa_family){
+            *addr = addrs[i].in4;
+            return ZEOK;
+        }
+    }
+    return ZEFAIL;
+}
+
+/**
+ * @brief wait up to <timeout_ms> for the reply doorbell
+ * @return 0 on timeout
+ * @note an st_thread parks on its scheduler, a plain thread blocks in poll()
+ */
+static int zresolv_poll(struct pollfd *pfd, st_netfd_t stfd, int timeout_ms){
+    if(stfd){
+        return ZETIMEOUT == zst_wait_readable(stfd, timeout_ms < 0 ? ST_UTIME_NO_TIMEOUT :
+                                              (st_utime_t)timeout_ms * 1000) ? 0 : 1;
+    }
+    return poll(pfd, 1, timeout_ms);
+}
+
+zerr_t zresolv_wait(zresolv_t *rs, const char *host, uint16_t port, zsockaddr_in *addr,
+                    int timeout_ms){
+    zresolv_req_t req;
+    zmbox_t *mbox;
+    zptr_t item;
+    struct pollfd pfd;
+    st_netfd_t stfd = NULL;
+    zerr_t ret;
+
+    if(ZEAGAIN != (ret = zresolv_addr(rs, host, port, addr)) || !timeout_ms){
+        return ret;
+    }
+    if(!(mbox = zmbox_create(2))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return ZEMEM_INSUFFICIENT;
+    }
+    memset(&req, 0, sizeof(req));
+    req.reply = mbox;
+    req.port = port;
+    pfd.fd = zmbox_fileno(mbox);
+    pfd.events = POLLIN;
+    if(st_thread_self() && !(stfd = st_netfd_open(pfd.fd))){
+        zmbox_destroy(mbox);
+        zerrno(ZEMEM_INSUFFICIENT);
+        return ZEMEM_INSUFFICIENT;
+    }
+    if(ZEAGAIN == (ret = zresolv_query(rs, host, &req))){
+        while(ZEAGAIN == zmbox_pop(mbox, &item, 1)){
+            if(0 == zresolv_poll(&pfd, stfd, timeout_ms) && ZEOK == zresolv_cancel(rs, host, &req)){
+                ret = ZETIMEOUT;
+                break;
+            }
+            /* answered while timing out, the push is under way */
+        }
+        if(ZEAGAIN == ret){
+            ret = req.ret;
+        }
+    }
+    if(stfd){
+        /* the descriptor belongs to the mailbox */
+        st_netfd_free(stfd);
+    }
+    zmbox_destroy(mbox);
+    if(ZEOK == ret && AF_INET != req.addr.sa.sa_family){
+        /* the cache now holds every family of the name */
+        ret = zresolv_addr(rs, host, port, addr);
+    }else if(ZEOK == ret){
+        *addr = req.addr.in4;
+    }
+    if(ZETIMEOUT == ret){
+        zerrno(ret);
+    }
+    return ret;
+}
+
+void zresolv_flush(zresolv_t *rs){
+    pthread_mutex_lock(&rs->mtx);
+    zresolv_sweep(rs, 0, 1);
+    rs->hosts_mtime = 0;
+    rs->hosts_check = 0;
+    pthread_mutex_unlock(&rs->mtx);
+}
+
+void zresolv_set_default(zresolv_t *rs){
+    zresolv_dft = rs;
+}
+
+zresolv_t *zresolv_default(void){
+    return zresolv_dft;
+}
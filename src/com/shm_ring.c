@@ -0,0 +1,354 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file shm_ring.c
+ * @brief Shared-memory SPSC ring transport between local processes
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/shm_ring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/eventfd.h>
+
+#define ZSHM_FRAME_HDR 8
+#define ZSHM_PAD 0xffffffff
+#define ZSHM_ALIGN(x) (((x) + 7) & ~((uint64_t)7))
+
+static void zshm_ring_bind(zshm_ring_t *ring){
+    ring->data = (char*)ring->hdr + sizeof(zshm_ring_hdr_t);
+    ring->mask = ring->hdr->size - 1;
+    ring->head = ring->tail_cache = __atomic_load_n(&ring->hdr->head, __ATOMIC_ACQUIRE);
+    ring->tail = ring->head_cache = __atomic_load_n(&ring->hdr->tail, __ATOMIC_ACQUIRE);
+    ring->armed = 0;
+    ring->frames = ring->publishes = ring->wakeups = 0;
+}
+
+zerr_t zshm_ring_create(zshm_ring_t *ring, size_t size){
+    zerr_t ret = ZEOK;
+    uint64_t sz = 4096;
+
+    memset(ring, 0, sizeof(zshm_ring_t));
+    ring->memfd = ring->evfd = -1;
+    while(sz < size){
+        sz <<= 1;
+    }
+    ring->map_len = sizeof(zshm_ring_hdr_t) + sz;
+
+    do{
+        if(-1 == (ring->memfd = memfd_create("znt-shm-ring", MFD_CLOEXEC))){
+            ret = errno;
+            break;
+        }
+        if(-1 == ftruncate(ring->memfd, ring->map_len)){
+            ret = errno;
+            break;
+        }
+        ring->hdr = (zshm_ring_hdr_t*)mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE,
+                                           MAP_SHARED, ring->memfd, 0);
+        if(MAP_FAILED == ring->hdr){
+            ring->hdr = NULL;
+            ret = errno;
+            break;
+        }
+        if(-1 == (ring->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))){
+            ret = errno;
+            break;
+        }
+        ring->hdr->size = sz;
+        ring->hdr->frame_max = (uint32_t)(sz / 2 - ZSHM_FRAME_HDR);
+        ring->hdr->head = ring->hdr->tail = 0;
+        ring->hdr->idle = 0;
+        __atomic_store_n(&ring->hdr->magic, ZSHM_MAGIC, __ATOMIC_RELEASE);
+        zshm_ring_bind(ring);
+    }while(0);
+
+    if(ZEOK != ret){
+        zerrno(ret);
+        zshm_ring_destroy(ring);
+        ret = ZEFAIL;
+    }
+#if ZTRACE_SOCKET
+    else{
+        zdbg("shm ring<memfd:%d, evfd:%d, size:%llu> created",
+             ring->memfd, ring->evfd, (unsigned long long)sz);
+    }
+#endif
+    return ret;
+}
+
+zerr_t zshm_ring_destroy(zshm_ring_t *ring){
+    if(ring->hdr){
+        munmap(ring->hdr, ring->map_len);
+        ring->hdr = NULL;
+        ring->data = NULL;
+    }
+    if(-1 != ring->evfd){
+        close(ring->evfd);
+        ring->evfd = -1;
+    }
+    if(-1 != ring->memfd){
+        close(ring->memfd);
+        ring->memfd = -1;
+    }
+    return ZEOK;
+}
+
+zerr_t zshm_ring_share(zshm_ring_t *ring, zsock_t usock){
+    struct msghdr msg;
+    struct iovec iov;
+    char ctl[CMSG_SPACE(2 * sizeof(int))];
+    struct cmsghdr *cmsg;
+    int fds[2];
+    char tag = 'z';
+
+    memset(&msg, 0, sizeof(msg));
+    memset(ctl, 0, sizeof(ctl));
+    iov.iov_base = &tag;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl;
+    msg.msg_controllen = sizeof(ctl);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+    fds[0] = ring->memfd;
+    fds[1] = ring->evfd;
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if(sendmsg(usock, &msg, 0) < 0){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+zerr_t zshm_ring_attach(zshm_ring_t *ring, zsock_t usock){
+    struct msghdr msg;
+    struct iovec iov;
+    char ctl[CMSG_SPACE(2 * sizeof(int))];
+    struct cmsghdr *cmsg;
+    struct stat st;
+    int fds[2];
+    char tag = 0;
+    zerr_t ret = ZEOK;
+
+    memset(ring, 0, sizeof(zshm_ring_t));
+    ring->memfd = ring->evfd = -1;
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = &tag;
+    iov.iov_len = 1;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl;
+    msg.msg_controllen = sizeof(ctl);
+
+    do{
+        if(recvmsg(usock, &msg, MSG_CMSG_CLOEXEC) <= 0){
+            ret = (EAGAIN == errno || EWOULDBLOCK == errno) ? ZEAGAIN : ZEFAIL;
+            break;
+        }
+        cmsg = CMSG_FIRSTHDR(&msg);
+        if(!cmsg || SCM_RIGHTS != cmsg->cmsg_type ||
+           CMSG_LEN(2 * sizeof(int)) != cmsg->cmsg_len){
+            ret = ZEFAIL;
+            break;
+        }
+        memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+        ring->memfd = fds[0];
+        ring->evfd = fds[1];
+        if(-1 == fstat(ring->memfd, &st)){
+            ret = ZEFAIL;
+            break;
+        }
+        ring->map_len = st.st_size;
+        ring->hdr = (zshm_ring_hdr_t*)mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE,
+                                           MAP_SHARED, ring->memfd, 0);
+        if(MAP_FAILED == ring->hdr){
+            ring->hdr = NULL;
+            ret = ZEFAIL;
+            break;
+        }
+        if(ZSHM_MAGIC != __atomic_load_n(&ring->hdr->magic, __ATOMIC_ACQUIRE) ||
+           ring->map_len != sizeof(zshm_ring_hdr_t) + ring->hdr->size){
+            ret = ZEFAIL;
+            break;
+        }
+        zshm_ring_bind(ring);
+    }while(0);
+
+    if(ZEOK != ret){
+        zerrno(ret);
+        zshm_ring_destroy(ring);
+    }
+    return ret;
+}
+
+zerr_t zshm_flush(zshm_ring_t *ring){
+    zshm_ring_hdr_t *hdr = ring->hdr;
+
+    if(ring->head == hdr->head){
+        return ZEOK;
+    }
+    __atomic_store_n(&hdr->head, ring->head, __ATOMIC_RELEASE);
+    ++ring->publishes;
+    /* order the head store before the idle load, pairs with zshm_recv() */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&hdr->idle, __ATOMIC_RELAXED) &&
+       __atomic_exchange_n(&hdr->idle, 0, __ATOMIC_ACQ_REL)){
+        uint64_t one = 1;
+        if(sizeof(one) != write(ring->evfd, &one, sizeof(one)) && EAGAIN != errno){
+            zerrno(errno);
+            return ZEFAIL;
+        }
+        ++ring->wakeups;
+    }
+    return ZEOK;
+}
+
+zerr_t zshm_send(zshm_ring_t *ring, const char *buf, int *len, int flags){
+    zshm_ring_hdr_t *hdr = ring->hdr;
+    uint64_t off = ring->head & ring->mask;
+    uint64_t need = ZSHM_ALIGN(ZSHM_FRAME_HDR + (uint64_t)*len);
+    uint64_t total = need;
+
+    if(*len < 0 || (uint32_t)*len > hdr->frame_max){
+        *len = 0;
+        return ZEPARAM_INVALID;
+    }
+    if(off + need > hdr->size){
+        /* pad to the end of data area */
+        total += hdr->size - off;
+    }
+    if(hdr->size - (ring->head - ring->tail_cache) < total){
+        ring->tail_cache = __atomic_load_n(&hdr->tail, __ATOMIC_ACQUIRE);
+        if(hdr->size - (ring->head - ring->tail_cache) < total){
+            /* let the consumer drain what was staged so far */
+            zshm_flush(ring);
+            *len = 0;
+            return ZEAGAIN;
+        }
+    }
+    if(total != need){
+        *(uint32_t*)(ring->data + off) = ZSHM_PAD;
+        ring->head += hdr->size - off;
+        off = 0;
+    }
+    *(uint32_t*)(ring->data + off) = (uint32_t)*len;
+    memcpy(ring->data + off + ZSHM_FRAME_HDR, buf, *len);
+    ring->head += need;
+    ++ring->frames;
+
+    return (flags & MSG_MORE) ? ZEOK : zshm_flush(ring);
+}
+
+zerr_t zshm_recv(zshm_ring_t *ring, char *buf, int len, int flags){
+    zshm_ring_hdr_t *hdr = ring->hdr;
+    uint64_t off;
+    uint32_t flen;
+
+    if(ring->armed){
+        /*
+         * drain whether or not <idle> was cleared: a producer that cleared
+         * it may ring only after we re-arm, the eventfd is non-blocking
+         */
+        uint64_t cnt;
+        if(sizeof(cnt) == read(ring->evfd, &cnt, sizeof(cnt))){
+            ++ring->wakeups;
+        }
+        ring->armed = 0;
+    }
+    for(;;){
+        if(ring->tail == ring->head_cache){
+            ring->head_cache = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+            if(ring->tail == ring->head_cache){
+                /* announce idle, then look again so a racing publish is not missed */
+                __atomic_store_n(&hdr->idle, 1, __ATOMIC_RELAXED);
+                __atomic_thread_fence(__ATOMIC_SEQ_CST);
+                ring->head_cache = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+                if(ring->tail == ring->head_cache){
+                    ring->armed = 1;
+                    return ZEAGAIN;
+                }
+                __atomic_store_n(&hdr->idle, 0, __ATOMIC_RELAXED);
+            }
+        }
+        off = ring->tail & ring->mask;
+        flen = *(uint32_t*)(ring->data + off);
+        if(ZSHM_PAD == flen){
+            ring->tail += hdr->size - off;
+            continue;
+        }
+        break;
+    }
+    if((uint32_t)len < flen){
+        return ZEPARAM_INVALID;
+    }
+    memcpy(buf, ring->data + off + ZSHM_FRAME_HDR, flen);
+    ring->tail += ZSHM_ALIGN(ZSHM_FRAME_HDR + (uint64_t)flen);
+    __atomic_store_n(&hdr->tail, ring->tail, __ATOMIC_RELEASE);
+    ++ring->frames;
+    return (zerr_t)flen;
+}
+
+static zerr_t zshm_trans_send(zptr_t ctx, const char *buf, int *len, int flags){
+    return zshm_send((zshm_ring_t*)ctx, buf, len, flags);
+}
+
+static zerr_t zshm_trans_recv(zptr_t ctx, char *buf, int len, int flags){
+    return zshm_recv((zshm_ring_t*)ctx, buf, len, flags);
+}
+
+static zerr_t zshm_trans_flush(zptr_t ctx){
+    return zshm_flush((zshm_ring_t*)ctx);
+}
+
+static int zshm_trans_fileno(zptr_t ctx){
+    return zshm_fileno((zshm_ring_t*)ctx);
+}
+
+static zerr_t zshm_trans_close(zptr_t ctx){
+    return zshm_ring_destroy((zshm_ring_t*)ctx);
+}
+
+const ztrans_ops_t zshm_trans_ops = {
+    "shm",
+    zshm_trans_send,
+    zshm_trans_recv,
+    zshm_trans_flush,
+    zshm_trans_fileno,
+    zshm_trans_close
+};
@@ -30,11 +30,18 @@
  *
  * @zmake.app znt;
  */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include <zsi/base/error.h>
 #include <zsi/base/trace.h>
 #include <znt/com/socket.h>
 #ifdef ZSYS_POSIX
 #include <arpa/inet.h>
+#include <netdb.h>
+#include <net/if.h>
+#include <time.h>
+#include <znt/com/resolv.h>
 #else
 #pragma comment(lib, "Ws2_32")
 #endif
@@ -111,6 +118,8 @@ zerr_t zsockclose(zsock_t sock){
     ret = close(sock);
     ret = (ret < 0)?errno:ZEOK;
 #endif
+    ZEVTRACE(ZEVT_CLOSE, sock, 0, 0, ret);
+    ZCAP_HOOK(ZCAP_CLOSE, sock, NULL, 0);
     zdbg("close socket<fd:%d> %s", sock, zstrerr(ret));
     return(ret);
 }
@@ -183,14 +192,16 @@ zerr_t zconnect(zsock_t sock, const ZSA *addr, int len){
 #else
         ret = errno;
 #endif
+        ZEVTRACE(ZEVT_CONNECT, sock, 0, 0, ret);
         zerrno(ret);
         ret = ZEFAIL;
     }
-#if ZTRACE_SOCKET
     else{
+        ZEVTRACE(ZEVT_CONNECT, sock, 0, 0, 0);
+#if ZTRACE_SOCKET
         zerrno(ret);
-    }
 #endif
+    }
     return(ret);
 }
 
@@ -396,15 +407,142 @@ zsock_t zaccept(zsock_t sock, ZSA *addr, int *addrlen){
     sk = accept(sock, addr, (socklen_t*)addrlen);
     ret = (sk < 0) ? errno : ZEOK;
 #endif
-    zdbg("accept <fd:%d> %s", sk, zstrerr(ret));
+    if(ZEOK != ret){
+        zerrno(ret);
+    }else{
+        ZEVTRACE(ZEVT_ACCEPT, sk, 0, 0, sock);
+        ZCAP_HOOK(ZCAP_OPEN, sk, NULL, 0);
+    }
     return(sk);
 }
 
+int zaccept_batch(zsock_t sock, zsock_t *socks, zsockaddr_in *addrs, int max,
+                  const zsockopt_t *opts){
+    zsockaddr_in addr;
+    socklen_t len;
+    zsock_t sk;
+    int cnt = 0;
+    int err;
+
+    while(cnt < max){
+        len = sizeof(addr);
+#if defined(ZSYS_POSIX) && defined(SOCK_NONBLOCK)
+        sk = accept4(sock, (ZSA*)&addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        sk = accept(sock, (ZSA*)&addr, &len);
+#endif
+        if(ZINVALID_SOCKET == sk){
+#ifdef ZSYS_WINDOWS
+            err = WSAGetLastError();
+            if(WSAEWOULDBLOCK == err || WSAECONNRESET == err){
+                break;
+            }
+#else
+            err = errno;
+            if(EAGAIN == err || EWOULDBLOCK == err){
+                break;
+            }
+            if(EINTR == err || ECONNABORTED == err || EPROTO == err){
+                /* aborted before we got it, try the next one */
+                continue;
+            }
+#endif
+            zerrno(err);
+            return cnt ? cnt : ZEFAIL;
+        }
+#if !defined(ZSYS_POSIX) || !defined(SOCK_NONBLOCK)
+        zsock_nonblock(sk, ztrue);
+#endif
+        if(opts){
+            zsockopt_apply(sk, opts);
+        }
+        if(addrs){
+            addrs[cnt] = addr;
+        }
+        ZEVTRACE(ZEVT_ACCEPT, sk, 0, 0, sock);
+        ZCAP_HOOK(ZCAP_OPEN, sk, NULL, 0);
+        socks[cnt++] = sk;
+    }
+    return cnt;
+}
+
+zerr_t zsockopt_add(zsockopt_t *opts, int level, int name, int val){
+    if(opts->cnt >= ZSOCKOPT_MAX){
+        return ZEMEM_INSUFFICIENT;
+    }
+    opts->opt[opts->cnt].level = level;
+    opts->opt[opts->cnt].name = name;
+    opts->opt[opts->cnt].val = val;
+    ++opts->cnt;
+    return ZEOK;
+}
+
+zerr_t zsockopt_tcp(zsockopt_t *opts, int nodelay, int sndbuf, int rcvbuf,
+                    int keepalive_s, int user_timeout_ms){
+    if(opts->cnt + 8 > ZSOCKOPT_MAX){
+        return ZEMEM_INSUFFICIENT;
+    }
+    if(nodelay > 0){
+        zsockopt_add(opts, IPPROTO_TCP, TCP_NODELAY, 1);
+    }
+    if(sndbuf > 0){
+        zsockopt_add(opts, SOL_SOCKET, SO_SNDBUF, sndbuf);
+    }
+    if(rcvbuf > 0){
+        zsockopt_add(opts, SOL_SOCKET, SO_RCVBUF, rcvbuf);
+    }
+    if(keepalive_s > 0){
+        zsockopt_add(opts, SOL_SOCKET, SO_KEEPALIVE, 1);
+#ifdef TCP_KEEPIDLE
+        zsockopt_add(opts, IPPROTO_TCP, TCP_KEEPIDLE, keepalive_s);
+        zsockopt_add(opts, IPPROTO_TCP, TCP_KEEPINTVL,
+                     keepalive_s / 3 > 0 ? keepalive_s / 3 : 1);
+        zsockopt_add(opts, IPPROTO_TCP, TCP_KEEPCNT, 3);
+#endif
+    }
+#ifdef TCP_USER_TIMEOUT
+    if(user_timeout_ms > 0){
+        zsockopt_add(opts, IPPROTO_TCP, TCP_USER_TIMEOUT, user_timeout_ms);
+    }
+#endif
+    return ZEOK;
+}
+
+zerr_t zsockopt_apply(zsock_t sock, const zsockopt_t *opts){
+    zerr_t ret = ZEOK;
+    int i;
+
+    for(i = 0; i < opts->cnt; ++i){
+        if(0 != setsockopt(sock, opts->opt[i].level, opts->opt[i].name,
+                           (const char*)&opts->opt[i].val, sizeof(int))){
+#ifdef ZSYS_WINDOWS
+            ret = WSAGetLastError();
+#else
+            ret = errno;
+#endif
+        }
+    }
+    if(ZEOK != ret){
+        zerrno(ret);
+        ret = ZEFAIL;
+    }
+    return ret;
+}
+
 zerr_t zconnectx(zsock_t sock, const char *host, uint16_t port, int listenq, int timeout_ms){
     zerr_t ret;
     zsockaddr_in addr;
 
+    if(-1 != timeout_ms && (timeout_ms < 1000 || timeout_ms > 15000)){
+        /* the lookup and the connect share one bound */
+        timeout_ms = 4000;
+    }
+#ifdef ZSYS_POSIX
+    /* numeric, /etc/hosts or cached names; others wait for the lookup */
+    ret = zresolv_wait(zresolv_default(), host, port, &addr, timeout_ms);
+#else
     ret = zinet_addr(&addr, host, port);
+#endif
     if(ret != ZEOK){
         return(ret);
     }
@@ -444,9 +582,6 @@ zerr_t zconnectx(zsock_t sock, const char *host, uint16_t port, int listenq, int
             fd_set rset, wset;
             int error;
             socklen_t len;
-            if(timeout_ms < 1000 || timeout_ms > 15000){
-                timeout_ms = 4000;
-            }
             tv.tv_sec = timeout_ms/1000;
             tv.tv_usec = (timeout_ms%1000)*1000;
             FD_ZERO(&rset);
@@ -473,9 +608,267 @@ zerr_t zconnectx(zsock_t sock, const char *host, uint16_t port, int listenq, int
                 }
             }else{
                 ret = ZETIMEOUT;
+                ZEVTRACE(ZEVT_TIMEOUT, sock, 0, 0, timeout_ms);
             }
         }
     }
     zerrno(ret);
     return(ret);
 }
+
+#ifdef ZSYS_POSIX
+/*
+ * address family agnostic addressing
+ */
+zerr_t zinet_addrx(zsockaddr_t *addr, const char *host, uint16_t port){
+    struct addrinfo hints, *res = NULL;
+    char name[INET6_ADDRSTRLEN + IF_NAMESIZE + 4];
+    size_t len;
+
+    if(!addr || !host){
+        return ZEPARAM_INVALID;
+    }
+    memset(addr, 0, sizeof(zsockaddr_t));
+    if(1 == inet_pton(AF_INET, host, &addr->in4.sin_addr)){
+        addr->in4.sin_family = AF_INET;
+        addr->in4.sin_port = htons(port);
+        return ZEOK;
+    }
+    /* strip "[...]", getaddrinfo() keeps a "%scope" */
+    len = strlen(host);
+    if('[' == *host && len > 2 && ']' == host[len - 1]){
+        ++host;
+        len -= 2;
+    }
+    if(len >= sizeof(name)){
+        return ZEPARAM_INVALID;
+    }
+    memcpy(name, host, len);
+    name[len] = '\0';
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET6;
+    hints.ai_flags = AI_NUMERICHOST;
+    if(0 != getaddrinfo(name, NULL, &hints, &res) || !res){
+        return ZEFAIL;
+    }
+    memcpy(&addr->in6, res->ai_addr, sizeof(struct sockaddr_in6));
+    addr->in6.sin6_port = htons(port);
+    freeaddrinfo(res);
+    return ZEOK;
+}
+
+zerr_t zinet_ntop(const zsockaddr_t *addr, char *host, int size, uint16_t *port){
+    const char *ret;
+
+    if(AF_INET6 == addr->sa.sa_family){
+        ret = inet_ntop(AF_INET6, &addr->in6.sin6_addr, host, size);
+        if(port){
+            *port = ntohs(addr->in6.sin6_port);
+        }
+    }else{
+        ret = inet_ntop(AF_INET, &addr->in4.sin_addr, host, size);
+        if(port){
+            *port = ntohs(addr->in4.sin_port);
+        }
+    }
+    return ret ? ZEOK : ZEFAIL;
+}
+
+/*
+ * Happy Eyeballs
+ */
+static uint64_t zrace_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+zerr_t zrace_init(zrace_t *race, const zsockaddr_t *cands, int cnt, int stagger_ms){
+    int i, turn, taken[ZRACE_MAX];
+    int family;
+
+    if(!race || !cands || cnt <= 0){
+        return ZEPARAM_INVALID;
+    }
+    if(cnt > ZRACE_MAX){
+        cnt = ZRACE_MAX;
+    }
+    memset(race, 0, sizeof(zrace_t));
+    memset(taken, 0, sizeof(taken));
+    race->stagger_ms = stagger_ms > 0 ? stagger_ms : ZRACE_STAGGER;
+    race->winner = -1;
+    /* alternate families, starting with the resolver's preferred one */
+    family = cands[0].sa.sa_family;
+    while(race->cnt < cnt){
+        for(turn = 0; turn < 2 && race->cnt < cnt; ++turn){
+            for(i = 0; i < cnt; ++i){
+                if(!taken[i] && (cands[i].sa.sa_family == family) == !turn){
+                    taken[i] = 1;
+                    race->cand[race->cnt++] = cands[i];
+                    break;
+                }
+            }
+        }
+    }
+    for(i = 0; i < ZRACE_MAX; ++i){
+        race->socks[i] = ZINVALID_SOCKET;
+    }
+    return ZEOK;
+}
+
+/** @brief start the next candidate, failed ones are skipped at once */
+static void zrace_start(zrace_t *race, uint64_t now){
+    zsock_t sock;
+    int i;
+
+    while(race->started < race->cnt && race->winner < 0){
+        i = race->started++;
+        if(ZINVALID_SOCKET == (sock = socket(race->cand[i].sa.sa_family, SOCK_STREAM, 0))){
+            continue;
+        }
+        zsock_nonblock(sock, 1);
+        if(0 == connect(sock, &race->cand[i].sa, zsockaddr_len(&race->cand[i]))){
+            race->socks[i] = sock;
+            race->winner = i;
+            return;
+        }
+        if(EINPROGRESS != errno){
+            close(sock);
+            continue;
+        }
+        race->socks[i] = sock;
+        ++race->live;
+        race->next_ms = now + race->stagger_ms;
+        return;
+    }
+}
+
+int zrace_fds(zrace_t *race, struct pollfd *pfds, int *timeout_ms){
+    uint64_t now = zrace_now();
+    int i, n = 0;
+
+    if(race->winner < 0 && (!race->live || now >= race->next_ms)){
+        zrace_start(race, now);
+    }
+    for(i = 0; i < race->started && race->winner < 0; ++i){
+        if(ZINVALID_SOCKET != race->socks[i]){
+            pfds[n].fd = race->socks[i];
+            pfds[n].events = POLLOUT;
+            pfds[n].revents = 0;
+            ++n;
+        }
+    }
+    *timeout_ms = -1;
+    if(race->winner < 0 && race->started < race->cnt){
+        *timeout_ms = race->next_ms > now ? (int)(race->next_ms - now) : 0;
+    }
+    return n;
+}
+
+zerr_t zrace_check(zrace_t *race, struct pollfd *pfds, int n){
+    socklen_t len;
+    int i, j, error;
+
+    for(i = 0; i < n && race->winner < 0; ++i){
+        if(!pfds[i].revents){
+            continue;
+        }
+        for(j = 0; j < race->started && race->socks[j] != pfds[i].fd; ++j);
+        if(j == race->started){
+            continue;
+        }
+        error = 0;
+        len = sizeof(error);
+        getsockopt(pfds[i].fd, SOL_SOCKET, SO_ERROR, &error, &len);
+        if(0 == error){
+            race->winner = j;
+        }else{
+            close(race->socks[j]);
+            race->socks[j] = ZINVALID_SOCKET;
+            --race->live;
+            /* a failure starts the next candidate right away */
+            race->next_ms = 0;
+        }
+    }
+    if(race->winner >= 0){
+        return ZEOK;
+    }
+    return (race->live || race->started < race->cnt) ? ZEAGAIN : ZEFAIL;
+}
+
+zsock_t zrace_take(zrace_t *race){
+    zsock_t sock = ZINVALID_SOCKET;
+
+    if(race->winner >= 0){
+        sock = race->socks[race->winner];
+        race->socks[race->winner] = ZINVALID_SOCKET;
+    }
+    return sock;
+}
+
+void zrace_fini(zrace_t *race){
+    int i;
+
+    for(i = 0; i < race->started; ++i){
+        if(ZINVALID_SOCKET != race->socks[i]){
+            close(race->socks[i]);
+            race->socks[i] = ZINVALID_SOCKET;
+        }
+    }
+    race->live = 0;
+}
+
+zerr_t zconnect_race(const zsockaddr_t *cands, int cnt, int stagger_ms, int timeout_ms,
+                     zsock_t *sock, int *index){
+    struct pollfd pfds[ZRACE_MAX];
+    zrace_t race;
+    uint64_t deadline;
+    uint64_t now;
+    zerr_t ret;
+    int n, wait;
+
+    if(ZEOK != (ret = zrace_init(&race, cands, cnt, stagger_ms))){
+        return ret;
+    }
+    deadline = zrace_now() + (timeout_ms > 0 ? timeout_ms : 4000);
+    ret = ZEAGAIN;
+    while(ZEAGAIN == ret){
+        if(!(n = zrace_fds(&race, pfds, &wait))){
+            ret = zrace_check(&race, pfds, 0);
+            break;
+        }
+        if((now = zrace_now()) >= deadline){
+            ret = ZETIMEOUT;
+            ZEVTRACE(ZEVT_TIMEOUT, -1, 0, 0, timeout_ms);
+            break;
+        }
+        if(wait < 0 || (uint64_t)wait > deadline - now){
+            wait = (int)(deadline - now);
+        }
+        if(poll(pfds, n, wait) < 0 && EINTR != errno){
+            ret = ZEFAIL;
+            break;
+        }
+        ret = zrace_check(&race, pfds, n);
+    }
+    if(ZEOK == ret){
+        *sock = zrace_take(&race);
+        if(index){
+            *index = race.winner;
+        }
+    }
+    zrace_fini(&race);
+    return ret;
+}
+
+zerr_t zconnect_host(const char *host, uint16_t port, int stagger_ms, int timeout_ms,
+                     zsock_t *sock){
+    zsockaddr_t cands[ZRACE_MAX];
+    int cnt;
+
+    if(0 >= (cnt = zresolv_addrs(zresolv_default(), host, port, cands, ZRACE_MAX))){
+        return 0 == cnt ? ZEFAIL : cnt;
+    }
+    return zconnect_race(cands, cnt, stagger_ms, timeout_ms, sock, NULL);
+}
+#endif /* ZSYS_POSIX */
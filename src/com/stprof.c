@@ -0,0 +1,257 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file stprof.c
+ * @brief Per st_thread CPU profiler on the ST context switch callbacks
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/stprof.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct zstprof_rec_s zstprof_rec_t;
+struct zstprof_rec_s{
+    zstprof_stat_t stat;
+    uint64_t in_ns; /** switch in stamp, 0 while not running */
+    zstprof_rec_t *prev;
+    zstprof_rec_t *next;
+};
+
+typedef struct zstprof_s{
+    int key; /** st_thread key of the record, -1 before the first start */
+    int on;
+    uint64_t hog_ns;
+    zstprof_hog_cb on_hog;
+    zptr_t hint;
+    st_switch_cb_t prev_in;
+    st_switch_cb_t prev_out;
+    zstprof_rec_t *live; /** records of running st_threads */
+    zstprof_rec_t *free;
+    int cnt;
+}zstprof_t;
+
+static __thread zstprof_t zstprof = {.key = -1};
+
+static uint64_t zstprof_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void zstprof_recycle(void *arg){
+    zstprof_rec_t *rec = (zstprof_rec_t*)arg;
+
+    if(rec->prev){
+        rec->prev->next = rec->next;
+    }else{
+        zstprof.live = rec->next;
+    }
+    if(rec->next){
+        rec->next->prev = rec->prev;
+    }
+    rec->next = zstprof.free;
+    zstprof.free = rec;
+    --zstprof.cnt;
+}
+
+static zstprof_rec_t *zstprof_self(void){
+    zstprof_rec_t *rec = (zstprof_rec_t*)st_thread_getspecific(zstprof.key);
+
+    if(rec){
+        return rec;
+    }
+    if(zstprof.free){
+        rec = zstprof.free;
+        zstprof.free = rec->next;
+    }else if(!(rec = (zstprof_rec_t*)malloc(sizeof(*rec)))){
+        return NULL;
+    }
+    memset(rec, 0, sizeof(*rec));
+    rec->stat.thr = st_thread_self();
+    if(0 != st_thread_setspecific(zstprof.key, rec)){
+        rec->next = zstprof.free;
+        zstprof.free = rec;
+        return NULL;
+    }
+    if((rec->next = zstprof.live)){
+        rec->next->prev = rec;
+    }
+    zstprof.live = rec;
+    ++zstprof.cnt;
+    return rec;
+}
+
+static void zstprof_in(void){
+    zstprof_rec_t *rec;
+
+    if(zstprof.prev_in){
+        zstprof.prev_in();
+    }
+    if((rec = zstprof_self())){
+        ++rec->stat.switches;
+        rec->in_ns = zstprof_ns();
+    }
+}
+
+static void zstprof_out(void){
+    zstprof_rec_t *rec = (zstprof_rec_t*)st_thread_getspecific(zstprof.key);
+    uint64_t slice;
+
+    if(rec && rec->in_ns){
+        slice = zstprof_ns() - rec->in_ns;
+        rec->in_ns = 0;
+        rec->stat.run_us += slice / 1000;
+        if(slice / 1000 > rec->stat.max_slice_us){
+            rec->stat.max_slice_us = slice / 1000;
+        }
+        if(slice >= zstprof.hog_ns){
+            ++rec->stat.hogs;
+            if(zstprof.on_hog){
+                zstprof.on_hog(&rec->stat, slice / 1000, zstprof.hint);
+            }else{
+                zinf("st_thread<%p %s> held the scheduler %lluus",
+                     rec->stat.thr, rec->stat.name, (unsigned long long)(slice / 1000));
+            }
+        }
+    }
+    if(zstprof.prev_out){
+        zstprof.prev_out();
+    }
+}
+
+zerr_t zstprof_start(uint64_t hog_us, zstprof_hog_cb on_hog, zptr_t hint){
+    zstprof_rec_t *rec;
+
+    if(zstprof.on){
+        return ZEOK;
+    }
+    /* ST keys can not be deleted, one per scheduler for its lifetime */
+    if(-1 == zstprof.key && 0 != st_key_create(&zstprof.key, zstprof_recycle)){
+        zstprof.key = -1;
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    zstprof.hog_ns = (hog_us ? hog_us : ZSTPROF_HOG_US) * 1000;
+    zstprof.on_hog = on_hog;
+    zstprof.hint = hint;
+    zstprof.prev_in = st_set_switch_in_cb(zstprof_in);
+    zstprof.prev_out = st_set_switch_out_cb(zstprof_out);
+    zstprof.on = 1;
+    /* the caller is running now, no switch in to stamp it */
+    if((rec = zstprof_self())){
+        rec->in_ns = zstprof_ns();
+    }
+    zdbg("stprof start, hog %lluus", (unsigned long long)(zstprof.hog_ns / 1000));
+    return ZEOK;
+}
+
+void zstprof_stop(void){
+    zstprof_rec_t *rec;
+
+    if(!zstprof.on){
+        return;
+    }
+    zstprof_out();
+    st_set_switch_in_cb(zstprof.prev_in);
+    st_set_switch_out_cb(zstprof.prev_out);
+    zstprof.prev_in = NULL;
+    zstprof.prev_out = NULL;
+    zstprof.on = 0;
+    for(rec = zstprof.live; rec; rec = rec->next){
+        rec->in_ns = 0;
+    }
+}
+
+void zstprof_name(const char *name){
+    zstprof_rec_t *rec;
+
+    if(-1 != zstprof.key && (rec = zstprof_self())){
+        strncpy(rec->stat.name, name, ZSTPROF_NAME - 1);
+    }
+}
+
+void zstprof_reset(void){
+    zstprof_rec_t *rec;
+    uint64_t now = zstprof_ns();
+
+    for(rec = zstprof.live; rec; rec = rec->next){
+        rec->stat.run_us = 0;
+        rec->stat.switches = 0;
+        rec->stat.max_slice_us = 0;
+        rec->stat.hogs = 0;
+        if(rec->in_ns){
+            rec->in_ns = now;
+        }
+    }
+}
+
+static uint64_t zstprof_key_of(const zstprof_stat_t *stat, int order){
+    return ZSTPROF_BY_SLICE == order ? stat->max_slice_us :
+        ZSTPROF_BY_HOGS == order ? stat->hogs : stat->run_us;
+}
+
+int zstprof_top(zstprof_stat_t *stats, int cnt, int order){
+    zstprof_rec_t *rec;
+    uint64_t key;
+    int n = 0, i;
+
+    /* insertion into a sorted window of <cnt>, reports are rare and short */
+    for(rec = zstprof.live; rec && cnt > 0; rec = rec->next){
+        key = zstprof_key_of(&rec->stat, order);
+        if(n == cnt && key <= zstprof_key_of(&stats[n - 1], order)){
+            continue;
+        }
+        i = n < cnt ? n++ : n - 1;
+        for(; i > 0 && zstprof_key_of(&stats[i - 1], order) < key; --i){
+            stats[i] = stats[i - 1];
+        }
+        stats[i] = rec->stat;
+    }
+    return n;
+}
+
+void zstprof_report(int cnt){
+    zstprof_stat_t *stats;
+    int n, i;
+
+    if(cnt <= 0 || !(stats = (zstprof_stat_t*)malloc(sizeof(*stats) * cnt))){
+        return;
+    }
+    n = zstprof_top(stats, cnt, ZSTPROF_BY_RUN);
+    zinf("stprof top %d of %d st_threads", n, zstprof.cnt);
+    for(i = 0; i < n; ++i){
+        zinf("  %-24s %p run:%lluus switch:%llu max_slice:%lluus hogs:%llu",
+             stats[i].name[0] ? stats[i].name : "-", stats[i].thr,
+             (unsigned long long)stats[i].run_us, (unsigned long long)stats[i].switches,
+             (unsigned long long)stats[i].max_slice_us, (unsigned long long)stats[i].hogs);
+    }
+    free(stats);
+}
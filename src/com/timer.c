@@ -0,0 +1,185 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file timer.c
+ * @brief Deadline timers for an ST scheduler
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/timer.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ZTIMER_CAP 64
+
+static void ztimer_swap(ztimer_t *timer, int a, int b){
+    ztimer_node_t *tmp = timer->heap[a];
+    timer->heap[a] = timer->heap[b];
+    timer->heap[b] = tmp;
+    timer->heap[a]->index = a;
+    timer->heap[b]->index = b;
+}
+
+static void ztimer_up(ztimer_t *timer, int i){
+    int parent;
+    while(i > 0){
+        parent = (i - 1) / 2;
+        if(timer->heap[parent]->expire <= timer->heap[i]->expire){
+            break;
+        }
+        ztimer_swap(timer, i, parent);
+        i = parent;
+    }
+}
+
+static void ztimer_down(ztimer_t *timer, int i){
+    int child;
+    while((child = 2 * i + 1) < timer->cnt){
+        if(child + 1 < timer->cnt &&
+           timer->heap[child + 1]->expire < timer->heap[child]->expire){
+            ++child;
+        }
+        if(timer->heap[i]->expire <= timer->heap[child]->expire){
+            break;
+        }
+        ztimer_swap(timer, i, child);
+        i = child;
+    }
+}
+
+static zptr_t ztimer_proc(zptr_t arg){
+    ztimer_t *timer = (ztimer_t*)arg;
+    st_utime_t wait;
+
+    while(!timer->stop){
+        wait = ztimer_expire(timer, st_utime());
+        if(ST_UTIME_NO_TIMEOUT == wait){
+            st_cond_wait(timer->cond);
+        }else{
+            st_cond_timedwait(timer->cond, wait);
+        }
+    }
+    return NULL;
+}
+
+zerr_t ztimer_init(ztimer_t *timer, zbool_t run_thread){
+    memset(timer, 0, sizeof(ztimer_t));
+    timer->cap = ZTIMER_CAP;
+    if(!(timer->heap = (ztimer_node_t**)malloc(timer->cap * sizeof(ztimer_node_t*)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return ZEMEM_INSUFFICIENT;
+    }
+    if(run_thread){
+        if(!(timer->cond = st_cond_new()) ||
+           !(timer->thr = zst_thread_create(ztimer_proc, timer, ztrue, 0))){
+            ztimer_fini(timer);
+            return ZEFAIL;
+        }
+    }
+    return ZEOK;
+}
+
+void ztimer_fini(ztimer_t *timer){
+    int i;
+
+    if(timer->thr){
+        timer->stop = 1;
+        st_thread_interrupt(timer->thr);
+        zst_thread_join(timer->thr);
+        timer->thr = NULL;
+    }
+    if(timer->cond){
+        st_cond_destroy(timer->cond);
+        timer->cond = NULL;
+    }
+    for(i = 0; i < timer->cnt; ++i){
+        timer->heap[i]->index = -1;
+    }
+    free(timer->heap);
+    timer->heap = NULL;
+    timer->cnt = timer->cap = 0;
+}
+
+zerr_t ztimer_add(ztimer_t *timer, ztimer_node_t *node, st_utime_t timeout_us,
+                  ztimer_cb_t cb, zptr_t hint){
+    if(-1 != node->index){
+        ztimer_del(timer, node);
+    }
+    if(timer->cnt == timer->cap){
+        ztimer_node_t **heap = (ztimer_node_t**)realloc(timer->heap,
+                                                        2 * timer->cap * sizeof(ztimer_node_t*));
+        if(!heap){
+            zerrno(ZEMEM_INSUFFICIENT);
+            return ZEMEM_INSUFFICIENT;
+        }
+        timer->heap = heap;
+        timer->cap *= 2;
+    }
+    node->expire = st_utime() + timeout_us;
+    node->cb = cb;
+    node->hint = hint;
+    node->index = timer->cnt;
+    timer->heap[timer->cnt++] = node;
+    ztimer_up(timer, node->index);
+    if(0 == node->index && timer->cond){
+        /* new earliest deadline */
+        st_cond_signal(timer->cond);
+    }
+    return ZEOK;
+}
+
+void ztimer_del(ztimer_t *timer, ztimer_node_t *node){
+    int i = node->index;
+
+    if(-1 == i){
+        return;
+    }
+    node->index = -1;
+    if(i != --timer->cnt){
+        timer->heap[i] = timer->heap[timer->cnt];
+        timer->heap[i]->index = i;
+        ztimer_down(timer, i);
+        ztimer_up(timer, i);
+    }
+}
+
+st_utime_t ztimer_expire(ztimer_t *timer, st_utime_t now){
+    ztimer_node_t *node;
+
+    while(timer->cnt > 0){
+        node = timer->heap[0];
+        if(node->expire > now){
+            return node->expire - now;
+        }
+        ztimer_del(timer, node);
+        ++timer->fired;
+        node->cb(node, node->hint);
+    }
+    return ST_UTIME_NO_TIMEOUT;
+}
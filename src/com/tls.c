@@ -0,0 +1,375 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tls.c
+ * @brief TLS links with kernel TLS offload
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/tls.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <time.h>
+#ifdef ZNT_HAVE_OPENSSL
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+#ifdef ZNT_HAVE_OPENSSL
+
+#define ZTLS_CIPHERS "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:" \
+    "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384:"                  \
+    "ECDHE-ECDSA-CHACHA20-POLY1305:ECDHE-RSA-CHACHA20-POLY1305"
+#define ZTLS_SUITES "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384:TLS_CHACHA20_POLY1305_SHA256"
+
+static void ztls_log_errors(const char *what){
+    char msg[256];
+    unsigned long e;
+
+    while((e = ERR_get_error())){
+        ERR_error_string_n(e, msg, sizeof(msg));
+        zinf("%s: %s", what, msg);
+    }
+}
+
+/**
+ * @brief map an SSL_get_error() to ZEAGAIN + want, ZEFAIL otherwise
+ * @note the error queue is per thread and outlives a call, clear it with
+ *       ERR_clear_error() before the SSL_* call whose result lands here
+ */
+static zerr_t ztls_error(ztls_t *tls, int ret){
+    switch(SSL_get_error((SSL*)tls->ssl, ret)){
+    case SSL_ERROR_WANT_READ:
+        tls->want = POLLIN;
+        return ZEAGAIN;
+    case SSL_ERROR_WANT_WRITE:
+        tls->want = POLLOUT;
+        return ZEAGAIN;
+    case SSL_ERROR_ZERO_RETURN:
+        return ZEOK;
+    case SSL_ERROR_SYSCALL:
+        if(EAGAIN == errno || EINTR == errno){
+            tls->want = POLLIN | POLLOUT;
+            return ZEAGAIN;
+        }
+        zerrno(errno);
+        /* fall through */
+    default:
+        ztls_log_errors("tls");
+        return ZEFAIL;
+    }
+}
+
+void ztls_cfg_default(ztls_cfg_t *cfg){
+    memset(cfg, 0, sizeof(ztls_cfg_t));
+    cfg->ktls = 1;
+}
+
+zerr_t ztls_ctx_init(ztls_ctx_t *ctx, int server, const ztls_cfg_t *cfg){
+    SSL_CTX *sc;
+    uint64_t opts = SSL_OP_NO_COMPRESSION | SSL_OP_NO_RENEGOTIATION;
+
+    memset(ctx, 0, sizeof(ztls_ctx_t));
+    if(!(sc = SSL_CTX_new(server ? TLS_server_method() : TLS_client_method()))){
+        ztls_log_errors("tls context");
+        return ZEFAIL;
+    }
+    ctx->ssl_ctx = sc;
+    ctx->server = server;
+    ctx->ktls = cfg->ktls;
+    SSL_CTX_set_min_proto_version(sc, TLS1_2_VERSION);
+    /* AEAD suites the kernel implements */
+    SSL_CTX_set_cipher_list(sc, cfg->ciphers ? cfg->ciphers : ZTLS_CIPHERS);
+    SSL_CTX_set_ciphersuites(sc, ZTLS_SUITES);
+#ifdef SSL_OP_ENABLE_KTLS
+    if(cfg->ktls){
+        opts |= SSL_OP_ENABLE_KTLS;
+    }
+#endif
+    SSL_CTX_set_options(sc, opts);
+    SSL_CTX_set_mode(sc, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    if(cfg->cert && (1 != SSL_CTX_use_certificate_chain_file(sc, cfg->cert) ||
+                     1 != SSL_CTX_use_PrivateKey_file(sc, cfg->key ? cfg->key : cfg->cert, SSL_FILETYPE_PEM) ||
+                     1 != SSL_CTX_check_private_key(sc))){
+        ztls_log_errors("tls certificate");
+        ztls_ctx_fini(ctx);
+        return ZEFAIL;
+    }
+    if(cfg->ca){
+        if(1 != SSL_CTX_load_verify_locations(sc, cfg->ca, NULL)){
+            ztls_log_errors("tls ca");
+            ztls_ctx_fini(ctx);
+            return ZEFAIL;
+        }
+        SSL_CTX_set_verify(sc, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, NULL);
+    }
+    return ZEOK;
+}
+
+void ztls_ctx_fini(ztls_ctx_t *ctx){
+    SSL_CTX_free((SSL_CTX*)ctx->ssl_ctx);
+    ctx->ssl_ctx = NULL;
+}
+
+zerr_t ztls_init(ztls_t *tls, ztls_ctx_t *ctx, zsock_t sock){
+    SSL *ssl;
+
+    memset(tls, 0, sizeof(ztls_t));
+    tls->sock = sock;
+    if(!(ssl = SSL_new((SSL_CTX*)ctx->ssl_ctx)) || 1 != SSL_set_fd(ssl, sock)){
+        ztls_log_errors("tls session");
+        SSL_free(ssl);
+        return ZEFAIL;
+    }
+    tls->ssl = ssl;
+    if(ctx->server){
+        SSL_set_accept_state(ssl);
+    }else{
+        SSL_set_connect_state(ssl);
+    }
+    return ZEOK;
+}
+
+void ztls_fini(ztls_t *tls){
+    if(tls->ssl){
+        if(tls->established){
+            SSL_shutdown((SSL*)tls->ssl);
+        }
+        SSL_free((SSL*)tls->ssl);
+        tls->ssl = NULL;
+    }
+    if(ZINVALID_SOCKET != tls->sock){
+        zsockclose(tls->sock);
+        tls->sock = ZINVALID_SOCKET;
+    }
+    free(tls->file_buf);
+    tls->file_buf = NULL;
+}
+
+zerr_t ztls_handshake(ztls_t *tls){
+    SSL *ssl = (SSL*)tls->ssl;
+    int ret;
+
+    if(tls->established){
+        return ZEOK;
+    }
+    ERR_clear_error();
+    if(1 != (ret = SSL_do_handshake(ssl))){
+        ret = ztls_error(tls, ret);
+        return ZEOK == ret ? ZEFAIL : ret;
+    }
+    tls->established = 1;
+#ifdef SSL_OP_ENABLE_KTLS
+    /* OpenSSL pushed the keys into the kernel if it could */
+    tls->ktls_tx = BIO_get_ktls_send(SSL_get_wbio(ssl)) > 0;
+    tls->ktls_rx = BIO_get_ktls_recv(SSL_get_rbio(ssl)) > 0;
+#endif
+    zdbg("tls<%d> %s %s ktls tx:%d rx:%d", tls->sock, SSL_get_version(ssl),
+         SSL_get_cipher_name(ssl), tls->ktls_tx, tls->ktls_rx);
+    return ZEOK;
+}
+
+zerr_t ztls_handshake_wait(ztls_t *tls, int timeout_ms){
+    struct pollfd pfd;
+    struct timespec ts;
+    uint64_t deadline, now;
+    zerr_t ret;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    deadline = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000 + timeout_ms;
+    while(ZEAGAIN == (ret = ztls_handshake(tls))){
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        if((now = (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000) >= deadline){
+            return ZETIMEOUT;
+        }
+        pfd.fd = tls->sock;
+        pfd.events = tls->want;
+        poll(&pfd, 1, (int)(deadline - now));
+    }
+    return ret;
+}
+
+zerr_t ztls_send(ztls_t *tls, const char *buf, int *len){
+    int sent = 0;
+    int ret;
+
+    while(sent < *len){
+        ERR_clear_error();
+        if((ret = SSL_write((SSL*)tls->ssl, buf + sent, *len - sent)) > 0){
+            sent += ret;
+            continue;
+        }
+        tls->bytes_out += sent;
+        *len = sent;
+        ret = ztls_error(tls, ret);
+        return ZEOK == ret ? ZEFAIL : ret;
+    }
+    tls->bytes_out += sent;
+    return ZEOK;
+}
+
+zerr_t ztls_recv(ztls_t *tls, char *buf, int len){
+    int ret;
+
+    ERR_clear_error();
+    if((ret = SSL_read((SSL*)tls->ssl, buf, len)) > 0){
+        tls->bytes_in += ret;
+        return ret;
+    }
+    /* close_notify reads as 0, like a closed socket */
+    return ztls_error(tls, ret);
+}
+
+ssize_t ztls_sendfile(ztls_t *tls, int fd, off_t offset, size_t size){
+    ssize_t sent = 0;
+    ssize_t n;
+    int len;
+    zerr_t ret;
+
+#ifdef SSL_OP_ENABLE_KTLS
+    if(tls->ktls_tx){
+        /* the kernel reads the page cache and encrypts, no user copy */
+        ERR_clear_error();
+        if((n = SSL_sendfile((SSL*)tls->ssl, fd, offset, size, 0)) > 0){
+            tls->bytes_out += n;
+            tls->sendfile_bytes += n;
+            return n;
+        }
+        ret = ztls_error(tls, (int)n);
+        return ZEOK == ret ? ZEFAIL : ret;
+    }
+#endif
+    if(!tls->file_buf && !(tls->file_buf = (char*)malloc(ZTLS_FILE_BUF))){
+        return ZEMEM_INSUFFICIENT;
+    }
+    while((size_t)sent < size){
+        len = size - sent < ZTLS_FILE_BUF ? (int)(size - sent) : ZTLS_FILE_BUF;
+        if((n = pread(fd, tls->file_buf, len, offset + sent)) <= 0){
+            if(sent){
+                break;
+            }
+            zerrno(errno);
+            return ZEFAIL;
+        }
+        len = (int)n;
+        ret = ztls_send(tls, tls->file_buf, &len);
+        sent += len;
+        if(ZEOK != ret){
+            /* the retry re-reads the same bytes at offset + sent, as SSL_write() wants */
+            if(!sent){
+                return ret;
+            }
+            break;
+        }
+    }
+    tls->sendfile_bytes += sent;
+    return sent;
+}
+#else /* ZNT_HAVE_OPENSSL */
+/* built without OpenSSL, links fail at once */
+void ztls_cfg_default(ztls_cfg_t *cfg){
+    memset(cfg, 0, sizeof(ztls_cfg_t));
+    cfg->ktls = 1;
+}
+
+zerr_t ztls_ctx_init(ztls_ctx_t *ctx, int server, const ztls_cfg_t *cfg){
+    memset(ctx, 0, sizeof(ztls_ctx_t));
+    zinf("tls needs -DZNT_HAVE_OPENSSL");
+    zerrno(ZEFAIL);
+    return ZEFAIL;
+}
+
+void ztls_ctx_fini(ztls_ctx_t *ctx){
+    ctx->ssl_ctx = NULL;
+}
+
+zerr_t ztls_init(ztls_t *tls, ztls_ctx_t *ctx, zsock_t sock){
+    memset(tls, 0, sizeof(ztls_t));
+    tls->sock = sock;
+    return ZEFAIL;
+}
+
+void ztls_fini(ztls_t *tls){
+    if(ZINVALID_SOCKET != tls->sock){
+        zsockclose(tls->sock);
+        tls->sock = ZINVALID_SOCKET;
+    }
+}
+
+zerr_t ztls_handshake(ztls_t *tls){
+    return ZEFAIL;
+}
+
+zerr_t ztls_handshake_wait(ztls_t *tls, int timeout_ms){
+    return ZEFAIL;
+}
+
+zerr_t ztls_send(ztls_t *tls, const char *buf, int *len){
+    *len = 0;
+    return ZEFAIL;
+}
+
+zerr_t ztls_recv(ztls_t *tls, char *buf, int len){
+    return ZEFAIL;
+}
+
+ssize_t ztls_sendfile(ztls_t *tls, int fd, off_t offset, size_t size){
+    return ZEFAIL;
+}
+#endif /* ZNT_HAVE_OPENSSL */
+
+/******************************************************************************
+ * transport binding
+ */
+static zerr_t ztrans_tls_send(zptr_t ctx, const char *buf, int *len, int flags){
+    return ztls_send((ztls_t*)ctx, buf, len);
+}
+
+static zerr_t ztrans_tls_recv(zptr_t ctx, char *buf, int len, int flags){
+    return ztls_recv((ztls_t*)ctx, buf, len);
+}
+
+static int ztrans_tls_fileno(zptr_t ctx){
+    return ((ztls_t*)ctx)->sock;
+}
+
+static zerr_t ztrans_tls_close(zptr_t ctx){
+    ztls_fini((ztls_t*)ctx);
+    return ZEOK;
+}
+
+const ztrans_ops_t ztrans_tls_ops = {
+    "tls",
+    ztrans_tls_send,
+    ztrans_tls_recv,
+    NULL,
+    ztrans_tls_fileno,
+    ztrans_tls_close
+};
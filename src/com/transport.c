@@ -0,0 +1,60 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file transport.c
+ * @brief Socket binding of the transport interface
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/transport.h>
+
+static zerr_t ztrans_sock_send(zptr_t ctx, const char *buf, int *len, int flags){
+    return zsend((zsock_t)(intptr_t)ctx, buf, len, flags);
+}
+
+static zerr_t ztrans_sock_recv(zptr_t ctx, char *buf, int len, int flags){
+    return zrecv((zsock_t)(intptr_t)ctx, buf, len, flags);
+}
+
+static int ztrans_sock_fileno(zptr_t ctx){
+    return (int)(intptr_t)ctx;
+}
+
+static zerr_t ztrans_sock_close(zptr_t ctx){
+    return zsockclose((zsock_t)(intptr_t)ctx);
+}
+
+const ztrans_ops_t ztrans_sock_ops = {
+    "tcp",
+    ztrans_sock_send,
+    ztrans_sock_recv,
+    NULL,
+    ztrans_sock_fileno,
+    ztrans_sock_close
+};
@@ -0,0 +1,479 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file wspool.c
+ * @brief Work-stealing thread pool for offloading ST request handlers
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/com/wspool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#define ZWSP_BATCH 32
+#define ZWSP_IDLE_MS 100
+#define ZWSP_HUB_SIZE 4096
+
+typedef struct zwsp_deque_s{
+    volatile int64_t top; /** thieves side */
+    char pad0[ZMBOX_CACHELINE - 8];
+    volatile int64_t bottom; /** owner side */
+    char pad1[ZMBOX_CACHELINE - 8];
+    int64_t mask;
+    zwsp_task_t **buf;
+}zwsp_deque_t;
+
+typedef struct zwsp_worker_s{
+    zwsp_deque_t deque;
+    zwsp_pool_t *pool;
+    zmbox_t *inbox; /** tasks from non-worker threads */
+    pthread_t thr;
+    int evfd; /** steal hint doorbell */
+    volatile int sleeping;
+    int id;
+    /* statistic */
+    uint64_t runs;
+    uint64_t steals;
+}zwsp_worker_t;
+
+struct zwsp_pool_s{
+    zwsp_worker_t *workers;
+    int nworkers;
+    int nstarted; /** threads to join */
+    volatile uint32_t rr; /** round robin inbox selector */
+    volatile uint32_t submitting; /** zwsp_submit() calls past their stop check */
+    volatile int stop;
+};
+
+struct zwsp_hub_s{
+    zmbox_t *done; /** finished tasks from workers */
+    st_netfd_t stfd; /** doorbell of <done> */
+    st_thread_t thr;
+    volatile uint32_t inflight; /** submitted, not yet popped, <= ZWSP_HUB_SIZE */
+    volatile int stop;
+};
+
+static __thread zwsp_worker_t *zwsp_self;
+
+/******************************************************************************
+ * Chase-Lev deque, bounded
+ */
+static zerr_t zwsp_deque_init(zwsp_deque_t *dq, uint32_t size){
+    int64_t sz = 2;
+    while(sz < size){
+        sz <<= 1;
+    }
+    dq->top = dq->bottom = 0;
+    dq->mask = sz - 1;
+    dq->buf = (zwsp_task_t**)calloc(sz, sizeof(zwsp_task_t*));
+    return dq->buf ? ZEOK : ZEMEM_INSUFFICIENT;
+}
+
+static zerr_t zwsp_deque_push(zwsp_deque_t *dq, zwsp_task_t *task){
+    int64_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED);
+    int64_t t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+
+    if(b - t > dq->mask){
+        return ZEAGAIN;
+    }
+    __atomic_store_n(&dq->buf[b & dq->mask], task, __ATOMIC_RELAXED);
+    __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELEASE);
+    return ZEOK;
+}
+
+static zwsp_task_t *zwsp_deque_pop(zwsp_deque_t *dq){
+    int64_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED) - 1;
+    int64_t t;
+    zwsp_task_t *task = NULL;
+
+    __atomic_store_n(&dq->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    t = __atomic_load_n(&dq->top, __ATOMIC_RELAXED);
+    if(t <= b){
+        task = __atomic_load_n(&dq->buf[b & dq->mask], __ATOMIC_RELAXED);
+        if(t == b){
+            /* last one, race against thieves */
+            if(!__atomic_compare_exchange_n(&dq->top, &t, t + 1, 0,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)){
+                task = NULL;
+            }
+            __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+        }
+    }else{
+        __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return task;
+}
+
+static zwsp_task_t *zwsp_deque_steal(zwsp_deque_t *dq){
+    int64_t t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+    int64_t b;
+    zwsp_task_t *task;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    b = __atomic_load_n(&dq->bottom, __ATOMIC_ACQUIRE);
+    if(t >= b){
+        return NULL;
+    }
+    task = __atomic_load_n(&dq->buf[t & dq->mask], __ATOMIC_RELAXED);
+    if(!__atomic_compare_exchange_n(&dq->top, &t, t + 1, 0,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)){
+        return NULL;
+    }
+    return task;
+}
+
+/******************************************************************************
+ * workers
+ */
+static void zwsp_wake_one(zwsp_pool_t *pool, zwsp_worker_t *self){
+    uint64_t one = 1;
+    int i;
+
+    for(i = 0; i < pool->nworkers; ++i){
+        zwsp_worker_t *w = &pool->workers[i];
+        if(w != self && __atomic_load_n(&w->sleeping, __ATOMIC_RELAXED) &&
+           __atomic_exchange_n(&w->sleeping, 0, __ATOMIC_ACQ_REL)){
+            if(write(w->evfd, &one, sizeof(one)) < 0 && EAGAIN != errno){
+                zerrno(errno);
+            }
+            break;
+        }
+    }
+}
+
+static void zwsp_run(zwsp_worker_t *self, zwsp_task_t *task){
+    zwsp_hub_t *hub = task->hub;
+
+    task->ret = task->op(task->in, &task->out, task->hint);
+    ++self->runs;
+    if(hub){
+        /* zwsp_submit() reserved a cell, the mailbox cannot be full */
+        zmbox_push(hub->done, task);
+    }
+}
+
+static zwsp_task_t *zwsp_find(zwsp_worker_t *self){
+    zwsp_pool_t *pool = self->pool;
+    zwsp_task_t *task;
+    zptr_t items[ZWSP_BATCH];
+    int cnt;
+    int i;
+
+    if((task = zwsp_deque_pop(&self->deque))){
+        return task;
+    }
+    if((cnt = zmbox_pop(self->inbox, items, ZWSP_BATCH)) > 0){
+        /* keep the first, expose the rest to thieves */
+        for(i = cnt - 1; i > 0; --i){
+            if(ZEOK != zwsp_deque_push(&self->deque, (zwsp_task_t*)items[i])){
+                zwsp_run(self, (zwsp_task_t*)items[i]);
+            }
+        }
+        if(cnt > 1){
+            zwsp_wake_one(pool, self);
+        }
+        return (zwsp_task_t*)items[0];
+    }
+    for(i = 1; i < pool->nworkers; ++i){
+        zwsp_worker_t *victim = &pool->workers[(self->id + i) % pool->nworkers];
+        if((task = zwsp_deque_steal(&victim->deque))){
+            ++self->steals;
+            return task;
+        }
+    }
+    return NULL;
+}
+
+static zptr_t zwsp_worker_proc(zptr_t arg){
+    zwsp_worker_t *self = (zwsp_worker_t*)arg;
+    zwsp_pool_t *pool = self->pool;
+    zwsp_task_t *task;
+    struct pollfd pfd[2];
+    uint64_t cnt;
+
+    zwsp_self = self;
+    pfd[0].fd = zmbox_fileno(self->inbox);
+    pfd[0].events = POLLIN;
+    pfd[1].fd = self->evfd;
+    pfd[1].events = POLLIN;
+    for(;;){
+        if((task = zwsp_find(self))){
+            zwsp_run(self, task);
+            continue;
+        }
+        if(__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE)){
+            break;
+        }
+        /* announce sleeping, then look again so a racing spawn is not missed */
+        __atomic_store_n(&self->sleeping, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if((task = zwsp_find(self))){
+            __atomic_store_n(&self->sleeping, 0, __ATOMIC_RELAXED);
+            zwsp_run(self, task);
+            continue;
+        }
+        poll(pfd, 2, ZWSP_IDLE_MS);
+        __atomic_store_n(&self->sleeping, 0, __ATOMIC_RELAXED);
+        if(pfd[1].revents & POLLIN){
+            if(read(self->evfd, &cnt, sizeof(cnt)) < 0){
+                zerrno(errno);
+            }
+        }
+    }
+    zdbg("wspool worker<%d> exit<runs:%llu steals:%llu>", self->id,
+         (unsigned long long)self->runs, (unsigned long long)self->steals);
+    return NULL;
+}
+
+zwsp_pool_t *zwsp_create(int workers, uint32_t deque_size){
+    zwsp_pool_t *pool = NULL;
+    int i;
+
+    if(workers <= 0 && (workers = (int)sysconf(_SC_NPROCESSORS_ONLN)) <= 0){
+        workers = 1;
+    }
+    if(!(pool = (zwsp_pool_t*)calloc(1, sizeof(zwsp_pool_t))) ||
+       0 != posix_memalign((void**)&pool->workers, ZMBOX_CACHELINE,
+                           workers * sizeof(zwsp_worker_t))){
+        free(pool);
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    memset(pool->workers, 0, workers * sizeof(zwsp_worker_t));
+    for(i = 0; i < workers; ++i){
+        zwsp_worker_t *w = &pool->workers[i];
+        w->pool = pool;
+        w->id = i;
+        w->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        w->inbox = zmbox_create(deque_size);
+        if(-1 == w->evfd || !w->inbox || ZEOK != zwsp_deque_init(&w->deque, deque_size)){
+            pool->nworkers = i + 1;
+            zwsp_destroy(pool);
+            zerrno(ZEFAIL);
+            return NULL;
+        }
+    }
+    pool->nworkers = workers;
+    for(i = 0; i < workers; ++i){
+        if(0 != pthread_create(&pool->workers[i].thr, NULL, zwsp_worker_proc, &pool->workers[i])){
+            /* every worker is initialised, only the started ones are joined */
+            zerrno(errno);
+            zwsp_destroy(pool);
+            return NULL;
+        }
+        pool->nstarted = i + 1;
+    }
+    zdbg("wspool<%p> created<workers:%d, deque:%u>", pool, workers, deque_size);
+    return pool;
+}
+
+void zwsp_destroy(zwsp_pool_t *pool){
+    uint64_t one = 1;
+    int i;
+
+    if(!pool){
+        return;
+    }
+    __atomic_store_n(&pool->stop, 1, __ATOMIC_SEQ_CST);
+    for(i = 0; i < pool->nstarted; ++i){
+        zwsp_worker_t *w = &pool->workers[i];
+        if(write(w->evfd, &one, sizeof(one)) < 0){
+            zerrno(errno);
+        }
+        pthread_join(w->thr, NULL);
+    }
+    /* submits that raced with the stop, run them here rather than drop them */
+    while(__atomic_load_n(&pool->submitting, __ATOMIC_SEQ_CST)){
+        sched_yield();
+    }
+    for(i = 0; i < pool->nstarted; ++i){
+        zwsp_worker_t *w = &pool->workers[i];
+        zptr_t item;
+        zwsp_task_t *task;
+
+        for(;;){
+            if(!(task = zwsp_deque_pop(&w->deque))){
+                if(zmbox_pop(w->inbox, &item, 1) <= 0){
+                    break;
+                }
+                task = (zwsp_task_t*)item;
+            }
+            zwsp_run(w, task);
+        }
+    }
+    for(i = 0; i < pool->nworkers; ++i){
+        zwsp_worker_t *w = &pool->workers[i];
+        if(-1 != w->evfd){
+            close(w->evfd);
+        }
+        zmbox_destroy(w->inbox);
+        free(w->deque.buf);
+    }
+    free(pool->workers);
+    free(pool);
+}
+
+zerr_t zwsp_submit(zwsp_pool_t *pool, zwsp_task_t *task){
+    zwsp_worker_t *self = zwsp_self;
+    zwsp_hub_t *hub = task->hub;
+    uint32_t rr;
+    int i;
+
+    zerr_t ret = ZEAGAIN;
+
+    task->done = 0;
+    /* announce before the check, zwsp_destroy() stops before it drains */
+    __atomic_add_fetch(&pool->submitting, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&pool->stop, __ATOMIC_SEQ_CST)){
+        __atomic_sub_fetch(&pool->submitting, 1, __ATOMIC_RELEASE);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    /* reserve the completion cell now, a worker never waits for the hub */
+    if(hub && __atomic_fetch_add(&hub->inflight, 1, __ATOMIC_ACQ_REL) >= ZWSP_HUB_SIZE){
+        __atomic_fetch_sub(&hub->inflight, 1, __ATOMIC_RELEASE);
+        __atomic_sub_fetch(&pool->submitting, 1, __ATOMIC_RELEASE);
+        return ZEAGAIN;
+    }
+    if(self && self->pool == pool && ZEOK == zwsp_deque_push(&self->deque, task)){
+        zwsp_wake_one(pool, self);
+        ret = ZEOK;
+    }else{
+        rr = __atomic_fetch_add(&pool->rr, 1, __ATOMIC_RELAXED);
+        for(i = 0; i < pool->nworkers && ZEOK != ret; ++i){
+            ret = zmbox_push(pool->workers[(rr + i) % pool->nworkers].inbox, task);
+        }
+    }
+    if(ZEOK != ret && hub){
+        __atomic_fetch_sub(&hub->inflight, 1, __ATOMIC_RELEASE);
+    }
+    __atomic_sub_fetch(&pool->submitting, 1, __ATOMIC_RELEASE);
+    return ret;
+}
+
+/******************************************************************************
+ * ST completion hub
+ */
+static zptr_t zwsp_hub_proc(zptr_t arg){
+    zwsp_hub_t *hub = (zwsp_hub_t*)arg;
+    zptr_t items[ZWSP_BATCH];
+    int cnt;
+    int i;
+
+    while(!hub->stop){
+        if(ZEAGAIN == (cnt = zmbox_pop(hub->done, items, ZWSP_BATCH))){
+            zst_wait_readable(hub->stfd, ST_UTIME_NO_TIMEOUT);
+            continue;
+        }
+        __atomic_fetch_sub(&hub->inflight, cnt, __ATOMIC_RELEASE);
+        for(i = 0; i < cnt; ++i){
+            zwsp_task_t *task = (zwsp_task_t*)items[i];
+            task->done = 1;
+            st_cond_signal(task->cond);
+        }
+    }
+    return NULL;
+}
+
+zwsp_hub_t *zwsp_hub_create(void){
+    zwsp_hub_t *hub = (zwsp_hub_t*)calloc(1, sizeof(zwsp_hub_t));
+
+    if(!hub){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    if(!(hub->done = zmbox_create(ZWSP_HUB_SIZE)) ||
+       !(hub->stfd = st_netfd_open(zmbox_fileno(hub->done))) ||
+       !(hub->thr = zst_thread_create(zwsp_hub_proc, hub, ztrue, 0))){
+        zwsp_hub_destroy(hub);
+        return NULL;
+    }
+    return hub;
+}
+
+void zwsp_hub_destroy(zwsp_hub_t *hub){
+    if(!hub){
+        return;
+    }
+    if(hub->thr){
+        hub->stop = 1;
+        st_thread_interrupt(hub->thr);
+        zst_thread_join(hub->thr);
+    }
+    if(hub->stfd){
+        /* the descriptor is owned by the mailbox */
+        st_netfd_free(hub->stfd);
+    }
+    zmbox_destroy(hub->done);
+    free(hub);
+}
+
+zerr_t zwsp_await(zwsp_task_t *task){
+    while(!task->done){
+        if(-1 == st_cond_wait(task->cond)){
+            /* interrupted, the worker still owns the task */
+            continue;
+        }
+    }
+    return task->ret;
+}
+
+zerr_t zwsp_call(zwsp_pool_t *pool, zwsp_hub_t *hub, zoperate op,
+                 zptr_t in, zptr_t *out, zptr_t hint){
+    zwsp_task_t task;
+    zerr_t ret;
+
+    memset(&task, 0, sizeof(task));
+    task.op = op;
+    task.in = in;
+    task.hint = hint;
+    task.hub = hub;
+    if(!(task.cond = st_cond_new())){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    while(ZEAGAIN == (ret = zwsp_submit(pool, &task))){
+        /* pool saturated, back off this coroutine only */
+        st_usleep(1000);
+    }
+    if(ZEOK == ret){
+        ret = zwsp_await(&task);
+        if(out){
+            *out = task.out;
+        }
+    }
+    st_cond_destroy(task.cond);
+    return ret;
+}
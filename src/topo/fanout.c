@@ -0,0 +1,446 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file fanout.c
+ * @brief Overlay fan-out tree for broadcasting to many nodes
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/topo/fanout.h>
+#include <znt/com/state_threads.h>
+#include <stdlib.h>
+#include <string.h>
+#include <endian.h>
+
+#define ZFANOUT_F_OPEN 0x0001
+#define ZFANOUT_SEND_TIMEOUT 1000000 /** us without progress before a child is dropped */
+
+typedef struct zfanout_hdr_s{
+    uint32_t len;
+    uint16_t flags;
+    uint16_t hops;
+    uint64_t bid;
+    uint64_t origin; /** key of the broadcasting node */
+    uint64_t total;
+    uint64_t offset;
+    zfanout_range_t range;
+}zfanout_hdr_t;
+
+typedef struct zfanout_peer_s{
+    uint32_t zone;
+    uint64_t key;
+    znt_node_t *node;
+}zfanout_peer_t;
+
+/******************************************************************************
+ * frame
+ */
+static void zfanout_put32(char *buf, uint32_t v){
+    v = htole32(v);
+    memcpy(buf, &v, 4);
+}
+
+static void zfanout_put64(char *buf, uint64_t v){
+    v = htole64(v);
+    memcpy(buf, &v, 8);
+}
+
+static uint32_t zfanout_get32(const char *buf){
+    uint32_t v;
+    memcpy(&v, buf, 4);
+    return le32toh(v);
+}
+
+static uint64_t zfanout_get64(const char *buf){
+    uint64_t v;
+    memcpy(&v, buf, 8);
+    return le64toh(v);
+}
+
+static void zfanout_encode(char *buf, const zfanout_hdr_t *hdr){
+    uint16_t u16;
+
+    zfanout_put32(buf, hdr->len);
+    u16 = htole16(hdr->range.open ? ZFANOUT_F_OPEN : 0);
+    memcpy(buf + 4, &u16, 2);
+    u16 = htole16(hdr->hops);
+    memcpy(buf + 6, &u16, 2);
+    zfanout_put64(buf + 8, hdr->bid);
+    zfanout_put64(buf + 16, hdr->origin);
+    zfanout_put64(buf + 24, hdr->total);
+    zfanout_put64(buf + 32, hdr->offset);
+    zfanout_put32(buf + 40, hdr->range.lo_zone);
+    zfanout_put32(buf + 44, hdr->range.hi_zone);
+    zfanout_put64(buf + 48, hdr->range.lo_key);
+    zfanout_put64(buf + 56, hdr->range.hi_key);
+}
+
+static void zfanout_decode(const char *buf, zfanout_hdr_t *hdr){
+    uint16_t u16;
+
+    hdr->len = zfanout_get32(buf);
+    memcpy(&u16, buf + 4, 2);
+    hdr->flags = le16toh(u16);
+    memcpy(&u16, buf + 6, 2);
+    hdr->hops = le16toh(u16);
+    hdr->bid = zfanout_get64(buf + 8);
+    hdr->origin = zfanout_get64(buf + 16);
+    hdr->total = zfanout_get64(buf + 24);
+    hdr->offset = zfanout_get64(buf + 32);
+    hdr->range.lo_zone = zfanout_get32(buf + 40);
+    hdr->range.hi_zone = zfanout_get32(buf + 44);
+    hdr->range.lo_key = zfanout_get64(buf + 48);
+    hdr->range.hi_key = zfanout_get64(buf + 56);
+    hdr->range.open = (hdr->flags & ZFANOUT_F_OPEN) ? 1 : 0;
+}
+
+int zfanout_frame_len(const char *hdr){
+    return ZFANOUT_HDR_SIZE + (int)zfanout_get32(hdr);
+}
+
+/******************************************************************************
+ * tree
+ */
+static int zfanout_cmp(uint32_t zone_a, uint64_t key_a, uint32_t zone_b, uint64_t key_b){
+    if(zone_a != zone_b){
+        return zone_a < zone_b ? -1 : 1;
+    }
+    return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+static int zfanout_peer_cmp(const void *a, const void *b){
+    const zfanout_peer_t *pa = (const zfanout_peer_t*)a;
+    const zfanout_peer_t *pb = (const zfanout_peer_t*)b;
+    return zfanout_cmp(pa->zone, pa->key, pb->zone, pb->key);
+}
+
+static int zfanout_in_range(const zfanout_range_t *range, uint32_t zone, uint64_t key){
+    return zfanout_cmp(zone, key, range->lo_zone, range->lo_key) >= 0 &&
+        (range->open || zfanout_cmp(zone, key, range->hi_zone, range->hi_key) < 0);
+}
+
+/** @return peers of <range> known locally, self and origin excluded, in tree order */
+static int zfanout_collect(zfanout_t *fo, const zfanout_range_t *range, uint64_t origin,
+                           zfanout_peer_t *peers){
+    znt_node_t *node;
+    uint32_t zone;
+    int cnt = 0;
+    int i;
+
+    for(i = 0; i < fo->route->nnodes; ++i){
+        node = fo->route->nodes[i];
+        if(node->key == fo->self_key || node->key == origin){
+            continue;
+        }
+        zone = fo->zone ? fo->zone(node, fo->hint) : 0;
+        if(zfanout_in_range(range, zone, node->key)){
+            peers[cnt].zone = zone;
+            peers[cnt].key = node->key;
+            peers[cnt].node = node;
+            ++cnt;
+        }
+    }
+    qsort(peers, cnt, sizeof(zfanout_peer_t), zfanout_peer_cmp);
+    return cnt;
+}
+
+/** @return end of the part starting at <pos>, snapped to a near zone boundary */
+static int zfanout_part_end(zfanout_peer_t *peers, int cnt, int pos, int parts){
+    int size = (cnt - pos + parts - 1) / parts;
+    int end = pos + size;
+    int back, fwd;
+
+    if(parts <= 1 || end >= cnt || peers[pos].zone == peers[cnt - 1].zone){
+        return parts <= 1 ? cnt : end;
+    }
+    for(back = end; back > pos + 1 && peers[back - 1].zone == peers[back].zone; --back);
+    for(fwd = end; fwd < cnt && peers[fwd - 1].zone == peers[fwd].zone; ++fwd);
+    if(peers[back - 1].zone != peers[back].zone && end - back <= size / 2 &&
+       (fwd - end >= end - back)){
+        return back;
+    }
+    if(fwd - end <= size / 2){
+        return fwd;
+    }
+    return end;
+}
+
+static void zfanout_split(zfanout_t *fo, const zfanout_range_t *range, uint64_t origin,
+                          zfanout_stream_t *stream){
+    zfanout_peer_t *peers;
+    zfanout_child_t *child;
+    int cnt, parts, pos, end, i;
+
+    stream->nchild = 0;
+    if(!fo->route->nnodes ||
+       !(peers = (zfanout_peer_t*)malloc(fo->route->nnodes * sizeof(zfanout_peer_t)))){
+        return;
+    }
+    cnt = zfanout_collect(fo, range, origin, peers);
+    parts = cnt < fo->degree ? cnt : fo->degree;
+    for(pos = 0; pos < cnt; pos = end){
+        end = zfanout_part_end(peers, cnt, pos, parts - stream->nchild);
+        child = &stream->child[stream->nchild];
+        /* the first reachable member leads the part */
+        for(i = pos; i < end && !peers[i].node->nconns; ++i);
+        if(i == end){
+            ++fo->send_fails;
+            zdbg("fanout part [%d, %d) has no reachable member", pos, end);
+            if(parts - stream->nchild > 1){
+                --parts;
+            }
+            continue;
+        }
+        child->node = peers[i].node;
+        child->conn = child->node->conns[child->node->rr++ % child->node->nconns];
+        child->range.lo_zone = peers[pos].zone;
+        child->range.lo_key = peers[pos].key;
+        if(end < cnt){
+            child->range.hi_zone = peers[end].zone;
+            child->range.hi_key = peers[end].key;
+            child->range.open = 0;
+        }else{
+            child->range.hi_zone = range->hi_zone;
+            child->range.hi_key = range->hi_key;
+            child->range.open = range->open;
+        }
+        ++stream->nchild;
+    }
+    free(peers);
+}
+
+/******************************************************************************
+ * forwarding
+ */
+static zerr_t zfanout_send_all(ztrans_t *conn, const char *buf, int len, int flags){
+    struct pollfd pd;
+    zerr_t ret;
+    int stalls = 0;
+    int sent;
+
+    while(len > 0){
+        sent = len;
+        if(ZEOK == (ret = ztrans_send(conn, buf, &sent, flags))){
+            return ZEOK;
+        }
+        if(ZEAGAIN != ret){
+            return ret;
+        }
+        buf += sent;
+        len -= sent;
+        if(sent){
+            stalls = 0;
+            continue;
+        }
+        /* wait for room, a descriptor that polls writable without room backs off */
+        pd.fd = ztrans_fileno(conn);
+        pd.events = POLLOUT;
+        pd.revents = 0;
+        if(st_poll(&pd, 1, ZFANOUT_SEND_TIMEOUT) <= 0){
+            return ZETIMEOUT;
+        }
+        if(++stalls > 1){
+            st_usleep(1000);
+        }
+    }
+    return ZEOK;
+}
+
+static st_mutex_t zfanout_lock_of(zfanout_t *fo, ztrans_t *conn){
+    return fo->locks[((uintptr_t)conn / sizeof(ztrans_t)) % ZFANOUT_LOCKS];
+}
+
+static void zfanout_forward(zfanout_t *fo, zfanout_stream_t *stream, zfanout_hdr_t *hdr,
+                            const char *data){
+    char head[ZFANOUT_HDR_SIZE];
+    zfanout_child_t *child;
+    st_mutex_t lock;
+    zerr_t ret;
+    int i;
+
+    hdr->hops = stream->hops + 1;
+    for(i = 0; i < stream->nchild; ++i){
+        child = &stream->child[i];
+        if(!child->conn){
+            continue;
+        }
+        hdr->range = child->range;
+        zfanout_encode(head, hdr);
+        /* header and payload must not interleave with another frame */
+        lock = zfanout_lock_of(fo, child->conn);
+        st_mutex_lock(lock);
+        if(!child->conn->ctx){
+            /* closed by another broadcast */
+            ret = ZEFAIL;
+        }else if(ZEOK != (ret = zfanout_send_all(child->conn, head, ZFANOUT_HDR_SIZE, MSG_MORE)) ||
+                 ZEOK != (ret = zfanout_send_all(child->conn, data, hdr->len, 0))){
+            /* part of a frame is on the wire, the peer can not resync */
+            zroute_detach(child->node, child->conn);
+            ztrans_close(child->conn);
+        }
+        st_mutex_unlock(lock);
+        if(ZEOK != ret){
+            /* the subtree misses the rest of this broadcast */
+            zinf("fanout bid<%llu> child lost at offset<%llu>",
+                 (unsigned long long)hdr->bid, (unsigned long long)hdr->offset);
+            child->conn = NULL;
+            ++fo->send_fails;
+            continue;
+        }
+        ++fo->chunks_out;
+        fo->bytes_out += ZFANOUT_HDR_SIZE + hdr->len;
+    }
+    for(i = 0; i < stream->nchild; ++i){
+        if(stream->child[i].conn && stream->child[i].conn->ctx){
+            ztrans_flush(stream->child[i].conn);
+        }
+    }
+}
+
+/******************************************************************************
+ * api
+ */
+zerr_t zfanout_init(zfanout_t *fanout, zroute_t *route, const znt_nid_t *self,
+                    int degree, int chunk, zfanout_zone_t zone,
+                    zfanout_deliver_t deliver, zptr_t hint){
+    int i;
+
+    if(!fanout || !route || !self){
+        return ZEPARAM_INVALID;
+    }
+    memset(fanout, 0, sizeof(zfanout_t));
+    for(i = 0; i < ZFANOUT_LOCKS; ++i){
+        if(!(fanout->locks[i] = st_mutex_new())){
+            zfanout_fini(fanout);
+            zerrno(ZEMEM_INSUFFICIENT);
+            return ZEMEM_INSUFFICIENT;
+        }
+    }
+    fanout->route = route;
+    fanout->self_key = zroute_hash(self->id, self->len);
+    fanout->degree = degree <= 0 ? 4 : (degree > ZFANOUT_DEGREE_MAX ? ZFANOUT_DEGREE_MAX : degree);
+    fanout->chunk = chunk <= 0 ? ZFANOUT_CHUNK : chunk;
+    fanout->zone = zone;
+    fanout->deliver = deliver;
+    fanout->hint = hint;
+    return ZEOK;
+}
+
+void zfanout_fini(zfanout_t *fanout){
+    zfanout_stream_t *stream;
+    int i;
+
+    while((stream = fanout->streams)){
+        fanout->streams = stream->next;
+        free(stream);
+    }
+    for(i = 0; i < ZFANOUT_LOCKS; ++i){
+        if(fanout->locks[i]){
+            st_mutex_destroy(fanout->locks[i]);
+            fanout->locks[i] = NULL;
+        }
+    }
+}
+
+zerr_t zfanout_bcast(zfanout_t *fanout, const char *data, int len, uint64_t *bid){
+    zfanout_stream_t stream;
+    zfanout_range_t range;
+    zfanout_hdr_t hdr;
+    uint64_t fails = fanout->send_fails;
+    int off = 0;
+
+    if(len < 0 || (len && !data)){
+        return ZEPARAM_INVALID;
+    }
+    memset(&range, 0, sizeof(range));
+    range.open = 1;
+    memset(&stream, 0, sizeof(stream));
+    zfanout_split(fanout, &range, fanout->self_key, &stream);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.bid = fanout->self_key ^ (++fanout->seq * 0x9e3779b97f4a7c15ULL);
+    hdr.origin = fanout->self_key;
+    hdr.total = (uint64_t)len;
+    do{
+        hdr.offset = (uint64_t)off;
+        hdr.len = len - off < fanout->chunk ? len - off : fanout->chunk;
+        zfanout_forward(fanout, &stream, &hdr, data + off);
+        off += hdr.len;
+    }while(off < len);
+    ++fanout->bcasts;
+    if(bid){
+        *bid = hdr.bid;
+    }
+    return fails == fanout->send_fails ? ZEOK : ZEFAIL;
+}
+
+zerr_t zfanout_input(zfanout_t *fanout, const char *frame, int len){
+    zfanout_stream_t **pos;
+    zfanout_stream_t *stream = NULL;
+    zfanout_hdr_t hdr;
+    const char *data = frame + ZFANOUT_HDR_SIZE;
+
+    if(len < ZFANOUT_HDR_SIZE || zfanout_frame_len(frame) != len){
+        return ZEPARAM_INVALID;
+    }
+    zfanout_decode(frame, &hdr);
+    if(hdr.offset + hdr.len > hdr.total){
+        return ZEPARAM_INVALID;
+    }
+    ++fanout->chunks_in;
+    if(hdr.hops > fanout->max_hops){
+        fanout->max_hops = hdr.hops;
+    }
+
+    for(pos = &fanout->streams; *pos && (*pos)->bid != hdr.bid; pos = &(*pos)->next);
+    if(!(stream = *pos) && 0 == hdr.offset){
+        /* first chunk, pick the children of the range handed to us */
+        if((stream = (zfanout_stream_t*)calloc(1, sizeof(zfanout_stream_t)))){
+            stream->bid = hdr.bid;
+            stream->total = hdr.total;
+            stream->hops = hdr.hops;
+            zfanout_split(fanout, &hdr.range, hdr.origin, stream);
+            stream->next = fanout->streams;
+            fanout->streams = stream;
+        }
+    }
+    if(stream){
+        zfanout_forward(fanout, stream, &hdr, data);
+    }
+    if(fanout->deliver){
+        fanout->deliver(fanout, hdr.bid, data, hdr.len, hdr.offset, hdr.total, fanout->hint);
+    }
+    if(stream && hdr.offset + hdr.len >= hdr.total){
+        /* the list may have changed while sending blocked */
+        for(pos = &fanout->streams; *pos != stream; pos = &(*pos)->next);
+        *pos = stream->next;
+        free(stream);
+    }
+    return ZEOK;
+}
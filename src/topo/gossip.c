@@ -0,0 +1,725 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file gossip.c
+ * @brief SWIM membership and failure detection over UDP
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ *
+ * @par Datagram (network byte order)
+ *      type:1 seq:4 inc:4 idlen:1 id
+ *      [PING_REQ: idlen:1 id ip:4 port:2]
+ *      count:1 { state:1 inc:4 ip:4 port:2 idlen:1 id } * count
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/topo/gossip.h>
+#include <znt/topo/route.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ZGOSSIP_PING 1
+#define ZGOSSIP_ACK 2
+#define ZGOSSIP_PING_REQ 3
+#define ZGOSSIP_JOIN 4
+#define ZGOSSIP_SYNC 5
+
+#define ZGOSSIP_UPDATE_MAX (1 + 4 + 4 + 2 + 1 + ZGOSSIP_ID_MAX)
+#define ZGOSSIP_RELAYS 16
+
+typedef struct zgossip_buf_s{
+    char data[ZGOSSIP_MTU];
+    int len;
+    int off; /** read position */
+}zgossip_buf_t;
+
+/******************************************************************************
+ * encoding
+ */
+static void zgossip_put(zgossip_buf_t *buf, const void *src, int len){
+    memcpy(buf->data + buf->len, src, len);
+    buf->len += len;
+}
+
+static void zgossip_put8(zgossip_buf_t *buf, uint8_t v){
+    buf->data[buf->len++] = (char)v;
+}
+
+static void zgossip_put32(zgossip_buf_t *buf, uint32_t v){
+    v = htonl(v);
+    zgossip_put(buf, &v, 4);
+}
+
+static zerr_t zgossip_get(zgossip_buf_t *buf, void *dst, int len){
+    if(buf->off + len > buf->len){
+        return ZEFAIL;
+    }
+    memcpy(dst, buf->data + buf->off, len);
+    buf->off += len;
+    return ZEOK;
+}
+
+static zerr_t zgossip_get8(zgossip_buf_t *buf, uint8_t *v){
+    return zgossip_get(buf, v, 1);
+}
+
+static zerr_t zgossip_get32(zgossip_buf_t *buf, uint32_t *v){
+    if(ZEOK != zgossip_get(buf, v, 4)){
+        return ZEFAIL;
+    }
+    *v = ntohl(*v);
+    return ZEOK;
+}
+
+static zerr_t zgossip_get_id(zgossip_buf_t *buf, char *id, uint8_t *len){
+    if(ZEOK != zgossip_get8(buf, len) || 0 == *len || *len > ZGOSSIP_ID_MAX){
+        return ZEFAIL;
+    }
+    return zgossip_get(buf, id, *len);
+}
+
+static void zgossip_put_member(zgossip_buf_t *buf, const zgossip_member_t *m,
+                               int state, uint32_t inc){
+    zgossip_put8(buf, (uint8_t)state);
+    zgossip_put32(buf, inc);
+    zgossip_put(buf, &m->addr.sin_addr.s_addr, 4);
+    zgossip_put(buf, &m->addr.sin_port, 2);
+    zgossip_put8(buf, (uint8_t)m->nid.len);
+    zgossip_put(buf, m->nid.id, m->nid.len);
+}
+
+static void zgossip_put_header(zgossip_t *g, zgossip_buf_t *buf, int type, uint32_t seq){
+    buf->len = 0;
+    zgossip_put8(buf, (uint8_t)type);
+    zgossip_put32(buf, seq);
+    zgossip_put32(buf, g->self.inc);
+    zgossip_put8(buf, (uint8_t)g->self.nid.len);
+    zgossip_put(buf, g->self.nid.id, g->self.nid.len);
+}
+
+/******************************************************************************
+ * members
+ */
+static int zgossip_log2n(zgossip_t *g){
+    int n = g->nalive + 1;
+    int lg = 1;
+    while(n >>= 1){
+        ++lg;
+    }
+    return lg;
+}
+
+zgossip_member_t *zgossip_find(zgossip_t *g, const char *id, int len){
+    zgossip_member_t *m = g->buckets[zroute_hash(id, len) & (ZGOSSIP_BUCKETS - 1)];
+    for(; m; m = m->next){
+        if(m->nid.len == len && 0 == memcmp(m->nid.id, id, len)){
+            return m;
+        }
+    }
+    return NULL;
+}
+
+static zgossip_member_t *zgossip_add(zgossip_t *g, const char *id, int len){
+    zgossip_member_t *m;
+    zgossip_member_t **bucket;
+
+    if(g->nmembers == g->cap){
+        int cap = g->cap ? g->cap * 2 : 64;
+        zgossip_member_t **members = (zgossip_member_t**)realloc(g->members,
+                                                                cap * sizeof(zgossip_member_t*));
+        if(!members){
+            return NULL;
+        }
+        g->members = members;
+        g->cap = cap;
+    }
+    if(!(m = (zgossip_member_t*)calloc(1, sizeof(zgossip_member_t)))){
+        return NULL;
+    }
+    memcpy(m->idbuf, id, len);
+    m->nid.id = m->idbuf;
+    m->nid.len = len;
+    m->state = ZMEMBER_DEAD;
+    m->gossip = g;
+    ztimer_node_init(&m->suspect);
+    bucket = &g->buckets[zroute_hash(id, len) & (ZGOSSIP_BUCKETS - 1)];
+    m->next = *bucket;
+    *bucket = m;
+    /* insert at a random position of the probe round */
+    g->members[g->nmembers] = m;
+    if(g->nmembers){
+        int pos = rand_r(&g->rand_seed) % (g->nmembers + 1);
+        g->members[g->nmembers] = g->members[pos];
+        g->members[pos] = m;
+    }
+    ++g->nmembers;
+    return m;
+}
+
+static void zgossip_queue(zgossip_t *g, zgossip_member_t *m, int state, uint32_t inc){
+    int i;
+
+    for(i = 0; i < g->nupdates; ++i){
+        if(g->updates[i].member == m){
+            break;
+        }
+    }
+    if(i == g->nupdates){
+        if(g->nupdates == g->ucap){
+            int cap = g->ucap ? g->ucap * 2 : 64;
+            zgossip_update_t *updates = (zgossip_update_t*)realloc(g->updates,
+                                                                  cap * sizeof(zgossip_update_t));
+            if(!updates){
+                zerrno(ZEMEM_INSUFFICIENT);
+                return;
+            }
+            g->updates = updates;
+            g->ucap = cap;
+        }
+        ++g->nupdates;
+    }
+    /* a newer fact about the member replaces the older one */
+    g->updates[i].member = m;
+    g->updates[i].state = state;
+    g->updates[i].inc = inc;
+    g->updates[i].sent = 0;
+}
+
+static void zgossip_on_reap_timeout(ztimer_node_t *node, zptr_t hint);
+
+static void zgossip_set_state(zgossip_t *g, zgossip_member_t *m, int state){
+    int old = m->state;
+
+    if(old == state){
+        return;
+    }
+    if(ZMEMBER_DEAD == old){
+        ++g->nalive;
+    }else if(ZMEMBER_DEAD == state){
+        --g->nalive;
+    }
+    m->state = state;
+    if(ZMEMBER_SUSPECT != state){
+        ztimer_del(g->timer, &m->suspect);
+    }
+    if(ZMEMBER_DEAD == state){
+        /* at least two periods, the prober may still hold it as its target */
+        int periods = g->cfg.reap_mult * zgossip_log2n(g);
+        ztimer_add(g->timer, &m->suspect,
+                   (st_utime_t)(periods > 2 ? periods : 2) * g->cfg.period_ms * 1000,
+                   zgossip_on_reap_timeout, m);
+    }
+    if(g->on_change){
+        g->on_change(g, m, old, g->hint);
+    }
+}
+
+static void zgossip_on_suspect_timeout(ztimer_node_t *node, zptr_t hint){
+    zgossip_member_t *m = (zgossip_member_t*)hint;
+    zgossip_t *g = m->gossip;
+
+    if(ZMEMBER_SUSPECT == m->state){
+        zgossip_set_state(g, m, ZMEMBER_DEAD);
+        zgossip_queue(g, m, ZMEMBER_DEAD, m->inc);
+    }
+}
+
+/** @brief forget a member that stayed DEAD through the linger */
+static void zgossip_on_reap_timeout(ztimer_node_t *node, zptr_t hint){
+    zgossip_member_t *m = (zgossip_member_t*)hint;
+    zgossip_t *g = m->gossip;
+    zgossip_member_t **pm;
+    int i, k;
+
+    if(ZMEMBER_DEAD != m->state){
+        return;
+    }
+    for(pm = &g->buckets[zroute_hash(m->nid.id, m->nid.len) & (ZGOSSIP_BUCKETS - 1)];
+        *pm && *pm != m; pm = &(*pm)->next){
+    }
+    if(*pm){
+        *pm = m->next;
+    }
+    /* keep the probe round order */
+    for(i = 0; i < g->nmembers && g->members[i] != m; ++i){
+    }
+    if(i < g->nmembers){
+        memmove(g->members + i, g->members + i + 1,
+                (g->nmembers - i - 1) * sizeof(zgossip_member_t*));
+        --g->nmembers;
+        if(i < g->probe_idx){
+            --g->probe_idx;
+        }
+    }
+    for(i = k = 0; i < g->nupdates; ++i){
+        if(g->updates[i].member != m){
+            g->updates[k++] = g->updates[i];
+        }
+    }
+    g->nupdates = k;
+    free(m);
+}
+
+static void zgossip_suspect(zgossip_t *g, zgossip_member_t *m){
+    zgossip_set_state(g, m, ZMEMBER_SUSPECT);
+    if(!ztimer_pending(&m->suspect)){
+        ztimer_add(g->timer, &m->suspect,
+                   (st_utime_t)g->cfg.suspect_mult * zgossip_log2n(g) * g->cfg.period_ms * 1000,
+                   zgossip_on_suspect_timeout, m);
+    }
+    zgossip_queue(g, m, ZMEMBER_SUSPECT, m->inc);
+}
+
+static void zgossip_apply(zgossip_t *g, int state, uint32_t inc, const char *id, int len,
+                          const zsockaddr_in *addr){
+    zgossip_member_t *m;
+
+    if(len == g->self.nid.len && 0 == memcmp(id, g->self.nid.id, len)){
+        if(ZMEMBER_ALIVE != state && inc >= g->self.inc){
+            /* refute */
+            g->self.inc = inc + 1;
+            zgossip_queue(g, &g->self, ZMEMBER_ALIVE, g->self.inc);
+        }
+        return;
+    }
+    if(!(m = zgossip_find(g, id, len))){
+        if(ZMEMBER_DEAD == state || !(m = zgossip_add(g, id, len))){
+            return;
+        }
+        m->addr = *addr;
+        m->inc = inc;
+        zgossip_set_state(g, m, ZMEMBER_ALIVE);
+        if(ZMEMBER_SUSPECT == state){
+            zgossip_suspect(g, m);
+        }else{
+            zgossip_queue(g, m, ZMEMBER_ALIVE, inc);
+        }
+        return;
+    }
+    switch(state){
+    case ZMEMBER_ALIVE:
+        if(inc > m->inc){
+            m->inc = inc;
+            m->addr = *addr;
+            zgossip_set_state(g, m, ZMEMBER_ALIVE);
+            zgossip_queue(g, m, ZMEMBER_ALIVE, inc);
+        }
+        break;
+    case ZMEMBER_SUSPECT:
+        if((ZMEMBER_ALIVE == m->state && inc >= m->inc) ||
+           (ZMEMBER_SUSPECT == m->state && inc > m->inc)){
+            m->inc = inc;
+            zgossip_suspect(g, m);
+        }
+        break;
+    case ZMEMBER_DEAD:
+        if(ZMEMBER_DEAD != m->state && inc >= m->inc){
+            m->inc = inc;
+            zgossip_set_state(g, m, ZMEMBER_DEAD);
+            zgossip_queue(g, m, ZMEMBER_DEAD, inc);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************************************
+ * messages
+ */
+static int zgossip_update_cmp(const void *a, const void *b){
+    return ((const zgossip_update_t*)a)->sent - ((const zgossip_update_t*)b)->sent;
+}
+
+static void zgossip_piggyback(zgossip_t *g, zgossip_buf_t *buf){
+    int count_off = buf->len;
+    int limit = g->cfg.retransmit_mult * zgossip_log2n(g);
+    int cnt = 0;
+    int i, k;
+
+    zgossip_put8(buf, 0);
+    if(!g->nupdates){
+        return;
+    }
+    /* least sent first */
+    qsort(g->updates, g->nupdates, sizeof(zgossip_update_t), zgossip_update_cmp);
+    for(i = 0; i < g->nupdates && cnt < 255 &&
+            buf->len + ZGOSSIP_UPDATE_MAX <= ZGOSSIP_MTU; ++i){
+        zgossip_put_member(buf, g->updates[i].member, g->updates[i].state, g->updates[i].inc);
+        ++g->updates[i].sent;
+        ++cnt;
+    }
+    buf->data[count_off] = (char)cnt;
+    for(i = k = 0; i < g->nupdates; ++i){
+        if(g->updates[i].sent < limit){
+            g->updates[k++] = g->updates[i];
+        }
+    }
+    g->nupdates = k;
+}
+
+static void zgossip_sendto(zgossip_t *g, zgossip_buf_t *buf, const zsockaddr_in *addr){
+    if(st_sendto(g->stfd, buf->data, buf->len, (const ZSA*)addr, sizeof(zsockaddr_in),
+                 ST_UTIME_NO_TIMEOUT) > 0){
+        ++g->tx_msgs;
+        g->tx_bytes += buf->len;
+    }
+}
+
+static void zgossip_send(zgossip_t *g, int type, uint32_t seq, const zsockaddr_in *addr,
+                         const zgossip_member_t *target){
+    zgossip_buf_t buf;
+
+    zgossip_put_header(g, &buf, type, seq);
+    if(target){
+        zgossip_put8(&buf, (uint8_t)target->nid.len);
+        zgossip_put(&buf, target->nid.id, target->nid.len);
+        zgossip_put(&buf, &target->addr.sin_addr.s_addr, 4);
+        zgossip_put(&buf, &target->addr.sin_port, 2);
+    }
+    zgossip_piggyback(g, &buf);
+    zgossip_sendto(g, &buf, addr);
+}
+
+static void zgossip_send_sync(zgossip_t *g, const zsockaddr_in *addr){
+    zgossip_buf_t buf;
+    int count_off;
+    int cnt = 0;
+    int i;
+
+    for(i = 0; i <= g->nmembers; ++i){
+        zgossip_member_t *m = i < g->nmembers ? g->members[i] : NULL;
+        if(m && ZMEMBER_DEAD == m->state){
+            continue;
+        }
+        if(!cnt){
+            zgossip_put_header(g, &buf, ZGOSSIP_SYNC, 0);
+            count_off = buf.len;
+            zgossip_put8(&buf, 0);
+        }
+        if(m){
+            zgossip_put_member(&buf, m, m->state, m->inc);
+            ++cnt;
+        }
+        if(cnt && (!m || 255 == cnt || buf.len + ZGOSSIP_UPDATE_MAX > ZGOSSIP_MTU)){
+            buf.data[count_off] = (char)cnt;
+            zgossip_sendto(g, &buf, addr);
+            cnt = 0;
+        }
+    }
+}
+
+static void zgossip_handle(zgossip_t *g, zgossip_buf_t *buf, const zsockaddr_in *from){
+    char id[ZGOSSIP_ID_MAX];
+    char tid[ZGOSSIP_ID_MAX];
+    uint8_t type, idlen, tidlen, cnt, state;
+    uint32_t seq, inc;
+    zgossip_member_t target;
+    zsockaddr_in addr;
+    int i;
+
+    buf->off = 0;
+    if(ZEOK != zgossip_get8(buf, &type) || ZEOK != zgossip_get32(buf, &seq) ||
+       ZEOK != zgossip_get32(buf, &inc) || ZEOK != zgossip_get_id(buf, id, &idlen)){
+        return;
+    }
+    if(ZGOSSIP_PING_REQ == type){
+        memset(&target, 0, sizeof(target));
+        target.addr.sin_family = AF_INET;
+        if(ZEOK != zgossip_get_id(buf, tid, &tidlen) ||
+           ZEOK != zgossip_get(buf, &target.addr.sin_addr.s_addr, 4) ||
+           ZEOK != zgossip_get(buf, &target.addr.sin_port, 2)){
+            return;
+        }
+    }
+    /* the sender is alive at its incarnation */
+    zgossip_apply(g, ZMEMBER_ALIVE, inc, id, idlen, from);
+
+    /* piggybacked updates */
+    if(ZEOK == zgossip_get8(buf, &cnt)){
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        for(i = 0; i < cnt; ++i){
+            if(ZEOK != zgossip_get8(buf, &state) || ZEOK != zgossip_get32(buf, &inc) ||
+               ZEOK != zgossip_get(buf, &addr.sin_addr.s_addr, 4) ||
+               ZEOK != zgossip_get(buf, &addr.sin_port, 2) ||
+               ZEOK != zgossip_get_id(buf, tid, &tidlen)){
+                break;
+            }
+            zgossip_apply(g, state, inc, tid, tidlen, &addr);
+        }
+    }
+
+    switch(type){
+    case ZGOSSIP_JOIN:
+        zgossip_send_sync(g, from);
+        /* fall through */
+    case ZGOSSIP_PING:
+        zgossip_send(g, ZGOSSIP_ACK, seq, from, NULL);
+        break;
+    case ZGOSSIP_ACK:
+        if(!seq){
+            /* JOIN ack, probes and relays skip 0, which marks a free slot */
+            break;
+        }
+        if(seq == g->probe_seq){
+            g->acked = 1;
+            st_cond_signal(g->ack_cond);
+            break;
+        }
+        for(i = 0; i < ZGOSSIP_RELAYS; ++i){
+            if(g->relay[i].seq == seq){
+                g->relay[i].seq = 0;
+                zgossip_send(g, ZGOSSIP_ACK, g->relay[i].orig_seq, &g->relay[i].requester, NULL);
+                break;
+            }
+        }
+        break;
+    case ZGOSSIP_PING_REQ:
+        i = g->relay_idx++ % ZGOSSIP_RELAYS;
+        if(0 == ++g->seq){
+            ++g->seq;
+        }
+        g->relay[i].seq = g->seq;
+        g->relay[i].orig_seq = seq;
+        g->relay[i].requester = *from;
+        zgossip_send(g, ZGOSSIP_PING, g->seq, &target.addr, NULL);
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************************************
+ * st_threads
+ */
+static zptr_t zgossip_receiver(zptr_t arg){
+    zgossip_t *g = (zgossip_t*)arg;
+    zgossip_buf_t buf;
+    zsockaddr_in from;
+    int fromlen;
+    int n;
+
+    while(!g->stop){
+        fromlen = sizeof(from);
+        n = st_recvfrom(g->stfd, buf.data, ZGOSSIP_MTU, (ZSA*)&from, &fromlen,
+                        ST_UTIME_NO_TIMEOUT);
+        if(n <= 0){
+            continue;
+        }
+        ++g->rx_msgs;
+        g->rx_bytes += n;
+        buf.len = n;
+        zgossip_handle(g, &buf, &from);
+    }
+    return NULL;
+}
+
+static zgossip_member_t *zgossip_next_target(zgossip_t *g){
+    zgossip_member_t *m;
+    int tries;
+
+    for(tries = 0; tries < g->nmembers; ++tries){
+        if(g->probe_idx >= g->nmembers){
+            /* new round, reshuffle */
+            int i;
+            for(i = g->nmembers - 1; i > 0; --i){
+                int j = rand_r(&g->rand_seed) % (i + 1);
+                m = g->members[i];
+                g->members[i] = g->members[j];
+                g->members[j] = m;
+            }
+            g->probe_idx = 0;
+        }
+        m = g->members[g->probe_idx++];
+        if(ZMEMBER_DEAD != m->state){
+            return m;
+        }
+    }
+    return NULL;
+}
+
+static void zgossip_wait_ack(zgossip_t *g, st_utime_t deadline){
+    st_utime_t now;
+    while(!g->acked && !g->stop && (now = st_utime()) < deadline){
+        st_cond_timedwait(g->ack_cond, deadline - now);
+    }
+}
+
+static zptr_t zgossip_prober(zptr_t arg){
+    zgossip_t *g = (zgossip_t*)arg;
+    zgossip_member_t *target;
+    st_utime_t start;
+    st_utime_t period = (st_utime_t)g->cfg.period_ms * 1000;
+    int i, sent;
+
+    while(!g->stop){
+        start = st_utime();
+        if((target = zgossip_next_target(g))){
+            if(0 == ++g->seq){
+                ++g->seq;
+            }
+            g->probe_seq = g->seq;
+            g->acked = 0;
+            zgossip_send(g, ZGOSSIP_PING, g->probe_seq, &target->addr, NULL);
+            zgossip_wait_ack(g, start + (st_utime_t)g->cfg.ping_timeout_ms * 1000);
+            if(!g->acked && !g->stop){
+                /* indirect probe through random members */
+                for(i = sent = 0; i < 4 * g->cfg.indirect && sent < g->cfg.indirect &&
+                        g->nmembers > 1; ++i){
+                    zgossip_member_t *m = g->members[rand_r(&g->rand_seed) % g->nmembers];
+                    if(m != target && ZMEMBER_ALIVE == m->state){
+                        zgossip_send(g, ZGOSSIP_PING_REQ, g->probe_seq, &m->addr, target);
+                        ++sent;
+                    }
+                }
+                zgossip_wait_ack(g, start + period);
+            }
+            g->probe_seq = 0;
+            if(!g->acked && !g->stop && ZMEMBER_ALIVE == target->state){
+                zgossip_suspect(g, target);
+            }
+        }
+        if(!g->stop && st_utime() < start + period){
+            st_usleep(start + period - st_utime());
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * instance
+ */
+void zgossip_cfg_default(zgossip_cfg_t *cfg){
+    cfg->period_ms = 1000;
+    cfg->ping_timeout_ms = 200;
+    cfg->indirect = 3;
+    cfg->suspect_mult = 4;
+    cfg->retransmit_mult = 4;
+    cfg->reap_mult = 16;
+}
+
+zgossip_t *zgossip_create(const znt_nid_t *nid, const char *host, uint16_t port,
+                          const zgossip_cfg_t *cfg, ztimer_t *timer,
+                          zgossip_change_t on_change, zptr_t hint){
+    zgossip_t *g = NULL;
+
+    if(!nid || nid->len <= 0 || nid->len > ZGOSSIP_ID_MAX){
+        zerrno(ZEPARAM_INVALID);
+        return NULL;
+    }
+    if(!(g = (zgossip_t*)calloc(1, sizeof(zgossip_t)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return NULL;
+    }
+    if(cfg){
+        g->cfg = *cfg;
+    }else{
+        zgossip_cfg_default(&g->cfg);
+    }
+    g->timer = timer;
+    g->on_change = on_change;
+    g->hint = hint;
+    memcpy(g->self.idbuf, nid->id, nid->len);
+    g->self.nid.id = g->self.idbuf;
+    g->self.nid.len = nid->len;
+    g->self.gossip = g;
+    ztimer_node_init(&g->self.suspect);
+    g->rand_seed = (unsigned int)(zroute_hash(nid->id, nid->len) ^ st_utime());
+    g->sock = ZINVALID_SOCKET;
+
+    do{
+        if(ZEOK != zinet_addr(&g->self.addr, host, port)){
+            break;
+        }
+        if(ZINVALID_SOCKET == (g->sock = zsocket(AF_INET, SOCK_DGRAM, 0)) ||
+           ZEOK != zbind(g->sock, (ZSA*)&g->self.addr, sizeof(g->self.addr)) ||
+           !(g->stfd = zst_socket(g->sock)) ||
+           !(g->ack_cond = st_cond_new())){
+            break;
+        }
+        if(!(g->receiver = zst_thread_create(zgossip_receiver, g, ztrue, 0)) ||
+           !(g->prober = zst_thread_create(zgossip_prober, g, ztrue, 0))){
+            break;
+        }
+        return g;
+    }while(0);
+
+    zgossip_destroy(g);
+    return NULL;
+}
+
+void zgossip_destroy(zgossip_t *g){
+    zgossip_member_t *m;
+    int i;
+
+    if(!g){
+        return;
+    }
+    g->stop = 1;
+    if(g->receiver){
+        st_thread_interrupt(g->receiver);
+        zst_thread_join(g->receiver);
+    }
+    if(g->prober){
+        st_thread_interrupt(g->prober);
+        zst_thread_join(g->prober);
+    }
+    for(i = 0; i < g->nmembers; ++i){
+        m = g->members[i];
+        ztimer_del(g->timer, &m->suspect);
+        free(m);
+    }
+    if(g->ack_cond){
+        st_cond_destroy(g->ack_cond);
+    }
+    if(g->stfd){
+        st_netfd_close(g->stfd);
+    }else if(ZINVALID_SOCKET != g->sock){
+        zsockclose(g->sock);
+    }
+    zdbg("gossip<%.*s> tx<msgs:%llu bytes:%llu> rx<msgs:%llu bytes:%llu>",
+         g->self.nid.len, g->self.nid.id,
+         (unsigned long long)g->tx_msgs, (unsigned long long)g->tx_bytes,
+         (unsigned long long)g->rx_msgs, (unsigned long long)g->rx_bytes);
+    free(g->members);
+    free(g->updates);
+    free(g);
+}
+
+zerr_t zgossip_join(zgossip_t *g, const char *host, uint16_t port){
+    zsockaddr_in seed;
+    zerr_t ret;
+
+    if(ZEOK != (ret = zinet_addr(&seed, host, port))){
+        return ret;
+    }
+    /* announce self, the seed answers with its member list */
+    zgossip_queue(g, &g->self, ZMEMBER_ALIVE, g->self.inc);
+    zgossip_send(g, ZGOSSIP_JOIN, 0, &seed, NULL);
+    return ZEOK;
+}
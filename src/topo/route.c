@@ -0,0 +1,353 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file route.c
+ * @brief Node topology routing table with consistent-hash placement
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <znt/topo/route.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ZROUTE_BITS 16
+#define ZROUTE_BITS_GROW 22 /** membership never grows the table past this */
+#define ZROUTE_BITS_MAX ZROUTE_BITS_GROW /** 2^22 slots, 32MB of pointers */
+
+static uint64_t zroute_mix(uint64_t h){
+    /* murmur3 fmix64 */
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t zroute_hash(const char *key, int len){
+    /* FNV-1a, finalized for avalanche */
+    uint64_t h = 0xcbf29ce484222325ULL;
+    int i;
+    for(i = 0; i < len; ++i){
+        h ^= (unsigned char)key[i];
+        h *= 0x100000001b3ULL;
+    }
+    return zroute_mix(h);
+}
+
+static int zroute_vnode_cmp(const void *a, const void *b){
+    const zroute_vnode_t *va = (const zroute_vnode_t*)a;
+    const zroute_vnode_t *vb = (const zroute_vnode_t*)b;
+    if(va->hash != vb->hash){
+        return va->hash < vb->hash ? -1 : 1;
+    }
+    /* same point, order by node so every process agrees */
+    if(va->node->key != vb->node->key){
+        return va->node->key < vb->node->key ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * keep at least two slots per ring point, otherwise nearly every slot holds
+ * a point and lookups fall back to the ring search
+ */
+static void zroute_grow(zroute_t *route){
+    znt_node_t **table;
+    int bits = route->bits;
+
+    while(bits < ZROUTE_BITS_GROW && ((uint64_t)1 << bits) < (uint64_t)route->nring * 2){
+        ++bits;
+    }
+    if(bits == route->bits){
+        return;
+    }
+    if(!(table = (znt_node_t**)calloc((size_t)1 << bits, sizeof(znt_node_t*)))){
+        /* the small table still routes exactly, only slower */
+        return;
+    }
+    /* empty slots search the ring until the refresh fills them */
+    free(route->table);
+    route->table = table;
+    route->bits = bits;
+}
+
+static void zroute_refresh_restart(zroute_t *route){
+    zroute_grow(route);
+    route->refresh_pos = 0;
+    route->refresh_vnode = 0;
+    route->refreshing = 1;
+    ++route->version;
+}
+
+zerr_t zroute_init(zroute_t *route, int bits){
+    memset(route, 0, sizeof(zroute_t));
+    if(bits <= 0){
+        bits = ZROUTE_BITS;
+    }
+    if(bits > ZROUTE_BITS_MAX){
+        bits = ZROUTE_BITS_MAX;
+    }
+    route->bits = bits;
+    if(!(route->table = (znt_node_t**)calloc((size_t)1 << bits, sizeof(znt_node_t*)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return ZEMEM_INSUFFICIENT;
+    }
+    return ZEOK;
+}
+
+static void zroute_node_free(znt_node_t *node){
+    free(node->nid.id);
+    free(node);
+}
+
+static void zroute_release_leaving(zroute_t *route){
+    znt_node_t *node;
+    while((node = route->leaving)){
+        route->leaving = node->next_leaving;
+        zroute_node_free(node);
+    }
+}
+
+void zroute_fini(zroute_t *route){
+    int i;
+    for(i = 0; i < route->nnodes; ++i){
+        zroute_node_free(route->nodes[i]);
+    }
+    zroute_release_leaving(route);
+    free(route->nodes);
+    free(route->ring);
+    free(route->table);
+    memset(route, 0, sizeof(zroute_t));
+}
+
+znt_node_t *zroute_find(zroute_t *route, const znt_nid_t *nid){
+    int i;
+    for(i = 0; i < route->nnodes; ++i){
+        znt_node_t *node = route->nodes[i];
+        if(node->nid.len == nid->len && 0 == memcmp(node->nid.id, nid->id, nid->len)){
+            return node;
+        }
+    }
+    return NULL;
+}
+
+int zroute_join_many(zroute_t *route, const znt_nid_t *nids, int cnt, int weight,
+                     znt_node_t **joined){
+    znt_node_t *node = NULL;
+    zroute_vnode_t *vnodes = NULL;
+    zroute_vnode_t *ring = NULL;
+    int nv, n = 0;
+    int i, j, k;
+
+    if(weight <= 0){
+        weight = 1;
+    }
+    if(cnt <= 0){
+        return 0;
+    }
+    if(route->nnodes + cnt > route->cap){
+        int cap = route->cap ? route->cap : 16;
+        znt_node_t **nodes;
+        while(cap < route->nnodes + cnt){
+            cap *= 2;
+        }
+        if(!(nodes = (znt_node_t**)realloc(route->nodes, cap * sizeof(znt_node_t*)))){
+            zerrno(ZEMEM_INSUFFICIENT);
+            return 0;
+        }
+        route->nodes = nodes;
+        route->cap = cap;
+    }
+    nv = weight * ZROUTE_VNODES;
+    if(!(vnodes = (zroute_vnode_t*)malloc((size_t)cnt * nv * sizeof(zroute_vnode_t)))){
+        zerrno(ZEMEM_INSUFFICIENT);
+        return 0;
+    }
+    for(; n < cnt; ++n){
+        if(zroute_find(route, &nids[n])){
+            zerrno(ZEPARAM_INVALID);
+            break;
+        }
+        if(!(node = (znt_node_t*)calloc(1, sizeof(znt_node_t))) ||
+           !(node->nid.id = (char*)malloc(nids[n].len))){
+            free(node);
+            zerrno(ZEMEM_INSUFFICIENT);
+            break;
+        }
+        memcpy(node->nid.id, nids[n].id, nids[n].len);
+        node->nid.len = nids[n].len;
+        node->nid.state = nids[n].state;
+        node->key = zroute_hash(nids[n].id, nids[n].len);
+        node->weight = weight;
+        node->state = ZNODE_UP;
+        for(i = 0; i < nv; ++i){
+            vnodes[n * nv + i].hash = zroute_mix(node->key + (uint64_t)(i + 1) * 0x9e3779b97f4a7c15ULL);
+            vnodes[n * nv + i].node = node;
+        }
+        /* visible to zroute_find() for the rest of the batch */
+        route->nodes[route->nnodes++] = node;
+        if(joined){
+            joined[n] = node;
+        }
+    }
+    nv *= n;
+    if(!n || !(ring = (zroute_vnode_t*)malloc((route->nring + nv) * sizeof(zroute_vnode_t)))){
+        for(i = 0; i < n; ++i){
+            zroute_node_free(route->nodes[--route->nnodes]);
+            if(joined){
+                /* the caller must not see freed nodes */
+                joined[i] = NULL;
+            }
+        }
+        free(vnodes);
+        if(n){
+            zerrno(ZEMEM_INSUFFICIENT);
+        }
+        return 0;
+    }
+    qsort(vnodes, nv, sizeof(zroute_vnode_t), zroute_vnode_cmp);
+    /* one merge into the ring for the whole batch */
+    for(i = j = k = 0; i < route->nring || j < nv; ++k){
+        if(j == nv || (i < route->nring && zroute_vnode_cmp(&route->ring[i], &vnodes[j]) <= 0)){
+            ring[k] = route->ring[i++];
+        }else{
+            ring[k] = vnodes[j++];
+        }
+    }
+    free(vnodes);
+    free(route->ring);
+    route->ring = ring;
+    route->nring += nv;
+    zroute_refresh_restart(route);
+    return n;
+}
+
+znt_node_t *zroute_join(zroute_t *route, const znt_nid_t *nid, int weight){
+    znt_node_t *node = NULL;
+
+    return 1 == zroute_join_many(route, nid, 1, weight, &node) ? node : NULL;
+}
+
+zerr_t zroute_leave(zroute_t *route, znt_node_t *node){
+    int i, k;
+
+    for(i = 0; i < route->nnodes && route->nodes[i] != node; ++i);
+    if(i == route->nnodes){
+        return ZEPARAM_INVALID;
+    }
+    route->nodes[i] = route->nodes[--route->nnodes];
+    for(i = k = 0; i < route->nring; ++i){
+        if(route->ring[i].node != node){
+            route->ring[k++] = route->ring[i];
+        }
+    }
+    route->nring = k;
+    node->state = ZNODE_LEAVING;
+    node->next_leaving = route->leaving;
+    route->leaving = node;
+    zroute_refresh_restart(route);
+    return ZEOK;
+}
+
+znt_node_t *zroute_owner(zroute_t *route, uint64_t hash){
+    int lo = 0;
+    int hi = route->nring;
+    int mid;
+
+    if(!route->nring){
+        return NULL;
+    }
+    /* first vnode with vnode.hash >= hash */
+    while(lo < hi){
+        mid = lo + (hi - lo) / 2;
+        if(route->ring[mid].hash < hash){
+            lo = mid + 1;
+        }else{
+            hi = mid;
+        }
+    }
+    return route->ring[lo == route->nring ? 0 : lo].node;
+}
+
+uint32_t zroute_rebalance(zroute_t *route, uint32_t budget){
+    uint32_t slots = (uint32_t)1 << route->bits;
+    int shift = 64 - route->bits;
+    uint64_t start, last;
+    znt_node_t *owner;
+
+    if(!route->refreshing){
+        return 0;
+    }
+    while(budget-- && route->refresh_pos < slots){
+        start = (uint64_t)route->refresh_pos << shift;
+        while(route->refresh_vnode < route->nring &&
+              route->ring[route->refresh_vnode].hash < start){
+            ++route->refresh_vnode;
+        }
+        last = start + (((uint64_t)1 << shift) - 1);
+        owner = NULL;
+        if(route->refresh_vnode == route->nring){
+            owner = route->nring ? route->ring[0].node : NULL;
+        }else if(route->ring[route->refresh_vnode].hash >= last){
+            owner = route->ring[route->refresh_vnode].node;
+        }
+        /* else a ring point splits the slot, its keys search the ring */
+        if(route->table[route->refresh_pos] != owner){
+            route->table[route->refresh_pos] = owner;
+            ++route->moved;
+        }
+        ++route->refresh_pos;
+    }
+    if(route->refresh_pos < slots){
+        return slots - route->refresh_pos;
+    }
+    route->refreshing = 0;
+    zroute_release_leaving(route);
+    return 0;
+}
+
+zerr_t zroute_attach(znt_node_t *node, ztrans_t *conn){
+    if(ZROUTE_CONNS == node->nconns){
+        return ZEAGAIN;
+    }
+    node->conns[node->nconns++] = conn;
+    return ZEOK;
+}
+
+void zroute_detach(znt_node_t *node, ztrans_t *conn){
+    int i;
+    for(i = 0; i < node->nconns; ++i){
+        if(node->conns[i] == conn){
+            node->conns[i] = node->conns[--node->nconns];
+            node->conns[node->nconns] = NULL;
+            break;
+        }
+    }
+}
@@ -0,0 +1,171 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZAPP_PUBSUB_H_
+#define _ZAPP_PUBSUB_H_
+
+/**
+ * @file pubsub.h
+ * @brief Topic publish/subscribe over shared immutable message buffers
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Zero copy fan-out
+ *      A published frame is copied once into a reference counted zps_msg_t,
+ *      every subscribed connection queues the pointer and its writer
+ *      st_thread writev()s straight from the shared buffer, so N subscribers
+ *      cost N pointers, not N copies. The last writer releases the buffer.
+ * @par Slow subscribers
+ *      Each connection bounds its queue by messages and bytes, on overflow:
+ *      - ZPS_DROP       drop the oldest queued message
+ *      - ZPS_DISCONNECT close the connection, on_close reports it
+ *      - ZPS_CONFLATE   a message replaces the queued one with the same
+ *                       non-zero key (always, not only on overflow), else
+ *                       the oldest is dropped; a laggard gets the latest
+ *                       value per key instead of the whole history
+ * @par Frames
+ *      Payloads are written as published, framing is up to the application.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <stdlib.h>
+#include <znt/com/socket.h>
+#include <znt/com/state_threads.h>
+
+ZC_BEGIN
+
+#define ZPS_DROP 0
+#define ZPS_DISCONNECT 1
+#define ZPS_CONFLATE 2
+
+#define ZPS_BUCKETS 256 /** topic hash buckets, power of two */
+#define ZPS_BATCH 64 /** messages per writev() */
+
+typedef struct zps_msg_s{
+    int ref; /** atomic */
+    int len;
+    uint64_t key; /** conflation key, 0 none */
+    char data[];
+}zps_msg_t;
+
+typedef struct zps_s zps_t;
+typedef struct zps_topic_s zps_topic_t;
+typedef struct zps_conn_s zps_conn_t;
+
+/**
+ * connection closed by policy or write error, runs in the publisher or writer
+ * st_thread; destroy the connection later, not inside the callback
+ */
+typedef void (*zps_close_t)(zps_conn_t *conn, zerr_t reason, zptr_t hint);
+
+struct zps_topic_s{
+    char *name;
+    int nlen;
+    zps_conn_t **conns; /** subscribers */
+    int nconns;
+    int cap;
+    struct zps_topic_s *next; /** hash chain */
+};
+
+struct zps_conn_s{
+    zps_t *ps;
+    st_netfd_t stfd;
+    int policy; /** ZPS_DROP/DISCONNECT/CONFLATE */
+    zps_msg_t **queue; /** ring of pending messages */
+    uint32_t mask;
+    uint32_t head;
+    uint32_t tail;
+    int max_msgs;
+    int max_bytes;
+    int bytes; /** pending bytes */
+    zps_topic_t **topics; /** subscriptions */
+    int ntopics;
+    int tcap;
+    st_cond_t cond;
+    st_thread_t writer;
+    int waiting; /** writer waits on cond */
+    int closed;
+    int stop;
+    zps_close_t on_close;
+    zptr_t hint;
+    /* statistic */
+    uint64_t queued;
+    uint64_t sent;
+    uint64_t dropped;
+    uint64_t conflated;
+    uint64_t writes; /** writev() calls */
+    int max_depth;
+};
+
+struct zps_s{
+    zps_topic_t *buckets[ZPS_BUCKETS];
+    int ntopics;
+    /* statistic */
+    uint64_t published;
+    uint64_t deliveries; /** queued pointers, a copy each without sharing */
+};
+
+/** @brief one copy of <data> with a reference owned by the caller */
+ZAPI zps_msg_t *zps_msg_create(const char *data, int len, uint64_t key);
+
+zinline zps_msg_t *zps_msg_ref(zps_msg_t *msg){
+    __atomic_add_fetch(&msg->ref, 1, __ATOMIC_RELAXED);
+    return msg;
+}
+
+zinline void zps_msg_unref(zps_msg_t *msg){
+    if(0 == __atomic_sub_fetch(&msg->ref, 1, __ATOMIC_ACQ_REL)){
+        free(msg);
+    }
+}
+
+ZAPI zps_t *zps_create(void);
+/** @brief release the topics, connections are destroyed by their owners first */
+ZAPI void zps_destroy(zps_t *ps);
+
+/**
+ * @brief wrap a connected socket and start its writer st_thread
+ * @param max_msgs [in] queued message bound, 1024 when <= 0
+ * @param max_bytes [in] queued byte bound, 16MB when <= 0
+ */
+ZAPI zps_conn_t *zps_conn_create(zps_t *ps, zsock_t sock, int policy, int max_msgs,
+                                 int max_bytes, zps_close_t on_close, zptr_t hint);
+/** @brief unsubscribe all, release queued messages and close the socket */
+ZAPI void zps_conn_destroy(zps_conn_t *conn);
+ZAPI zerr_t zps_subscribe(zps_conn_t *conn, const char *topic, int len);
+ZAPI zerr_t zps_unsubscribe(zps_conn_t *conn, const char *topic, int len);
+
+/**
+ * @brief queue <msg> on every subscriber of <topic>
+ * @note the caller keeps its reference
+ * @return subscribers that queued the message
+ */
+ZAPI int zps_publish_msg(zps_t *ps, const char *topic, int len, zps_msg_t *msg);
+/** @brief zps_msg_create() + zps_publish_msg(), one copy whatever the subscribers */
+ZAPI int zps_publish(zps_t *ps, const char *topic, int len, const char *data, int dlen,
+                     uint64_t key);
+
+ZC_END
+
+#endif /*_ZAPP_PUBSUB_H_*/
@@ -0,0 +1,154 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZAPP_RPC_H_
+#define _ZAPP_RPC_H_
+
+/**
+ * @file rpc.h
+ * @brief Pipelined request/response RPC over one connection
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Frame (little-endian)
+ *      +--------+--------+----------+--------+--------+----------+---------+
+ *      | len:4  | id:4   | method:2 | type:1 | rsv:1  | status:4 | payload |
+ *      +--------+--------+----------+--------+--------+----------+---------+
+ * @par Pipelining
+ *      Any number of calls may be in flight, each gets a connection unique id
+ *      and replies are matched by id in whatever order they arrive. Requests
+ *      are queued on the connection cork, so calls issued in one tick share
+ *      one writev(); the reader decodes every complete frame of one read.
+ * @par Deadlines
+ *      Each call arms a ztimer_node_t, expiry completes the call with
+ *      ZETIMEOUT and a late reply is dropped.
+ * @par Server
+ *      Requests are dispatched to service->handlers[method] in the reader
+ *      st_thread. A handler may zrpc_reply() at once, or hand the id to
+ *      another st_thread (or zwsp_call()) and reply later, out of order.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/socket.h>
+#include <znt/com/state_threads.h>
+#include <znt/com/timer.h>
+#include <znt/com/cork.h>
+
+ZC_BEGIN
+
+#define ZRPC_HDR_SIZE 16
+#define ZRPC_METHOD_MAX 256
+#define ZRPC_FRAME_MAX (16 * 1024 * 1024)
+#define ZRPC_BUCKETS 256 /** pending call hash buckets, power of two */
+
+#define ZRPC_REQ 1
+#define ZRPC_REP 2
+
+typedef struct zrpc_hdr_s{
+    uint32_t len; /** payload length */
+    uint32_t id; /** request id */
+    uint16_t method;
+    uint8_t type; /** ZRPC_REQ/ZRPC_REP */
+    uint8_t rsv;
+    int32_t status; /** reply status, zerr_t */
+}zrpc_hdr_t;
+
+typedef struct zrpc_conn_s zrpc_conn_t;
+typedef struct zrpc_call_s zrpc_call_t;
+
+/** completion callback, runs in the reader or timer st_thread */
+typedef void (*zrpc_done_t)(zrpc_call_t *call, zptr_t hint);
+/** server handler, <req> is only valid during the call */
+typedef zerr_t (*zrpc_handler_t)(zrpc_conn_t *conn, const zrpc_hdr_t *hdr,
+                                 const char *req, zptr_t hint);
+
+struct zrpc_call_s{
+    uint32_t id;
+    uint16_t method;
+    zerr_t ret; /** ZEOK, remote status, ZETIMEOUT or ZEFAIL */
+    char *rep; /** reply payload, malloc(), owned by the caller */
+    int rep_len;
+    zrpc_done_t done;
+    zptr_t hint;
+    ztimer_node_t deadline;
+    zrpc_call_t *next; /** hash chain */
+};
+
+typedef struct zrpc_service_s{
+    zrpc_handler_t handlers[ZRPC_METHOD_MAX];
+    zptr_t hint; /** passed to handlers */
+}zrpc_service_t;
+
+struct zrpc_conn_s{
+    zsock_t sock;
+    st_netfd_t stfd;
+    zcork_t cork; /** batched encode */
+    ztimer_t *timer; /** deadline facility */
+    zrpc_service_t *service; /** NULL for a client only connection */
+    st_thread_t reader;
+    char *rbuf; /** receive buffer */
+    int rbuf_size;
+    int rbuf_len;
+    uint32_t next_id;
+    zrpc_call_t *pending[ZRPC_BUCKETS];
+    int inflight;
+    int closed;
+    /* statistic */
+    uint64_t calls;
+    uint64_t replies;
+    uint64_t timeouts;
+    uint64_t reads; /** read syscalls */
+    uint64_t frames; /** frames decoded */
+    int max_inflight;
+};
+
+/**
+ * @brief wrap a connected socket, start the reader st_thread
+ * @param tick [in] end-of-tick flusher for the cork, NULL flush per call
+ */
+ZAPI zrpc_conn_t *zrpc_conn_create(zsock_t sock, zrpc_service_t *service,
+                                   ztimer_t *timer, zcork_tick_t *tick);
+/** @brief fail pending calls with ZEFAIL, stop the reader, close the socket */
+ZAPI void zrpc_conn_destroy(zrpc_conn_t *conn);
+
+/**
+ * @brief issue a call, <done> runs once on reply, timeout or close
+ * @param timeout_us [in] deadline, ST_UTIME_NO_TIMEOUT none
+ */
+ZAPI zerr_t zrpc_call_async(zrpc_conn_t *conn, zrpc_call_t *call, uint16_t method,
+                            const char *req, int len, st_utime_t timeout_us,
+                            zrpc_done_t done, zptr_t hint);
+/**
+ * @brief issue a call and block the calling st_thread until it completes
+ * @param rep [out] reply payload, free() by the caller
+ */
+ZAPI zerr_t zrpc_call(zrpc_conn_t *conn, uint16_t method, const char *req, int len,
+                      char **rep, int *rep_len, st_utime_t timeout_us);
+/** @brief answer request <id>, may be called from any st_thread of the scheduler */
+ZAPI zerr_t zrpc_reply(zrpc_conn_t *conn, uint32_t id, uint16_t method, zerr_t status,
+                       const char *rep, int len);
+
+ZC_END
+
+#endif /*_ZAPP_RPC_H_*/
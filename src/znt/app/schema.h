@@ -0,0 +1,335 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZAPP_SCHEMA_H_
+#define _ZAPP_SCHEMA_H_
+
+/**
+ * @file schema.h
+ * @brief Zero-copy binary messages with schema generated accessors
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Message (little-endian)
+ *      +--------+---------+----------+----------------------+---------------+
+ *      | size:4 | type:2  | fixed:2  | fields, fixed offset | bytes payload |
+ *      +--------+---------+----------+----------------------+---------------+
+ *      Scalars sit at offsets aligned to their size; a bytes field is an
+ *      (off:4, len:4) slot pointing into the payload behind the fields.
+ * @par Schema
+ *      A schema is an X-macro list, ZSCHEMA_DEFINE() generates the layout
+ *      and one getter/setter per field:
+ *      @code
+ *      #define ORDER_FIELDS(X, n) \
+ *          X(n, u64, id)          \
+ *          X(n, u32, qty)         \
+ *          X(n, f64, price)       \
+ *          X(n, bytes, symbol)
+ *      ZSCHEMA_DEFINE(order, 1, ORDER_FIELDS)
+ *
+ *      order_build(&b, buf, cap);          // writer
+ *      order_set_id(&b, 7);
+ *      order_set_symbol(&b, "ZNT", 3);
+ *      len = zschema_end(&b);
+ *
+ *      if((msg = order_view(frame, len))){ // reader, no decode pass
+ *          id = order_id(msg);
+ *          sym = order_symbol(msg, &sym_len);
+ *      }
+ *      @endcode
+ *      Types: u8 u16 u32 u64 i32 i64 f64 bytes.
+ * @par Evolution
+ *      Append fields only. A getter past the sender's <fixed> returns 0
+ *      (NULL for bytes), so old and new peers interoperate.
+ * @par Buffers
+ *      zschema_pool_t recycles fixed size send buffers, one pool per loop.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <stddef.h>
+#include <string.h>
+#include <endian.h>
+
+ZC_BEGIN
+
+#define ZSCHEMA_HDR_SIZE 8
+#define ZSCHEMA_MAX (16 * 1024 * 1024)
+
+/* wire slots, aligned to their size whatever the ABI */
+typedef struct zschema_ref_s{
+    uint32_t off;
+    uint32_t len;
+}zschema_ref_t;
+
+typedef uint8_t zschema_u8_t;
+typedef uint16_t zschema_u16_t __attribute__((aligned(2)));
+typedef uint32_t zschema_u32_t __attribute__((aligned(4)));
+typedef uint64_t zschema_u64_t __attribute__((aligned(8)));
+typedef int32_t zschema_i32_t __attribute__((aligned(4)));
+typedef int64_t zschema_i64_t __attribute__((aligned(8)));
+typedef double zschema_f64_t __attribute__((aligned(8)));
+typedef zschema_ref_t zschema_bytes_t __attribute__((aligned(4)));
+
+#define ZSCHEMA_CTYPE_u8 uint8_t
+#define ZSCHEMA_CTYPE_u16 uint16_t
+#define ZSCHEMA_CTYPE_u32 uint32_t
+#define ZSCHEMA_CTYPE_u64 uint64_t
+#define ZSCHEMA_CTYPE_i32 int32_t
+#define ZSCHEMA_CTYPE_i64 int64_t
+#define ZSCHEMA_CTYPE_f64 double
+
+typedef struct zschema_builder_s{
+    char *buf;
+    uint32_t cap;
+    uint32_t size; /** fields + payload written */
+    zerr_t err; /** first error, reported by zschema_end() */
+}zschema_builder_t;
+
+/*
+ * little-endian loads and stores, one unaligned mov on x86/arm64
+ */
+zinline uint8_t zschema_ld_u8(const char *p){
+    return *(const uint8_t*)p;
+}
+zinline uint16_t zschema_ld_u16(const char *p){
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return le16toh(v);
+}
+zinline uint32_t zschema_ld_u32(const char *p){
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return le32toh(v);
+}
+zinline uint64_t zschema_ld_u64(const char *p){
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return le64toh(v);
+}
+zinline int32_t zschema_ld_i32(const char *p){
+    return (int32_t)zschema_ld_u32(p);
+}
+zinline int64_t zschema_ld_i64(const char *p){
+    return (int64_t)zschema_ld_u64(p);
+}
+zinline double zschema_ld_f64(const char *p){
+    uint64_t u = zschema_ld_u64(p);
+    double v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+zinline void zschema_st_u8(char *p, uint8_t v){
+    *(uint8_t*)p = v;
+}
+zinline void zschema_st_u16(char *p, uint16_t v){
+    v = htole16(v);
+    memcpy(p, &v, sizeof(v));
+}
+zinline void zschema_st_u32(char *p, uint32_t v){
+    v = htole32(v);
+    memcpy(p, &v, sizeof(v));
+}
+zinline void zschema_st_u64(char *p, uint64_t v){
+    v = htole64(v);
+    memcpy(p, &v, sizeof(v));
+}
+zinline void zschema_st_i32(char *p, int32_t v){
+    zschema_st_u32(p, (uint32_t)v);
+}
+zinline void zschema_st_i64(char *p, int64_t v){
+    zschema_st_u64(p, (uint64_t)v);
+}
+zinline void zschema_st_f64(char *p, double v){
+    uint64_t u;
+    memcpy(&u, &v, sizeof(u));
+    zschema_st_u64(p, u);
+}
+
+/** @brief size of the fixed section the sender wrote */
+zinline uint32_t zschema_fixed(const char *msg){
+    return zschema_ld_u16(msg + 6);
+}
+zinline uint32_t zschema_size(const char *msg){
+    return zschema_ld_u32(msg);
+}
+zinline uint16_t zschema_type(const char *msg){
+    return zschema_ld_u16(msg + 4);
+}
+
+/**
+ * @brief validate a received message in place
+ * @return <buf> when it holds one well formed message of <type>, else NULL
+ */
+zinline const char *zschema_view(const char *buf, int len, uint16_t type){
+    uint32_t size, fixed;
+
+    if(!buf || len < ZSCHEMA_HDR_SIZE){
+        return NULL;
+    }
+    size = zschema_size(buf);
+    fixed = zschema_fixed(buf);
+    if(size > (uint32_t)len || fixed < ZSCHEMA_HDR_SIZE || fixed > size ||
+       type != zschema_type(buf)){
+        return NULL;
+    }
+    return buf;
+}
+
+/** @brief bytes slot at <off>, NULL when absent or out of bounds */
+zinline const char *zschema_ld_bytes(const char *msg, uint32_t off, uint32_t *len){
+    uint32_t size = zschema_size(msg);
+    uint32_t fixed = zschema_fixed(msg);
+    uint32_t at, n;
+
+    *len = 0;
+    if(off + sizeof(zschema_ref_t) > fixed){
+        /* sent by an older schema */
+        return NULL;
+    }
+    at = zschema_ld_u32(msg + off);
+    n = zschema_ld_u32(msg + off + 4);
+    if(at < fixed || at > size || n > size - at){
+        return NULL;
+    }
+    *len = n;
+    return msg + at;
+}
+
+/** @brief start a message of <type> with a <fixed> byte field section in <buf> */
+zinline zerr_t zschema_begin(zschema_builder_t *b, char *buf, int cap, uint16_t type, uint32_t fixed){
+    b->buf = buf;
+    b->cap = cap > 0 ? (uint32_t)cap : 0;
+    b->size = fixed;
+    b->err = ZEOK;
+    if(fixed > 0xffff || fixed > b->cap){
+        b->err = ZEMEM_INSUFFICIENT;
+        return b->err;
+    }
+    memset(buf, 0, fixed);
+    zschema_st_u16(buf + 4, type);
+    zschema_st_u16(buf + 6, (uint16_t)fixed);
+    return ZEOK;
+}
+
+/** @brief append <data> to the payload and point the slot at <off> to it */
+zinline zerr_t zschema_st_bytes(zschema_builder_t *b, uint32_t off, const char *data, uint32_t len){
+    if(ZEOK != b->err){
+        return b->err;
+    }
+    if(len > b->cap - b->size || b->size + len > ZSCHEMA_MAX){
+        b->err = ZEMEM_INSUFFICIENT;
+        return b->err;
+    }
+    memcpy(b->buf + b->size, data, len);
+    zschema_st_u32(b->buf + off, b->size);
+    zschema_st_u32(b->buf + off + 4, len);
+    b->size += len;
+    return ZEOK;
+}
+
+/** @return message length, or the first error of the build */
+zinline int zschema_end(zschema_builder_t *b){
+    if(ZEOK != b->err){
+        return b->err;
+    }
+    zschema_st_u32(b->buf, b->size);
+    return (int)b->size;
+}
+
+/*
+ * generators
+ */
+#define ZSCHEMA_SLOT(name, type, field) zschema_##type##_t field;
+
+#define ZSCHEMA_SCALAR(name, type, field)                                      \
+    zinline ZSCHEMA_CTYPE_##type name##_##field(const char *msg){              \
+        return offsetof(name##_layout_t, field) + sizeof(zschema_##type##_t)   \
+            <= zschema_fixed(msg) ?                                            \
+            zschema_ld_##type(msg + offsetof(name##_layout_t, field)) : 0;     \
+    }                                                                          \
+    zinline void name##_set_##field(zschema_builder_t *b, ZSCHEMA_CTYPE_##type v){ \
+        if(ZEOK == b->err){                                                    \
+            zschema_st_##type(b->buf + offsetof(name##_layout_t, field), v);   \
+        }                                                                      \
+    }
+
+#define ZSCHEMA_ACCESSOR_u8 ZSCHEMA_SCALAR
+#define ZSCHEMA_ACCESSOR_u16 ZSCHEMA_SCALAR
+#define ZSCHEMA_ACCESSOR_u32 ZSCHEMA_SCALAR
+#define ZSCHEMA_ACCESSOR_u64 ZSCHEMA_SCALAR
+#define ZSCHEMA_ACCESSOR_i32 ZSCHEMA_SCALAR
+#define ZSCHEMA_ACCESSOR_i64 ZSCHEMA_SCALAR
+#define ZSCHEMA_ACCESSOR_f64 ZSCHEMA_SCALAR
+#define ZSCHEMA_ACCESSOR_bytes(name, type, field)                              \
+    zinline const char *name##_##field(const char *msg, uint32_t *len){        \
+        return zschema_ld_bytes(msg, offsetof(name##_layout_t, field), len);   \
+    }                                                                          \
+    zinline zerr_t name##_set_##field(zschema_builder_t *b, const char *data, uint32_t len){ \
+        return zschema_st_bytes(b, offsetof(name##_layout_t, field), data, len); \
+    }
+#define ZSCHEMA_ACCESSOR(name, type, field) ZSCHEMA_ACCESSOR_##type(name, type, field)
+
+/**
+ * @brief generate <name>_layout_t, <name>_view(), <name>_build() and the
+ *        field accessors <name>_<field>() / <name>_set_<field>()
+ * @param id [in] message type written to the header
+ * @param FIELDS [in] X-macro FIELDS(X, name) listing X(name, type, field)
+ */
+#define ZSCHEMA_DEFINE(name, id, FIELDS)                                       \
+    typedef struct name##_layout_s{                                            \
+        uint8_t zschema_hdr[ZSCHEMA_HDR_SIZE];                                 \
+        FIELDS(ZSCHEMA_SLOT, name)                                             \
+    }name##_layout_t;                                                          \
+    enum{name##_type = (id)};                                                  \
+    zinline const char *name##_view(const char *buf, int len){                 \
+        return zschema_view(buf, len, (id));                                   \
+    }                                                                          \
+    zinline zerr_t name##_build(zschema_builder_t *b, char *buf, int cap){     \
+        return zschema_begin(b, buf, cap, (id), sizeof(name##_layout_t));      \
+    }                                                                          \
+    FIELDS(ZSCHEMA_ACCESSOR, name)
+
+/*
+ * send buffer pool, single threaded
+ */
+typedef struct zschema_pool_s{
+    char *free; /** idle buffers, linked through their first bytes */
+    uint32_t bufsize;
+    uint32_t idle;
+    uint32_t max_idle;
+    /* statistic */
+    uint64_t allocs; /** buffers taken from malloc() */
+    uint64_t reuses;
+}zschema_pool_t;
+
+/** @param max_idle [in] idle buffers kept, the rest are freed */
+ZAPI void zschema_pool_init(zschema_pool_t *pool, uint32_t bufsize, uint32_t max_idle);
+ZAPI void zschema_pool_fini(zschema_pool_t *pool);
+/** @return buffer of pool->bufsize bytes, 8 byte aligned */
+ZAPI char *zschema_pool_get(zschema_pool_t *pool);
+ZAPI void zschema_pool_put(zschema_pool_t *pool, char *buf);
+
+ZC_END
+
+#endif /*_ZAPP_SCHEMA_H_*/
@@ -0,0 +1,131 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_ADMIT_H_
+#define _ZCOM_ADMIT_H_
+
+/**
+ * @file admit.h
+ * @brief Admission control and load shedding on the accept path
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Signals
+ *      - loop lag: a probe st_thread sleeps <probe_ms> and measures how late
+ *        it wakes, which is how long runnable st_threads hold the scheduler
+ *      - queue depth: reported by the application through a callback
+ *      - descriptors: an accepted fd number against st_getfdlimit()
+ *      The pressure is the largest of lag/max_lag_us, depth/max_depth and
+ *      fds/(fd_pct% of the limit).
+ * @par Levels
+ *      - ZADMIT_OPEN  pressure < 1: accept everyone
+ *      - ZADMIT_SHED  pressure >= 1: accept known peers (classify() says
+ *                     ZADMIT_PEER), answer anonymous clients with the
+ *                     <reject> bytes and close at once
+ *      - ZADMIT_PAUSE pressure >= pause_ratio: stop accepting for
+ *                     <pause_ms>, the kernel backlog absorbs the storm
+ *      A level is left when the pressure falls below 80% of its threshold,
+ *      so the controller does not flap around a threshold. Running out of
+ *      descriptors (EMFILE/ENFILE) pauses at once.
+ * @par Accept
+ *      Each listener wakeup drains the backlog with zaccept_batch(), which
+ *      sets non-blocking and close-on-exec in accept4() and applies the
+ *      <opts> template, the pressure is updated once per batch.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/socket.h>
+#include <znt/com/state_threads.h>
+
+ZC_BEGIN
+
+#define ZADMIT_OPEN 0
+#define ZADMIT_SHED 1
+#define ZADMIT_PAUSE 2
+
+#define ZADMIT_CLIENT 0
+#define ZADMIT_PEER 1
+
+/** @return ZADMIT_PEER for known nodes, ZADMIT_CLIENT otherwise */
+typedef int (*zadmit_classify_t)(const zsockaddr_in *addr, zptr_t hint);
+/** @return current queue depth of the application */
+typedef int (*zadmit_depth_t)(zptr_t hint);
+/** @brief take an admitted connection, runs in the accept st_thread */
+typedef void (*zadmit_accept_t)(zsock_t sock, const zsockaddr_in *addr, int cls, zptr_t hint);
+
+typedef struct zadmit_cfg_s{
+    int backlog; /** zlisten() backlog */
+    int max_lag_us; /** loop lag at pressure 1 */
+    int max_depth; /** queue depth at pressure 1, 0 ignore */
+    int fd_pct; /** percent of st_getfdlimit() at pressure 1 */
+    double pause_ratio; /** pressure that pauses accepts */
+    int pause_ms;
+    int probe_ms; /** lag probe period */
+    const char *reject; /** answer to shed clients, NULL close only */
+    int reject_len;
+    int batch; /** connections accepted per zaccept_batch() */
+    const zsockopt_t *opts; /** applied to accepted connections, may be NULL */
+}zadmit_cfg_t;
+
+typedef struct zadmit_s{
+    zadmit_cfg_t cfg;
+    st_netfd_t listener;
+    zadmit_classify_t classify;
+    zadmit_depth_t depth;
+    zadmit_accept_t on_accept;
+    zptr_t hint;
+    st_thread_t acceptor;
+    st_thread_t prober;
+    int fd_limit;
+    int last_fd; /** highest recent accepted fd */
+    int level; /** ZADMIT_* */
+    double pressure;
+    int lag_us; /** smoothed loop lag */
+    int stop;
+    /* statistic */
+    uint64_t admitted;
+    uint64_t admitted_peers;
+    uint64_t rejected;
+    uint64_t pauses;
+    uint64_t wakeups; /** listener readiness events */
+    uint64_t accepted; /** accepted before admission, accepted/wakeups per event */
+}zadmit_t;
+
+ZAPI void zadmit_cfg_default(zadmit_cfg_t *cfg);
+/**
+ * @brief listen on <sock> and start the accept and probe st_threads
+ * @param sock [in] bound socket
+ * @param classify [in] NULL treats everyone as a client
+ * @param depth [in] NULL ignores queue depth
+ */
+ZAPI zadmit_t *zadmit_create(zsock_t sock, const zadmit_cfg_t *cfg, zadmit_classify_t classify,
+                             zadmit_depth_t depth, zadmit_accept_t on_accept, zptr_t hint);
+/** @brief stop accepting and close the listener */
+ZAPI void zadmit_destroy(zadmit_t *admit);
+/** @brief re-evaluate the pressure now, returns the level */
+ZAPI int zadmit_update(zadmit_t *admit);
+
+ZC_END
+
+#endif /*_ZCOM_ADMIT_H_*/
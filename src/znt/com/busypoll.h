@@ -0,0 +1,111 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_BUSYPOLL_H_
+#define _ZCOM_BUSYPOLL_H_
+
+/**
+ * @file busypoll.h
+ * @brief Busy-polling event loop for latency-critical links on a dedicated core
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Mode
+ *      zbpoll_run() owns the calling OS thread, optionally pinned to <cpu>,
+ *      and spins over its sources: non-blocking zrecv() on sockets, with
+ *      SO_BUSY_POLL/SO_PREFER_BUSY_POLL so the kernel polls the NIC queue in
+ *      the recv() itself, and poll callbacks for rings and mailboxes. No
+ *      wakeup, no context switch, the data is picked up as it lands.
+ * @par Adaptive fallback
+ *      After <idle_us> without work the loop blocks in poll() on the source
+ *      descriptors and resumes spinning at the first event, so an idle link
+ *      gives the core back. idle_us 0 is the plain blocking loop, which is
+ *      what the busypoll test compares against.
+ * @par Opt-in
+ *      Nothing else changes: ST schedulers keep their blocking waits, only
+ *      the links added to a zbpoll_t are served this way.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/socket.h>
+
+ZC_BEGIN
+
+#define ZBPOLL_SOURCES 64
+#define ZBPOLL_BUF_SIZE (64 * 1024)
+
+typedef struct zbpoll_s zbpoll_t;
+
+/** @brief socket data, len 0 peer closed, len < 0 error; the source is dropped after either */
+typedef void (*zbpoll_read_t)(zbpoll_t *bp, zsock_t sock, const char *buf, int len, zptr_t hint);
+/** @brief poll a ring or mailbox, return the work done, < 0 drops the source */
+typedef int (*zbpoll_fn_t)(zbpoll_t *bp, zptr_t hint);
+
+typedef struct zbpoll_src_s{
+    zsock_t sock; /** socket source, ZINVALID_SOCKET for a poller */
+    int fd; /** readable when there is work, -1 none */
+    zbpoll_read_t on_read;
+    zbpoll_fn_t poll;
+    zptr_t hint;
+}zbpoll_src_t;
+
+struct zbpoll_s{
+    int cpu; /** pinned core, -1 none */
+    uint64_t idle_us; /** spin budget without work */
+    zsockopt_t opts; /** busy poll options for socket sources */
+    zbpoll_src_t src[ZBPOLL_SOURCES];
+    int nsrc;
+    char *buf; /** receive buffer */
+    int buf_size;
+    int wakefd; /** zbpoll_stop() doorbell */
+    int stop;
+    /* statistic */
+    uint64_t loops; /** spin iterations */
+    uint64_t busy; /** iterations that found work */
+    uint64_t sleeps; /** blocking fallbacks */
+};
+
+/**
+ * @param cpu [in] core to pin zbpoll_run() to, -1 leave the affinity
+ * @param busy_poll_us [in] SO_BUSY_POLL budget of socket sources, 0 none
+ * @param idle_us [in] spin without work before blocking, 0 always block
+ */
+ZAPI zerr_t zbpoll_init(zbpoll_t *bp, int cpu, int busy_poll_us, uint64_t idle_us);
+ZAPI void zbpoll_fini(zbpoll_t *bp);
+/** @brief serve a socket, set non-blocking with the busy poll options */
+ZAPI zerr_t zbpoll_add_sock(zbpoll_t *bp, zsock_t sock, zbpoll_read_t on_read, zptr_t hint);
+/**
+ * @brief serve a poller
+ * @param fd [in] readable when <poll> may find work (eventfd doorbell), -1 none:
+ *            the blocking fallback then wakes every millisecond
+ */
+ZAPI zerr_t zbpoll_add(zbpoll_t *bp, zbpoll_fn_t poll, int fd, zptr_t hint);
+/** @brief run the loop in the calling thread until zbpoll_stop() */
+ZAPI zerr_t zbpoll_run(zbpoll_t *bp);
+/** @brief stop the loop, from any thread */
+ZAPI void zbpoll_stop(zbpoll_t *bp);
+
+ZC_END
+
+#endif /*_ZCOM_BUSYPOLL_H_*/
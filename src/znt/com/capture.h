@@ -0,0 +1,162 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_CAPTURE_H_
+#define _ZCOM_CAPTURE_H_
+
+/**
+ * @file capture.h
+ * @brief Traffic capture to a memory-mapped file and timed replay
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Capture
+ *      zcap_start() maps a sparse file of <max_bytes> and hooks the socket
+ *      layer: connections from zaccept()/zaccept_batch() (or zcap_track())
+ *      get a capture id, their zrecv() frames are recorded with payload,
+ *      their zsend() frames by length only (the baseline of response
+ *      times), zsockclose() ends them. Writers reserve space with one
+ *      atomic add, any thread may record. A full file drops records.
+ * @par Record
+ *      kind:1, then LEB128 varints: micro seconds since start, capture id,
+ *      length; payload for ZCAP_IN. A frame of a few hundred bytes costs
+ *      about 6 bytes of framing.
+ * @par Replay
+ *      zcap_replay() opens one connection per captured one to the target
+ *      and sends the ZCAP_IN frames at their offsets divided by <speed>
+ *      (0 as fast as possible). The first bytes back after a frame count
+ *      as its response. zcap_baseline() computes the same figures from
+ *      the capture itself, ZCAP_IN to the next ZCAP_OUT, for comparison.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+
+ZC_BEGIN
+
+/** @brief record kinds, 0 marks the end of the data */
+#define ZCAP_OPEN 1
+#define ZCAP_IN 2
+#define ZCAP_OUT 3
+#define ZCAP_CLOSE 4
+
+typedef struct zcap_s{
+    int fd;
+    char *map;
+    uint64_t size; /** mapped bytes */
+    uint64_t tail; /** next free byte, atomic */
+    uint64_t start_us; /** CLOCK_MONOTONIC of zcap_start() */
+    uint32_t next_id;
+    uint32_t *ids; /** socket -> capture id, 0 not captured */
+    int ids_cap;
+    uint64_t records; /** statistic */
+    uint64_t dropped;
+}zcap_t;
+
+typedef struct zcap_rec_s{
+    int kind;
+    uint64_t ts_us; /** since the start of the capture */
+    uint32_t conn;
+    uint32_t len;
+    const char *data; /** ZCAP_IN payload inside the mapping */
+}zcap_rec_t;
+
+typedef struct zcap_reader_s{
+    int fd;
+    const char *map;
+    uint64_t size;
+    uint64_t off;
+}zcap_reader_t;
+
+typedef struct zcap_stat_s{
+    uint64_t frames; /** ZCAP_IN frames */
+    uint64_t bytes;
+    uint32_t conns;
+    uint64_t duration_us;
+    uint64_t responses;
+    uint64_t lat_avg_us;
+    uint64_t lat_p50_us;
+    uint64_t lat_p99_us;
+    uint64_t max_lag_us; /** replay: worst delay behind schedule */
+}zcap_stat_t;
+
+ZAPI zcap_t *zcap_active; /** the capture the socket hooks feed, NULL off */
+
+/**
+ * @brief create <path>, start capturing the socket layer into it
+ * @param max_bytes [in] file size limit, the file is sparse until written
+ */
+ZAPI zerr_t zcap_start(zcap_t *cap, const char *path, uint64_t max_bytes);
+
+/**
+ * @brief stop, truncate the file to the data and unmap it
+ * @note waits for hooks still recording on other threads
+ */
+ZAPI zerr_t zcap_stop(zcap_t *cap);
+
+/**
+ * @brief capture a connection not accepted through zaccept*()
+ */
+ZAPI void zcap_track(zcap_t *cap, int sock);
+
+/**
+ * @brief socket layer hook, <kind> on socket <sock>
+ * @note ignored unless <cap> is zcap_active, zcap_stop() waits for it
+ */
+ZAPI void zcap_sock(zcap_t *cap, int kind, int sock, const char *buf, int len);
+
+#if defined(ZNT_NO_CAPTURE) || !defined(ZSYS_POSIX)
+#define ZCAP_HOOK(kind, sock, buf, len) do{}while(0)
+#else
+#define ZCAP_HOOK(kind, sock, buf, len) do{                             \
+        zcap_t *zcap_ = __atomic_load_n(&zcap_active, __ATOMIC_ACQUIRE); \
+        if(zcap_){                                                      \
+            zcap_sock(zcap_, kind, sock, buf, len);                     \
+        }                                                               \
+    }while(0)
+#endif
+
+ZAPI zerr_t zcap_reader_open(zcap_reader_t *rd, const char *path);
+ZAPI void zcap_reader_close(zcap_reader_t *rd);
+
+/**
+ * @retval ZEOK <rec> filled
+ * @retval ZEFAIL end of the capture
+ */
+ZAPI zerr_t zcap_next(zcap_reader_t *rd, zcap_rec_t *rec);
+
+/**
+ * @brief load shape and response times as recorded
+ */
+ZAPI zerr_t zcap_baseline(const char *path, zcap_stat_t *stat);
+
+/**
+ * @brief replay the ZCAP_IN frames of <path> against <host>:<port>
+ * @param speed [in] 1.0 real time, 4.0 four times faster, 0 no pacing
+ */
+ZAPI zerr_t zcap_replay(const char *path, const char *host, uint16_t port, double speed,
+                        zcap_stat_t *stat);
+
+ZC_END
+
+#endif /*_ZCOM_CAPTURE_H_*/
@@ -0,0 +1,141 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_COMP_H_
+#define _ZCOM_COMP_H_
+
+/**
+ * @file comp.h
+ * @brief Adaptive per-frame compression for node links
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Frame (little-endian)
+ *      +----------+-----------+---------+
+ *      | codec:1  | raw_len:4 | payload |
+ *      +----------+-----------+---------+
+ *      codec ZCOMP_STORED, ZCOMP_LZ4 or ZCOMP_ZSTD, | ZCOMP_DICT when the
+ *      payload was compressed against the link dictionary.
+ * @par Codecs
+ *      LZ4 block format is always available: liblz4 with -DZNT_HAVE_LZ4,
+ *      else a built-in compressor writing the same format, so peers built
+ *      either way interoperate. zstd needs -DZNT_HAVE_ZSTD (add -lzstd or
+ *      -llz4 to @zmake.link).
+ * @par Negotiation
+ *      Each side sends zcomp_hello() and feeds the peer's to zcomp_accept():
+ *      both pick the best codec they share, and use the dictionary only
+ *      when both loaded the same one (by content hash).
+ * @par Adaptation
+ *      Frames under <threshold> are stored. Every <window> compressed frames
+ *      the ratio and bytes saved per CPU microsecond are checked; when not
+ *      worth it the link stores frames for a back-off that doubles up to
+ *      <backoff_max> frames, then probes again.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+
+ZC_BEGIN
+
+#define ZCOMP_STORED 0
+#define ZCOMP_LZ4 1
+#define ZCOMP_ZSTD 2
+#define ZCOMP_DICT 0x80
+
+#define ZCOMP_HDR_SIZE 5
+#define ZCOMP_HELLO_SIZE 8
+#define ZCOMP_DICT_MAX (64 * 1024) /** LZ4 window */
+
+typedef struct zcomp_cfg_s{
+    int threshold; /** frames shorter are stored */
+    int level; /** zstd level, LZ4 acceleration */
+    double max_ratio; /** compressed/raw above this is not worth it */
+    uint32_t min_gain; /** bytes saved per CPU microsecond worth spending */
+    int window; /** compressed frames per evaluation */
+    int backoff_max; /** stored frames at most before probing again */
+    const char *dict; /** trained dictionary, NULL none */
+    int dict_len;
+}zcomp_cfg_t;
+
+typedef struct zcomp_s{
+    zcomp_cfg_t cfg;
+    uint8_t codecs; /** mask of codecs built in, 1 << codec */
+    uint8_t codec; /** negotiated send codec */
+    uint8_t use_dict; /** both sides hold the dictionary */
+    uint32_t dict_id; /** content hash of cfg.dict, 0 none */
+    uint32_t *dict_table; /** built-in LZ4 dictionary positions */
+    uint32_t *table; /** built-in LZ4 frame positions */
+    zptr_t lz4; /** liblz4 stream */
+    zptr_t zcctx; /** zstd contexts and digested dictionaries */
+    zptr_t zdctx;
+    zptr_t zcdict;
+    zptr_t zddict;
+    /* adaptation */
+    int skip; /** frames left to store before probing */
+    int backoff;
+    int win_frames;
+    uint64_t win_in;
+    uint64_t win_out;
+    uint64_t win_ns;
+    /* statistic */
+    uint64_t frames; /** zcomp_pack() calls */
+    uint64_t packed; /** frames sent compressed */
+    uint64_t bytes_in; /** raw bytes packed */
+    uint64_t bytes_out; /** bytes on the wire, headers included */
+    uint64_t cpu_ns; /** spent compressing, kept or not */
+    uint64_t unpack_ns;
+    uint64_t disables; /** back-offs entered */
+}zcomp_t;
+
+ZAPI void zcomp_cfg_default(zcomp_cfg_t *cfg);
+/** @param cfg [in] copied, the dictionary is referenced and must outlive <comp> */
+ZAPI zerr_t zcomp_init(zcomp_t *comp, const zcomp_cfg_t *cfg);
+ZAPI void zcomp_fini(zcomp_t *comp);
+/** @brief write the offer to send to the peer, ZCOMP_HELLO_SIZE bytes */
+ZAPI int zcomp_hello(zcomp_t *comp, char *buf);
+/** @brief settle codec and dictionary from the peer's offer */
+ZAPI zerr_t zcomp_accept(zcomp_t *comp, const char *hello, int len);
+/** @return wire bytes needed at most for <len> raw bytes */
+zinline int zcomp_bound(int len){
+    return ZCOMP_HDR_SIZE + len + len / 255 + 16;
+}
+/**
+ * @brief encode one frame, compressed when worth it
+ * @param cap [in] >= zcomp_bound(len)
+ * @return wire length, ZEMEM_INSUFFICIENT <cap> too small
+ */
+ZAPI int zcomp_pack(zcomp_t *comp, const char *src, int len, char *dst, int cap);
+/** @return raw length of the frame, ZEFAIL corrupt, ZEMEM_INSUFFICIENT <cap> too small */
+ZAPI int zcomp_unpack(zcomp_t *comp, const char *src, int len, char *dst, int cap);
+/** @brief raw length announced by a frame header, for sizing <dst> */
+ZAPI int zcomp_raw_len(const char *src, int len);
+/**
+ * @brief build a dictionary from sample frames
+ * @return dictionary length; zstd training with ZNT_HAVE_ZSTD, else the
+ *         most recent sample bytes, which is what an LZ4 prefix wants
+ */
+ZAPI int zcomp_dict_train(const char **samples, const int *lens, int cnt, char *dict, int cap);
+
+ZC_END
+
+#endif /*_ZCOM_COMP_H_*/
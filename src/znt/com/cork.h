@@ -0,0 +1,149 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_CORK_H_
+#define _ZCOM_CORK_H_
+
+/**
+ * @file cork.h
+ * @brief Per-connection write coalescing, many small frames per writev()
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Flush points
+ *      - end of tick: the first frame marks the cork dirty on its tick, the
+ *        tick st_thread runs after every runnable st_thread and flushes all
+ *        dirty corks
+ *      - byte budget: queued bytes reach <max_bytes>
+ *      - latency budget: oldest queued frame is older than <max_delay_us>
+ *      - iovec budget: ZCORK_IOV_MAX frames queued
+ * @par Frames
+ *      frames are copied into the cork buffer (adjacent copies share one
+ *      iovec), ZCORK_REF queues the caller buffer by pointer instead, the
+ *      caller keeps it unchanged until the cork is flushed.
+ *      A frame larger than the cork is written through: its st_thread owns
+ *      the socket until the frame is out, meanwhile other writers wait and
+ *      zcork_flush() of a non-empty cork reports ZEAGAIN. A write-through that fails leaves
+ *      part of a frame on the wire, the cork is failed from then on and
+ *      every call returns ZEFAIL; close the connection.
+ * @par Statistic
+ *      frames / syscalls is the number of frames per writev().
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <sys/uio.h>
+#include <znt/com/socket.h>
+#include <znt/com/transport.h>
+#include <znt/com/state_threads.h>
+
+ZC_BEGIN
+
+#define ZCORK_IOV_MAX 64
+#define ZCORK_REF 0x40000000 /** queue frame by reference */
+
+typedef struct zcork_tick_s zcork_tick_t;
+
+typedef struct zcork_s{
+    zsock_t sock;
+    struct iovec iov[ZCORK_IOV_MAX]; /** queued frames */
+    int iovcnt;
+    int iov_copy; /** iov[iovcnt-1] points into buf, may be extended */
+    char *buf; /** copy buffer */
+    int buf_size;
+    int buf_used;
+    int pending; /** queued bytes */
+    int max_bytes; /** byte budget */
+    uint32_t max_delay_us; /** latency budget, 0 disable */
+    uint64_t first_us; /** queue time of the oldest frame */
+    zcork_tick_t *tick; /** end of tick flusher, NULL: budgets and manual flush only */
+    struct zcork_s *next_dirty;
+    int dirty;
+    int through; /** a write-through owns the socket */
+    int failed; /** a write-through broke off mid-frame */
+    st_cond_t through_cond; /** writers waiting for the write-through */
+    /* statistic */
+    uint64_t frames; /** frames queued */
+    uint64_t bytes; /** bytes written */
+    uint64_t syscalls; /** writev() calls */
+    uint64_t budget_flushes; /** flushes forced by a budget */
+    uint64_t tick_flushes; /** flushes at end of tick */
+}zcork_t;
+
+struct zcork_tick_s{
+    zcork_t *dirty; /** corks with queued frames */
+    st_cond_t cond;
+    st_thread_t thr;
+    int stop;
+};
+
+/**
+ * @param buf_size [in] copy buffer size, 64KB when <= 0
+ * @param max_bytes [in] byte budget, buf_size when <= 0
+ * @param max_delay_us [in] latency budget
+ */
+ZAPI zerr_t zcork_init(zcork_t *cork, zsock_t sock, zcork_tick_t *tick,
+                       int buf_size, int max_bytes, uint32_t max_delay_us);
+/** @brief drop queued frames and release the buffer, the socket is not closed */
+ZAPI void zcork_fini(zcork_t *cork);
+/**
+ * @brief queue a frame, flush when a budget is reached
+ * @note a frame larger than the cork is written through, the calling
+ *       st_thread waits for room rather than returning half a frame
+ * @retval ZEOK frame queued or written
+ * @retval ZEAGAIN socket blocked with a full cork, nothing queued
+ * @retval ZEFAIL socket error or failed cork
+ */
+ZAPI zerr_t zcork_write(zcork_t *cork, const char *buf, int len, int flags);
+/**
+ * @brief queue the parts of one frame, all or nothing
+ * @note frames of several st_threads never interleave, a frame larger
+ *       than the cork is written through like zcork_write()
+ * @retval ZEAGAIN socket blocked with too little room, nothing queued
+ */
+ZAPI zerr_t zcork_writev(zcork_t *cork, const struct iovec *iov, int cnt, int flags);
+/**
+ * @brief write queued frames with writev()
+ * @retval ZEOK cork empty
+ * @retval ZEAGAIN socket blocked or written through, the remainder stays queued
+ * @retval ZEFAIL socket error or failed cork
+ */
+ZAPI zerr_t zcork_flush(zcork_t *cork);
+
+/** @brief start the end-of-tick flusher in the calling ST scheduler */
+ZAPI zerr_t zcork_tick_init(zcork_tick_t *tick);
+ZAPI void zcork_tick_fini(zcork_tick_t *tick);
+/** @brief flush every dirty cork of <tick> */
+ZAPI void zcork_tick_flush(zcork_tick_t *tick);
+
+/** corked socket binding, ctx is a zcork_t* */
+ZAPI const ztrans_ops_t zcork_trans_ops;
+
+zinline void zcork_trans(zcork_t *cork, ztrans_t *trans){
+    trans->ops = &zcork_trans_ops;
+    trans->ctx = (zptr_t)cork;
+}
+
+ZC_END
+
+#endif /*_ZCOM_CORK_H_*/
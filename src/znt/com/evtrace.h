@@ -0,0 +1,136 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_EVTRACE_H_
+#define _ZCOM_EVTRACE_H_
+
+/**
+ * @file evtrace.h
+ * @brief Binary connection lifecycle tracer, per thread lock-free rings
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Model
+ *      Every thread writes fixed 32 byte records into its own ring, the
+ *      first ZEVTRACE() of a thread allocates and registers it. Single
+ *      writer, no lock, no syscall but the clock read; when tracing is
+ *      off a ZEVTRACE() is one load and branch. Old records are
+ *      overwritten, the rings keep the last <records> per thread.
+ * @par Points
+ *      socket.c and socket.h trace connect, accept, recv, send, close and
+ *      errors; connect and ST waits trace timeouts. Sessions are bound by
+ *      ZEVTRACE(ZEVT_SESSION, fd, sid, 0, 0), the converter then tags the
+ *      fd events with the sid until close.
+ * @par Dump
+ *      zevtrace_dump() on demand, or zevtrace_dump_on(SIGUSR2, path) from
+ *      a signal (async-signal-safe: open/write/close only). The oldest
+ *      sixteenth of each ring is skipped, it may be torn by a writer
+ *      that keeps running during the dump.
+ * @par Offline
+ *      zevtrace_chrome() turns a dump into Chrome trace JSON
+ *      (chrome://tracing, Perfetto): one async slice per connection from
+ *      connect/accept to close, send/recv/timeout/error as instants.
+ * @par ZNT_NO_EVTRACE
+ *      define to compile every ZEVTRACE() out.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+
+ZC_BEGIN
+
+/** @brief events */
+#define ZEVT_CONNECT 1 /** aux: errno of connect(), EINPROGRESS for nonblock */
+#define ZEVT_ACCEPT 2 /** aux: listener fd */
+#define ZEVT_RECV 3
+#define ZEVT_SEND 4
+#define ZEVT_CLOSE 5
+#define ZEVT_TIMEOUT 6
+#define ZEVT_ERROR 7 /** aux: errno */
+#define ZEVT_SESSION 8 /** binds <sid> to <fd> */
+#define ZEVT_USER 64 /** first application event id */
+
+#define ZEVT_RECORDS 4096 /** default records per thread ring */
+#define ZEVT_RINGS 256 /** maximum tracing threads */
+
+typedef struct zevt_s{
+    uint64_t ts; /** CLOCK_MONOTONIC nano seconds */
+    uint64_t sid; /** session id, 0 unknown */
+    uint32_t bytes;
+    int32_t fd;
+    uint16_t event;
+    uint16_t tid; /** ring index */
+    int32_t aux;
+}zevt_t;
+
+ZAPI int zevtrace_on;
+
+/**
+ * @brief set ring size of threads that start tracing from now on
+ * @param records [in] rounded up to a power of 2
+ */
+ZAPI void zevtrace_init(int records);
+
+ZAPI void zevtrace_enable(int on);
+
+/**
+ * @brief append a record to the calling thread's ring
+ */
+ZAPI void zevtrace_put(int event, int fd, uint64_t sid, uint32_t bytes, int aux);
+
+#if defined(ZNT_NO_EVTRACE) || !defined(ZSYS_POSIX)
+#define ZEVTRACE(event, fd, sid, bytes, aux) do{}while(0)
+#else
+#define ZEVTRACE(event, fd, sid, bytes, aux) do{                 \
+        if(zevtrace_on){                                        \
+            zevtrace_put(event, fd, sid, bytes, aux);           \
+        }                                                       \
+    }while(0)
+#endif
+
+/**
+ * @brief write every ring to <path>
+ * @retval ZEOK
+ * @retval ZEFAIL open/write failed
+ */
+ZAPI zerr_t zevtrace_dump(const char *path);
+
+/**
+ * @brief dump to <path> whenever <signo> is raised
+ */
+ZAPI zerr_t zevtrace_dump_on(int signo, const char *path);
+
+/**
+ * @brief read a dump, sorted by time
+ * @param evts [out] free() by the caller
+ */
+ZAPI zerr_t zevtrace_load(const char *path, zevt_t **evts, int *cnt);
+
+/**
+ * @brief convert dump <in> to Chrome trace JSON <out>
+ */
+ZAPI zerr_t zevtrace_chrome(const char *in, const char *out);
+
+ZC_END
+
+#endif /*_ZCOM_EVTRACE_H_*/
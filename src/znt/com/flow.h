@@ -0,0 +1,116 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_FLOW_H_
+#define _ZCOM_FLOW_H_
+
+/**
+ * @file flow.h
+ * @brief Credit-based flow control for node-to-node message streams
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Credits
+ *      Each side grants its peer <window> bytes at creation. A message
+ *      costs its length plus ZFLOW_HDR_SIZE; a sender without enough credit
+ *      sleeps on an st_cond until the peer returns credit, so the coroutine
+ *      is parked instead of spinning on a full socket. The receiver returns
+ *      credit only when the application consumes messages, in batches of at
+ *      least window / 4 bytes, so queued data never exceeds <window>
+ *      however slow the consumer is. Up to window / 4 bytes may wait in the
+ *      batch, so a message costs at most window - window / 4, which always
+ *      fits once the receive queue drains.
+ * @par Frame (little-endian)
+ *      len:4 type:1 rsv:3 payload, a CREDIT frame carries the grant in len
+ * @par Threads
+ *      One reader st_thread per stream; any st_thread of the scheduler may
+ *      send or receive, writes are serialized by a st_mutex.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/socket.h>
+#include <znt/com/state_threads.h>
+
+ZC_BEGIN
+
+#define ZFLOW_HDR_SIZE 8
+#define ZFLOW_WINDOW (256 * 1024) /** default receive window */
+/** largest message a peer granting <window> accepts */
+#define ZFLOW_MSG_MAX(window) ((window) - (window) / 4 - ZFLOW_HDR_SIZE)
+
+typedef struct zflow_msg_s{
+    struct zflow_msg_s *next;
+    int len;
+    char data[];
+}zflow_msg_t;
+
+typedef struct zflow_s{
+    st_netfd_t stfd;
+    st_mutex_t wlock; /** frame writes */
+    st_thread_t reader;
+    int window; /** granted to the peer */
+    int peer_window; /** first grant of the peer, bounds the message size */
+    int credits; /** bytes we may still send */
+    int consumed; /** bytes consumed, not yet returned */
+    st_cond_t credit_cond; /** senders wait for credit */
+    st_cond_t recv_cond; /** receivers wait for messages */
+    zflow_msg_t *head; /** received messages */
+    zflow_msg_t *tail;
+    int queued; /** bytes in the receive queue, <= window */
+    int closed;
+    /* statistic */
+    uint64_t msgs_out;
+    uint64_t msgs_in;
+    uint64_t grants; /** CREDIT frames sent */
+    uint64_t stalls; /** sends that waited for credit */
+    uint64_t stall_us; /** time spent waiting for credit */
+    int max_queued;
+}zflow_t;
+
+/**
+ * @brief wrap a connected socket, grant <window> bytes to the peer
+ * @param window [in] ZFLOW_WINDOW when <= 0
+ */
+ZAPI zflow_t *zflow_create(zsock_t sock, int window);
+/** @brief stop the reader, wake waiters, close the socket */
+ZAPI void zflow_destroy(zflow_t *flow);
+/**
+ * @brief send one message, sleeping while the peer has not granted credit
+ * @param timeout [in] ST_UTIME_NO_WAIT fails at once, ST_UTIME_NO_TIMEOUT waits
+ * @retval ZEAGAIN no credit and ST_UTIME_NO_WAIT
+ * @retval ZETIMEOUT no credit within <timeout>
+ * @retval ZEPARAM_INVALID message larger than ZFLOW_MSG_MAX(peer window)
+ * @retval ZEFAIL stream closed
+ */
+ZAPI zerr_t zflow_send(zflow_t *flow, const char *data, int len, st_utime_t timeout);
+/**
+ * @brief take the next message, returning its credit to the peer
+ * @return message length, ZEAGAIN/ZETIMEOUT as zflow_send(), ZEFAIL closed,
+ *         ZEMEM_INSUFFICIENT <size> too small (the message stays queued)
+ */
+ZAPI int zflow_recv(zflow_t *flow, char *buf, int size, st_utime_t timeout);
+
+ZC_END
+
+#endif /*_ZCOM_FLOW_H_*/
@@ -0,0 +1,148 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_HOTRESTART_H_
+#define _ZCOM_HOTRESTART_H_
+
+/**
+ * @file hotrestart.h
+ * @brief Hot restart, listener handoff over SCM_RIGHTS and draining
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Old process
+ *      zhot_listen() creates (or reuses) its listeners, zhot_serve() binds
+ *      the handoff Unix socket, the loop watches zhot_fd() and calls
+ *      zhot_poll(). On a handoff it sends every listener with its key;
+ *      when the new process says it is accepting, it closes its copies,
+ *      stops accepting (zhot_draining()) and serves the sessions it has
+ *      until they end or the drain deadline passes (zhot_drained()).
+ * @par New process
+ *      zhot_inherit() fetches the listeners, zhot_listen() hands back the
+ *      inherited one with the same "host:port" key instead of a new
+ *      socket, zhot_ready() tells the old process once accept runs and
+ *      zhot_serve() takes over the handoff path for the next restart.
+ *      Without a running old process zhot_inherit() fails and
+ *      zhot_listen() creates the listeners cold.
+ * @par No accept gap
+ *      Both processes hold the same listening socket, not a copy of the
+ *      address; its accept queue is never closed, connections queued
+ *      during the switch are accepted by the new process.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/socket.h>
+
+ZC_BEGIN
+
+#define ZHOT_MAX 32 /** listeners per process */
+#define ZHOT_KEY 64
+#define ZHOT_PATH 108 /** sun_path */
+
+/** @brief states */
+#define ZHOT_RUNNING 0
+#define ZHOT_DRAINING 1 /** listeners handed over, finishing sessions */
+
+typedef struct zhot_s{
+    char path[ZHOT_PATH];
+    zsock_t server; /** handoff listener, ZINVALID_SOCKET before zhot_serve() */
+    zsock_t peer; /** handoff link with the other process */
+    int cnt;
+    struct{
+        char key[ZHOT_KEY];
+        zsock_t fd;
+        int inherited; /** received from the old process */
+        int used; /** returned by zhot_listen() */
+    }lsn[ZHOT_MAX];
+    int state;
+    int drain_ms;
+    uint64_t deadline; /** drain deadline, CLOCK_MONOTONIC ms */
+    pid_t other; /** pid of the process on the other end */
+}zhot_t;
+
+/**
+ * @param path [in] handoff Unix socket path, shared by old and new binary
+ * @param drain_ms [in] how long an old process serves its sessions
+ */
+ZAPI zerr_t zhot_init(zhot_t *hot, const char *path, int drain_ms);
+
+/**
+ * @brief close the handoff sockets and every listener still held
+ */
+ZAPI void zhot_fini(zhot_t *hot);
+
+/**
+ * @brief new process: receive the listeners of the running one
+ * @retval ZEOK listeners received
+ * @retval ZEFAIL no old process or handoff broken, start cold
+ * @retval ZETIMEOUT old process did not answer, start cold
+ */
+ZAPI zerr_t zhot_inherit(zhot_t *hot, int timeout_ms);
+
+/**
+ * @brief inherited listener of <host>:<port>, else a new one by zconnectx()
+ * @return listener, ZINVALID_SOCKET on error
+ */
+ZAPI zsock_t zhot_listen(zhot_t *hot, const char *host, uint16_t port, int listenq);
+
+/**
+ * @brief new process: accepting now, let the old one drain
+ * @note inherited listeners no zhot_listen() asked for are closed
+ * @retval ZEOK the old process is draining
+ */
+ZAPI zerr_t zhot_ready(zhot_t *hot, int timeout_ms);
+
+/**
+ * @brief bind the handoff path, waiting for the next binary
+ */
+ZAPI zerr_t zhot_serve(zhot_t *hot);
+
+/**
+ * @brief the descriptor to watch for POLLIN, ZINVALID_SOCKET if none
+ */
+zinline zsock_t zhot_fd(zhot_t *hot){
+    return ZINVALID_SOCKET != hot->peer ? hot->peer : hot->server;
+}
+
+/**
+ * @brief old process: run the handoff, never blocks
+ * @retval ZEOK nothing to do or step done; once zhot_draining() the
+ *         listeners are closed, drop them from the accept loop
+ * @retval ZEFAIL handoff link broken, still running
+ */
+ZAPI zerr_t zhot_poll(zhot_t *hot);
+
+zinline int zhot_draining(zhot_t *hot){
+    return ZHOT_DRAINING == hot->state;
+}
+
+/**
+ * @brief old process: may it exit now
+ * @param sessions [in] sessions still open
+ */
+ZAPI int zhot_drained(zhot_t *hot, int sessions);
+
+ZC_END
+
+#endif /*_ZCOM_HOTRESTART_H_*/
@@ -0,0 +1,98 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_MAILBOX_H_
+#define _ZCOM_MAILBOX_H_
+
+/**
+ * @file mailbox.h
+ * @brief Bounded lock-free MPSC mailbox for cross-thread message handoff
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Model
+ *      Any OS thread may zmbox_push(), exactly one thread (usually an ST
+ *      scheduler) calls zmbox_pop(). Cells carry a sequence number so
+ *      producers only contend on one CAS of <tail> and never block.
+ * @par Doorbell
+ *      zmbox_pop() returning ZEAGAIN arms the doorbell; the consumer then
+ *      waits for zmbox_fileno() to become readable:
+ *      - ST thread: zst_wait_readable(st_netfd_open(zmbox_fileno(mbox)), timeout)
+ *      - OS thread: zselect()/poll()
+ *      Producers only write the doorbell when the consumer is armed.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+
+ZC_BEGIN
+
+#define ZMBOX_CACHELINE 64
+
+typedef struct zmbox_cell_s{
+    volatile uint64_t seq;
+    zptr_t data;
+}zmbox_cell_t;
+
+typedef struct zmbox_s{
+    volatile uint64_t tail; /** producers claim position */
+    char pad0[ZMBOX_CACHELINE - 8];
+    uint64_t head; /** consumer position */
+    volatile uint32_t idle; /** consumer armed the doorbell */
+    int armed; /** consumer private copy of idle */
+    char pad1[ZMBOX_CACHELINE - 16];
+    uint64_t mask; /** size - 1 */
+    zmbox_cell_t *cells;
+    int rfd; /** doorbell read end */
+    int wfd; /** doorbell write end, same as rfd for eventfd */
+    /* statistic, consumer side */
+    uint64_t pops; /** messages popped */
+    uint64_t batches; /** non-empty zmbox_pop() calls */
+    uint64_t wakeups; /** doorbells consumed */
+}zmbox_t;
+
+/**
+ * @brief create a mailbox
+ * @param size [in] capacity, rounded up to a power of two
+ */
+ZAPI zmbox_t *zmbox_create(uint32_t size);
+ZAPI void zmbox_destroy(zmbox_t *mbox);
+/**
+ * @brief push a message from any thread
+ * @retval ZEOK pushed
+ * @retval ZEAGAIN mailbox full
+ */
+ZAPI zerr_t zmbox_push(zmbox_t *mbox, zptr_t data);
+/**
+ * @brief pop up to <max> messages, consumer thread only
+ * @return number of messages, ZEAGAIN when empty (doorbell armed)
+ */
+ZAPI int zmbox_pop(zmbox_t *mbox, zptr_t *items, int max);
+
+zinline int zmbox_fileno(zmbox_t *mbox){
+    return mbox->rfd;
+}
+
+ZC_END
+
+#endif /*_ZCOM_MAILBOX_H_*/
@@ -0,0 +1,178 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_MLOG_H_
+#define _ZCOM_MLOG_H_
+
+/**
+ * @file mlog.h
+ * @brief Segmented memory-mapped append-only log with group commit
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Layout
+ *      <dir>/<base offset %020llu>.log, preallocated segments of
+ *      <seg_bytes>, mapped shared. Records are <len:4><sum:4><payload>
+ *      padded to 8 bytes, sum is FNV-1a of the payload; a zero length
+ *      ends a segment. Offsets count records from 0 across segments.
+ * @par Index
+ *      A sparse in-memory index per segment, one (offset, position) pair
+ *      every ZMLOG_IDX_BYTES of data, rebuilt by the recovery scan at
+ *      zmlog_open(); a lookup is two binary searches and a short walk.
+ * @par Group commit
+ *      zmlog_append() only copies into the mapping. A committer pthread
+ *      waits for appends, lingers up to <max_delay_us> (or until
+ *      <max_batch> bytes are pending), then msync(MS_SYNC)s every dirty
+ *      range in one go (a data-only sync of the range on Linux, the files
+ *      never change size) and publishes the committed offset. One sync
+ *      covers every append made meanwhile.
+ * @par ST
+ *      zmlog_st_start() runs an st_thread that sleeps on the committer's
+ *      eventfd and broadcasts an st_cond; zmlog_st_wait() parks a session
+ *      until its record is durable, the loop keeps running meanwhile.
+ *      zmlog_sync() is the blocking variant for plain threads.
+ * @par Threads
+ *      Append, read and sendfile belong to one thread (the loop); only
+ *      the commit runs beside it.
+ * @par Zero copy
+ *      zmlog_read() points into the mapping; zmlog_sendfile() streams
+ *      committed records, framing included, from the page cache to a
+ *      socket, a replica can zmlog_append_raw() them as they come.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/state_threads.h>
+
+ZC_BEGIN
+
+#define ZMLOG_HDR 8 /** len + sum */
+#define ZMLOG_IDX_BYTES 4096
+#define ZMLOG_SEGS 1024 /** segments per log */
+
+typedef struct zmlog_cfg_s{
+    uint64_t seg_bytes; /** segment size, 64MB */
+    int max_delay_us; /** linger before a sync to batch more, 200us */
+    uint64_t max_batch; /** sync at once when this many bytes wait, 1MB */
+}zmlog_cfg_t;
+
+typedef struct zmlog_seg_s{
+    uint64_t base; /** first offset */
+    uint64_t count; /** records */
+    uint64_t written; /** bytes used, release stored by the appender */
+    uint64_t synced; /** committer only */
+    uint64_t size;
+    int fd;
+    char *map;
+    uint32_t (*idx)[2]; /** (offset - base, position) */
+    int idx_cnt;
+}zmlog_seg_t;
+
+typedef struct zmlog_s zmlog_t;
+
+typedef struct zmlog_rec_s{
+    const char *data; /** inside the mapping, valid while the log is open */
+    uint32_t len;
+    uint64_t offset;
+}zmlog_rec_t;
+
+/** @brief streaming position, start with {offset, 0} */
+typedef struct zmlog_cursor_s{
+    uint64_t offset; /** record being sent */
+    uint32_t sent; /** bytes of it already sent */
+}zmlog_cursor_t;
+
+zinline void zmlog_cfg_default(zmlog_cfg_t *cfg){
+    cfg->seg_bytes = 64 << 20;
+    cfg->max_delay_us = 200;
+    cfg->max_batch = 1 << 20;
+}
+
+/**
+ * @brief open or create the log in <dir>, recover and start the committer
+ * @param cfg [in] NULL for zmlog_cfg_default()
+ */
+ZAPI zerr_t zmlog_open(zmlog_t **log, const char *dir, const zmlog_cfg_t *cfg);
+
+/**
+ * @brief commit what is appended, stop the committer and unmap
+ */
+ZAPI void zmlog_close(zmlog_t *log);
+
+/**
+ * @brief copy one record into the log, not durable before the commit
+ * @param offset [out] offset of the record, may be NULL
+ * @retval ZEOK
+ * @retval ZEPARAM_INVALID empty or larger than a segment
+ * @retval ZEFAIL no new segment
+ */
+ZAPI zerr_t zmlog_append(zmlog_t *log, const void *buf, uint32_t len, uint64_t *offset);
+
+/**
+ * @brief append records in log format as streamed by zmlog_sendfile()
+ * @return bytes consumed, whole records only; ZEFAIL bad record
+ */
+ZAPI int zmlog_append_raw(zmlog_t *log, const char *buf, int len);
+
+/** @brief next offset to be appended */
+ZAPI uint64_t zmlog_end(zmlog_t *log);
+
+/** @brief every record below this offset is durable */
+ZAPI uint64_t zmlog_committed(zmlog_t *log);
+
+/**
+ * @brief block the calling pthread until <offset> is durable
+ * @retval ZEOK
+ * @retval ZETIMEOUT
+ */
+ZAPI zerr_t zmlog_sync(zmlog_t *log, uint64_t offset, int timeout_ms);
+
+/**
+ * @brief start the ST side of the commit notification, after st_init()
+ */
+ZAPI zerr_t zmlog_st_start(zmlog_t *log);
+
+/**
+ * @brief park the calling st_thread until <offset> is durable
+ * @param timeout [in] micro seconds, ST_UTIME_NO_TIMEOUT to wait forever
+ */
+ZAPI zerr_t zmlog_st_wait(zmlog_t *log, uint64_t offset, st_utime_t timeout);
+
+/**
+ * @brief look record <offset> up, zero copy
+ * @retval ZEOK
+ * @retval ZEPARAM_INVALID no such offset
+ */
+ZAPI zerr_t zmlog_read(zmlog_t *log, uint64_t offset, zmlog_rec_t *rec);
+
+/**
+ * @brief sendfile() committed records from the cursor on, at most <max_bytes>
+ * @param cur [in,out] advanced past what was sent, partial records included
+ * @return bytes sent, 0 nothing committed beyond the cursor, ZEAGAIN
+ *         socket full, ZEFAIL
+ */
+ZAPI int zmlog_sendfile(zmlog_t *log, int sock, zmlog_cursor_t *cur, int max_bytes);
+
+ZC_END
+
+#endif /*_ZCOM_MLOG_H_*/
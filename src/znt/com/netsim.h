@@ -0,0 +1,169 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_NETSIM_H_
+#define _ZCOM_NETSIM_H_
+
+/**
+ * @file netsim.h
+ * @brief In-process network simulator behind the ztrans_t surface
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Model
+ *      Virtual nodes exchange messages over in-memory queues. A message
+ *      leaves its node when the node's egress is free (size / bandwidth of
+ *      serialization per node), travels the link latency plus jitter of the
+ *      (zone, zone) pair, and is lost with the link's loss rate. Partition
+ *      groups cut every link between nodes of different groups.
+ * @par Virtual clock
+ *      Deliveries and timers are events in one heap ordered by virtual
+ *      time; znetsim_run() pops them in order, so thousands of nodes run in
+ *      one thread, as fast as the host allows, reproducibly for a seed.
+ * @par Transports
+ *      - port: the address of a node, every node sends to it, datagram
+ *        semantics (one message per recv, lost messages are gone, jitter
+ *        may reorder them, data staged with MSG_MORE goes out as one
+ *        message at the flush). The
+ *        sender is the node whose event is running, so one table of ports
+ *        serves every node, as a shared zroute_t does.
+ *      - pair: a connected stream between two nodes, bytes arrive in order,
+ *        a lost or partitioned segment is retried after an RTO, like TCP.
+ *      Both answer the ztrans_t contract; send never blocks (queues are
+ *      unbounded, bandwidth shows up as delay), fileno() is -1, readiness
+ *      is the node's on_recv callback.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/transport.h>
+
+ZC_BEGIN
+
+#define ZNETSIM_ZONES 16
+#define ZNETSIM_RTO_US 200000 /** stream retransmit, plus two latencies */
+
+typedef struct znetsim_s znetsim_t;
+typedef struct znetsim_node_s znetsim_node_t;
+typedef struct znetsim_ev_s znetsim_ev_t;
+typedef struct znetsim_ep_s znetsim_ep_t;
+
+/** @brief data or a close is ready on <trans> of <node> */
+typedef void (*znetsim_recv_t)(znetsim_t *sim, znetsim_node_t *node, ztrans_t *trans);
+typedef void (*znetsim_timer_t)(znetsim_t *sim, znetsim_node_t *node, zptr_t arg);
+
+typedef struct znetsim_link_s{
+    uint32_t latency_us;
+    uint32_t jitter_us; /** uniform extra delay */
+    uint32_t loss_ppm; /** lost messages per million */
+}znetsim_link_t;
+
+struct znetsim_node_s{
+    int id; /** index in the simulation */
+    int zone; /** picks the link, < ZNETSIM_ZONES */
+    int group; /** partition group, links across groups are cut */
+    uint64_t bandwidth; /** egress bytes per second, 0 unlimited */
+    uint64_t tx_free; /** virtual time the egress is idle again */
+    znetsim_recv_t on_recv;
+    zptr_t hint; /** user data */
+    znetsim_ep_t *port;
+    znetsim_ep_t *stage_ep; /** MSG_MORE data waiting for the flush */
+    char *stage;
+    int stage_len;
+    int stage_cap;
+    /* statistic */
+    uint64_t tx_msgs;
+    uint64_t tx_bytes;
+    uint64_t rx_msgs;
+    uint64_t rx_bytes;
+};
+
+struct znetsim_s{
+    uint64_t now; /** virtual micro seconds */
+    znetsim_node_t *cur; /** node whose event runs, the sender of ports */
+    znetsim_node_t *nodes;
+    int nnodes;
+    znetsim_link_t links[ZNETSIM_ZONES][ZNETSIM_ZONES];
+    znetsim_ep_t *eps; /** every endpoint, released by znetsim_fini() */
+    znetsim_ev_t **heap;
+    int nheap;
+    int cap;
+    uint64_t seq; /** ties break in scheduling order */
+    uint64_t rand;
+    /* statistic */
+    uint64_t events;
+    uint64_t msgs; /** sent */
+    uint64_t bytes;
+    uint64_t lost; /** dropped by loss or partition */
+    uint64_t retrans; /** stream segments sent again */
+};
+
+/**
+ * @brief <nodes> nodes in zone 0, group 0, unlimited bandwidth, links of
+ *        <latency_us> without loss
+ */
+ZAPI zerr_t znetsim_init(znetsim_t *sim, int nodes, uint32_t latency_us, uint64_t seed);
+ZAPI void znetsim_fini(znetsim_t *sim);
+
+/** @brief set the links from zone <a> to zone <b> and back */
+ZAPI void znetsim_link(znetsim_t *sim, int a, int b, const znetsim_link_t *link);
+
+/** @brief move <node> into partition <group>, 0 everywhere heals */
+zinline void znetsim_partition(znetsim_t *sim, int node, int group){
+    sim->nodes[node].group = group;
+}
+
+ZAPI void znetsim_heal(znetsim_t *sim);
+
+/** @brief address of <node>, valid until znetsim_fini() */
+ZAPI ztrans_t *znetsim_port(znetsim_t *sim, int node);
+
+/**
+ * @brief connected stream, <ta> is the end of <a>, <tb> the end of <b>;
+ *        both ends must be closed
+ */
+ZAPI zerr_t znetsim_pair(znetsim_t *sim, int a, int b, ztrans_t *ta, ztrans_t *tb);
+
+/** @brief run <cb> on <node> after <delay_us> of virtual time */
+ZAPI zerr_t znetsim_timer(znetsim_t *sim, int node, uint64_t delay_us,
+                          znetsim_timer_t cb, zptr_t arg);
+
+/**
+ * @brief act as <node> outside of an event, to seed the traffic
+ */
+zinline void znetsim_enter(znetsim_t *sim, int node){
+    sim->cur = node < 0 ? NULL : &sim->nodes[node];
+}
+
+/**
+ * @brief process events up to virtual time <until> (inclusive)
+ * @return events left, 0 the network is quiet
+ */
+ZAPI int znetsim_run(znetsim_t *sim, uint64_t until);
+
+/** @brief uniform random in [0, n), deterministic for the seed */
+ZAPI uint32_t znetsim_rand(znetsim_t *sim, uint32_t n);
+
+ZC_END
+
+#endif /*_ZCOM_NETSIM_H_*/
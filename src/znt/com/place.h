@@ -0,0 +1,116 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_PLACE_H_
+#define _ZCOM_PLACE_H_
+
+/**
+ * @file place.h
+ * @brief NUMA- and core-aware placement of event loops, buffers and sockets
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Loops
+ *      One OS thread per chosen core, pinned before the entry runs, so the
+ *      ST scheduler (or zbpoll_t) it starts never migrates.
+ * @par Memory
+ *      zplace_alloc() maps pages preferring the node of the loop and touches
+ *      them from the calling thread; call it from the loop itself so buffer
+ *      pools are node-local by first touch even where mbind() is missing.
+ * @par Steering
+ *      - zplace_listen(): one SO_REUSEPORT listener per loop with a classic
+ *        BPF program that picks the listener of the loop serving the CPU
+ *        which received the SYN (the NIC queue CPU), or a loop on the same
+ *        node when that CPU runs no loop
+ *      - zplace_steer(): for a single listener, SO_INCOMING_CPU of an
+ *        accepted socket names the loop to hand it to
+ *      Either way a connection is served on the node its packets arrive.
+ * @par Topology
+ *      Read from /sys/devices/system/node, a host without it is one node.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <pthread.h>
+#include <znt/com/socket.h>
+
+ZC_BEGIN
+
+#define ZPLACE_CPUS 1024
+#define ZPLACE_NODES 64
+
+typedef struct zplace_s zplace_t;
+
+typedef struct zplace_loop_s{
+    int index;
+    int cpu;
+    int node;
+    zsock_t listener; /** reuseport listener of the loop, ZINVALID_SOCKET none */
+    pthread_t thr;
+    int started;
+    zplace_t *place;
+}zplace_loop_t;
+
+/** @brief body of a loop, runs on its pinned core */
+typedef void (*zplace_entry_t)(zplace_loop_t *loop, zptr_t hint);
+
+struct zplace_s{
+    int ncpus; /** highest online cpu + 1 */
+    int nnodes;
+    int16_t cpu_node[ZPLACE_CPUS]; /** -1 offline */
+    int16_t cpu_loop[ZPLACE_CPUS]; /** loop serving each cpu, same node first */
+    zplace_loop_t *loops;
+    int nloops;
+    zplace_entry_t entry;
+    zptr_t hint;
+    /* statistic */
+    uint64_t steered_local; /** zplace_steer() onto the receiving cpu's loop */
+    uint64_t steered_remote;
+};
+
+/**
+ * @brief discover the topology and plan one loop per cpu of <cpus>
+ * @param cpus [in] cores to run loops on, NULL every cpu of the process affinity
+ */
+ZAPI zerr_t zplace_init(zplace_t *place, const int *cpus, int cnt);
+/** @brief close the listeners, loops must have returned */
+ZAPI void zplace_fini(zplace_t *place);
+/**
+ * @brief bind one SO_REUSEPORT listener per loop on host:port and attach
+ *        the CPU steering program
+ */
+ZAPI zerr_t zplace_listen(zplace_t *place, const char *host, uint16_t port, int backlog);
+/** @brief start every loop thread, pinned, running <entry> */
+ZAPI zerr_t zplace_start(zplace_t *place, zplace_entry_t entry, zptr_t hint);
+ZAPI void zplace_join(zplace_t *place);
+/** @return loop for accepted <sock> by SO_INCOMING_CPU, NULL unknown */
+ZAPI zplace_loop_t *zplace_steer(zplace_t *place, zsock_t sock);
+/** @brief <size> bytes preferring memory of <node>, touched by the caller */
+ZAPI void *zplace_alloc(int node, size_t size);
+ZAPI void zplace_free(void *ptr, size_t size);
+/** @return node of the memory page at <ptr>, -1 unknown */
+ZAPI int zplace_node_of(const void *ptr);
+
+ZC_END
+
+#endif /*_ZCOM_PLACE_H_*/
@@ -0,0 +1,164 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_RESOLV_H_
+#define _ZCOM_RESOLV_H_
+
+/**
+ * @file resolv.h
+ * @brief Asynchronous, cached hostname resolution
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Model
+ *      Lookups never run on the calling loop. A small pool of OS threads
+ *      runs getaddrinfo(); answers come back through the caller's zmbox_t,
+ *      so an ST thread waits with zst_wait_readable() on zmbox_fileno().
+ * @par Cache
+ *      - numeric addresses and /etc/hosts (reloaded when it changes) are
+ *        answered inline
+ *      - answers are kept <ttl> seconds, failures <neg_ttl> seconds;
+ *        getaddrinfo() hides record TTLs so <ttl> is the upper bound
+ *      - concurrent queries of one name wait on a single lookup
+ *      - IPv6 and IPv4 addresses are kept in getaddrinfo() order and
+ *        handed out round robin
+ * @par Dialing
+ *      zconnect_host() races every address of a name (Happy Eyeballs),
+ *      zconnectx() resolves through zresolv_wait() on the default
+ *      resolver and waits for a lookup in flight up to its connect timeout.
+ *      zresolv_wait() called from an st_thread parks it on the scheduler
+ *      with zst_wait_readable() on the reply mailbox, a plain thread
+ *      blocks in poll(). An st_thread that wants to do more meanwhile
+ *      queries with zresolv_query() and a reply mailbox of its own.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <time.h>
+#include <pthread.h>
+#include <znt/com/socket.h>
+#include <znt/com/mailbox.h>
+
+ZC_BEGIN
+
+#define ZRESOLV_NAME 256
+#define ZRESOLV_ADDRS 8
+#define ZRESOLV_HOSTS "/etc/hosts"
+
+/** @brief one query, owned by the caller until it returns on <reply> */
+typedef struct zresolv_req_s{
+    struct zresolv_req_s *next; /** waiters of the same lookup */
+    zmbox_t *reply; /** mailbox the answered request is pushed to, NULL none */
+    zptr_t user;
+    uint16_t port;
+    zerr_t ret; /** ZEOK or ZEFAIL */
+    zsockaddr_t addr;
+}zresolv_req_t;
+
+typedef struct zresolv_ent_s{
+    struct zresolv_ent_s *next; /** bucket chain */
+    struct zresolv_ent_s *job; /** lookup queue */
+    char name[ZRESOLV_NAME];
+    int state; /** pending, ok, fail */
+    int cnt;
+    uint32_t rr;
+    zsockaddr_t addrs[ZRESOLV_ADDRS]; /** IPv6 and IPv4, resolver order */
+    uint64_t expire; /** monotonic micro seconds */
+    zresolv_req_t *waiters;
+}zresolv_ent_t;
+
+typedef struct zresolv_host_s{
+    char name[ZRESOLV_NAME];
+    zsockaddr_t addr;
+}zresolv_host_t;
+
+typedef struct zresolv_s{
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    pthread_t *thrs;
+    int nthrs;
+    int stop;
+    zresolv_ent_t **buckets;
+    uint32_t mask;
+    int count;
+    int max_entries;
+    zresolv_ent_t *job_head;
+    zresolv_ent_t *job_tail;
+    uint32_t ttl;
+    uint32_t neg_ttl;
+    zresolv_host_t *hosts;
+    int nhosts;
+    time_t hosts_mtime;
+    uint64_t hosts_check; /** next stat() of the hosts file */
+    /* statistic */
+    uint64_t hits; /** answered from hosts or cache */
+    uint64_t lookups; /** getaddrinfo() calls */
+    uint64_t coalesced; /** queries joined to an in-flight lookup */
+    uint64_t failures;
+}zresolv_t;
+
+/**
+ * @brief start a resolver
+ * @param threads [in] lookup threads, <= 0 is 2
+ * @param ttl [in] seconds an answer is cached, 0 is 60
+ * @param neg_ttl [in] seconds a failure is cached, 0 is 5
+ * @param max_entries [in] cache capacity, <= 0 is 4096
+ */
+ZAPI zresolv_t *zresolv_create(int threads, uint32_t ttl, uint32_t neg_ttl, int max_entries);
+/** @brief stop the threads, in-flight waiters are answered ZEFAIL */
+ZAPI void zresolv_destroy(zresolv_t *rs);
+/**
+ * @brief resolve <host> for <req>
+ * @param req [in|out] reply, user and port set by the caller; without
+ *                    a reply only answers from the cache, NULL prefetch
+ * @retval ZEOK answered now in req->addr
+ * @retval ZEAGAIN lookup pending, <req> is pushed to req->reply later
+ * @retval ZEFAIL unknown name (cached failure)
+ */
+ZAPI zerr_t zresolv_query(zresolv_t *rs, const char *host, zresolv_req_t *req);
+/**
+ * @brief non-blocking addresses of <host>:<port>, both families
+ * @param rs [in] resolver, NULL numeric addresses only
+ * @return addresses filled, ZEAGAIN lookup started or in flight, ZEFAIL unknown
+ */
+ZAPI int zresolv_addrs(zresolv_t *rs, const char *host, uint16_t port, zsockaddr_t *addrs, int max);
+/** @brief first IPv4 address of zresolv_addrs(), for AF_INET sockets */
+ZAPI zerr_t zresolv_addr(zresolv_t *rs, const char *host, uint16_t port, zsockaddr_in *addr);
+/**
+ * @brief zresolv_addr(), waiting for a lookup in flight on a private mailbox
+ * @note an st_thread (st_thread_self() set on the calling OS thread) waits on
+ *       its scheduler, a plain thread blocks in poll()
+ * @param timeout_ms [in] -1 waits for the answer, 0 returns ZEAGAIN at once
+ * @retval ZETIMEOUT no answer within <timeout_ms>, the lookup keeps running
+ */
+ZAPI zerr_t zresolv_wait(zresolv_t *rs, const char *host, uint16_t port, zsockaddr_in *addr,
+                         int timeout_ms);
+/** @brief drop every settled cache entry */
+ZAPI void zresolv_flush(zresolv_t *rs);
+/** @brief resolver used by zconnectx(), NULL numeric only */
+ZAPI void zresolv_set_default(zresolv_t *rs);
+ZAPI zresolv_t *zresolv_default(void);
+
+ZC_END
+
+#endif /*_ZCOM_RESOLV_H_*/
@@ -0,0 +1,136 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_SHM_RING_H_
+#define _ZCOM_SHM_RING_H_
+
+/**
+ * @file shm_ring.h
+ * @brief Shared-memory SPSC ring transport between local processes
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Layout
+ *      +--------+--------+----------------+------------------------------+
+ *      | header | head   | tail, idle     | data (power of two bytes)    |
+ *      +--------+--------+----------------+------------------------------+
+ *      each part is on its own cache line, the producer only writes <head>,
+ *      the consumer only writes <tail> and <idle>.
+ *      frame = [len:4][rsv:4][payload], aligned to 8 bytes; a frame that does
+ *      not fit before the end of the data area is preceded by a pad frame.
+ * @par Wakeup
+ *      The consumer raises <idle> before it sleeps on the eventfd, the
+ *      producer writes the eventfd only when it sees <idle> after publishing,
+ *      so a busy consumer costs the producer no syscall at all.
+ * @par Usage
+ *      producer: zshm_ring_create() -> zshm_ring_share(unix_sock)
+ *      consumer: zshm_ring_attach(unix_sock)
+ *      both:     zshm_ring_trans() to obtain a ztrans_t
+ * @note Linux only (memfd_create/eventfd).
+ */
+#include <zsi/base/type.h>
+#include <znt/com/socket.h>
+#include <znt/com/transport.h>
+
+ZC_BEGIN
+
+#define ZSHM_CACHELINE 64
+#define ZSHM_MAGIC 0x7a73686d /* "zshm" */
+
+typedef struct zshm_ring_hdr_s{
+    uint32_t magic;
+    uint32_t frame_max; /** maximum payload of one frame */
+    uint64_t size; /** data area size, power of two */
+    char pad0[ZSHM_CACHELINE - 16];
+    volatile uint64_t head; /** producer published position */
+    char pad1[ZSHM_CACHELINE - 8];
+    volatile uint64_t tail; /** consumer released position */
+    volatile uint32_t idle; /** consumer is (about to be) waiting on the doorbell */
+    char pad2[ZSHM_CACHELINE - 12];
+}zshm_ring_hdr_t;
+
+typedef struct zshm_ring_s{
+    zshm_ring_hdr_t *hdr; /** mapped shared header */
+    char *data; /** mapped data area */
+    uint64_t mask; /** size - 1 */
+    size_t map_len; /** mapped length */
+    int memfd; /** shared memory descriptor */
+    int evfd; /** doorbell eventfd */
+    /* producer private */
+    uint64_t head; /** staged position, published by zshm_flush() */
+    uint64_t tail_cache; /** last observed consumer position */
+    /* consumer private */
+    uint64_t tail; /** local read position */
+    uint64_t head_cache; /** last observed producer position */
+    int armed; /** doorbell armed by last empty recv */
+    /* statistic */
+    uint64_t frames; /** frames sent or received */
+    uint64_t publishes; /** producer head stores */
+    uint64_t wakeups; /** doorbell writes/reads */
+}zshm_ring_t;
+
+/**
+ * @brief create a ring backed by an anonymous memfd
+ * @param ring [out] ring handle
+ * @param size [in]  data area size, rounded up to a power of two
+ */
+ZAPI zerr_t zshm_ring_create(zshm_ring_t *ring, size_t size);
+/** @brief unmap and close the local handle, the memory goes with the last user */
+ZAPI zerr_t zshm_ring_destroy(zshm_ring_t *ring);
+/** @brief pass memfd and eventfd to the peer over a unix socket (SCM_RIGHTS) */
+ZAPI zerr_t zshm_ring_share(zshm_ring_t *ring, zsock_t usock);
+/** @brief attach to a ring shared by zshm_ring_share() */
+ZAPI zerr_t zshm_ring_attach(zshm_ring_t *ring, zsock_t usock);
+
+/**
+ * @brief stage a frame, publish it unless flags has MSG_MORE
+ * @retval ZEOK frame staged (and published)
+ * @retval ZEAGAIN ring full, pending frames were published, *len = 0
+ * @retval ZEPARAM_INVALID frame larger than hdr->frame_max
+ */
+ZAPI zerr_t zshm_send(zshm_ring_t *ring, const char *buf, int *len, int flags);
+/** @brief publish staged frames, ring the doorbell if the consumer is idle */
+ZAPI zerr_t zshm_flush(zshm_ring_t *ring);
+/**
+ * @brief receive one frame, message boundaries are preserved
+ * @return frame length, ZEAGAIN when empty (doorbell armed, poll zshm_fileno())
+ * @retval ZEPARAM_INVALID buffer smaller than the next frame
+ */
+ZAPI zerr_t zshm_recv(zshm_ring_t *ring, char *buf, int len, int flags);
+
+zinline int zshm_fileno(zshm_ring_t *ring){
+    return ring->evfd;
+}
+
+/** shared memory binding, ctx is a zshm_ring_t* */
+ZAPI const ztrans_ops_t zshm_trans_ops;
+
+zinline void zshm_ring_trans(zshm_ring_t *ring, ztrans_t *trans){
+    trans->ops = &zshm_trans_ops;
+    trans->ctx = (zptr_t)ring;
+}
+
+ZC_END
+
+#endif /*_ZCOM_SHM_RING_H_*/
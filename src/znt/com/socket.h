@@ -54,7 +54,9 @@ typedef struct sockaddr ZSA;
 #include <sys/select.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <fcntl.h>
+#include <poll.h>
 typedef int zsock_t;
 typedef struct sockaddr_in zsockaddr_in;
 typedef struct sockaddr ZSA;
@@ -63,6 +65,8 @@ typedef struct sockaddr ZSA;
 #endif /* ZSYS_WINDOWS */
 
 #include <zsi/base/error.h>
+#include <znt/com/evtrace.h>
+#include <znt/com/capture.h>
 
 #define ZTRACE_SOCKET 1
 
@@ -98,6 +102,139 @@ ZAPI zsock_t zaccept(zsock_t sock, ZSA *addr, int *addrlen);
 ZAPI int zselect(int maxfdp1, fd_set *read, fd_set *write, fd_set *except, struct timeval *timeout);
 /* get/setoption() */
 ZAPI int zsock_nonblock(zsock_t sock, int noblock);
+/*
+ * socket option template, built once and applied with one setsockopt() per
+ * option, unset options cost nothing
+ */
+#define ZSOCKOPT_MAX 12
+
+typedef struct zsockopt_s{
+    int cnt;
+    struct{
+        int level;
+        int name;
+        int val;
+    }opt[ZSOCKOPT_MAX];
+}zsockopt_t;
+
+zinline void zsockopt_init(zsockopt_t *opts){
+    opts->cnt = 0;
+}
+ZAPI zerr_t zsockopt_add(zsockopt_t *opts, int level, int name, int val);
+/**
+ * @brief common TCP template, a value <= 0 leaves the system default
+ * @param keepalive_s [in] idle seconds before probing, 3 probes <keepalive_s>/3 apart
+ * @param user_timeout_ms [in] TCP_USER_TIMEOUT where supported
+ */
+ZAPI zerr_t zsockopt_tcp(zsockopt_t *opts, int nodelay, int sndbuf, int rcvbuf,
+                         int keepalive_s, int user_timeout_ms);
+ZAPI zerr_t zsockopt_apply(zsock_t sock, const zsockopt_t *opts);
+
+/**
+ * @brief drain up to <max> pending connections of a non-blocking listener
+ * @param addrs [out] peer addresses, may be NULL
+ * @param opts [in] option template applied to each connection, may be NULL
+ * @return connections accepted, 0 backlog empty, ZEFAIL listener error
+ * @note connections are non-blocking and close-on-exec, on Linux with one
+ *       accept4() each instead of accept() + 2 fcntl()
+ */
+ZAPI int zaccept_batch(zsock_t sock, zsock_t *socks, zsockaddr_in *addrs, int max,
+                       const zsockopt_t *opts);
+
+#ifdef ZSYS_POSIX
+/*
+ * address family agnostic addressing
+ */
+typedef union zsockaddr_u{
+    ZSA sa;
+    struct sockaddr_in in4;
+    struct sockaddr_in6 in6;
+    struct sockaddr_storage ss;
+}zsockaddr_t;
+
+zinline socklen_t zsockaddr_len(const zsockaddr_t *addr){
+    return AF_INET6 == addr->sa.sa_family ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+}
+
+zinline void zsockaddr_set_port(zsockaddr_t *addr, uint16_t port){
+    if(AF_INET6 == addr->sa.sa_family){
+        addr->in6.sin6_port = htons(port);
+    }else{
+        addr->in4.sin_port = htons(port);
+    }
+}
+
+/**
+ * @brief numeric IPv4 or IPv6 address, "::1", "[fe80::1%eth0]" and "10.0.0.1" alike
+ */
+ZAPI zerr_t zinet_addrx(zsockaddr_t *addr, const char *host, uint16_t port);
+/** @brief printable host and port of <addr>, <port> may be NULL */
+ZAPI zerr_t zinet_ntop(const zsockaddr_t *addr, char *host, int size, uint16_t *port);
+
+/*
+ * Happy Eyeballs (RFC 8305) connection racing
+ *
+ * Candidates are interleaved by family, keeping the resolver's order
+ * within a family, and started <stagger> ms apart or as soon as the
+ * previous attempt fails; the first to connect wins, the rest are closed.
+ * The race is driven by poll()-style descriptors so an ST thread can wait
+ * with st_poll() and an OS thread with poll():
+ *     while(ZEAGAIN == ret){
+ *         if((n = zrace_fds(&race, pfds, &timeout_ms))){
+ *             poll(pfds, n, timeout_ms);
+ *         }
+ *         ret = zrace_check(&race, pfds, n);
+ *     }
+ */
+#define ZRACE_MAX 16
+#define ZRACE_STAGGER 250 /** RFC 8305 recommended connection attempt delay, ms */
+
+typedef struct zrace_s{
+    zsockaddr_t cand[ZRACE_MAX];
+    zsock_t socks[ZRACE_MAX]; /** attempt in flight, ZINVALID_SOCKET none */
+    int cnt;
+    int started; /** candidates tried so far */
+    int live; /** attempts in flight */
+    int stagger_ms;
+    uint64_t next_ms; /** monotonic start of the next attempt */
+    int winner; /** index of the connected candidate, -1 none */
+}zrace_t;
+
+/** @param stagger_ms [in] delay between attempts, <= 0 ZRACE_STAGGER */
+ZAPI zerr_t zrace_init(zrace_t *race, const zsockaddr_t *cands, int cnt, int stagger_ms);
+/**
+ * @brief start due attempts and list the descriptors to wait on
+ * @param pfds [out] ZRACE_MAX entries
+ * @param timeout_ms [out] until the next attempt is due, -1 none
+ * @return descriptors filled, 0 the race is settled
+ */
+ZAPI int zrace_fds(zrace_t *race, struct pollfd *pfds, int *timeout_ms);
+/**
+ * @brief settle the attempts reported by poll()
+ * @retval ZEOK race->winner connected, take it with zrace_take()
+ * @retval ZEAGAIN still racing
+ * @retval ZEFAIL every candidate failed
+ */
+ZAPI zerr_t zrace_check(zrace_t *race, struct pollfd *pfds, int n);
+/** @brief detach the winning socket (non-blocking) from the race */
+ZAPI zsock_t zrace_take(zrace_t *race);
+/** @brief close every attempt still held by the race */
+ZAPI void zrace_fini(zrace_t *race);
+/**
+ * @brief race <cands> with poll(), blocking up to <timeout_ms>
+ * @param sock [out] connected non-blocking socket
+ * @param index [out] winning candidate, may be NULL
+ */
+ZAPI zerr_t zconnect_race(const zsockaddr_t *cands, int cnt, int stagger_ms, int timeout_ms,
+                          zsock_t *sock, int *index);
+/**
+ * @brief dial <host>:<port> over every address family it has
+ * @retval ZEAGAIN name lookup in flight on zresolv_default(), retry later
+ */
+ZAPI zerr_t zconnect_host(const char *host, uint16_t port, int stagger_ms, int timeout_ms,
+                          zsock_t *sock);
+#endif /* ZSYS_POSIX */
+
 /**@fn int recv_packet(sock_t sock, char *buf, int maxlen, int* offset, int *len, char *bitmask)
  * @brief recv a packet
  * @return ZOK - sock closed
@@ -113,6 +250,10 @@ ZAPI int zrecv_packet(zsock_t sock, char *buf, int maxlen, int* offset, int *len
 
 /**@fn int zconnectx(zsock_t sock, const char *host, uint 16_t port, int listenq)
  * @brief listenq <= 0 active connect listenq > 0 passive connect
+ * @param timeout_ms [in] bounds the name lookup and the connect alike, -1
+ *        forever, outside [1000, 15000] 4000
+ * @note <host> may be a name, resolved by zresolv_wait() on zresolv_default();
+ *       ZETIMEOUT when its lookup outlasts the timeout
  */
 ZAPI int zconnectx(zsock_t sock, const char *host, uint16_t port, int listenq, int timeout_ms);
 
@@ -132,11 +273,16 @@ zinline zerr_t zrecv(zsock_t sock, char *buf, int len, int flags){
         }
 #endif
         if(ret != ZEAGAIN){
+            ZEVTRACE(ZEVT_ERROR, sock, 0, 0, ret);
             zerrno(ret);
             ret = ZEFAIL;
         }
     }else{
         ret = readed;
+        ZEVTRACE(ZEVT_RECV, sock, 0, readed, 0);
+        if(readed){
+            ZCAP_HOOK(ZCAP_IN, sock, buf, readed);
+        }
 #if ZTRACE_SOCKET
         /* ztrace_bin(buf, readed); */
         //zdbg("recv: %d", readed);
@@ -192,12 +338,19 @@ zinline zerr_t zsend(zsock_t sock, const char *buf, int *len, int flags){
                 continue;
             }else{
                 *len = sended;
+                ZEVTRACE(ZEVT_ERROR, sock, 0, sended, ret);
                 zerrno(ret);
                 ret = ZEFAIL;
                 break;
             }
         }
     }
+    if(sended == length){
+        /* ret holds the last send() count, the contract says ZEOK */
+        ret = ZEOK;
+        ZEVTRACE(ZEVT_SEND, sock, 0, sended, 0);
+        ZCAP_HOOK(ZCAP_OUT, sock, buf, sended);
+    }
     return(ret);
 }
 
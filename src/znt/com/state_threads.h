@@ -142,12 +142,14 @@
  * State-Threads only support UNIX like system
  */
 #include <errno.h>
+#include <poll.h>
 
 #include <st.h>
 
 #include <zsi/base/type.h>
 #include <zsi/base/error.h>
 #include <zsi/base/trace.h>
+#include <znt/com/evtrace.h>
 
 zinline zerr_t zst_init(zoperate pre_init, zoperate post_init){
     /*
@@ -236,5 +238,23 @@ zinline st_netfd_t zst_socket(int osfd){
     return stfd;
 }
 
+/**
+ * @brief sleep the current st_thread until <stfd> is readable
+ * @param timeout [in] micro seconds, ST_UTIME_NO_TIMEOUT to wait forever
+ * @retval ZEOK readable
+ * @retval ZETIMEOUT timeout
+ * @retval ZEFAIL interrupted or descriptor error
+ */
+zinline zerr_t zst_wait_readable(st_netfd_t stfd, st_utime_t timeout){
+    if(0 == st_netfd_poll(stfd, POLLIN, timeout)){
+        return ZEOK;
+    }
+    if(ETIME != errno){
+        return ZEFAIL;
+    }
+    ZEVTRACE(ZEVT_TIMEOUT, st_netfd_fileno(stfd), 0, 0, (int)timeout);
+    return ZETIMEOUT;
+}
+
 #endif /* ZSYS_POSIX */
 #endif /*_ZCOM_ST_H_*/
@@ -0,0 +1,116 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_STPROF_H_
+#define _ZCOM_STPROF_H_
+
+/**
+ * @file stprof.h
+ * @brief Per st_thread CPU profiler on the ST context switch callbacks
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Model
+ *      zstprof_start() installs st_set_switch_in_cb()/st_set_switch_out_cb()
+ *      (chaining any callbacks already set). Switch in stamps the clock,
+ *      switch out charges the slice to the running st_thread: run time,
+ *      switch count and the longest uninterrupted slice. A slice longer
+ *      than <hog_us> means the coroutine kept the scheduler from every
+ *      other one; it is counted and reported through the hog callback.
+ * @par Record
+ *      Each st_thread gets its record on its first switch in, bound with
+ *      st_thread_setspecific(); the key destructor recycles it when the
+ *      thread exits. zstprof_name() labels the current thread so a report
+ *      says "conn 10.0.0.7:5000" instead of a pointer.
+ * @par Scope
+ *      All state is per scheduler (thread local), nothing is locked.
+ *      Costs two clock_gettime() per switch while running.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/state_threads.h>
+
+ZC_BEGIN
+
+#define ZSTPROF_NAME 32
+#define ZSTPROF_HOG_US 10000 /** default hog threshold, 10ms */
+
+/** @brief zstprof_top() orders */
+#define ZSTPROF_BY_RUN 0 /** total run time */
+#define ZSTPROF_BY_SLICE 1 /** longest slice */
+#define ZSTPROF_BY_HOGS 2 /** hog count */
+
+typedef struct zstprof_stat_s{
+    st_thread_t thr;
+    char name[ZSTPROF_NAME];
+    uint64_t run_us; /** total time on the CPU */
+    uint64_t switches; /** times switched in */
+    uint64_t max_slice_us; /** longest uninterrupted run */
+    uint64_t hogs; /** slices over the threshold */
+}zstprof_stat_t;
+
+/**
+ * @brief called on switch out after a slice over the threshold
+ * @param stat [in] the hog, already charged with the slice
+ */
+typedef void (*zstprof_hog_cb)(const zstprof_stat_t *stat, uint64_t slice_us, zptr_t hint);
+
+/**
+ * @brief start profiling the calling scheduler, after st_init()
+ * @param hog_us [in] slice threshold, 0 for ZSTPROF_HOG_US
+ * @param on_hog [in] NULL to log hogs with zinf()
+ * @retval ZEOK
+ * @retval ZEFAIL no st_thread key left
+ */
+ZAPI zerr_t zstprof_start(uint64_t hog_us, zstprof_hog_cb on_hog, zptr_t hint);
+
+/**
+ * @brief uninstall the callbacks, restore the previous ones, keep the records
+ */
+ZAPI void zstprof_stop(void);
+
+/**
+ * @brief label the calling st_thread, truncated to ZSTPROF_NAME - 1
+ */
+ZAPI void zstprof_name(const char *name);
+
+/**
+ * @brief zero every live record
+ */
+ZAPI void zstprof_reset(void);
+
+/**
+ * @brief copy the top <cnt> live records in <order>
+ * @return records copied
+ */
+ZAPI int zstprof_top(zstprof_stat_t *stats, int cnt, int order);
+
+/**
+ * @brief log the top <cnt> by run time with zinf()
+ */
+ZAPI void zstprof_report(int cnt);
+
+ZC_END
+
+#endif /*_ZCOM_STPROF_H_*/
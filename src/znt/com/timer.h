@@ -0,0 +1,96 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_TIMER_H_
+#define _ZCOM_TIMER_H_
+
+/**
+ * @file timer.h
+ * @brief Deadline timers for an ST scheduler
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Model
+ *      A binary min-heap of deadlines, O(log n) add/del and O(1) peek.
+ *      ztimer_init() starts an st_thread that sleeps until the earliest
+ *      deadline and runs the expired callbacks in the scheduler context;
+ *      ztimer_expire() runs them by hand for loops without ST.
+ * @par Node
+ *      Nodes are embedded in the owner object, no allocation per timer.
+ *      A callback may add or delete any node, including its own.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/state_threads.h>
+
+ZC_BEGIN
+
+typedef struct ztimer_node_s ztimer_node_t;
+typedef void (*ztimer_cb_t)(ztimer_node_t *node, zptr_t hint);
+
+struct ztimer_node_s{
+    st_utime_t expire; /** absolute deadline, micro seconds */
+    int index; /** heap slot, -1 when not scheduled */
+    ztimer_cb_t cb;
+    zptr_t hint;
+};
+
+typedef struct ztimer_s{
+    ztimer_node_t **heap;
+    int cnt;
+    int cap;
+    st_cond_t cond; /** wakes the timer thread on a new earliest deadline */
+    st_thread_t thr;
+    int stop;
+    uint64_t fired; /** statistic */
+}ztimer_t;
+
+zinline void ztimer_node_init(ztimer_node_t *node){
+    node->index = -1;
+}
+
+zinline int ztimer_pending(ztimer_node_t *node){
+    return -1 != node->index;
+}
+
+/**
+ * @brief create the heap
+ * @param run_thread [in] ztrue start the ST timer thread
+ */
+ZAPI zerr_t ztimer_init(ztimer_t *timer, zbool_t run_thread);
+ZAPI void ztimer_fini(ztimer_t *timer);
+/** @brief (re)schedule <node> <timeout_us> from now */
+ZAPI zerr_t ztimer_add(ztimer_t *timer, ztimer_node_t *node, st_utime_t timeout_us,
+                       ztimer_cb_t cb, zptr_t hint);
+/** @brief cancel <node>, no-op when it is not scheduled */
+ZAPI void ztimer_del(ztimer_t *timer, ztimer_node_t *node);
+/**
+ * @brief run callbacks of nodes expired at <now>
+ * @return micro seconds to the next deadline, ST_UTIME_NO_TIMEOUT if none
+ */
+ZAPI st_utime_t ztimer_expire(ztimer_t *timer, st_utime_t now);
+
+ZC_END
+
+#endif /*_ZCOM_TIMER_H_*/
@@ -0,0 +1,128 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_TLS_H_
+#define _ZCOM_TLS_H_
+
+/**
+ * @file tls.h
+ * @brief TLS links with kernel TLS offload
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Offload
+ *      OpenSSL runs the handshake in userspace, then installs the session
+ *      keys into the kernel (setsockopt TCP_ULP "tls" + TLS_TX/TLS_RX) when
+ *      the kernel and cipher allow it. From then on records are built by
+ *      the kernel: ztls_send() is a plain write and ztls_sendfile() a real
+ *      sendfile(), nothing is copied to userspace.
+ * @par Fallback
+ *      Without kTLS (module missing, cipher unsupported, disabled in cfg)
+ *      the same calls encrypt in userspace; ztls_sendfile() then reads the
+ *      file through a buffer. tls->ktls_tx/ktls_rx tell which path is live.
+ * @par Non-blocking
+ *      ztls_handshake(), ztls_send() and ztls_recv() return ZEAGAIN with
+ *      tls->want set to POLLIN or POLLOUT, wait for it on the socket with
+ *      st_netfd_poll() in an ST thread or poll() in an OS thread.
+ *      ztls_trans() binds a link to ztrans_t.
+ * @par Link
+ *      -DZNT_HAVE_OPENSSL -lssl -lcrypto; without it every link fails with
+ *      ZEFAIL. Offload needs OpenSSL 3 built with kTLS (SSL_OP_ENABLE_KTLS),
+ *      older versions always run in userspace.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <sys/types.h>
+#include <znt/com/socket.h>
+#include <znt/com/transport.h>
+
+ZC_BEGIN
+
+#define ZTLS_FILE_BUF (64 * 1024) /** software sendfile chunk */
+
+typedef struct ztls_cfg_s{
+    const char *cert; /** PEM certificate chain file, required on servers */
+    const char *key; /** PEM private key file */
+    const char *ca; /** PEM CA file, peers must verify against it; NULL no verify */
+    const char *ciphers; /** TLS 1.2 list, NULL kTLS friendly AES-GCM/CHACHA20 */
+    int ktls; /** try kernel offload */
+}ztls_cfg_t;
+
+typedef struct ztls_ctx_s{
+    zptr_t ssl_ctx; /** SSL_CTX */
+    int server;
+    int ktls;
+}ztls_ctx_t;
+
+typedef struct ztls_s{
+    zptr_t ssl; /** SSL */
+    zsock_t sock;
+    short want; /** POLLIN/POLLOUT after ZEAGAIN */
+    uint8_t established;
+    uint8_t ktls_tx; /** kernel encrypts sends */
+    uint8_t ktls_rx; /** kernel decrypts receives */
+    char *file_buf; /** software sendfile buffer */
+    /* statistic */
+    uint64_t bytes_out;
+    uint64_t bytes_in;
+    uint64_t sendfile_bytes; /** bytes sent from files */
+}ztls_t;
+
+ZAPI void ztls_cfg_default(ztls_cfg_t *cfg);
+ZAPI zerr_t ztls_ctx_init(ztls_ctx_t *ctx, int server, const ztls_cfg_t *cfg);
+ZAPI void ztls_ctx_fini(ztls_ctx_t *ctx);
+/** @brief attach TLS to a connected non-blocking socket, the link owns it after */
+ZAPI zerr_t ztls_init(ztls_t *tls, ztls_ctx_t *ctx, zsock_t sock);
+/** @brief close_notify, free the session and close the socket */
+ZAPI void ztls_fini(ztls_t *tls);
+/**
+ * @brief advance the handshake
+ * @retval ZEOK established, kTLS installed when possible
+ * @retval ZEAGAIN wait for tls->want
+ * @retval ZEFAIL handshake or verification failed
+ */
+ZAPI zerr_t ztls_handshake(ztls_t *tls);
+/** @brief drive the handshake with poll(), up to <timeout_ms> */
+ZAPI zerr_t ztls_handshake_wait(ztls_t *tls, int timeout_ms);
+/** @brief zsend() contract: ZEOK all sent, ZEAGAIN *len accepted, ZEFAIL */
+ZAPI zerr_t ztls_send(ztls_t *tls, const char *buf, int *len);
+/** @brief zrecv() contract: >0 bytes, 0 peer closed, ZEAGAIN, ZEFAIL */
+ZAPI zerr_t ztls_recv(ztls_t *tls, char *buf, int len);
+/**
+ * @brief send <size> bytes of <fd> from <offset>
+ * @return bytes sent (may be short on a full socket), ZEAGAIN none, ZEFAIL
+ */
+ZAPI ssize_t ztls_sendfile(ztls_t *tls, int fd, off_t offset, size_t size);
+
+/** @brief ztrans_t binding, ctx is the ztls_t */
+ZAPI const ztrans_ops_t ztrans_tls_ops;
+
+zinline void ztrans_tls(ztrans_t *trans, ztls_t *tls){
+    trans->ops = &ztrans_tls_ops;
+    trans->ctx = (zptr_t)tls;
+}
+
+ZC_END
+
+#endif /*_ZCOM_TLS_H_*/
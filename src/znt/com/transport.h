@@ -0,0 +1,92 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_TRANSPORT_H_
+#define _ZCOM_TRANSPORT_H_
+
+/**
+ * @file transport.h
+ * @brief Uniform send/receive surface over sockets and local transports
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Semantics
+ *      send/recv keep the zsend()/zrecv() contract:
+ *      - send: ZEOK all bytes accepted, ZEAGAIN no room (*len = accepted), ZEFAIL
+ *      - recv: >0 bytes, 0 peer closed, ZEAGAIN nothing ready, ZEFAIL
+ *      fileno() returns a descriptor that becomes readable when recv() may
+ *      succeed, so callers can wait with zselect() or st_netfd_poll().
+ */
+#include <zsi/base/type.h>
+#include <znt/com/socket.h>
+
+ZC_BEGIN
+
+typedef struct ztrans_ops_s{
+    const char *name; /** transport name, "tcp", "shm" ... */
+    zerr_t (*send)(zptr_t ctx, const char *buf, int *len, int flags);
+    zerr_t (*recv)(zptr_t ctx, char *buf, int len, int flags);
+    zerr_t (*flush)(zptr_t ctx); /** publish data staged with MSG_MORE */
+    int (*fileno)(zptr_t ctx); /** readable descriptor for polling */
+    zerr_t (*close)(zptr_t ctx);
+}ztrans_ops_t;
+
+typedef struct ztrans_s{
+    const ztrans_ops_t *ops;
+    zptr_t ctx;
+}ztrans_t;
+
+/** socket binding, ctx is the zsock_t itself */
+ZAPI const ztrans_ops_t ztrans_sock_ops;
+
+zinline void ztrans_sock(ztrans_t *trans, zsock_t sock){
+    trans->ops = &ztrans_sock_ops;
+    trans->ctx = (zptr_t)(intptr_t)sock;
+}
+
+zinline zerr_t ztrans_send(ztrans_t *trans, const char *buf, int *len, int flags){
+    return trans->ops->send(trans->ctx, buf, len, flags);
+}
+
+zinline zerr_t ztrans_recv(ztrans_t *trans, char *buf, int len, int flags){
+    return trans->ops->recv(trans->ctx, buf, len, flags);
+}
+
+zinline zerr_t ztrans_flush(ztrans_t *trans){
+    return trans->ops->flush ? trans->ops->flush(trans->ctx) : ZEOK;
+}
+
+zinline int ztrans_fileno(ztrans_t *trans){
+    return trans->ops->fileno(trans->ctx);
+}
+
+zinline zerr_t ztrans_close(ztrans_t *trans){
+    zerr_t ret = trans->ops->close(trans->ctx);
+    trans->ctx = NULL;
+    return ret;
+}
+
+ZC_END
+
+#endif /*_ZCOM_TRANSPORT_H_*/
@@ -0,0 +1,104 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZCOM_WSPOOL_H_
+#define _ZCOM_WSPOOL_H_
+
+/**
+ * @file wspool.h
+ * @brief Work-stealing thread pool for offloading ST request handlers
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Model
+ *      - each worker owns a Chase-Lev deque: the owner pushes/pops at the
+ *        bottom (LIFO, hot cache), thieves take from the top (FIFO, oldest)
+ *      - tasks submitted from outside the pool land in the inbox (zmbox_t)
+ *        of a worker chosen round robin
+ *      - a worker without work sleeps on its inbox doorbell and a private
+ *        eventfd, spawners wake one sleeper so new work gets stolen
+ * @par ST integration
+ *      A completion hub lives in each ST scheduler, finished tasks are pushed
+ *      to its mailbox and a hub st_thread signals the waiting coroutine, so
+ *      zwsp_call() blocks the calling coroutine, never the scheduler.
+ *      @code
+ *      hub = zwsp_hub_create(); // once per ST scheduler, after zst_init()
+ *      ret = zwsp_call(pool, hub, heavy_handler, req, &rep, NULL);
+ *      @endcode
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/com/mailbox.h>
+#include <znt/com/state_threads.h>
+
+ZC_BEGIN
+
+typedef struct zwsp_pool_s zwsp_pool_t;
+typedef struct zwsp_hub_s zwsp_hub_t;
+
+typedef struct zwsp_task_s{
+    zoperate op; /** handler, called as op(in, &out, hint) on a worker */
+    zptr_t in;
+    zptr_t out;
+    zptr_t hint;
+    zerr_t ret; /** op return value */
+    zwsp_hub_t *hub; /** completion hub, NULL for fire and forget */
+    st_cond_t cond; /** signaled by the hub */
+    volatile int done;
+}zwsp_task_t;
+
+/**
+ * @brief create a pool
+ * @param workers [in] worker threads, <= 0 means one per online cpu
+ * @param deque_size [in] per-worker deque and inbox capacity
+ */
+ZAPI zwsp_pool_t *zwsp_create(int workers, uint32_t deque_size);
+/**
+ * @brief stop workers after the queued tasks are done
+ * @note tasks whose submit raced with the stop run on the calling thread
+ */
+ZAPI void zwsp_destroy(zwsp_pool_t *pool);
+/**
+ * @brief submit a task from any thread
+ * @note on a worker of <pool> the task is pushed to the local deque.
+ *       With hub == NULL the pool never touches the task after op returns,
+ *       so op may release it.
+ * @retval ZEAGAIN all inboxes are full, or the hub already waits for as
+ *         many tasks as its mailbox holds
+ * @retval ZEFAIL the pool is being destroyed
+ */
+ZAPI zerr_t zwsp_submit(zwsp_pool_t *pool, zwsp_task_t *task);
+
+/** @brief create the completion hub of the calling ST scheduler */
+ZAPI zwsp_hub_t *zwsp_hub_create(void);
+ZAPI void zwsp_hub_destroy(zwsp_hub_t *hub);
+/** @brief block the calling st_thread until <task> submitted with <hub> is done */
+ZAPI zerr_t zwsp_await(zwsp_task_t *task);
+/** @brief run op(in, out, hint) on the pool and wait in the calling st_thread */
+ZAPI zerr_t zwsp_call(zwsp_pool_t *pool, zwsp_hub_t *hub, zoperate op,
+                      zptr_t in, zptr_t *out, zptr_t hint);
+
+ZC_END
+
+#endif /*_ZCOM_WSPOOL_H_*/
@@ -0,0 +1,150 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTOPO_FANOUT_H_
+#define _ZTOPO_FANOUT_H_
+
+/**
+ * @file fanout.h
+ * @brief Overlay fan-out tree for broadcasting to many nodes
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Tree
+ *      Members of the routing table are ordered by (zone, key). A node that
+ *      owns a range of that order splits it into at most <degree> contiguous
+ *      parts, cutting at zone boundaries when one is near, and forwards to
+ *      the first reachable member of each part, handing it the rest of the
+ *      part. Each node sends <degree> copies instead of the origin sending N,
+ *      the depth is log_degree(N) and subtrees stay inside one zone below the
+ *      top levels, so few copies cross zones.
+ * @par Views
+ *      Ranges travel as (zone, key) bounds, not indices; a node whose view
+ *      differs from its parent's still covers its whole range with the
+ *      members it knows.
+ * @par Pipelining
+ *      Payloads are cut into <chunk> byte frames, a node forwards each frame
+ *      to its children as soon as it arrives, so a large payload streams
+ *      through every level at once instead of being stored and forwarded.
+ * @par Frame (little-endian)
+ *      len:4 flags:2 hops:2 bid:8 origin:8 total:8 offset:8
+ *      lo_zone:4 hi_zone:4 lo_key:8 hi_key:8 payload
+ * @par Input
+ *      Frames share the node connections with other traffic, the reader of a
+ *      connection sizes a frame with zfanout_frame_len() and passes it whole
+ *      to zfanout_input(). A frame goes out under the send lock of its
+ *      connection, so frames of concurrent broadcasts never interleave; a
+ *      connection that fails mid-frame is closed and detached from its node.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/common/defines.h>
+#include <znt/com/transport.h>
+#include <znt/com/state_threads.h>
+#include <znt/topo/route.h>
+
+ZC_BEGIN
+
+#define ZFANOUT_HDR_SIZE 64
+#define ZFANOUT_DEGREE_MAX 32
+#define ZFANOUT_CHUNK (16 * 1024) /** default chunk size */
+#define ZFANOUT_LOCKS 16 /** send locks, striped by child connection */
+
+typedef struct zfanout_s zfanout_t;
+
+/** @brief locality of <node>, members of one zone form subtrees */
+typedef uint32_t (*zfanout_zone_t)(znt_node_t *node, zptr_t hint);
+/** @brief one chunk of broadcast <bid>, chunks arrive in offset order */
+typedef void (*zfanout_deliver_t)(zfanout_t *fanout, uint64_t bid, const char *data, int len,
+                                  uint64_t offset, uint64_t total, zptr_t hint);
+
+typedef struct zfanout_range_s{
+    uint32_t lo_zone; /** inclusive */
+    uint32_t hi_zone; /** exclusive unless open */
+    uint64_t lo_key;
+    uint64_t hi_key;
+    int open; /** no upper bound */
+}zfanout_range_t;
+
+typedef struct zfanout_child_s{
+    znt_node_t *node;
+    ztrans_t *conn;
+    zfanout_range_t range; /** handed to the child, includes itself */
+}zfanout_child_t;
+
+typedef struct zfanout_stream_s{
+    uint64_t bid;
+    uint64_t total;
+    uint16_t hops;
+    int nchild;
+    zfanout_child_t child[ZFANOUT_DEGREE_MAX];
+    struct zfanout_stream_s *next;
+}zfanout_stream_t;
+
+struct zfanout_s{
+    zroute_t *route; /** membership view */
+    uint64_t self_key; /** zroute_hash() of the local nid */
+    int degree;
+    int chunk;
+    uint64_t seq;
+    zfanout_zone_t zone;
+    zfanout_deliver_t deliver;
+    zptr_t hint;
+    zfanout_stream_t *streams; /** broadcasts in transit */
+    st_mutex_t locks[ZFANOUT_LOCKS]; /** one frame at a time per connection */
+    /* statistic */
+    uint64_t bcasts; /** broadcasts originated */
+    uint64_t chunks_in;
+    uint64_t chunks_out; /** frames sent to children */
+    uint64_t bytes_out;
+    uint64_t send_fails;
+    uint16_t max_hops; /** deepest level seen */
+};
+
+/**
+ * @param degree [in] children per node, 4 when <= 0
+ * @param chunk [in] frame payload size, ZFANOUT_CHUNK when <= 0
+ * @param zone [in] NULL puts every member in zone 0
+ */
+ZAPI zerr_t zfanout_init(zfanout_t *fanout, zroute_t *route, const znt_nid_t *self,
+                         int degree, int chunk, zfanout_zone_t zone,
+                         zfanout_deliver_t deliver, zptr_t hint);
+ZAPI void zfanout_fini(zfanout_t *fanout);
+/**
+ * @brief broadcast <data> to every member of the route
+ * @param bid [out] broadcast id, may be NULL
+ * @return ZEOK when every first level child got the payload
+ */
+ZAPI zerr_t zfanout_bcast(zfanout_t *fanout, const char *data, int len, uint64_t *bid);
+/**
+ * @brief handle one whole frame, deliver and forward it
+ * @retval ZEPARAM_INVALID not a complete fan-out frame
+ */
+ZAPI zerr_t zfanout_input(zfanout_t *fanout, const char *frame, int len);
+/** @return size of the frame starting with header <hdr> */
+ZAPI int zfanout_frame_len(const char *hdr);
+
+ZC_END
+
+#endif /*_ZTOPO_FANOUT_H_*/
@@ -0,0 +1,162 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTOPO_GOSSIP_H_
+#define _ZTOPO_GOSSIP_H_
+
+/**
+ * @file gossip.h
+ * @brief SWIM membership and failure detection over UDP
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Failure detection
+ *      Every <period_ms> a member pings the next member of a shuffled
+ *      round; without an ack in <ping_timeout_ms> it asks <indirect> other
+ *      members to ping on its behalf (ping-req). No ack by the end of the
+ *      period makes the target SUSPECT, a suspect that does not refute with a
+ *      higher incarnation in suspect_mult * log2(n) periods becomes DEAD.
+ *      A DEAD member lingers reap_mult * log2(n) periods, long enough for the
+ *      DEAD update to spread and stale ALIVE updates to die out, then it is
+ *      forgotten and freed; do not keep member pointers past the DEAD change.
+ * @par Dissemination
+ *      State changes are piggybacked on pings and acks, least sent first,
+ *      each retransmitted retransmit_mult * log2(n) times, which spreads an
+ *      update in O(log n) periods. A member sends one ping per period plus
+ *      ping-req traffic, every datagram is at most ZGOSSIP_MTU bytes, so the
+ *      bandwidth per member is bounded whatever the cluster size.
+ * @par Join
+ *      zgossip_join() pings a seed with a JOIN flag, the seed answers with
+ *      SYNC datagrams carrying its member list.
+ * @par Threads
+ *      A receiver and a prober st_thread per instance, many instances can
+ *      share one ST scheduler, which is how the test runs a cluster on
+ *      loopback in one process.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/common/defines.h>
+#include <znt/com/socket.h>
+#include <znt/com/state_threads.h>
+#include <znt/com/timer.h>
+
+ZC_BEGIN
+
+#define ZGOSSIP_MTU 1400
+#define ZGOSSIP_ID_MAX 64
+#define ZGOSSIP_BUCKETS 1024
+
+#define ZMEMBER_ALIVE 0
+#define ZMEMBER_SUSPECT 1
+#define ZMEMBER_DEAD 2
+
+typedef struct zgossip_s zgossip_t;
+
+typedef struct zgossip_member_s{
+    znt_nid_t nid; /** id points to <idbuf> */
+    char idbuf[ZGOSSIP_ID_MAX];
+    zsockaddr_in addr;
+    uint32_t inc; /** incarnation */
+    int state; /** ZMEMBER_* */
+    ztimer_node_t suspect; /** suspicion timeout, reap timeout once DEAD */
+    zgossip_t *gossip;
+    struct zgossip_member_s *next; /** hash chain */
+}zgossip_member_t;
+
+/** membership change callback, runs in the receiver or timer st_thread */
+typedef void (*zgossip_change_t)(zgossip_t *gossip, zgossip_member_t *member,
+                                 int old_state, zptr_t hint);
+
+typedef struct zgossip_cfg_s{
+    int period_ms; /** protocol period */
+    int ping_timeout_ms; /** direct ping timeout */
+    int indirect; /** ping-req fan-out */
+    int suspect_mult; /** suspicion timeout = suspect_mult * log2(n) periods */
+    int retransmit_mult; /** piggyback count = retransmit_mult * log2(n) */
+    int reap_mult; /** DEAD linger = reap_mult * log2(n) periods, 2 at least */
+}zgossip_cfg_t;
+
+typedef struct zgossip_update_s{
+    zgossip_member_t *member;
+    int state;
+    uint32_t inc;
+    int sent;
+}zgossip_update_t;
+
+struct zgossip_s{
+    zgossip_cfg_t cfg;
+    zgossip_member_t self;
+    zsock_t sock;
+    st_netfd_t stfd;
+    ztimer_t *timer;
+    zgossip_member_t *buckets[ZGOSSIP_BUCKETS];
+    zgossip_member_t **members; /** every known member but self */
+    int nmembers;
+    int cap;
+    int nalive; /** ALIVE + SUSPECT, self excluded */
+    int probe_idx; /** position in the shuffled round */
+    zgossip_update_t *updates; /** piggyback queue */
+    int nupdates;
+    int ucap;
+    uint32_t seq;
+    uint32_t probe_seq; /** seq of the outstanding probe */
+    int acked;
+    st_cond_t ack_cond;
+    struct{
+        uint32_t seq; /** seq we used, 0 when free */
+        uint32_t orig_seq; /** seq of the requester */
+        zsockaddr_in requester;
+    }relay[16]; /** ping-req relays in flight */
+    int relay_idx;
+    unsigned int rand_seed;
+    st_thread_t receiver;
+    st_thread_t prober;
+    int stop;
+    zgossip_change_t on_change;
+    zptr_t hint;
+    /* statistic */
+    uint64_t tx_msgs;
+    uint64_t tx_bytes;
+    uint64_t rx_msgs;
+    uint64_t rx_bytes;
+};
+
+ZAPI void zgossip_cfg_default(zgossip_cfg_t *cfg);
+/**
+ * @brief bind a UDP socket on host:port and start the st_threads
+ * @param cfg [in] NULL for zgossip_cfg_default()
+ * @param timer [in] suspicion timeouts, a running ztimer_t of the scheduler
+ */
+ZAPI zgossip_t *zgossip_create(const znt_nid_t *nid, const char *host, uint16_t port,
+                               const zgossip_cfg_t *cfg, ztimer_t *timer,
+                               zgossip_change_t on_change, zptr_t hint);
+/** @brief stop silently, peers will detect the failure */
+ZAPI void zgossip_destroy(zgossip_t *gossip);
+/** @brief join the cluster through a seed member */
+ZAPI zerr_t zgossip_join(zgossip_t *gossip, const char *host, uint16_t port);
+ZAPI zgossip_member_t *zgossip_find(zgossip_t *gossip, const char *id, int len);
+
+ZC_END
+
+#endif /*_ZTOPO_GOSSIP_H_*/
@@ -0,0 +1,166 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTOPO_ROUTE_H_
+#define _ZTOPO_ROUTE_H_
+
+/**
+ * @file route.h
+ * @brief Node topology routing table with consistent-hash placement
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par Placement
+ *      Every node owns weight * ZROUTE_VNODES points on a 64-bit hash ring,
+ *      a key belongs to the first point at or after its hash.
+ * @par Lookup
+ *      The ring is bucketized into a table of 2^bits slots, a slot that no
+ *      ring point splits caches its single owner, so most routes are one
+ *      hash and one array load. Keys of a split slot search the ring, thus
+ *      placement is the exact ring successor whatever the table size. The
+ *      table grows with membership to keep two slots per ring point, up to
+ *      2^22 slots.
+ * @par Rebalance
+ *      zroute_join()/zroute_leave() only edit the ring; the table is refreshed
+ *      by zroute_rebalance() a bounded number of slots at a time, so a large
+ *      table never stalls the loop. Until then lookups keep the old owner,
+ *      except for leaving nodes, which fall back to a ring search. Leaving
+ *      nodes are released when the refresh completes.
+ */
+#include <zsi/base/type.h>
+#include <zsi/base/error.h>
+#include <znt/common/defines.h>
+#include <znt/com/transport.h>
+
+ZC_BEGIN
+
+#define ZROUTE_VNODES 160 /** ring points per unit of weight */
+#define ZROUTE_CONNS 4 /** pooled connections per node */
+
+#define ZNODE_UP 0
+#define ZNODE_LEAVING 1
+
+typedef struct znt_node_s{
+    znt_nid_t nid; /** node identification, copied */
+    uint64_t key; /** hash of nid */
+    int weight;
+    int state; /** ZNODE_UP/ZNODE_LEAVING */
+    ztrans_t *conns[ZROUTE_CONNS]; /** pooled connections */
+    int nconns;
+    uint32_t rr; /** connection round robin */
+    zptr_t hint; /** user data */
+    struct znt_node_s *next_leaving;
+}znt_node_t;
+
+typedef struct zroute_vnode_s{
+    uint64_t hash;
+    znt_node_t *node;
+}zroute_vnode_t;
+
+typedef struct zroute_s{
+    znt_node_t **nodes; /** members, UP only */
+    int nnodes;
+    int cap;
+    zroute_vnode_t *ring; /** sorted by hash */
+    int nring;
+    znt_node_t **table; /** 1 << bits slots, NULL when split by a ring point */
+    int bits;
+    znt_node_t *leaving; /** released after the refresh */
+    uint32_t refresh_pos; /** next slot to refresh */
+    int refresh_vnode; /** ring cursor of refresh_pos */
+    int refreshing;
+    uint64_t version; /** membership version */
+    /* statistic */
+    uint64_t moved; /** slots that changed owner */
+    uint64_t fallbacks; /** lookups that searched the ring */
+}zroute_t;
+
+/** @brief 64-bit hash used for keys and node ids */
+ZAPI uint64_t zroute_hash(const char *key, int len);
+
+/**
+ * @param bits [in] initial table size 2^bits, 16 when <= 0, at most 22
+ */
+ZAPI zerr_t zroute_init(zroute_t *route, int bits);
+ZAPI void zroute_fini(zroute_t *route);
+/** @brief add a member, the table catches up in zroute_rebalance() */
+ZAPI znt_node_t *zroute_join(zroute_t *route, const znt_nid_t *nid, int weight);
+/**
+ * @brief add <cnt> members with one merge of the ring, building a large
+ *        view by zroute_join() costs a ring merge per member
+ * @param joined [out] the new nodes, may be NULL; entries are NULL when
+ *        the batch is rolled back
+ * @return members added, the batch stops at a duplicate, 0 when out of
+ *         memory
+ */
+ZAPI int zroute_join_many(zroute_t *route, const znt_nid_t *nids, int cnt, int weight,
+                          znt_node_t **joined);
+/** @brief remove a member, <node> stays valid until the refresh completes */
+ZAPI zerr_t zroute_leave(zroute_t *route, znt_node_t *node);
+ZAPI znt_node_t *zroute_find(zroute_t *route, const znt_nid_t *nid);
+/**
+ * @brief refresh at most <budget> table slots
+ * @return slots left to refresh, 0 when the table matches the ring
+ */
+ZAPI uint32_t zroute_rebalance(zroute_t *route, uint32_t budget);
+/** @brief successor of ring position <hash>, O(log n) */
+ZAPI znt_node_t *zroute_owner(zroute_t *route, uint64_t hash);
+/** @brief attach a pooled connection to <node> */
+ZAPI zerr_t zroute_attach(znt_node_t *node, ztrans_t *conn);
+ZAPI void zroute_detach(znt_node_t *node, ztrans_t *conn);
+
+/**
+ * @brief owner of <hash>
+ * @note one array load for an unsplit slot, a ring search, O(log n), for a
+ *       split slot or a node that is not up
+ */
+zinline znt_node_t *zroute_lookup_hash(zroute_t *route, uint64_t hash){
+    znt_node_t *node;
+    if(!route->table || !route->nring){
+        return NULL;
+    }
+    node = route->table[hash >> (64 - route->bits)];
+    if(!node || ZNODE_UP != node->state){
+        ++route->fallbacks;
+        node = zroute_owner(route, hash);
+    }
+    return node;
+}
+
+zinline znt_node_t *zroute_lookup(zroute_t *route, const char *key, int len){
+    return zroute_lookup_hash(route, zroute_hash(key, len));
+}
+
+/** @brief pooled connection to the owner of <key>, NULL if none */
+zinline ztrans_t *zroute_conn(zroute_t *route, const char *key, int len){
+    znt_node_t *node = zroute_lookup(route, key, len);
+    if(!node || !node->nconns){
+        return NULL;
+    }
+    return node->conns[node->rr++ % node->nconns];
+}
+
+ZC_END
+
+#endif /*_ZTOPO_ROUTE_H_*/
@@ -30,7 +30,7 @@
  *
  * @zmake.build on;
  * @zmake.install off;
- * @zmake.link -lst -lzsi -pthread;
+ * @zmake.link -lst -lzsi -lssl -lcrypto -pthread;
  * @zmake.app znt;
  */
 #include <stdio.h>
@@ -43,6 +43,30 @@
 
 #include "tst_socket.h"
 #include "tst_state_threads.h"
+#include "tst_shm_ring.h"
+#include "tst_mailbox.h"
+#include "tst_wspool.h"
+#include "tst_cork.h"
+#include "tst_rpc.h"
+#include "tst_route.h"
+#include "tst_gossip.h"
+#include "tst_fanout.h"
+#include "tst_pubsub.h"
+#include "tst_flow.h"
+#include "tst_admit.h"
+#include "tst_busypoll.h"
+#include "tst_place.h"
+#include "tst_resolv.h"
+#include "tst_eyeballs.h"
+#include "tst_schema.h"
+#include "tst_comp.h"
+#include "tst_tls.h"
+#include "tst_stprof.h"
+#include "tst_evtrace.h"
+#include "tst_hotrestart.h"
+#include "tst_capture.h"
+#include "tst_mlog.h"
+#include "tst_netsim.h"
 
 static void zprint_help();
 static void ztrace2znt(const char *msg, int msg_len, zptr_t hint);
@@ -100,6 +124,30 @@ static void ztrace2znt(const char *msg, int msg_len, zptr_t hint){
 #define ZREG_MIS(key) zitac_reg_mission(itac, #key, strlen(#key), tu_##key, tc_##key)
 static void zregister_mission(zitac_t itac){
     ZREG_MIS(socket);
+    ZREG_MIS(shm_ring);
+    ZREG_MIS(mailbox);
+    ZREG_MIS(wspool);
+    ZREG_MIS(cork);
+    ZREG_MIS(rpc);
+    ZREG_MIS(route);
+    ZREG_MIS(gossip);
+    ZREG_MIS(fanout);
+    ZREG_MIS(pubsub);
+    ZREG_MIS(flow);
+    ZREG_MIS(admit);
+    ZREG_MIS(busypoll);
+    ZREG_MIS(place);
+    ZREG_MIS(resolv);
+    ZREG_MIS(eyeballs);
+    ZREG_MIS(schema);
+    ZREG_MIS(comp);
+    ZREG_MIS(tls);
+    ZREG_MIS(stprof);
+    ZREG_MIS(evtrace);
+    ZREG_MIS(hotrestart);
+    ZREG_MIS(capture);
+    ZREG_MIS(mlog);
+    ZREG_MIS(netsim);
 }
 
 static void zprint_help(){
@@ -0,0 +1,207 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_admit.c
+ * @brief admission control test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/admit.h>
+
+#define TC_ADMIT_DEPTH 100
+#define TC_ADMIT_PEER_ADDR "127.0.0.2" /** peers connect from here */
+
+typedef struct tc_admit_s{
+    zsockaddr_in addr;
+    int depth; /** simulated queue depth */
+    int ok[2]; /** answered, by class */
+    int busy[2]; /** rejected, by class */
+}tc_admit_t;
+
+typedef struct tc_admit_client_s{
+    tc_admit_t *tc;
+    int cls;
+}tc_admit_client_t;
+
+static int tc_admit_classify(const zsockaddr_in *addr, zptr_t hint){
+    zsockaddr_in peer;
+    zinet_addr(&peer, TC_ADMIT_PEER_ADDR, 0);
+    return addr->sin_addr.s_addr == peer.sin_addr.s_addr ? ZADMIT_PEER : ZADMIT_CLIENT;
+}
+
+static int tc_admit_depth(zptr_t hint){
+    return ((tc_admit_t*)hint)->depth;
+}
+
+static void tc_admit_accept(zsock_t sock, const zsockaddr_in *addr, int cls, zptr_t hint){
+    send(sock, "ok", 2, MSG_NOSIGNAL);
+    zsockclose(sock);
+}
+
+static zptr_t tc_admit_client(zptr_t arg){
+    tc_admit_client_t *client = (tc_admit_client_t*)arg;
+    tc_admit_t *tc = client->tc;
+    zsockaddr_in local;
+    st_netfd_t stfd = NULL;
+    zsock_t sock;
+    char buf[8];
+    int len;
+
+    if(ZINVALID_SOCKET == (sock = zsocket(AF_INET, SOCK_STREAM, 0))){
+        return NULL;
+    }
+    if(ZADMIT_PEER == client->cls){
+        zinet_addr(&local, TC_ADMIT_PEER_ADDR, 0);
+        zbind(sock, (ZSA*)&local, sizeof(local));
+    }
+    if((stfd = zst_socket(sock)) &&
+       0 == st_connect(stfd, (ZSA*)&tc->addr, sizeof(tc->addr), 1000000) &&
+       (len = (int)st_read(stfd, buf, sizeof(buf), 1000000)) > 0){
+        if(2 == len && 0 == memcmp(buf, "ok", 2)){
+            ++tc->ok[client->cls];
+        }else{
+            ++tc->busy[client->cls];
+        }
+    }
+    if(stfd){
+        st_netfd_close(stfd);
+    }else{
+        zsockclose(sock);
+    }
+    return NULL;
+}
+
+static void tc_admit_storm(tc_admit_t *tc, int clients){
+    tc_admit_client_t *args = calloc(clients, sizeof(tc_admit_client_t));
+    st_thread_t *thrs = calloc(clients, sizeof(st_thread_t));
+    int i;
+
+    memset(tc->ok, 0, sizeof(tc->ok));
+    memset(tc->busy, 0, sizeof(tc->busy));
+    for(i = 0; i < clients; ++i){
+        args[i].tc = tc;
+        args[i].cls = i & 1 ? ZADMIT_PEER : ZADMIT_CLIENT;
+        thrs[i] = zst_thread_create(tc_admit_client, &args[i], ztrue, 0);
+    }
+    for(i = 0; i < clients; ++i){
+        zst_thread_join(thrs[i]);
+    }
+    free(thrs);
+    free(args);
+}
+
+zerr_t tu_admit(zop_arg){
+    printf("# admit <port> <clients>\n");
+    return ZEOK;
+}
+
+zerr_t tc_admit(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    tc_admit_t tc;
+    zadmit_cfg_t cfg;
+    zsockopt_t opts;
+    zadmit_t *admit = NULL;
+    zsock_t sock;
+    int reuse = 1;
+    int port, clients, half;
+
+    if(3 != argc || (port = atoi(argv[1])) <= 0 || (clients = atoi(argv[2])) < 2){
+        tu_admit(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    half = clients / 2;
+    memset(&tc, 0, sizeof(tc));
+    zst_init(NULL, NULL);
+    zinet_addr(&tc.addr, "127.0.0.1", (uint16_t)port);
+    sock = zsocket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if(ZEOK != zbind(sock, (ZSA*)&tc.addr, sizeof(tc.addr))){
+        zsockclose(sock);
+        return ZEFAIL;
+    }
+    zadmit_cfg_default(&cfg);
+    cfg.max_depth = TC_ADMIT_DEPTH;
+    cfg.max_lag_us = 1000000; /* keep lag out of the picture on a loaded box */
+    cfg.reject = "busy";
+    cfg.reject_len = 4;
+    zsockopt_init(&opts);
+    zsockopt_tcp(&opts, 1, 0, 0, 30, 10000);
+    cfg.opts = &opts;
+    if(!(admit = zadmit_create(sock, &cfg, tc_admit_classify, tc_admit_depth,
+                               tc_admit_accept, &tc))){
+        zsockclose(sock);
+        return ZEFAIL;
+    }
+
+    /* open: everyone admitted */
+    tc_admit_storm(&tc, clients);
+    zinf("\nopen  clients<ok:%d busy:%d> peers<ok:%d busy:%d>",
+         tc.ok[0], tc.busy[0], tc.ok[1], tc.busy[1]);
+    if(tc.ok[ZADMIT_CLIENT] != clients - half || tc.ok[ZADMIT_PEER] != half){
+        ret = ZEFAIL;
+    }
+
+    /* shed: peers admitted, clients answered busy */
+    tc.depth = TC_ADMIT_DEPTH * 12 / 10;
+    zadmit_update(admit);
+    tc_admit_storm(&tc, clients);
+    zinf("\nshed  clients<ok:%d busy:%d> peers<ok:%d busy:%d>",
+         tc.ok[0], tc.busy[0], tc.ok[1], tc.busy[1]);
+    if(tc.busy[ZADMIT_CLIENT] != clients - half || tc.ok[ZADMIT_PEER] != half){
+        ret = ZEFAIL;
+    }
+
+    /* pause, then step down through the hysteresis */
+    tc.depth = TC_ADMIT_DEPTH * 2;
+    if(ZADMIT_PAUSE != zadmit_update(admit)){
+        ret = ZEFAIL;
+    }
+    tc.depth = TC_ADMIT_DEPTH * 9 / 10;
+    if(ZADMIT_SHED != zadmit_update(admit)){
+        ret = ZEFAIL;
+    }
+    tc.depth = 0;
+    if(ZADMIT_OPEN != zadmit_update(admit)){
+        ret = ZEFAIL;
+    }
+    zinf("\nadmitted:%llu peers:%llu rejected:%llu level:%d accepted/wakeup:%.2f",
+         (unsigned long long)admit->admitted, (unsigned long long)admit->admitted_peers,
+         (unsigned long long)admit->rejected, admit->level,
+         admit->wakeups ? (double)admit->accepted / admit->wakeups : .0);
+
+    zadmit_destroy(admit);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,160 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_busypoll.c
+ * @brief busy-poll wake-up latency test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/busypoll.h>
+
+typedef struct tc_bpoll_s{
+    zbpoll_t bp;
+    uint64_t *lat; /** wake-up latency, ns */
+    int cnt;
+    int max;
+}tc_bpoll_t;
+
+static uint64_t tc_bpoll_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void tc_bpoll_read(zbpoll_t *bp, zsock_t sock, const char *buf, int len, zptr_t hint){
+    tc_bpoll_t *tc = (tc_bpoll_t*)bp;
+    uint64_t now = tc_bpoll_ns();
+    uint64_t sent;
+
+    if(len == (int)sizeof(sent) && tc->cnt < tc->max){
+        memcpy(&sent, buf, sizeof(sent));
+        tc->lat[tc->cnt] = now - sent;
+        __atomic_store_n(&tc->cnt, tc->cnt + 1, __ATOMIC_RELEASE);
+    }
+}
+
+static zptr_t tc_bpoll_loop(zptr_t arg){
+    zbpoll_run(&((tc_bpoll_t*)arg)->bp);
+    return NULL;
+}
+
+static int tc_bpoll_cmp(const void *a, const void *b){
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/** @brief one run, <idle_us> 0 is the blocking loop */
+static zerr_t tc_bpoll_run(int msgs, int gap_us, int cpu, uint64_t idle_us, const char *mode){
+    tc_bpoll_t tc;
+    pthread_t thr;
+    struct timespec gap;
+    uint64_t now;
+    uint64_t sum = 0;
+    int sv[2];
+    int i;
+
+    memset(&tc, 0, sizeof(tc));
+    if(0 != socketpair(AF_UNIX, SOCK_DGRAM, 0, sv)){
+        return ZEFAIL;
+    }
+    tc.max = msgs;
+    tc.lat = calloc(msgs, sizeof(uint64_t));
+    zbpoll_init(&tc.bp, cpu, 50, idle_us);
+    zbpoll_add_sock(&tc.bp, sv[1], tc_bpoll_read, NULL);
+    pthread_create(&thr, NULL, tc_bpoll_loop, &tc);
+
+    gap.tv_sec = 0;
+    gap.tv_nsec = (long)gap_us * 1000;
+    for(i = 0; i < msgs; ++i){
+        nanosleep(&gap, NULL);
+        now = tc_bpoll_ns();
+        if(sizeof(now) != send(sv[0], &now, sizeof(now), 0)){
+            break;
+        }
+    }
+    /* let the loop take the last ones */
+    for(i = 0; i < 1000 && __atomic_load_n(&tc.cnt, __ATOMIC_ACQUIRE) < msgs; ++i){
+        gap.tv_nsec = 1000000;
+        nanosleep(&gap, NULL);
+    }
+    zbpoll_stop(&tc.bp);
+    pthread_join(thr, NULL);
+
+    for(i = 0; i < tc.cnt; ++i){
+        sum += tc.lat[i];
+    }
+    qsort(tc.lat, tc.cnt, sizeof(uint64_t), tc_bpoll_cmp);
+    if(tc.cnt){
+        zinf("\n%-8s msgs:%d avg:%lluns p50:%lluns p99:%lluns sleeps:%llu busy/loops:%llu/%llu",
+             mode, tc.cnt, (unsigned long long)(sum / tc.cnt),
+             (unsigned long long)tc.lat[tc.cnt / 2],
+             (unsigned long long)tc.lat[tc.cnt * 99 / 100],
+             (unsigned long long)tc.bp.sleeps, (unsigned long long)tc.bp.busy,
+             (unsigned long long)tc.bp.loops);
+    }
+    zbpoll_fini(&tc.bp);
+    close(sv[0]);
+    close(sv[1]);
+    free(tc.lat);
+    return tc.cnt == msgs ? ZEOK : ZEFAIL;
+}
+
+zerr_t tu_busypoll(zop_arg){
+    printf("# busypoll <messages> <gap:us> <cpu|-1>\n");
+    return ZEOK;
+}
+
+zerr_t tc_busypoll(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    int msgs, gap_us, cpu;
+
+    if(4 != argc || (msgs = atoi(argv[1])) <= 0 || (gap_us = atoi(argv[2])) < 0){
+        tu_busypoll(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    cpu = atoi(argv[3]);
+    if(ZEOK != tc_bpoll_run(msgs, gap_us, -1, 0, "blocking")){
+        ret = ZEFAIL;
+    }
+    /* spin for 10 gaps before falling back */
+    if(ZEOK != tc_bpoll_run(msgs, gap_us, cpu, (uint64_t)gap_us * 10 + 1000, "busypoll")){
+        ret = ZEFAIL;
+    }
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,267 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_capture.c
+ * @brief capture a load shape, replay it at 1x and faster
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/socket.h>
+#include <znt/com/capture.h>
+
+#define TC_CAP_FILE "/tmp/znt_tst_capture.zcap"
+#define TC_CAP_SESSIONS 256
+
+typedef struct tc_cap_sess_s{
+    zsock_t sock;
+    int fill;
+    char buf[4096];
+}tc_cap_sess_t;
+
+typedef struct tc_cap_s{
+    zsock_t listener;
+    zsockaddr_t addr;
+    int frames;
+    volatile int stop;
+}tc_cap_t;
+
+static void tc_cap_spin(int us){
+    struct timespec ts, now;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    do{
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }while((now.tv_sec - ts.tv_sec) * 1000000 + (now.tv_nsec - ts.tv_nsec) / 1000 < us);
+}
+
+/** @brief take the complete <len:4><payload> frames of a session */
+static int tc_cap_frames(tc_cap_sess_t *sess){
+    uint32_t len;
+    int n = 0, off = 0;
+
+    while(sess->fill - off >= 4 && (memcpy(&len, sess->buf + off, 4), sess->fill - off >= (int)len + 4)){
+        off += len + 4;
+        ++n;
+    }
+    memmove(sess->buf, sess->buf + off, sess->fill - off);
+    sess->fill -= off;
+    return n;
+}
+
+/** @brief the node: 50us of work per request frame, an 8 byte answer */
+static void *tc_cap_server(void *arg){
+    tc_cap_t *tc = (tc_cap_t*)arg;
+    struct pollfd pfds[TC_CAP_SESSIONS + 1];
+    tc_cap_sess_t *sess = (tc_cap_sess_t*)calloc(TC_CAP_SESSIONS, sizeof(tc_cap_sess_t));
+    int cnt = 0, i, n, len;
+    zsock_t sock;
+
+    while(!tc->stop){
+        for(i = 0; i < cnt; ++i){
+            pfds[i].fd = sess[i].sock;
+            pfds[i].events = POLLIN;
+        }
+        pfds[cnt].fd = tc->listener;
+        pfds[cnt].events = POLLIN;
+        poll(pfds, cnt + 1, 10);
+        for(i = 0; i < cnt; ++i){
+            if(!pfds[i].revents || ZEAGAIN == (len = zrecv(sess[i].sock, sess[i].buf + sess[i].fill,
+                                                           sizeof(sess[i].buf) - sess[i].fill, 0))){
+                continue;
+            }
+            if(len > 0){
+                sess[i].fill += len;
+                for(n = tc_cap_frames(&sess[i]); n > 0; --n){
+                    tc_cap_spin(50);
+                    len = 8;
+                    if(ZEOK != zsend(sess[i].sock, "answered", &len, 0)){
+                        break;
+                    }
+                }
+                if(!n){
+                    continue;
+                }
+            }
+            ZSOCK_CLOSE(sess[i].sock);
+        }
+        for(i = 0; i < cnt; ++i){
+            if(ZINVALID_SOCKET == sess[i].sock){
+                sess[i--] = sess[--cnt];
+            }
+        }
+        if(pfds[cnt].revents && cnt < TC_CAP_SESSIONS &&
+           ZINVALID_SOCKET != (sock = zaccept(tc->listener, NULL, NULL))){
+            setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &(int){1}, sizeof(int));
+            sess[cnt].sock = sock;
+            sess[cnt++].fill = 0;
+        }
+    }
+    for(i = 0; i < cnt; ++i){
+        zsockclose(sess[i].sock);
+    }
+    free(sess);
+    return NULL;
+}
+
+/** @brief one production client: bursts of quick requests between pauses */
+static void *tc_cap_client(void *arg){
+    tc_cap_t *tc = (tc_cap_t*)arg;
+    struct pollfd pfd;
+    unsigned seed = (unsigned)(uintptr_t)&pfd;
+    char buf[1024];
+    zsock_t sock;
+    uint32_t size;
+    int i, len;
+
+    memset(buf, 'c', sizeof(buf));
+    sock = zsocket(AF_INET, SOCK_STREAM, 0);
+    zsock_nonblock(sock, 0);
+    if(ZEOK != zconnect(sock, &tc->addr.sa, zsockaddr_len(&tc->addr))){
+        zsockclose(sock);
+        return NULL;
+    }
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &(int){1}, sizeof(int));
+    for(i = 0; i < tc->frames; ++i){
+        len = 64 + rand_r(&seed) % 960;
+        size = len - 4;
+        memcpy(buf, &size, 4);
+        if(ZEOK != zsend(sock, buf, &len, 0)){
+            break;
+        }
+        pfd.fd = sock;
+        pfd.events = POLLIN;
+        if(1 != poll(&pfd, 1, 1000) || 0 >= zrecv(sock, buf, sizeof(buf), 0)){
+            break;
+        }
+        usleep(i % 8 ? 200 : 5000 + rand_r(&seed) % 5000);
+    }
+    zsockclose(sock);
+    return NULL;
+}
+
+static void tc_cap_print(const char *title, const zcap_stat_t *st){
+    zinf("%-9s frames:%llu bytes:%llu conns:%u %llums %.0f frames/s "
+         "latency avg:%lluus p50:%lluus p99:%lluus (%llu answers) lag:%lluus", title,
+         (unsigned long long)st->frames, (unsigned long long)st->bytes, st->conns,
+         (unsigned long long)(st->duration_us / 1000),
+         st->duration_us ? st->frames * 1e6 / st->duration_us : 0.0,
+         (unsigned long long)st->lat_avg_us, (unsigned long long)st->lat_p50_us,
+         (unsigned long long)st->lat_p99_us, (unsigned long long)st->responses,
+         (unsigned long long)st->max_lag_us);
+}
+
+zerr_t tu_capture(zop_arg){
+    printf("# capture <conns> <frames> <speed>\n");
+    return ZEOK;
+}
+
+zerr_t tc_capture(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    tc_cap_t tc;
+    zcap_t cap;
+    zcap_stat_t base, real, fast;
+    pthread_t server, *clients;
+    socklen_t alen = sizeof(tc.addr);
+    char host[64];
+    uint16_t port;
+    double speed;
+    int conns, i;
+    zerr_t ret = ZEOK;
+
+    memset(&tc, 0, sizeof(tc));
+    if(4 != argc || (conns = atoi(argv[1])) <= 0 || conns > TC_CAP_SESSIONS ||
+       (tc.frames = atoi(argv[2])) <= 0 || (speed = atof(argv[3])) < 0){
+        tu_capture(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    tc.listener = zsocket(AF_INET, SOCK_STREAM, 0);
+    zinet_addrx(&tc.addr, "127.0.0.1", 0);
+    if(ZEOK != zbind(tc.listener, &tc.addr.sa, zsockaddr_len(&tc.addr)) ||
+       ZEOK != zlisten(tc.listener, 256)){
+        zsockclose(tc.listener);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    getsockname(tc.listener, &tc.addr.sa, &alen);
+    zinet_ntop(&tc.addr, host, sizeof(host), &port);
+    pthread_create(&server, NULL, tc_cap_server, &tc);
+
+    /* production: record what the node receives */
+    if(ZEOK != zcap_start(&cap, TC_CAP_FILE, 256 << 20)){
+        ret = ZEFAIL;
+        goto out;
+    }
+    clients = (pthread_t*)calloc(conns, sizeof(pthread_t));
+    for(i = 0; i < conns; ++i){
+        pthread_create(&clients[i], NULL, tc_cap_client, &tc);
+        usleep(1000);
+    }
+    for(i = 0; i < conns; ++i){
+        pthread_join(clients[i], NULL);
+    }
+    free(clients);
+    /* the node closes its ends after the clients */
+    usleep(50000);
+    zcap_stop(&cap);
+
+    zcap_baseline(TC_CAP_FILE, &base);
+    if(ZEOK != zcap_replay(TC_CAP_FILE, host, port, 1.0, &real) ||
+       ZEOK != zcap_replay(TC_CAP_FILE, host, port, speed, &fast)){
+        ret = ZEFAIL;
+    }
+    tc_cap_print("captured", &base);
+    tc_cap_print("replay 1x", &real);
+    if(speed > 0){
+        snprintf(host, sizeof(host), "replay %gx", speed);
+    }else{
+        strcpy(host, "unpaced");
+    }
+    tc_cap_print(host, &fast);
+    if(base.frames != (uint64_t)conns * tc.frames || real.frames != base.frames ||
+       fast.frames != base.frames || real.bytes != base.bytes ||
+       real.responses * 100 < real.frames * 99){
+        ret = ZEFAIL;
+    }
+ out:
+    tc.stop = 1;
+    pthread_join(server, NULL);
+    zsockclose(tc.listener);
+    unlink(TC_CAP_FILE);
+    zerrno(ret);
+    return ret;
+}
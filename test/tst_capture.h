@@ -0,0 +1,48 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_CAPTURE_H_
+#define _ZTST_CAPTURE_H_
+
+/**
+ * @file tst_capture.h
+ * @brief capture a load shape, replay it at 1x and faster
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par capture
+ *      - capture <conns> <frames> <speed>
+ *        a loopback node answers each <len:4> framed request after 50us;
+ *        <conns> clients send <frames> requests of 64..1023 bytes, each
+ *        waiting for its answer, in bursts of 8 with
+ *        5-10ms pauses while the node is captured, then the capture is
+ *        replayed at 1x and at <speed>x (0 unpaced) against the node and
+ *        throughput and latency are printed next to the recorded ones.
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_capture(zop_arg);
+zerr_t tc_capture(zop_arg);
+
+#endif /*_ZTST_CAPTURE_H_*/
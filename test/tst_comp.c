@@ -0,0 +1,171 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_comp.c
+ * @brief adaptive link compression test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/comp.h>
+
+#define TC_COMP_SAMPLES 16
+
+/** @brief replication-like record: repetitive keys, varying values */
+static int tc_comp_record(char *buf, int cap, int seq){
+    int len = 0;
+
+    while(len < cap - 96){
+        len += snprintf(buf + len, cap - len,
+                        "{\"table\":\"orders\",\"op\":\"upsert\",\"key\":%d,"
+                        "\"qty\":%d,\"status\":\"%s\"}\n",
+                        seq, seq * 7 % 1000, seq & 1 ? "filled" : "open");
+        ++seq;
+    }
+    return len;
+}
+
+static void tc_comp_random(char *buf, int len, uint32_t *seed){
+    int i;
+
+    for(i = 0; i < len; ++i){
+        *seed = *seed * 1103515245 + 12345;
+        buf[i] = (char)(*seed >> 16);
+    }
+}
+
+/** @brief connect two links, run <frames> of <kind> through both ways */
+static zerr_t tc_comp_link(const char *title, zcomp_cfg_t *cfg_a, zcomp_cfg_t *cfg_b,
+                           int frames, int size, int random){
+    zcomp_t a, b;
+    char hello[ZCOMP_HELLO_SIZE];
+    char *raw = malloc(size);
+    char *wire = malloc(zcomp_bound(size));
+    char *back = malloc(size);
+    uint32_t seed = 7;
+    zerr_t ret = ZEOK;
+    int i, len, n;
+
+    zcomp_init(&a, cfg_a);
+    zcomp_init(&b, cfg_b);
+    zcomp_hello(&b, hello);
+    zcomp_accept(&a, hello, sizeof(hello));
+    zcomp_hello(&a, hello);
+    zcomp_accept(&b, hello, sizeof(hello));
+
+    for(i = 0; i < frames && ZEOK == ret; ++i){
+        if(random){
+            len = size;
+            tc_comp_random(raw, len, &seed);
+        }else{
+            len = tc_comp_record(raw, size, i * 1000);
+        }
+        n = zcomp_pack(&a, raw, len, wire, zcomp_bound(size));
+        if(len != zcomp_unpack(&b, wire, n, back, size) || memcmp(raw, back, len)){
+            zinf("%s frame<%d> round trip failed", title, i);
+            ret = ZEFAIL;
+        }
+    }
+    zinf("%-8s codec:%d dict:%d frames:%llu packed:%llu ratio:%.3f saved:%lluB "
+         "pack:%.1fMB/s unpack:%.1fMB/s backoffs:%llu",
+         title, a.codec, a.use_dict, (unsigned long long)a.frames, (unsigned long long)a.packed,
+         (double)a.bytes_out / a.bytes_in,
+         (unsigned long long)(a.bytes_in > a.bytes_out ? a.bytes_in - a.bytes_out : 0),
+         a.cpu_ns ? (double)a.bytes_in * 1000 / a.cpu_ns : 0.0,
+         b.unpack_ns ? (double)a.bytes_in * 1000 / b.unpack_ns : 0.0,
+         (unsigned long long)a.disables);
+    if(!random && a.packed * 2 < a.frames){
+        zinf("%s compressible frames were stored", title);
+        ret = ZEFAIL;
+    }
+    if(random && (!a.disables || a.packed)){
+        zinf("%s random frames did not back off", title);
+        ret = ZEFAIL;
+    }
+    zcomp_fini(&a);
+    zcomp_fini(&b);
+    free(raw);
+    free(wire);
+    free(back);
+    return ret;
+}
+
+zerr_t tu_comp(zop_arg){
+    printf("# comp <frames> <frame-size>\n");
+    return ZEOK;
+}
+
+zerr_t tc_comp(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zcomp_cfg_t cfg, dcfg;
+    const char *samples[TC_COMP_SAMPLES];
+    int lens[TC_COMP_SAMPLES];
+    char *bufs[TC_COMP_SAMPLES];
+    char *dict;
+    zerr_t ret = ZEOK;
+    int frames, size, i;
+
+    if(3 != argc || (frames = atoi(argv[1])) <= 0 || (size = atoi(argv[2])) < 128){
+        tu_comp(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    zcomp_cfg_default(&cfg);
+    if(ZEOK != tc_comp_link("plain", &cfg, &cfg, frames, size, 0) ||
+       ZEOK != tc_comp_link("random", &cfg, &cfg, frames, size, 1)){
+        ret = ZEFAIL;
+    }
+    /* small frames gain most from a dictionary trained on earlier traffic */
+    dict = malloc(ZCOMP_DICT_MAX);
+    for(i = 0; i < TC_COMP_SAMPLES; ++i){
+        bufs[i] = malloc(size);
+        lens[i] = tc_comp_record(bufs[i], size, -1000 * (i + 1));
+        samples[i] = bufs[i];
+    }
+    dcfg = cfg;
+    dcfg.dict = dict;
+    dcfg.dict_len = zcomp_dict_train(samples, lens, TC_COMP_SAMPLES, dict, ZCOMP_DICT_MAX);
+    if(ZEOK != tc_comp_link("dict", &dcfg, &dcfg, frames, size, 0)){
+        ret = ZEFAIL;
+    }
+    /* only one side holds it: negotiated off, still decodable */
+    if(ZEOK != tc_comp_link("halfdict", &dcfg, &cfg, frames, size, 0)){
+        ret = ZEFAIL;
+    }
+    for(i = 0; i < TC_COMP_SAMPLES; ++i){
+        free(bufs[i]);
+    }
+    free(dict);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,219 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_cork.c
+ * @brief write coalescing test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/cork.h>
+
+#define TC_CORK_BIG (1024 * 1024)
+#define TC_CORK_REFS 16
+
+typedef struct tc_cork_s{
+    st_netfd_t peer;
+    uint64_t sent; /** stream offset of the next frame */
+    uint64_t got; /** bytes checked by the reader */
+    zcork_t *cork; /** target of the interleaving writer */
+    int bad;
+    int stop;
+}tc_cork_t;
+
+/** @brief stream byte at offset <off> */
+zinline char tc_cork_byte(uint64_t off){
+    return (char)(off % 251);
+}
+
+static char *tc_cork_frame(tc_cork_t *tc, int len){
+    char *buf = (char*)malloc(len);
+    int i;
+
+    for(i = 0; i < len; ++i){
+        buf[i] = tc_cork_byte(tc->sent + i);
+    }
+    tc->sent += len;
+    return buf;
+}
+
+static zptr_t tc_cork_reader(zptr_t arg){
+    tc_cork_t *tc = (tc_cork_t*)arg;
+    char buf[16384];
+    ssize_t n, i;
+
+    while(!tc->stop && 0 < (n = st_read(tc->peer, buf, sizeof(buf), ST_UTIME_NO_TIMEOUT))){
+        for(i = 0; i < n; ++i){
+            if(buf[i] != tc_cork_byte(tc->got + i)){
+                ++tc->bad;
+                break;
+            }
+        }
+        tc->got += n;
+    }
+    return NULL;
+}
+
+/** @brief let the tick flush and the reader catch up */
+static int tc_cork_settle(tc_cork_t *tc){
+    int i;
+
+    for(i = 0; i < 1000 && tc->got != tc->sent; ++i){
+        st_usleep(1000);
+    }
+    return tc->got == tc->sent && !tc->bad;
+}
+
+static zerr_t tc_cork_write(tc_cork_t *tc, zcork_t *cork, int len){
+    char *buf = tc_cork_frame(tc, len);
+    zerr_t ret = zcork_write(cork, buf, len, 0);
+
+    free(buf);
+    return ret;
+}
+
+/** @brief small frames and flushes while a write-through owns the socket */
+static zptr_t tc_cork_interleave(zptr_t arg){
+    tc_cork_t *tc = (tc_cork_t*)arg;
+    int i;
+
+    for(i = 0; i < TC_CORK_REFS; ++i){
+        tc_cork_write(tc, tc->cork, 64);
+        zcork_flush(tc->cork);
+    }
+    return NULL;
+}
+
+zerr_t tu_cork(zop_arg){
+    printf("# cork <frames> <size:Byte>\n");
+    return ZEOK;
+}
+
+zerr_t tc_cork(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    tc_cork_t tc;
+    zcork_tick_t tick;
+    zcork_t cork;
+    zcork_t small;
+    st_thread_t reader;
+    st_thread_t writer;
+    char *refs[TC_CORK_REFS];
+    uint64_t calls;
+    int frames, size, sv[2], i;
+
+    if(3 != argc || (frames = atoi(argv[1])) <= 0 || (size = atoi(argv[2])) <= 0 ||
+       size > 4096){
+        tu_cork(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    zst_init(NULL, NULL);
+    if(0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    zsock_nonblock(sv[0], ztrue);
+    memset(&tc, 0, sizeof(tc));
+    tc.peer = st_netfd_open_socket(sv[1]);
+    reader = zst_thread_create(tc_cork_reader, &tc, ztrue, 0);
+    zcork_tick_init(&tick);
+    zcork_init(&cork, sv[0], &tick, 0, 0, 0);
+
+    /* coalescing, nothing leaves before the end of the tick */
+    for(i = 0; i < frames && ZEOK == ret; ++i){
+        ret = tc_cork_write(&tc, &cork, size);
+    }
+    if(!tc_cork_settle(&tc) || ZEOK != ret){
+        ret = ZEFAIL;
+    }
+    printf("coalesce: %d frames in %llu writev, %llu tick %llu budget flushes\n", frames,
+           (unsigned long long)cork.syscalls, (unsigned long long)cork.tick_flushes,
+           (unsigned long long)cork.budget_flushes);
+    if(cork.syscalls * 8 > (uint64_t)frames + 7){
+        ret = ZEFAIL;
+    }
+
+    /* references and copies keep their order, the buffers live until the flush */
+    calls = cork.syscalls;
+    for(i = 0; i < TC_CORK_REFS; ++i){
+        refs[i] = tc_cork_frame(&tc, size);
+        zcork_write(&cork, refs[i], size, ZCORK_REF);
+        tc_cork_write(&tc, &cork, 16);
+    }
+    if(!tc_cork_settle(&tc)){
+        ret = ZEFAIL;
+    }
+    printf("ref: %d referenced frames between copies in %llu writev, stream %s\n",
+           TC_CORK_REFS, (unsigned long long)(cork.syscalls - calls), tc.bad ? "BAD" : "ok");
+    for(i = 0; i < TC_CORK_REFS; ++i){
+        free(refs[i]);
+    }
+
+    /* byte budget */
+    zcork_init(&small, sv[0], &tick, 0, 4096, 0);
+    for(i = 0; i < frames; ++i){
+        tc_cork_write(&tc, &small, size);
+    }
+    if(!tc_cork_settle(&tc) || ((uint64_t)frames * size >= 8192 && small.budget_flushes < 2)){
+        ret = ZEFAIL;
+    }
+    printf("budget: %d bytes through a 4KB budget, %llu budget flushes\n", frames * size,
+           (unsigned long long)small.budget_flushes);
+    zcork_fini(&small);
+
+    /*
+     * write-through, the reader runs while the writer waits for room and
+     * another st_thread queues and flushes frames that must follow it
+     */
+    tc.cork = &cork;
+    writer = zst_thread_create(tc_cork_interleave, &tc, ztrue, 0);
+    if(ZEOK != tc_cork_write(&tc, &cork, TC_CORK_BIG)){
+        ret = ZEFAIL;
+    }
+    zst_thread_join(writer);
+    if(!tc_cork_settle(&tc)){
+        ret = ZEFAIL;
+    }
+    printf("write-through: %d byte frame, %llu of %llu stream bytes checked, bad %d\n",
+           TC_CORK_BIG, (unsigned long long)tc.got, (unsigned long long)tc.sent, tc.bad);
+
+    zcork_fini(&cork);
+    zcork_tick_fini(&tick);
+    tc.stop = 1;
+    shutdown(sv[0], SHUT_WR);
+    zst_thread_join(reader);
+    st_netfd_close(tc.peer);
+    zsockclose(sv[0]);
+    zerrno(ret);
+    return ret;
+}
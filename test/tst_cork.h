@@ -0,0 +1,49 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_CORK_H_
+#define _ZTST_CORK_H_
+
+/**
+ * @file tst_cork.h
+ * @brief write coalescing test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par cork
+ *      - cork <frames> <size:Byte>
+ *        a cork on one end of a socketpair, a reader st_thread on the other
+ *        checks every byte; in one tick: <frames> copied frames coalesce
+ *        into a few writev(), ZCORK_REF frames interleave with copies in
+ *        order, a 4KB byte budget forces flushes before the tick, and a
+ *        1MB frame (larger than the cork and the socket buffer) is written
+ *        through while the reader drains it on the same scheduler and a
+ *        second writer's frames and flushes wait until it is out.
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_cork(zop_arg);
+zerr_t tc_cork(zop_arg);
+
+#endif /*_ZTST_CORK_H_*/
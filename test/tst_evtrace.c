@@ -0,0 +1,213 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_evtrace.c
+ * @brief trace loopback connections, dump and convert to Chrome JSON
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/socket.h>
+#include <znt/com/evtrace.h>
+
+#define TC_EVT_DUMP "/tmp/znt_tst_evtrace.bin"
+#define TC_EVT_SIG "/tmp/znt_tst_evtrace_sig.bin"
+#define TC_EVT_JSON "/tmp/znt_tst_evtrace.json"
+#define TC_EVT_MSG 64
+
+typedef struct tc_evt_s{
+    zsock_t listener;
+    int conns;
+    int msgs;
+    int received;
+}tc_evt_t;
+
+static uint64_t tc_evt_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** @brief accept the links one by one, bind a session, drain, close */
+static void *tc_evt_server(void *arg){
+    tc_evt_t *tc = (tc_evt_t*)arg;
+    struct pollfd pfd;
+    char buf[4096];
+    zsock_t sock;
+    int i, got, n;
+
+    for(i = 0; i < tc->conns; ++i){
+        pfd.fd = tc->listener;
+        pfd.events = POLLIN;
+        poll(&pfd, 1, 3000);
+        if(ZINVALID_SOCKET == (sock = zaccept(tc->listener, NULL, NULL))){
+            break;
+        }
+        ZEVTRACE(ZEVT_SESSION, sock, 1000 + i, 0, 0);
+        for(got = 0; got < tc->msgs * TC_EVT_MSG;){
+            pfd.fd = sock;
+            poll(&pfd, 1, 1000);
+            if((n = zrecv(sock, buf, sizeof(buf), 0)) > 0){
+                got += n;
+            }else if(ZEAGAIN != n){
+                break;
+            }
+        }
+        tc->received += got;
+        zsockclose(sock);
+    }
+    return NULL;
+}
+
+static zerr_t tc_evt_convert(const char *in, const char *out){
+    zerr_t ret = zevtrace_chrome(in, out);
+
+    zinf("%s -> %s: %s", in, out, zstrerr(ret));
+    return ret;
+}
+
+zerr_t tu_evtrace(zop_arg){
+    printf("# evtrace <conns> <msgs>\n"
+           "# evtrace -c <dump> <json>\n");
+    return ZEOK;
+}
+
+zerr_t tc_evtrace(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    tc_evt_t tc;
+    pthread_t thr;
+    zsockaddr_t addr;
+    socklen_t alen = sizeof(addr);
+    char msg[TC_EVT_MSG];
+    zevt_t *evts;
+    int counts[ZEVT_SESSION + 1];
+    int cnt, sig_cnt, i, j, len;
+    uint64_t ns;
+    zsock_t sock;
+    zerr_t ret = ZEOK;
+
+    if(4 == argc && 0 == strcmp("-c", argv[1])){
+        ret = tc_evt_convert(argv[2], argv[3]);
+        zerrno(ret);
+        return ret;
+    }
+    memset(&tc, 0, sizeof(tc));
+    if(3 != argc || (tc.conns = atoi(argv[1])) <= 0 || (tc.msgs = atoi(argv[2])) <= 0){
+        tu_evtrace(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    zevtrace_init(tc.conns * (tc.msgs + 8) * 2);
+    zevtrace_dump_on(SIGUSR2, TC_EVT_SIG);
+    zevtrace_enable(1);
+
+    tc.listener = zsocket(AF_INET, SOCK_STREAM, 0);
+    zinet_addrx(&addr, "127.0.0.1", 0);
+    if(ZEOK != zbind(tc.listener, &addr.sa, zsockaddr_len(&addr)) || ZEOK != zlisten(tc.listener, 64)){
+        zsockclose(tc.listener);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    getsockname(tc.listener, &addr.sa, &alen);
+    pthread_create(&thr, NULL, tc_evt_server, &tc);
+    memset(msg, 'e', sizeof(msg));
+    for(i = 0; i < tc.conns; ++i){
+        sock = zsocket(AF_INET, SOCK_STREAM, 0);
+        zsock_nonblock(sock, 0);
+        if(ZEOK == zconnect(sock, &addr.sa, zsockaddr_len(&addr))){
+            for(j = 0; j < tc.msgs; ++j){
+                len = sizeof(msg);
+                zsend(sock, msg, &len, 0);
+            }
+        }
+        zsockclose(sock);
+    }
+    pthread_join(thr, NULL);
+    zsockclose(tc.listener);
+
+    raise(SIGUSR2);
+    zevtrace_dump(TC_EVT_DUMP);
+    zevtrace_enable(0);
+    if(ZEOK != zevtrace_load(TC_EVT_SIG, &evts, &sig_cnt)){
+        sig_cnt = -1;
+    }else{
+        free(evts);
+    }
+    if(ZEOK != zevtrace_load(TC_EVT_DUMP, &evts, &cnt)){
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    memset(counts, 0, sizeof(counts));
+    for(i = 0; i < cnt; ++i){
+        if(evts[i].event <= ZEVT_SESSION){
+            ++counts[evts[i].event];
+        }
+        if(i && evts[i].ts < evts[i - 1].ts){
+            ret = ZEFAIL;
+        }
+    }
+    free(evts);
+    zinf("records:%d (signal dump:%d) connect:%d accept:%d send:%d recv:%d close:%d "
+         "session:%d, received %d bytes", cnt, sig_cnt, counts[ZEVT_CONNECT],
+         counts[ZEVT_ACCEPT], counts[ZEVT_SEND], counts[ZEVT_RECV], counts[ZEVT_CLOSE],
+         counts[ZEVT_SESSION], tc.received);
+    if(sig_cnt != cnt || counts[ZEVT_CONNECT] != tc.conns || counts[ZEVT_ACCEPT] != tc.conns ||
+       counts[ZEVT_SEND] != tc.conns * tc.msgs || counts[ZEVT_SESSION] != tc.conns ||
+       counts[ZEVT_CLOSE] != tc.conns * 2 + 1 || tc.received != tc.conns * tc.msgs * TC_EVT_MSG){
+        ret = ZEFAIL;
+    }
+    if(ZEOK != tc_evt_convert(TC_EVT_DUMP, TC_EVT_JSON)){
+        ret = ZEFAIL;
+    }
+
+    /* cost of a record, and of a disabled trace point */
+    ns = tc_evt_ns();
+    zevtrace_enable(1);
+    for(i = 0; i < 1000000; ++i){
+        ZEVTRACE(ZEVT_USER, i, 0, i, 0);
+    }
+    ns = tc_evt_ns() - ns;
+    zevtrace_enable(0);
+    zinf("%.1fns per record", ns / 1000000.0);
+    ns = tc_evt_ns();
+    for(i = 0; i < 1000000; ++i){
+        ZEVTRACE(ZEVT_USER, i, 0, i, 0);
+    }
+    ns = tc_evt_ns() - ns;
+    zinf("%.2fns per disabled trace point", ns / 1000000.0);
+    unlink(TC_EVT_SIG);
+    zerrno(ret);
+    return ret;
+}
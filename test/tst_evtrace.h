@@ -0,0 +1,47 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_EVTRACE_H_
+#define _ZTST_EVTRACE_H_
+
+/**
+ * @file tst_evtrace.h
+ * @brief trace loopback connections, dump and convert to Chrome JSON
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par evtrace
+ *      - evtrace <conns> <msgs>
+ *        opens <conns> loopback links, sends <msgs> records on each,
+ *        dumps the rings by SIGUSR2 and on demand, checks the event counts
+ *        and writes /tmp/znt_tst_evtrace.json; then times a trace point.
+ *      - evtrace -c <dump> <json>
+ *        converts a dump to Chrome trace JSON (chrome://tracing, Perfetto).
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_evtrace(zop_arg);
+zerr_t tc_evtrace(zop_arg);
+
+#endif /*_ZTST_EVTRACE_H_*/
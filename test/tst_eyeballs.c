@@ -0,0 +1,136 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_eyeballs.c
+ * @brief dual-stack Happy Eyeballs connect test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/socket.h>
+#include <znt/com/resolv.h>
+
+static uint64_t tc_eyeballs_ms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/** @brief race <hosts> on <port>, expect candidate <expect> of the raced order */
+static zerr_t tc_eyeballs_race(const char **hosts, int cnt, uint16_t port, int stagger_ms,
+                               const char *expect, const char *title){
+    zsockaddr_t cands[ZRACE_MAX];
+    char host[INET6_ADDRSTRLEN];
+    uint64_t begin;
+    zsock_t sock = ZINVALID_SOCKET;
+    zerr_t ret;
+    int i, n = 0, index = -1;
+
+    for(i = 0; i < cnt; ++i){
+        if(ZEOK == zinet_addrx(&cands[n], hosts[i], port)){
+            ++n;
+        }
+    }
+    begin = tc_eyeballs_ms();
+    ret = zconnect_race(cands, n, stagger_ms, 5000, &sock, &index);
+    host[0] = '\0';
+    if(ZEOK == ret){
+        zsockaddr_t peer;
+        socklen_t len = sizeof(peer);
+        getpeername(sock, &peer.sa, &len);
+        zinet_ntop(&peer, host, sizeof(host), NULL);
+        zsockclose(sock);
+    }
+    zinf("%-10s %s winner:%d <%s> in %llums", title, zstrerr(ret), index, host,
+         (unsigned long long)(tc_eyeballs_ms() - begin));
+    return (ZEOK == ret && 0 == strcmp(host, expect)) ? ZEOK : ZEFAIL;
+}
+
+zerr_t tu_eyeballs(zop_arg){
+    printf("# eyeballs <stagger:ms>\n");
+    return ZEOK;
+}
+
+zerr_t tc_eyeballs(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    /* nothing listens on ::1, the refused attempt hands over at once */
+    const char *refused[] = {"::1", "127.0.0.1"};
+    /* unreachable, blackholed then loopback: wins after the staggers */
+    const char *stalled[] = {"100::1", "10.255.255.1", "[::1]", "127.0.0.1"};
+    zsockaddr_t addr;
+    socklen_t len = sizeof(addr);
+    zresolv_t *rs;
+    zsock_t listener, sock = ZINVALID_SOCKET;
+    zerr_t ret = ZEOK;
+    zerr_t dial;
+    uint16_t port;
+    int stagger, i;
+
+    if(2 != argc || (stagger = atoi(argv[1])) <= 0){
+        tu_eyeballs(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    if(ZINVALID_SOCKET == (listener = zsocket(AF_INET, SOCK_STREAM, 0)) ||
+       ZEOK != zinet_addrx(&addr, "127.0.0.1", 0) ||
+       ZEOK != zbind(listener, &addr.sa, zsockaddr_len(&addr)) ||
+       ZEOK != zlisten(listener, 64) ||
+       0 != getsockname(listener, &addr.sa, &len)){
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    port = ntohs(addr.in4.sin_port);
+
+    if(ZEOK != tc_eyeballs_race(refused, 2, port, stagger, "127.0.0.1", "refused")){
+        ret = ZEFAIL;
+    }
+    if(ZEOK != tc_eyeballs_race(stalled, 4, port, stagger, "127.0.0.1", "stalled")){
+        ret = ZEFAIL;
+    }
+    /* by name through the resolver, both families of localhost raced */
+    rs = zresolv_create(1, 0, 0, 0);
+    zresolv_set_default(rs);
+    for(i = 0; i < 100 && ZEAGAIN == (dial = zconnect_host("localhost", port, stagger, 5000, &sock)); ++i){
+        usleep(10000);
+    }
+    zinf("%-10s %s", "localhost", zstrerr(dial));
+    if(ZEOK == dial){
+        zsockclose(sock);
+    }else{
+        ret = ZEFAIL;
+    }
+    zresolv_destroy(rs);
+    zsockclose(listener);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,191 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_fanout.c
+ * @brief overlay fan-out tree test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/topo/fanout.h>
+
+/** in-process link, hands each whole frame to the fan-out of the peer */
+typedef struct tc_fanout_link_s{
+    zfanout_t fanout;
+    char *buf;
+    int len;
+    uint64_t got; /** payload bytes delivered */
+    int bad; /** chunks out of order or corrupted */
+    int zone;
+    ztrans_t trans;
+}tc_fanout_link_t;
+
+static zerr_t tc_fanout_send(zptr_t ctx, const char *buf, int *len, int flags){
+    tc_fanout_link_t *link = (tc_fanout_link_t*)ctx;
+
+    memcpy(link->buf + link->len, buf, *len);
+    link->len += *len;
+    if(link->len >= ZFANOUT_HDR_SIZE && link->len == zfanout_frame_len(link->buf)){
+        link->len = 0;
+        zfanout_input(&link->fanout, link->buf, zfanout_frame_len(link->buf));
+    }
+    return ZEOK;
+}
+
+static zerr_t tc_fanout_recv(zptr_t ctx, char *buf, int len, int flags){
+    return ZEAGAIN;
+}
+
+static int tc_fanout_fileno(zptr_t ctx){
+    return -1;
+}
+
+static zerr_t tc_fanout_close(zptr_t ctx){
+    return ZEOK;
+}
+
+static const ztrans_ops_t tc_fanout_ops = {
+    "loop", tc_fanout_send, tc_fanout_recv, NULL, tc_fanout_fileno, tc_fanout_close
+};
+
+static uint32_t tc_fanout_zone(znt_node_t *node, zptr_t hint){
+    return (uint32_t)((tc_fanout_link_t*)node->hint)->zone;
+}
+
+static void tc_fanout_deliver(zfanout_t *fanout, uint64_t bid, const char *data, int len,
+                              uint64_t offset, uint64_t total, zptr_t hint){
+    tc_fanout_link_t *link = (tc_fanout_link_t*)fanout;
+    int i;
+
+    if(total && offset != link->got % total){
+        ++link->bad;
+    }
+    for(i = 0; i < len; ++i){
+        if(data[i] != (char)(offset + i)){
+            ++link->bad;
+            break;
+        }
+    }
+    link->got += len;
+}
+
+zerr_t tu_fanout(zop_arg){
+    printf("# fanout <nodes> <degree> <zones> <payload:Byte>\n");
+    return ZEOK;
+}
+
+zerr_t tc_fanout(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    zroute_t route;
+    znt_nid_t nid;
+    znt_node_t *node;
+    tc_fanout_link_t *links = NULL;
+    char *payload = NULL;
+    char buf[32];
+    int nodes, degree, zones, len;
+    int roots[2];
+    int max_hops = 0;
+    uint64_t max_out = 0;
+    uint64_t origin_out = 0;
+    int chunks;
+    int i, r;
+
+    if(5 != argc || (nodes = atoi(argv[1])) <= 1 || (degree = atoi(argv[2])) <= 0 ||
+       (zones = atoi(argv[3])) <= 0 || (len = atoi(argv[4])) < 0){
+        tu_fanout(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    /* one shared view, every node reaches every other through its link */
+    zroute_init(&route, 8);
+    links = calloc(nodes, sizeof(tc_fanout_link_t));
+    payload = malloc(len + 1);
+    for(i = 0; i < len; ++i){
+        payload[i] = (char)i;
+    }
+    for(i = 0; i < nodes; ++i){
+        nid.len = sprintf(buf, "node-%d", i);
+        nid.id = buf;
+        nid.state = 0;
+        links[i].buf = malloc(ZFANOUT_HDR_SIZE + ZFANOUT_CHUNK);
+        links[i].zone = i % zones;
+        links[i].trans.ops = &tc_fanout_ops;
+        links[i].trans.ctx = &links[i];
+        zfanout_init(&links[i].fanout, &route, &nid, degree, ZFANOUT_CHUNK,
+                     tc_fanout_zone, tc_fanout_deliver, NULL);
+        node = zroute_join(&route, &nid, 1);
+        node->hint = &links[i];
+        zroute_attach(node, &links[i].trans);
+    }
+
+    roots[0] = 0;
+    roots[1] = nodes / 2;
+    for(r = 0; r < 2; ++r){
+        if(ZEOK != zfanout_bcast(&links[roots[r]].fanout, payload, len, NULL)){
+            zinf("bcast from node-%d failed", roots[r]);
+            ret = ZEFAIL;
+        }
+        if(!r){
+            origin_out = links[roots[0]].fanout.chunks_out;
+        }
+    }
+    for(i = 0; i < nodes; ++i){
+        uint64_t expect = (uint64_t)len * ((i == roots[0] || i == roots[1]) ? 1 : 2);
+        if(links[i].got != expect || links[i].bad){
+            zinf("node-%d got %llu of %llu bytes, bad chunks %d", i,
+                 (unsigned long long)links[i].got, (unsigned long long)expect, links[i].bad);
+            ret = ZEFAIL;
+        }
+        if(links[i].fanout.max_hops > max_hops){
+            max_hops = links[i].fanout.max_hops;
+        }
+        if(i != roots[0] && i != roots[1] && links[i].fanout.chunks_out > max_out){
+            max_out = links[i].fanout.chunks_out;
+        }
+    }
+    chunks = len ? (len + ZFANOUT_CHUNK - 1) / ZFANOUT_CHUNK : 1;
+    zinf("\nnodes:%d degree:%d zones:%d depth:%d origin frames:%llu "
+         "max relay frames:%llu (sequential send: %d)",
+         nodes, degree, zones, max_hops, (unsigned long long)origin_out,
+         (unsigned long long)max_out, (nodes - 1) * chunks);
+
+    for(i = 0; i < nodes; ++i){
+        zfanout_fini(&links[i].fanout);
+        free(links[i].buf);
+    }
+    zroute_fini(&route);
+    free(links);
+    free(payload);
+    zerrno(ret);
+    return ret;
+}
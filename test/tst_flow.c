@@ -0,0 +1,157 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_flow.c
+ * @brief credit-based flow control test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/base/time.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/flow.h>
+
+typedef struct tc_flow_s{
+    zflow_t *tx;
+    zflow_t *rx;
+    int msgs;
+    int size;
+    int delay_us; /** consumer work per message */
+    int got;
+    int disorder;
+}tc_flow_t;
+
+static zptr_t tc_flow_producer(zptr_t arg){
+    tc_flow_t *tc = (tc_flow_t*)arg;
+    char *buf = calloc(1, tc->size);
+    int i;
+
+    for(i = 0; i < tc->msgs; ++i){
+        memcpy(buf, &i, sizeof(i));
+        if(ZEOK != zflow_send(tc->tx, buf, tc->size, ST_UTIME_NO_TIMEOUT)){
+            break;
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+static zptr_t tc_flow_consumer(zptr_t arg){
+    tc_flow_t *tc = (tc_flow_t*)arg;
+    char *buf = calloc(1, tc->size);
+    int seq;
+
+    while(tc->got < tc->msgs){
+        if(zflow_recv(tc->rx, buf, tc->size, 5000000) != tc->size){
+            break;
+        }
+        memcpy(&seq, buf, sizeof(seq));
+        if(seq != tc->got){
+            ++tc->disorder;
+        }
+        ++tc->got;
+        if(tc->delay_us){
+            st_usleep(tc->delay_us);
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+zerr_t tu_flow(zop_arg){
+    printf("# flow <messages> <message-size:Byte> <window:Byte> <consumer-delay:us>\n");
+    return ZEOK;
+}
+
+zerr_t tc_flow(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    tc_flow_t tc;
+    st_thread_t producer, consumer;
+    int window;
+    int sv[2];
+    char *big = NULL;
+    ztick_t clock = NULL;
+    int sec = 0;
+    int usec = 0;
+
+    memset(&tc, 0, sizeof(tc));
+    if(5 != argc || (tc.msgs = atoi(argv[1])) <= 0 || (tc.size = atoi(argv[2])) < 4 ||
+       (window = atoi(argv[3])) <= 0 || tc.size > ZFLOW_MSG_MAX(window)){
+        tu_flow(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    tc.delay_us = atoi(argv[4]);
+
+    zst_init(NULL, NULL);
+    if(0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    zsock_nonblock(sv[0], ztrue);
+    zsock_nonblock(sv[1], ztrue);
+    tc.tx = zflow_create(sv[0], window);
+    tc.rx = zflow_create(sv[1], window);
+
+    clock = ztick();
+    producer = zst_thread_create(tc_flow_producer, &tc, ztrue, 0);
+    consumer = zst_thread_create(tc_flow_consumer, &tc, ztrue, 0);
+    zst_thread_join(consumer);
+    zst_thread_join(producer);
+    ztock(clock, &sec, &usec);
+
+    zinf("\nmsgs:%d got:%d disorder:%d window:%d max_queued:%d stalls:%llu "
+         "stall_us:%llu grants:%llu sec:%d usec:%d",
+         tc.msgs, tc.got, tc.disorder, window, tc.rx->max_queued,
+         (unsigned long long)tc.tx->stalls, (unsigned long long)tc.tx->stall_us,
+         (unsigned long long)tc.rx->grants, sec, usec);
+    if(tc.got != tc.msgs || tc.disorder || tc.rx->max_queued > window){
+        ret = ZEFAIL;
+    }
+
+    /* the largest message right after a small one, its credit still batched */
+    big = calloc(1, window);
+    if(ZEOK != zflow_send(tc.tx, big, 4, 1000000) ||
+       4 != zflow_recv(tc.rx, big, 4, 1000000) ||
+       ZEPARAM_INVALID != zflow_send(tc.tx, big, window - ZFLOW_HDR_SIZE, 1000000) ||
+       ZEOK != zflow_send(tc.tx, big, ZFLOW_MSG_MAX(window), 1000000) ||
+       ZFLOW_MSG_MAX(window) != zflow_recv(tc.rx, big, window, 1000000)){
+        zinf("\n%d byte message after a small one failed", ZFLOW_MSG_MAX(window));
+        ret = ZEFAIL;
+    }
+    free(big);
+
+    zflow_destroy(tc.tx);
+    zflow_destroy(tc.rx);
+    zerrno(ret);
+    return ret;
+}
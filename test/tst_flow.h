@@ -0,0 +1,47 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_FLOW_H_
+#define _ZTST_FLOW_H_
+
+/**
+ * @file tst_flow.h
+ * @brief credit-based flow control test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par backpressure
+ *      - flow <messages> <message-size:Byte> <window:Byte> <consumer-delay:us>
+ *        a producer outruns a slow consumer over a socketpair; every message
+ *        must arrive in order with the receive queue never above <window>,
+ *        the producer stalls on credit instead of filling the socket; then
+ *        the largest message, ZFLOW_MSG_MAX(window), follows a small one
+ *        whose credit is still batched, a window-sized one is refused.
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_flow(zop_arg);
+zerr_t tc_flow(zop_arg);
+
+#endif /*_ZTST_FLOW_H_*/
@@ -0,0 +1,168 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_gossip.c
+ * @brief SWIM gossip membership test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/base/time.h>
+#include <zsi/app/interactive.h>
+#include <znt/topo/gossip.h>
+
+#define TC_GOSSIP_WAIT_MS 60000
+
+/** @return ms until every instance but <skip> sees <expect> alive members, -1 on timeout */
+static int tc_gossip_wait(zgossip_t **nodes, int cnt, int skip, int expect){
+    int ms;
+    int i;
+
+    for(ms = 0; ms < TC_GOSSIP_WAIT_MS; ms += 10){
+        for(i = 0; i < cnt; ++i){
+            if(i != skip && nodes[i]->nalive != expect){
+                break;
+            }
+        }
+        if(i == cnt){
+            return ms;
+        }
+        st_usleep(10000);
+    }
+    return -1;
+}
+
+/** @return ms until every instance knows <expect> members, DEAD ones reaped, -1 on timeout */
+static int tc_gossip_reaped(zgossip_t **nodes, int cnt, int expect){
+    int ms;
+    int i;
+
+    for(ms = 0; ms < TC_GOSSIP_WAIT_MS; ms += 10){
+        for(i = 0; i < cnt && nodes[i]->nmembers == expect; ++i){
+        }
+        if(i == cnt){
+            return ms;
+        }
+        st_usleep(10000);
+    }
+    return -1;
+}
+
+zerr_t tu_gossip(zop_arg){
+    printf("# gossip <nodes> <base-port> <period:ms>\n");
+    return ZEOK;
+}
+
+zerr_t tc_gossip(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    zgossip_t **nodes = NULL;
+    zgossip_cfg_t cfg;
+    ztimer_t timer;
+    znt_nid_t nid;
+    char buf[32];
+    uint64_t tx_bytes = 0;
+    int cnt = 0;
+    int port = 0;
+    int ms;
+    int i;
+
+    if(4 != argc || (cnt = atoi(argv[1])) <= 2 || (port = atoi(argv[2])) <= 0){
+        tu_gossip(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    zgossip_cfg_default(&cfg);
+    if(atoi(argv[3]) > 0){
+        cfg.period_ms = atoi(argv[3]);
+        cfg.ping_timeout_ms = cfg.period_ms / 5 > 0 ? cfg.period_ms / 5 : 1;
+    }
+
+    zst_init(NULL, NULL);
+    ztimer_init(&timer, ztrue);
+    nodes = calloc(cnt, sizeof(zgossip_t*));
+    for(i = 0; i < cnt; ++i){
+        nid.len = sprintf(buf, "gossip-%d", i);
+        nid.id = buf;
+        nid.state = 0;
+        if(!(nodes[i] = zgossip_create(&nid, "127.0.0.1", (uint16_t)(port + i), &cfg,
+                                       &timer, NULL, NULL))){
+            zinf("create gossip-%d failed", i);
+            ret = ZEFAIL;
+            cnt = i;
+            break;
+        }
+        if(i){
+            zgossip_join(nodes[i], "127.0.0.1", (uint16_t)port);
+        }
+    }
+
+    if(ZEOK == ret){
+        /* convergence */
+        ms = tc_gossip_wait(nodes, cnt, -1, cnt - 1);
+        zinf("\nconverged %d members in %d ms", cnt, ms);
+        if(ms < 0){
+            ret = ZEFAIL;
+        }
+    }
+    if(ZEOK == ret){
+        /* failure detection, the last member leaves silently */
+        zgossip_destroy(nodes[cnt - 1]);
+        nodes[cnt - 1] = NULL;
+        ms = tc_gossip_wait(nodes, cnt - 1, -1, cnt - 2);
+        zinf("\nfailure detected by all %d members in %d ms (%.1f periods)",
+             cnt - 1, ms, (double)ms / cfg.period_ms);
+        if(ms < 0){
+            ret = ZEFAIL;
+        }
+    }
+    if(ZEOK == ret){
+        /* the DEAD member is forgotten after the linger */
+        ms = tc_gossip_reaped(nodes, cnt - 1, cnt - 2);
+        zinf("\ndead member reaped by all %d members in %d ms (%.1f periods)",
+             cnt - 1, ms, (double)ms / cfg.period_ms);
+        if(ms < 0){
+            ret = ZEFAIL;
+        }
+    }
+
+    for(i = 0; i < cnt; ++i){
+        if(nodes[i]){
+            tx_bytes += nodes[i]->tx_bytes;
+            zgossip_destroy(nodes[i]);
+        }
+    }
+    zinf("\ntx bytes per member: %llu", (unsigned long long)(cnt ? tx_bytes / cnt : 0));
+    ztimer_fini(&timer);
+    free(nodes);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,246 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_hotrestart.c
+ * @brief restart a server under load, count refused connects
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/hotrestart.h>
+
+#define TC_HOT_PATH "/tmp/znt_tst_hot.sock"
+#define TC_HOT_SESSIONS 64
+
+typedef struct tc_hot_client_s{
+    uint16_t port;
+    int run_ms;
+    int old_pid;
+    int by_old;
+    int by_new;
+    int failed;
+    int long_old; /** long session replies from the old process */
+    int long_other;
+}tc_hot_client_t;
+
+static uint64_t tc_hot_ms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief the server of both generations: answer every byte with its pid
+ *        until <run_ms> or, once handed over, until drained
+ */
+static int tc_hot_server(zhot_t *hot, zsock_t lsn, int run_ms){
+    struct pollfd pfds[TC_HOT_SESSIONS + 2];
+    zsock_t sess[TC_HOT_SESSIONS];
+    int32_t pid = getpid();
+    uint64_t end = tc_hot_ms() + run_ms;
+    int cnt = 0, n, i, len;
+    zsock_t sock;
+    char c;
+
+    while(!zhot_drained(hot, cnt) && (zhot_draining(hot) || tc_hot_ms() < end)){
+        n = 0;
+        for(i = 0; i < cnt; ++i){
+            pfds[n].fd = sess[i];
+            pfds[n++].events = POLLIN;
+        }
+        pfds[n].fd = zhot_draining(hot) ? -1 : lsn;
+        pfds[n++].events = POLLIN;
+        pfds[n].fd = zhot_fd(hot);
+        pfds[n++].events = POLLIN;
+        poll(pfds, n, 10);
+        for(i = 0; i < cnt; ++i){
+            if(!pfds[i].revents || ZEAGAIN == (len = zrecv(sess[i], &c, 1, 0))){
+                continue;
+            }
+            if(1 == len){
+                len = sizeof(pid);
+                len = ZEOK == zsend(sess[i], (char*)&pid, &len, 0) ? 1 : 0;
+            }
+            if(1 != len){
+                zsockclose(sess[i]);
+                sess[i] = ZINVALID_SOCKET;
+            }
+        }
+        for(i = 0; i < cnt; ++i){
+            if(ZINVALID_SOCKET == sess[i]){
+                sess[i--] = sess[--cnt];
+                pfds[i + 1] = pfds[cnt];
+            }
+        }
+        if(pfds[n - 2].revents && cnt < TC_HOT_SESSIONS &&
+           ZINVALID_SOCKET != (sock = zaccept(lsn, NULL, NULL))){
+            sess[cnt++] = sock;
+        }
+        if(pfds[n - 1].revents){
+            zhot_poll(hot);
+        }
+    }
+    for(i = 0; i < cnt; ++i){
+        zsockclose(sess[i]);
+    }
+    return cnt;
+}
+
+static zerr_t tc_hot_ask(zsock_t sock, int32_t *pid){
+    struct pollfd pfd;
+    int len = 1;
+
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    if(ZEOK != zsend(sock, "?", &len, 0) || 1 != poll(&pfd, 1, 1000) ||
+       sizeof(*pid) != zrecv(sock, (char*)pid, sizeof(*pid), 0)){
+        return ZEFAIL;
+    }
+    return ZEOK;
+}
+
+/** @brief a short connection every 2ms and one long session across the restart */
+static void *tc_hot_client(void *arg){
+    tc_hot_client_t *tc = (tc_hot_client_t*)arg;
+    zsockaddr_t addr;
+    zsock_t sock, keep;
+    uint64_t end = tc_hot_ms() + tc->run_ms;
+    uint64_t bye = tc_hot_ms() + tc->run_ms * 3 / 5;
+    int32_t pid;
+    int i;
+
+    zinet_addrx(&addr, "127.0.0.1", tc->port);
+    keep = zsocket(AF_INET, SOCK_STREAM, 0);
+    zsock_nonblock(keep, 0);
+    zconnect(keep, &addr.sa, zsockaddr_len(&addr));
+    zsock_nonblock(keep, 1);
+    for(i = 0; tc_hot_ms() < end; ++i){
+        sock = zsocket(AF_INET, SOCK_STREAM, 0);
+        zsock_nonblock(sock, 0);
+        if(ZEOK == zconnect(sock, &addr.sa, zsockaddr_len(&addr)) &&
+           (zsock_nonblock(sock, 1), ZEOK == tc_hot_ask(sock, &pid))){
+            pid == tc->old_pid ? ++tc->by_old : ++tc->by_new;
+        }else{
+            ++tc->failed;
+        }
+        zsockclose(sock);
+        if(ZINVALID_SOCKET != keep && tc_hot_ms() >= bye){
+            /* the long session ends by itself, within the drain time */
+            ZSOCK_CLOSE(keep);
+        }else if(ZINVALID_SOCKET != keep && 0 == i % 10){
+            if(ZEOK == tc_hot_ask(keep, &pid) && pid == tc->old_pid){
+                ++tc->long_old;
+            }else{
+                ++tc->long_other;
+            }
+        }
+        usleep(2000);
+    }
+    return NULL;
+}
+
+/** @brief the new binary */
+static int tc_hot_successor(uint16_t port, int run_ms){
+    zhot_t hot;
+    zsock_t lsn;
+    int inherited;
+
+    zhot_init(&hot, TC_HOT_PATH, 0);
+    inherited = ZEOK == zhot_inherit(&hot, 1000);
+    lsn = zhot_listen(&hot, "127.0.0.1", port, 128);
+    if(ZINVALID_SOCKET == lsn || !inherited || ZEOK != zhot_ready(&hot, 1000) ||
+       ZEOK != zhot_serve(&hot)){
+        return 1;
+    }
+    tc_hot_server(&hot, lsn, run_ms);
+    zhot_fini(&hot);
+    return 0;
+}
+
+zerr_t tu_hotrestart(zop_arg){
+    printf("# hotrestart <port> <drain_ms>\n");
+    return ZEOK;
+}
+
+zerr_t tc_hotrestart(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    tc_hot_client_t tc;
+    zhot_t hot;
+    pthread_t thr;
+    zsock_t lsn;
+    pid_t child;
+    uint64_t begin;
+    int drain_ms, status = -1, left;
+    zerr_t ret = ZEOK;
+
+    memset(&tc, 0, sizeof(tc));
+    if(3 != argc || (tc.port = atoi(argv[1])) <= 0 || (drain_ms = atoi(argv[2])) <= 0){
+        tu_hotrestart(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    zhot_init(&hot, TC_HOT_PATH, drain_ms);
+    if(ZINVALID_SOCKET == (lsn = zhot_listen(&hot, "127.0.0.1", tc.port, 128)) ||
+       ZEOK != zhot_serve(&hot)){
+        zhot_fini(&hot);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    /* fork before any thread, the child is the next binary after 150ms */
+    if(0 == (child = fork())){
+        usleep(150000);
+        _exit(tc_hot_successor(tc.port, 600));
+    }
+    tc.old_pid = getpid();
+    tc.run_ms = 500;
+    pthread_create(&thr, NULL, tc_hot_client, &tc);
+    begin = tc_hot_ms();
+    left = tc_hot_server(&hot, lsn, 2000);
+    zinf("old process done after %llums, %d sessions left at the deadline",
+         (unsigned long long)(tc_hot_ms() - begin), left);
+    pthread_join(thr, NULL);
+    waitpid(child, &status, 0);
+    zhot_fini(&hot);
+    zinf("short links: old:%d new:%d failed:%d; long session: old:%d other:%d; successor exit:%d",
+         tc.by_old, tc.by_new, tc.failed, tc.long_old, tc.long_other, WEXITSTATUS(status));
+    if(!zhot_draining(&hot) || left || tc.failed || !tc.by_old || !tc.by_new || tc.long_other ||
+       0 != status){
+        ret = ZEFAIL;
+    }
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,47 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_HOTRESTART_H_
+#define _ZTST_HOTRESTART_H_
+
+/**
+ * @file tst_hotrestart.h
+ * @brief restart a server under load, count refused connects
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par hotrestart
+ *      - hotrestart <port> <drain_ms>
+ *        serves 127.0.0.1:<port> while a client opens a link every 2ms
+ *        and keeps one session open; a forked successor inherits the
+ *        listener after 150ms. Checks no connect fails, both generations
+ *        answered and the long session stays with the old process until
+ *        it ends or <drain_ms> runs out.
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_hotrestart(zop_arg);
+zerr_t tc_hotrestart(zop_arg);
+
+#endif /*_ZTST_HOTRESTART_H_*/
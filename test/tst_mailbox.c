@@ -0,0 +1,142 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_mailbox.c
+ * @brief MPSC mailbox test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/base/time.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/socket.h>
+#include <znt/com/mailbox.h>
+
+typedef struct tc_mbox_producer_s{
+    zmbox_t *mbox;
+    uintptr_t id;
+    uintptr_t msgs;
+}tc_mbox_producer_t;
+
+static zptr_t tc_mbox_produce(zptr_t arg){
+    tc_mbox_producer_t *prod = (tc_mbox_producer_t*)arg;
+    uintptr_t i;
+
+    for(i = 1; i <= prod->msgs; ++i){
+        /* message = producer id << 32 | serial */
+        while(ZEAGAIN == zmbox_push(prod->mbox, (zptr_t)((prod->id << 32) | i))){
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+zerr_t tu_mailbox(zop_arg){
+    printf("# mailbox <producers> <messages-per-producer> <capacity>\n");
+    return ZEOK;
+}
+
+zerr_t tc_mailbox(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    zmbox_t *mbox = NULL;
+    tc_mbox_producer_t *prods = NULL;
+    pthread_t *thrs = NULL;
+    uint32_t *last = NULL;
+    zptr_t items[64];
+    fd_set rset;
+    uint64_t total = 0;
+    uint64_t got = 0;
+    int producers = 0;
+    int msgs = 0;
+    int cnt = 0;
+    int i = 0;
+    ztick_t tick = NULL;
+    int sec = 0;
+    int usec = 0;
+
+    if(4 != argc || (producers = atoi(argv[1])) <= 0 || (msgs = atoi(argv[2])) <= 0){
+        tu_mailbox(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    if(!(mbox = zmbox_create((uint32_t)atoi(argv[3])))){
+        return ZEFAIL;
+    }
+    prods = calloc(producers, sizeof(tc_mbox_producer_t));
+    thrs = calloc(producers, sizeof(pthread_t));
+    last = calloc(producers, sizeof(uint32_t));
+    total = (uint64_t)producers * msgs;
+
+    tick = ztick();
+    for(i = 0; i < producers; ++i){
+        prods[i].mbox = mbox;
+        prods[i].id = i;
+        prods[i].msgs = msgs;
+        pthread_create(&thrs[i], NULL, tc_mbox_produce, &prods[i]);
+    }
+    while(got < total){
+        if(ZEAGAIN == (cnt = zmbox_pop(mbox, items, 64))){
+            FD_ZERO(&rset);
+            FD_SET(zmbox_fileno(mbox), &rset);
+            zselect(zmbox_fileno(mbox) + 1, &rset, NULL, NULL, NULL);
+            continue;
+        }
+        for(i = 0; i < cnt; ++i){
+            uintptr_t msg = (uintptr_t)items[i];
+            uint32_t id = (uint32_t)(msg >> 32);
+            /* FIFO per producer */
+            if(id >= (uint32_t)producers || (uint32_t)msg != last[id] + 1){
+                ret = ZEFAIL;
+                continue;
+            }
+            last[id] = (uint32_t)msg;
+        }
+        got += cnt;
+    }
+    for(i = 0; i < producers; ++i){
+        pthread_join(thrs[i], NULL);
+    }
+    ztock(tick, &sec, &usec);
+    zinf("\nmessages:%llu batches:%llu msgs_per_batch:%.2f wakeups:%llu %s",
+         (unsigned long long)mbox->pops, (unsigned long long)mbox->batches,
+         mbox->batches ? (double)mbox->pops / mbox->batches : .0,
+         (unsigned long long)mbox->wakeups, zstrerr(ret));
+
+    free(last);
+    free(thrs);
+    free(prods);
+    zmbox_destroy(mbox);
+    zerrno(ret);
+    return ret;
+}
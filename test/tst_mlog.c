@@ -0,0 +1,253 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_mlog.c
+ * @brief group commit log against a write+fdatasync per message
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/mlog.h>
+
+#define TC_MLOG_WINDOW 64
+#define TC_MLOG_NAIVE 2000
+
+typedef struct tc_mlog_replica_s{
+    char dir[300];
+    int sock;
+    int msgs;
+    uint32_t size;
+    zerr_t ret;
+}tc_mlog_replica_t;
+
+static double tc_mlog_now(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void tc_mlog_clean(const char *dir){
+    char path[600];
+    struct dirent *de;
+    DIR *dp;
+
+    if((dp = opendir(dir))){
+        while((de = readdir(dp))){
+            if(strstr(de->d_name, ".log") || strstr(de->d_name, ".naive")){
+                snprintf(path, sizeof(path), "%s/%s", dir, de->d_name);
+                unlink(path);
+            }
+        }
+        closedir(dp);
+    }
+}
+
+/** @brief message <i>: its offset, then a byte derived from it */
+static void tc_mlog_fill(char *buf, uint32_t size, uint64_t i){
+    memset(buf, (int)(i * 131 & 0xff), size);
+    memcpy(buf, &i, size < 8 ? size : 8);
+}
+
+static int tc_mlog_check(zmlog_t *log, uint64_t i, uint32_t size, char *buf){
+    zmlog_rec_t rec;
+
+    tc_mlog_fill(buf, size, i);
+    return ZEOK == zmlog_read(log, i, &rec) && rec.len == size && rec.offset == i &&
+        0 == memcmp(rec.data, buf, size);
+}
+
+static void *tc_mlog_replica(void *arg){
+    tc_mlog_replica_t *rep = (tc_mlog_replica_t*)arg;
+    zmlog_t *log;
+    char *buf, *chk;
+    int fill = 0, n, used;
+
+    rep->ret = ZEFAIL;
+    mkdir(rep->dir, 0755);
+    tc_mlog_clean(rep->dir);
+    if(ZEOK != zmlog_open(&log, rep->dir, NULL)){
+        return NULL;
+    }
+    buf = (char*)malloc(1 << 20);
+    chk = (char*)malloc(rep->size);
+    while(0 < (n = read(rep->sock, buf + fill, (1 << 20) - fill))){
+        fill += n;
+        if(0 > (used = zmlog_append_raw(log, buf, fill))){
+            break;
+        }
+        memmove(buf, buf + used, fill - used);
+        fill -= used;
+    }
+    if(!fill && (int)zmlog_end(log) == rep->msgs && ZEOK == zmlog_sync(log, rep->msgs - 1, 5000) &&
+       tc_mlog_check(log, 0, rep->size, chk) && tc_mlog_check(log, rep->msgs - 1, rep->size, chk)){
+        rep->ret = ZEOK;
+    }
+    zmlog_close(log);
+    tc_mlog_clean(rep->dir);
+    free(buf);
+    free(chk);
+    return NULL;
+}
+
+zerr_t tu_mlog(zop_arg){
+    printf("# mlog <dir> <msgs> <size>\n");
+    return ZEOK;
+}
+
+zerr_t tc_mlog(zop_arg){
+    zitac_arg_t *arg = (zitac_arg_t*)in;
+    zerr_t ret = ZEFAIL;
+    zmlog_cfg_t cfg;
+    zmlog_t *log = NULL;
+    zmlog_cursor_t cur = {0, 0};
+    tc_mlog_replica_t rep;
+    pthread_t thr;
+    const char *dir;
+    char path[300];
+    char *buf;
+    uint64_t off = 0, i, naive;
+    uint32_t size;
+    double t0, naive_rate, log_rate;
+    int msgs, fd, sv[2], n;
+
+    if(arg->argc < 4 || (msgs = atoi(arg->argv[2])) <= 0 ||
+       (size = (uint32_t)atoi(arg->argv[3])) < 8 || size > (1 << 20)){
+        tu_mlog(NULL, NULL, NULL);
+        return ZEPARAM_INVALID;
+    }
+    dir = arg->argv[1];
+    mkdir(dir, 0755);
+    tc_mlog_clean(dir);
+    buf = (char*)malloc(size);
+
+    /* baseline: every message is its own write and its own sync */
+    naive = msgs < TC_MLOG_NAIVE ? msgs : TC_MLOG_NAIVE;
+    snprintf(path, sizeof(path), "%s/0.naive", dir);
+    if(0 > (fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644))){
+        free(buf);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    t0 = tc_mlog_now();
+    for(i = 0; i < naive; ++i){
+        tc_mlog_fill(buf, size, i);
+        if((ssize_t)size != write(fd, buf, size) || 0 != fdatasync(fd)){
+            break;
+        }
+    }
+    naive_rate = i / (tc_mlog_now() - t0);
+    close(fd);
+    unlink(path);
+
+    /* group commit, small segments to go through a few rolls */
+    zmlog_cfg_default(&cfg);
+    cfg.seg_bytes = 4 << 20;
+    if(ZEOK != zmlog_open(&log, dir, &cfg)){
+        free(buf);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    t0 = tc_mlog_now();
+    for(i = 0; i < (uint64_t)msgs; ++i){
+        tc_mlog_fill(buf, size, i);
+        if(ZEOK != zmlog_append(log, buf, size, &off) || off != i ||
+           ((TC_MLOG_WINDOW - 1 == i % TC_MLOG_WINDOW || i == (uint64_t)msgs - 1) &&
+            ZEOK != zmlog_sync(log, off, 5000))){
+            break;
+        }
+    }
+    log_rate = i / (tc_mlog_now() - t0);
+    printf("durable %u byte messages:\n"
+           "  write+fdatasync  %10.0f msg/s\n"
+           "  zmlog window %d  %10.0f msg/s (%.1fx)\n",
+           size, naive_rate, TC_MLOG_WINDOW, log_rate, log_rate / naive_rate);
+    zmlog_close(log);
+    log = NULL;
+    if(i != (uint64_t)msgs){
+        printf("append/sync failed at %llu\n", (unsigned long long)i);
+        goto end;
+    }
+
+    /* recovery: every record back from the segments */
+    if(ZEOK != zmlog_open(&log, dir, &cfg) || zmlog_end(log) != (uint64_t)msgs ||
+       zmlog_committed(log) != (uint64_t)msgs){
+        printf("reopen failed\n");
+        goto end;
+    }
+    t0 = tc_mlog_now();
+    for(i = 0; i < (uint64_t)msgs && tc_mlog_check(log, i, size, buf); ++i){
+    }
+    printf("reopened, %llu/%d records verified in %.1f ms\n",
+           (unsigned long long)i, msgs, (tc_mlog_now() - t0) * 1000);
+    if(i != (uint64_t)msgs){
+        goto end;
+    }
+
+    /* replication: committed records straight from the page cache */
+    if(0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)){
+        goto end;
+    }
+    snprintf(rep.dir, sizeof(rep.dir), "%s.replica", dir);
+    rep.sock = sv[1];
+    rep.msgs = msgs;
+    rep.size = size;
+    pthread_create(&thr, NULL, tc_mlog_replica, &rep);
+    t0 = tc_mlog_now();
+    while(cur.offset < (uint64_t)msgs && 0 < (n = zmlog_sendfile(log, sv[0], &cur, 256 << 10))){
+    }
+    shutdown(sv[0], SHUT_WR);
+    pthread_join(thr, NULL);
+    close(sv[0]);
+    close(sv[1]);
+    printf("sendfile to replica: %llu/%d records in %.1f ms, replica %s\n",
+           (unsigned long long)cur.offset, msgs, (tc_mlog_now() - t0) * 1000,
+           ZEOK == rep.ret ? "ok" : "FAILED");
+    if(cur.offset == (uint64_t)msgs && !cur.sent && ZEOK == rep.ret){
+        ret = ZEOK;
+    }
+ end:
+    if(log){
+        zmlog_close(log);
+    }
+    tc_mlog_clean(dir);
+    free(buf);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,47 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_MLOG_H_
+#define _ZTST_MLOG_H_
+
+/**
+ * @file tst_mlog.h
+ * @brief group commit log against a write+fdatasync per message
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par mlog
+ *      - mlog <dir> <msgs> <size>
+ *        writes <size> byte messages durably, first with write+fdatasync
+ *        each (a few thousand), then <msgs> through zmlog in windows of 64
+ *        appends waiting for the last one, and prints both rates; the log
+ *        is reopened and every record verified, then streamed with
+ *        zmlog_sendfile() over a socketpair into <dir>.replica.
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_mlog(zop_arg);
+zerr_t tc_mlog(zop_arg);
+
+#endif /*_ZTST_MLOG_H_*/
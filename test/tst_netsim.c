@@ -0,0 +1,358 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_netsim.c
+ * @brief fan-out and membership dissemination on the network simulator
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/netsim.h>
+#include <znt/topo/fanout.h>
+
+#define TC_NETSIM_ZONE 1000 /** nodes per zone */
+#define TC_NETSIM_PERIOD 1000000 /** gossip period, us */
+#define TC_NETSIM_PING 1
+#define TC_NETSIM_ACK 2
+
+typedef struct tc_netsim_node_s{
+    zfanout_t fanout;
+    int zone;
+    uint64_t got; /** payload bytes */
+    int bad;
+    uint64_t done_at;
+    int informed;
+    int sent; /** piggybacked copies of the update */
+}tc_netsim_node_t;
+
+typedef struct tc_netsim_s{
+    znetsim_t sim; /** first, callbacks cast back */
+    zroute_t route;
+    tc_netsim_node_t *nodes;
+    char *buf;
+    uint64_t total;
+    int done; /** nodes complete/informed */
+    int rounds; /** piggyback budget per node */
+}tc_netsim_t;
+
+static double tc_netsim_wall(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t tc_netsim_zone(znt_node_t *node, zptr_t hint){
+    return (uint32_t)((tc_netsim_node_t*)node->hint)->zone;
+}
+
+static void tc_netsim_deliver(zfanout_t *fanout, uint64_t bid, const char *data, int len,
+                              uint64_t offset, uint64_t total, zptr_t hint){
+    tc_netsim_t *tc = (tc_netsim_t*)hint;
+    tc_netsim_node_t *tn = (tc_netsim_node_t*)fanout;
+
+    if(offset != tn->got){
+        ++tn->bad;
+    }
+    if((tn->got += len) == total){
+        tn->done_at = tc->sim.now;
+        ++tc->done;
+    }
+}
+
+static void tc_netsim_fanout_recv(znetsim_t *sim, znetsim_node_t *node, ztrans_t *trans){
+    tc_netsim_t *tc = (tc_netsim_t*)sim;
+    int n;
+
+    while(0 < (n = ztrans_recv(trans, tc->buf, ZFANOUT_HDR_SIZE + ZFANOUT_CHUNK, 0))){
+        zfanout_input(&tc->nodes[node->id].fanout, tc->buf, n);
+    }
+}
+
+static void tc_netsim_flat_recv(znetsim_t *sim, znetsim_node_t *node, ztrans_t *trans){
+    tc_netsim_t *tc = (tc_netsim_t*)sim;
+    tc_netsim_node_t *tn = &tc->nodes[node->id];
+    int n;
+
+    while(0 < (n = ztrans_recv(trans, tc->buf, ZFANOUT_CHUNK, 0))){
+        if((tn->got += n) == tc->total){
+            tn->done_at = sim->now;
+            ++tc->done;
+        }
+    }
+}
+
+/** @brief one node sending a message with the update if it still spreads it */
+static void tc_netsim_gossip_send(tc_netsim_t *tc, int from, int to, char type){
+    tc_netsim_node_t *tn = &tc->nodes[from];
+    char msg[6];
+    int len = 6;
+
+    msg[0] = type;
+    msg[1] = tn->informed && tn->sent < tc->rounds;
+    memcpy(msg + 2, &from, 4);
+    tn->sent += msg[1];
+    ztrans_send(znetsim_port(&tc->sim, to), msg, &len, 0);
+}
+
+static void tc_netsim_gossip_recv(znetsim_t *sim, znetsim_node_t *node, ztrans_t *trans){
+    tc_netsim_t *tc = (tc_netsim_t*)sim;
+    tc_netsim_node_t *tn = &tc->nodes[node->id];
+    char msg[6];
+    int from;
+
+    while(6 == ztrans_recv(trans, msg, 6, 0)){
+        if(msg[1] && !tn->informed){
+            tn->informed = 1;
+            tn->done_at = sim->now;
+            ++tc->done;
+        }
+        if(TC_NETSIM_PING == msg[0]){
+            memcpy(&from, msg + 2, 4);
+            tc_netsim_gossip_send(tc, node->id, from, TC_NETSIM_ACK);
+        }
+    }
+}
+
+static void tc_netsim_probe(znetsim_t *sim, znetsim_node_t *node, zptr_t arg){
+    tc_netsim_gossip_send((tc_netsim_t*)sim, node->id,
+                          (node->id + 1 + znetsim_rand(sim, sim->nnodes - 1)) % sim->nnodes,
+                          TC_NETSIM_PING);
+    znetsim_timer(sim, node->id, TC_NETSIM_PERIOD, tc_netsim_probe, NULL);
+}
+
+static void tc_netsim_heal(znetsim_t *sim, znetsim_node_t *node, zptr_t arg){
+    znetsim_heal(sim);
+}
+
+/**
+ * @brief <n> nodes in zones of TC_NETSIM_ZONE, LAN inside, WAN across;
+ *        jitter reorders port messages, keep it off for fan-out frames
+ */
+static zerr_t tc_netsim_setup(tc_netsim_t *tc, int n, uint32_t loss_ppm, int jitter){
+    znetsim_link_t link;
+    int zones = (n + TC_NETSIM_ZONE - 1) / TC_NETSIM_ZONE;
+    int i, j;
+
+    if(zones > ZNETSIM_ZONES){
+        zones = ZNETSIM_ZONES;
+    }
+    memset(tc->nodes, 0, n * sizeof(tc_netsim_node_t));
+    tc->done = 0;
+    if(ZEOK != znetsim_init(&tc->sim, n, 0, 0x5eed)){
+        return ZEFAIL;
+    }
+    for(i = 0; i < zones; ++i){
+        for(j = i; j < zones; ++j){
+            link.latency_us = i == j ? 200 : 5000;
+            link.jitter_us = !jitter ? 0 : (i == j ? 50 : 500);
+            link.loss_ppm = loss_ppm;
+            znetsim_link(&tc->sim, i, j, &link);
+        }
+    }
+    for(i = 0; i < n; ++i){
+        tc->nodes[i].zone = tc->sim.nodes[i].zone = i % zones;
+        tc->sim.nodes[i].bandwidth = 125000000;
+    }
+    return ZEOK;
+}
+
+/** @brief fan-out against flat broadcast on <n> nodes */
+static zerr_t tc_netsim_bcast(tc_netsim_t *tc, int n, int degree, const char *payload, int len){
+    znt_nid_t *nids;
+    znt_node_t **joined;
+    char *ids;
+    uint64_t fo_at = 0, flat_at = 0, fo_msgs, fo_bytes, flat_msgs;
+    double wall = tc_netsim_wall();
+    int i, j, max_hops = 0, bad = 0, fo_done, sent;
+
+    if(ZEOK != tc_netsim_setup(tc, n, 0, 0)){
+        return ZEFAIL;
+    }
+    /* one shared view, a node's port is the connection every node uses */
+    nids = (znt_nid_t*)malloc(n * sizeof(znt_nid_t));
+    ids = (char*)malloc(n * 16);
+    joined = (znt_node_t**)malloc(n * sizeof(znt_node_t*));
+    for(i = 0; i < n; ++i){
+        nids[i].id = ids + i * 16;
+        nids[i].len = sprintf(nids[i].id, "node-%d", i);
+        nids[i].state = 0;
+    }
+    zroute_init(&tc->route, 8);
+    if(n != zroute_join_many(&tc->route, nids, n, 1, joined)){
+        free(nids);
+        free(ids);
+        free(joined);
+        zroute_fini(&tc->route);
+        znetsim_fini(&tc->sim);
+        return ZEFAIL;
+    }
+    for(i = 0; i < n; ++i){
+        zfanout_init(&tc->nodes[i].fanout, &tc->route, &nids[i], degree, ZFANOUT_CHUNK,
+                     tc_netsim_zone, tc_netsim_deliver, tc);
+        joined[i]->hint = &tc->nodes[i];
+        zroute_attach(joined[i], znetsim_port(&tc->sim, i));
+        tc->sim.nodes[i].on_recv = tc_netsim_fanout_recv;
+    }
+    free(nids);
+    free(ids);
+    free(joined);
+    tc->total = len;
+    znetsim_enter(&tc->sim, 0);
+    zfanout_bcast(&tc->nodes[0].fanout, payload, len, NULL);
+    znetsim_run(&tc->sim, (uint64_t)-1);
+    fo_done = tc->done;
+    fo_msgs = tc->sim.msgs;
+    fo_bytes = tc->sim.bytes;
+    for(i = 1; i < n; ++i){
+        fo_at = tc->nodes[i].done_at > fo_at ? tc->nodes[i].done_at : fo_at;
+        max_hops = tc->nodes[i].fanout.max_hops > max_hops ? tc->nodes[i].fanout.max_hops : max_hops;
+        bad += tc->nodes[i].bad;
+        zfanout_fini(&tc->nodes[i].fanout);
+    }
+    zfanout_fini(&tc->nodes[0].fanout);
+    zroute_fini(&tc->route);
+
+    /* flat: the origin sends every node its own copy */
+    for(i = 0; i < n; ++i){
+        tc->nodes[i].got = 0;
+        tc->sim.nodes[i].on_recv = tc_netsim_flat_recv;
+    }
+    tc->done = 0;
+    tc->sim.msgs = 0;
+    znetsim_enter(&tc->sim, 0);
+    for(i = 1; i < n; ++i){
+        for(j = 0; j < len; j += ZFANOUT_CHUNK){
+            sent = len - j < ZFANOUT_CHUNK ? len - j : ZFANOUT_CHUNK;
+            ztrans_send(znetsim_port(&tc->sim, i), payload + j, &sent, 0);
+        }
+    }
+    znetsim_run(&tc->sim, (uint64_t)-1);
+    flat_msgs = tc->sim.msgs;
+    for(i = 1; i < n; ++i){
+        flat_at = tc->nodes[i].done_at > flat_at ? tc->nodes[i].done_at : flat_at;
+    }
+    printf("%6d nodes %2d zones  fanout %8.1f ms depth %d %5.2f msg/node %6.1f KB/node | "
+           "flat %9.1f ms origin %llu msgs | %.2fs wall\n",
+           n, (n + TC_NETSIM_ZONE - 1) / TC_NETSIM_ZONE, fo_at / 1000.0, max_hops,
+           (double)fo_msgs / n, fo_bytes / 1024.0 / n, flat_at / 1000.0,
+           (unsigned long long)flat_msgs, tc_netsim_wall() - wall);
+    i = fo_done == n - 1 && tc->done == n - 1 && !bad;
+    znetsim_fini(&tc->sim);
+    return i ? ZEOK : ZEFAIL;
+}
+
+/** @brief SWIM style dissemination of one update from node 0 */
+static zerr_t tc_netsim_gossip(tc_netsim_t *tc, int n, int partition){
+    uint64_t limit = 120 * (uint64_t)TC_NETSIM_PERIOD;
+    uint64_t last = 0;
+    double wall = tc_netsim_wall();
+    int i, log2n;
+
+    if(ZEOK != tc_netsim_setup(tc, n, 10000, 1)){
+        return ZEFAIL;
+    }
+    for(log2n = 1; (1 << log2n) < n; ++log2n);
+    tc->rounds = 4 * log2n;
+    for(i = 0; i < n; ++i){
+        tc->sim.nodes[i].on_recv = tc_netsim_gossip_recv;
+        /* random phase, the nodes do not probe in lock step */
+        znetsim_timer(&tc->sim, i, znetsim_rand(&tc->sim, TC_NETSIM_PERIOD), tc_netsim_probe, NULL);
+        if(partition && tc->nodes[i].zone % 2){
+            znetsim_partition(&tc->sim, i, 1);
+        }
+    }
+    if(partition){
+        znetsim_timer(&tc->sim, 0, 5 * TC_NETSIM_PERIOD, tc_netsim_heal, NULL);
+    }
+    tc->nodes[0].informed = 1;
+    tc->done = 1;
+    while(tc->done < n && tc->sim.now < limit){
+        znetsim_run(&tc->sim, tc->sim.now + TC_NETSIM_PERIOD);
+    }
+    for(i = 0; i < n; ++i){
+        last = tc->nodes[i].done_at > last ? tc->nodes[i].done_at : last;
+    }
+    printf("%6d nodes %s  %d/%d informed in %6.2f s (%.1f periods) "
+           "%.2f msg/node/period, lost %llu | %.2fs wall\n",
+           n, partition ? "partitioned 5s" : "clean         ", tc->done, n,
+           last / 1e6, (double)last / TC_NETSIM_PERIOD,
+           (double)tc->sim.msgs * TC_NETSIM_PERIOD / n / (tc->sim.now ? tc->sim.now : 1),
+           (unsigned long long)tc->sim.lost, tc_netsim_wall() - wall);
+    i = tc->done == n;
+    znetsim_fini(&tc->sim);
+    return i ? ZEOK : ZEFAIL;
+}
+
+zerr_t tu_netsim(zop_arg){
+    printf("# netsim <nodes> <degree> <payload:Byte>\n");
+    return ZEOK;
+}
+
+zerr_t tc_netsim(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    tc_netsim_t tc;
+    char *payload;
+    int nodes, degree, len, s, i;
+
+    if(4 != argc || (nodes = atoi(argv[1])) <= 8 || (degree = atoi(argv[2])) <= 0 ||
+       (len = atoi(argv[3])) <= 0){
+        tu_netsim(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    memset(&tc, 0, sizeof(tc));
+    tc.nodes = (tc_netsim_node_t*)malloc(nodes * sizeof(tc_netsim_node_t));
+    tc.buf = (char*)malloc(ZFANOUT_HDR_SIZE + ZFANOUT_CHUNK);
+    payload = (char*)malloc(len);
+    for(i = 0; i < len; ++i){
+        payload[i] = (char)i;
+    }
+    printf("broadcast %d bytes, degree %d:\n", len, degree);
+    for(s = 3; s >= 0; --s){
+        if(ZEOK != tc_netsim_bcast(&tc, nodes >> s, degree, payload, len)){
+            printf("broadcast on %d nodes incomplete\n", nodes >> s);
+            ret = ZEFAIL;
+        }
+    }
+    printf("membership update, 1%% loss:\n");
+    if(ZEOK != tc_netsim_gossip(&tc, nodes, 0) || ZEOK != tc_netsim_gossip(&tc, nodes, 1)){
+        ret = ZEFAIL;
+    }
+    free(payload);
+    free(tc.buf);
+    free(tc.nodes);
+    zerrno(ret);
+    return ret;
+}
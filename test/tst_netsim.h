@@ -0,0 +1,52 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_NETSIM_H_
+#define _ZTST_NETSIM_H_
+
+/**
+ * @file tst_netsim.h
+ * @brief fan-out and membership dissemination on the network simulator
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par netsim
+ *      - netsim <nodes> <degree> <payload:Byte>
+ *        for 1/8, 1/4, 1/2 and all of <nodes> virtual nodes in zones of
+ *        1000 (200us inside a zone, 5ms across, 1Gbps egress) broadcasts
+ *        <payload> with zfanout over simulated ports and sends it flat from
+ *        the origin, printing virtual completion time and messages per node;
+ *        then spreads one membership update SWIM style (a ping per node per
+ *        second, update piggybacked on pings and acks 4*log2(n) times) with
+ *        1% loss and jitter, once clean and once with half of the zones
+ *        partitioned for the first 5 seconds, printing convergence time and
+ *        overhead. Fan-out frames need ordered links, those runs have no
+ *        jitter.
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_netsim(zop_arg);
+zerr_t tc_netsim(zop_arg);
+
+#endif /*_ZTST_NETSIM_H_*/
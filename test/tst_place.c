@@ -0,0 +1,144 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_place.c
+ * @brief NUMA/core placement test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/place.h>
+
+#define TC_PLACE_BUF (1 << 20)
+
+typedef struct tc_place_s{
+    int conns;
+    int accepted; /** by every loop */
+    int errors;
+}tc_place_t;
+
+static void tc_place_entry(zplace_loop_t *loop, zptr_t hint){
+    tc_place_t *tc = (tc_place_t*)hint;
+    char *buf;
+    int node, cpu = sched_getcpu();
+    int cnt = 0;
+
+    if(cpu != loop->cpu){
+        zinf("loop<%d> runs on cpu<%d>, pinned to <%d>", loop->index, cpu, loop->cpu);
+        __atomic_add_fetch(&tc->errors, 1, __ATOMIC_RELAXED);
+    }
+    if((buf = (char*)zplace_alloc(loop->node, TC_PLACE_BUF))){
+        node = zplace_node_of(buf);
+        if(node >= 0 && node != loop->node){
+            zinf("loop<%d> buffer on node<%d>, expect <%d>", loop->index, node, loop->node);
+            __atomic_add_fetch(&tc->errors, 1, __ATOMIC_RELAXED);
+        }
+        zplace_free(buf, TC_PLACE_BUF);
+    }
+    /* drain whatever the steering program put on this listener */
+    if(ZINVALID_SOCKET != loop->listener){
+        zsock_t sock;
+        usleep(200000);
+        while(ZINVALID_SOCKET != (sock = accept(loop->listener, NULL, NULL))){
+            zplace_steer(loop->place, sock);
+            zsockclose(sock);
+            ++cnt;
+        }
+        __atomic_add_fetch(&tc->accepted, cnt, __ATOMIC_RELAXED);
+    }
+    zinf("loop<%d> cpu:%d node:%d accepted:%d", loop->index, loop->cpu, loop->node, cnt);
+}
+
+zerr_t tu_place(zop_arg){
+    printf("# place <port|0> <connections> [cpu...]\n");
+    return ZEOK;
+}
+
+zerr_t tc_place(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    int cpus[ZPLACE_CPUS];
+    zplace_t *place;
+    tc_place_t tc;
+    zsockaddr_in addr;
+    zsock_t sock;
+    zerr_t ret = ZEOK;
+    int port, i, cnt = 0;
+
+    if(argc < 3 || (port = atoi(argv[1])) < 0 || (tc.conns = atoi(argv[2])) < 0){
+        tu_place(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    for(i = 3; i < argc && cnt < ZPLACE_CPUS; ++i){
+        cpus[cnt++] = atoi(argv[i]);
+    }
+    tc.accepted = tc.errors = 0;
+    if(!(place = (zplace_t*)calloc(1, sizeof(zplace_t))) ||
+       ZEOK != (ret = zplace_init(place, cnt ? cpus : NULL, cnt))){
+        free(place);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    zinf("cpus:%d nodes:%d loops:%d", place->ncpus, place->nnodes, place->nloops);
+    if(port && ZEOK != zplace_listen(place, "127.0.0.1", (uint16_t)port, 0)){
+        zinf("listen on port<%d> failed", port);
+        tc.conns = 0;
+    }
+    /* queue the connections before the loops accept */
+    for(i = 0; port && i < tc.conns; ++i){
+        if(ZINVALID_SOCKET == (sock = zsocket(AF_INET, SOCK_STREAM, 0))){
+            break;
+        }
+        zsock_nonblock(sock, 0);
+        zinet_addr(&addr, "127.0.0.1", (uint16_t)port);
+        if(ZEOK != zconnect(sock, (ZSA*)&addr, sizeof(addr))){
+            zsockclose(sock);
+            break;
+        }
+        zsockclose(sock);
+    }
+    zplace_start(place, tc_place_entry, &tc);
+    zplace_join(place);
+
+    zinf("accepted:%d/%d steered local/remote:%llu/%llu errors:%d",
+         tc.accepted, tc.conns, (unsigned long long)place->steered_local,
+         (unsigned long long)place->steered_remote, tc.errors);
+    if(tc.errors || (port && tc.accepted != tc.conns)){
+        ret = ZEFAIL;
+    }
+    zplace_fini(place);
+    free(place);
+    zerrno(ret);
+    return ret;
+}
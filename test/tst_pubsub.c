@@ -0,0 +1,201 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_pubsub.c
+ * @brief publish/subscribe fan-out test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/base/time.h>
+#include <zsi/app/interactive.h>
+#include <znt/app/pubsub.h>
+
+#define TC_PS_KEYS 8
+#define TC_PS_SLOW 3 /** drop, disconnect and conflate laggards */
+#define TC_PS_SLOW_QUEUE 16
+
+typedef struct tc_ps_sub_s{
+    zps_conn_t *conn;
+    st_netfd_t peer; /** reading end */
+    st_thread_t reader;
+    int size; /** frame size */
+    int slow;
+    uint32_t got;
+    uint32_t last; /** last seq + 1 */
+    uint32_t last_of_key[TC_PS_KEYS]; /** seq + 1 */
+    int disorder;
+    int closed;
+}tc_ps_sub_t;
+
+static void tc_ps_on_close(zps_conn_t *conn, zerr_t reason, zptr_t hint){
+    ((tc_ps_sub_t*)hint)->closed = 1;
+}
+
+static zptr_t tc_ps_reader(zptr_t arg){
+    tc_ps_sub_t *sub = (tc_ps_sub_t*)arg;
+    char *buf = malloc(sub->size);
+    uint32_t seq;
+
+    while(st_read_fully(sub->peer, buf, sub->size, ST_UTIME_NO_TIMEOUT) == sub->size){
+        memcpy(&seq, buf, 4);
+        /* conflation replaces in place, laggards are ordered per key only */
+        if(sub->slow ? seq < sub->last_of_key[seq % TC_PS_KEYS] : seq != sub->last){
+            ++sub->disorder;
+        }
+        sub->last = seq + 1;
+        sub->last_of_key[seq % TC_PS_KEYS] = seq + 1;
+        ++sub->got;
+        if(sub->slow){
+            st_usleep(1000);
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+/** @return 1 when <sub> saw the last message of every key */
+static int tc_ps_latest(tc_ps_sub_t *sub, int msgs){
+    int k;
+    for(k = 0; k < TC_PS_KEYS && k < msgs; ++k){
+        if(sub->last_of_key[k] != (uint32_t)(msgs - 1 - (msgs - 1 - k) % TC_PS_KEYS) + 1){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+zerr_t tu_pubsub(zop_arg){
+    printf("# pubsub <subscribers> <messages> <message-size:Byte>\n");
+    return ZEOK;
+}
+
+zerr_t tc_pubsub(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    zps_t *ps = NULL;
+    tc_ps_sub_t *subs = NULL;
+    tc_ps_sub_t *sub;
+    char *buf = NULL;
+    int nsubs, msgs, size, total;
+    int policy, max_msgs;
+    int sv[2];
+    int ms, i;
+    ztick_t clock = NULL;
+    int sec = 0;
+    int usec = 0;
+
+    if(4 != argc || (nsubs = atoi(argv[1])) <= 0 || (msgs = atoi(argv[2])) <= 0){
+        tu_pubsub(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    size = atoi(argv[3]) < 8 ? 8 : atoi(argv[3]);
+    total = nsubs + TC_PS_SLOW;
+
+    zst_init(NULL, NULL);
+    ps = zps_create();
+    subs = calloc(total, sizeof(tc_ps_sub_t));
+    buf = calloc(1, size);
+    for(i = 0; i < total; ++i){
+        sub = &subs[i];
+        sub->size = size;
+        sub->slow = i >= nsubs;
+        policy = sub->slow ? i - nsubs : ZPS_DROP;
+        max_msgs = sub->slow ? TC_PS_SLOW_QUEUE : msgs;
+        if(0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)){
+            zerrno(errno);
+            ret = ZEFAIL;
+            total = i;
+            break;
+        }
+        zsock_nonblock(sv[0], ztrue);
+        zsock_nonblock(sv[1], ztrue);
+        sub->peer = zst_socket(sv[1]);
+        sub->conn = zps_conn_create(ps, sv[0], policy, max_msgs, 0, tc_ps_on_close, sub);
+        zps_subscribe(sub->conn, "tick", 4);
+        sub->reader = zst_thread_create(tc_ps_reader, sub, ztrue, 0);
+    }
+
+    clock = ztick();
+    for(i = 0; ZEOK == ret && i < msgs; ++i){
+        memcpy(buf, &i, 4);
+        zps_publish(ps, "tick", 4, buf, size, (uint64_t)(i % TC_PS_KEYS) + 1);
+        if(0 == (i & 63)){
+            st_usleep(0);
+        }
+    }
+    /* fast subscribers get everything, the conflating laggard ends with the latest per key */
+    for(ms = 0; ZEOK == ret && ms < 10000; ++ms){
+        for(i = 0; i < nsubs && subs[i].got == (uint32_t)msgs; ++i);
+        if(i == nsubs && tc_ps_latest(&subs[nsubs + ZPS_CONFLATE], msgs)){
+            break;
+        }
+        st_usleep(1000);
+    }
+    ztock(clock, &sec, &usec);
+
+    for(i = 0; ZEOK == ret && i < total; ++i){
+        sub = &subs[i];
+        if((!sub->slow && sub->got != (uint32_t)msgs) || sub->disorder){
+            zinf("subscriber %d got %u of %d, disorder %d", i, sub->got, msgs, sub->disorder);
+            ret = ZEFAIL;
+        }
+    }
+    if(ZEOK == ret && msgs > 4 * TC_PS_SLOW_QUEUE){
+        if(!subs[nsubs + ZPS_DROP].conn->dropped || !subs[nsubs + ZPS_DISCONNECT].closed ||
+           !subs[nsubs + ZPS_CONFLATE].conn->conflated || ms >= 10000){
+            zinf("slow subscriber policy not applied");
+            ret = ZEFAIL;
+        }
+    }
+    zinf("\npublished:%llu deliveries:%llu buffers:%llu sec:%d usec:%d\n"
+         "fast frames/writev:%.2f drop<got:%u dropped:%llu> disconnect<closed:%d> "
+         "conflate<got:%u conflated:%llu>",
+         (unsigned long long)ps->published, (unsigned long long)ps->deliveries,
+         (unsigned long long)ps->published, sec, usec,
+         subs[0].conn->writes ? (double)subs[0].conn->sent / subs[0].conn->writes : .0,
+         subs[nsubs + ZPS_DROP].got, (unsigned long long)subs[nsubs + ZPS_DROP].conn->dropped,
+         subs[nsubs + ZPS_DISCONNECT].closed,
+         subs[nsubs + ZPS_CONFLATE].got,
+         (unsigned long long)subs[nsubs + ZPS_CONFLATE].conn->conflated);
+
+    for(i = 0; i < total; ++i){
+        zps_conn_destroy(subs[i].conn);
+        zst_thread_join(subs[i].reader);
+        st_netfd_close(subs[i].peer);
+    }
+    zps_destroy(ps);
+    free(subs);
+    free(buf);
+    zerrno(ret);
+    return ret;
+}
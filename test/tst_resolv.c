@@ -0,0 +1,134 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_resolv.c
+ * @brief asynchronous resolver test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/resolv.h>
+
+zerr_t tu_resolv(zop_arg){
+    printf("# resolv <name> <concurrent-queries>\n");
+    return ZEOK;
+}
+
+zerr_t tc_resolv(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zresolv_t *rs;
+    zmbox_t *mbox;
+    zresolv_req_t *reqs;
+    zptr_t items[64];
+    zsockaddr_in addr;
+    struct pollfd pfd;
+    char host[INET6_ADDRSTRLEN];
+    uint16_t port;
+    zerr_t ret = ZEOK;
+    zerr_t first;
+    int queries, i, n, pending = 0, answered = 0, same = 0;
+
+    if(3 != argc || (queries = atoi(argv[2])) <= 0){
+        tu_resolv(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    rs = zresolv_create(2, 0, 0, 0);
+    mbox = zmbox_create(queries);
+    reqs = (zresolv_req_t*)calloc(queries, sizeof(zresolv_req_t));
+    if(!rs || !mbox || !reqs){
+        ret = ZEMEM_INSUFFICIENT;
+        goto out;
+    }
+    /* numeric and /etc/hosts answer inline */
+    if(ZEOK != zresolv_addr(rs, "127.0.0.1", 80, &addr) ||
+       ZEOK != zresolv_addr(rs, "localhost", 80, &addr)){
+        zinf("numeric or hosts name not answered inline");
+        ret = ZEFAIL;
+    }
+    inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+    zinf("localhost -> %s:%d", host, ntohs(addr.sin_port));
+
+    /* a burst of queries for one name shares a lookup */
+    for(i = 0; i < queries; ++i){
+        reqs[i].reply = mbox;
+        reqs[i].port = (uint16_t)i;
+        if(ZEAGAIN == zresolv_query(rs, argv[1], &reqs[i])){
+            ++pending;
+        }else{
+            ++answered;
+        }
+    }
+    pfd.fd = zmbox_fileno(mbox);
+    pfd.events = POLLIN;
+    while(answered < queries){
+        if(ZEAGAIN == (n = zmbox_pop(mbox, items, 64))){
+            if(poll(&pfd, 1, 10000) <= 0){
+                zinf("timeout waiting for answers");
+                ret = ZETIMEOUT;
+                break;
+            }
+            continue;
+        }
+        answered += n;
+    }
+    for(i = 0, first = reqs[0].ret; i < queries; ++i){
+        zinet_ntop(&reqs[i].addr, host, sizeof(host), &port);
+        same += reqs[i].ret == first && (ZEOK != first || port == i);
+    }
+    if(same != queries || (pending && 1 != rs->lookups)){
+        ret = ZEFAIL;
+    }
+    /* the answer, or the failure, is cached now */
+    n = zresolv_addr(rs, argv[1], 80, &addr);
+    if(n != first){
+        ret = ZEFAIL;
+    }
+    /* a blocking caller waits for a fresh lookup instead of ZEAGAIN */
+    zresolv_flush(rs);
+    if(first != zresolv_wait(rs, argv[1], 80, &addr, 10000)){
+        zinf("zresolv_wait() disagrees with the queries");
+        ret = ZEFAIL;
+    }
+    zinf("%s: %s, queries:%d pending:%d lookups:%llu coalesced:%llu hits:%llu",
+         argv[1], ZEOK == first ? "resolved" : "unknown", queries, pending,
+         (unsigned long long)rs->lookups, (unsigned long long)rs->coalesced,
+         (unsigned long long)rs->hits);
+ out:
+    zresolv_destroy(rs);
+    zmbox_destroy(mbox);
+    free(reqs);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,149 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_route.c
+ * @brief consistent-hash routing test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/topo/route.h>
+
+#define TC_ROUTE_MEAN 100 /** keys per node before the balance is checked */
+
+static void tc_route_nid(znt_nid_t *nid, char *buf, int i){
+    nid->len = sprintf(buf, "node-%d", i);
+    nid->id = buf;
+    nid->state = 0;
+}
+
+zerr_t tu_route(zop_arg){
+    printf("# route <nodes> <keys>\n");
+    return ZEOK;
+}
+
+zerr_t tc_route(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    zroute_t route;
+    znt_nid_t nid;
+    znt_node_t **owners = NULL;
+    znt_node_t *node = NULL;
+    znt_node_t *joined = NULL;
+    char buf[64];
+    int nodes = 0;
+    int keys = 0;
+    int moved = 0;
+    int min_cnt = 0x7fffffff;
+    int max_cnt = 0;
+    int mean = 0;
+    int *counts = NULL;
+    znt_nid_t *nids = NULL;
+    char *names = NULL;
+    int i, j;
+
+    if(3 != argc || (nodes = atoi(argv[1])) <= 1 || (keys = atoi(argv[2])) <= 0){
+        tu_route(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    zroute_init(&route, 16);
+    owners = calloc(keys, sizeof(znt_node_t*));
+    nids = calloc(nodes, sizeof(znt_nid_t));
+    names = calloc(nodes, sizeof(buf));
+    for(i = 0; i < nodes; ++i){
+        tc_route_nid(&nids[i], names + i * sizeof(buf), i);
+    }
+    zroute_join_many(&route, nids, nodes, 1, NULL);
+    while(zroute_rebalance(&route, 4096));
+
+    /* balance */
+    for(i = 0; i < keys; ++i){
+        owners[i] = zroute_lookup(&route, (char*)&i, sizeof(i));
+    }
+    counts = calloc(nodes, sizeof(int));
+    for(j = 0; j < nodes; ++j){
+        route.nodes[j]->hint = (zptr_t)&counts[j];
+    }
+    for(i = 0; i < keys; ++i){
+        ++*(int*)owners[i]->hint;
+    }
+    for(j = 0; j < nodes; ++j){
+        min_cnt = counts[j] < min_cnt ? counts[j] : min_cnt;
+        max_cnt = counts[j] > max_cnt ? counts[j] : max_cnt;
+    }
+    mean = keys / nodes;
+    zinf("\nbalance<min:%d max:%d mean:%d> table<bits:%d fallbacks:%llu>", min_cnt, max_cnt,
+         mean, route.bits, (unsigned long long)route.fallbacks);
+    /* 160 points per node keep every share within 1/3..2x of the mean */
+    if(mean >= TC_ROUTE_MEAN && (max_cnt > 2 * mean || min_cnt < mean / 3)){
+        ret = ZEFAIL;
+    }
+
+    /* one join only moves keys to the new node */
+    tc_route_nid(&nid, buf, nodes);
+    joined = zroute_join(&route, &nid, 1);
+    while(zroute_rebalance(&route, 4096));
+    for(i = 0; i < keys; ++i){
+        node = zroute_lookup(&route, (char*)&i, sizeof(i));
+        if(node != owners[i]){
+            ++moved;
+            if(node != joined){
+                ret = ZEFAIL;
+            }
+        }
+        owners[i] = node;
+    }
+    zinf("\njoin moved %d of %d keys (%.2f%%, ideal %.2f%%)", moved, keys,
+         100.0 * moved / keys, 100.0 / (nodes + 1));
+
+    /* leaving node is never returned while the table catches up */
+    node = route.nodes[0];
+    zroute_leave(&route, node);
+    while(zroute_rebalance(&route, ((uint32_t)1 << route.bits) / 64)){
+        for(i = 0; i < keys; i += 97){
+            if(zroute_lookup(&route, (char*)&i, sizeof(i)) == node){
+                ret = ZEFAIL;
+            }
+        }
+    }
+    zinf("\nleave fallbacks:%llu moved_slots:%llu %s",
+         (unsigned long long)route.fallbacks, (unsigned long long)route.moved, zstrerr(ret));
+
+    free(names);
+    free(nids);
+    free(counts);
+    free(owners);
+    zroute_fini(&route);
+    zerrno(ret);
+    return ret;
+}
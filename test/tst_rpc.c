@@ -0,0 +1,200 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_rpc.c
+ * @brief pipelined rpc test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/base/time.h>
+#include <zsi/app/interactive.h>
+#include <znt/app/rpc.h>
+
+#define TC_RPC_ECHO 1
+#define TC_RPC_SILENT 2
+#define TC_RPC_BIG (1024 * 1024)
+
+typedef struct tc_rpc_s{
+    zrpc_conn_t *client;
+    int calls;
+    int payload;
+    int seed; /** payload pattern, tells callers apart */
+    int fails;
+}tc_rpc_t;
+
+static zerr_t tc_rpc_echo(zrpc_conn_t *conn, const zrpc_hdr_t *hdr, const char *req, zptr_t hint){
+    return zrpc_reply(conn, hdr->id, hdr->method, ZEOK, req, hdr->len);
+}
+
+static zerr_t tc_rpc_silent(zrpc_conn_t *conn, const zrpc_hdr_t *hdr, const char *req, zptr_t hint){
+    return ZEOK;
+}
+
+static zptr_t tc_rpc_caller(zptr_t arg){
+    tc_rpc_t *tc = (tc_rpc_t*)arg;
+    char *req = calloc(1, tc->payload);
+    char *rep = NULL;
+    int rep_len = 0;
+    int i;
+
+    for(i = 0; i < tc->payload; ++i){
+        req[i] = (char)((tc->seed + i) % 251);
+    }
+    for(i = 0; i < tc->calls; ++i){
+        memcpy(req, &i, sizeof(i));
+        if(ZEOK != zrpc_call(tc->client, TC_RPC_ECHO, req, tc->payload, &rep, &rep_len, 1000000) ||
+           rep_len != tc->payload || 0 != memcmp(req, rep, tc->payload)){
+            ++tc->fails;
+        }
+        free(rep);
+        rep = NULL;
+    }
+    free(req);
+    return NULL;
+}
+
+zerr_t tu_rpc(zop_arg){
+    printf("# rpc <callers> <calls-per-caller> <payload:Byte>\n");
+    return ZEOK;
+}
+
+zerr_t tc_rpc(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    zrpc_service_t service;
+    zrpc_conn_t *server = NULL;
+    tc_rpc_t tc;
+    ztimer_t timer;
+    zcork_tick_t tick;
+    st_thread_t *callers = NULL;
+    int callers_cnt = 0;
+    int sv[2];
+    int i;
+    ztick_t clock = NULL;
+    int sec = 0;
+    int usec = 0;
+
+    if(4 != argc || (callers_cnt = atoi(argv[1])) <= 0){
+        tu_rpc(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    memset(&tc, 0, sizeof(tc));
+    tc.calls = atoi(argv[2]);
+    tc.payload = atoi(argv[3]) > (int)sizeof(int) ? atoi(argv[3]) : (int)sizeof(int);
+
+    zst_init(NULL, NULL);
+    if(0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    zsock_nonblock(sv[0], ztrue);
+    zsock_nonblock(sv[1], ztrue);
+
+    memset(&service, 0, sizeof(service));
+    service.handlers[TC_RPC_ECHO] = tc_rpc_echo;
+    service.handlers[TC_RPC_SILENT] = tc_rpc_silent;
+    ztimer_init(&timer, ztrue);
+    zcork_tick_init(&tick);
+    server = zrpc_conn_create(sv[0], &service, &timer, &tick);
+    tc.client = zrpc_conn_create(sv[1], NULL, &timer, &tick);
+
+    /* deadline */
+    if(ZETIMEOUT != zrpc_call(tc.client, TC_RPC_SILENT, "ping", 4, NULL, NULL, 10000)){
+        zinf("silent call did not time out");
+        ret = ZEFAIL;
+    }
+
+    /* pipelining */
+    callers = calloc(callers_cnt > 2 ? callers_cnt : 2, sizeof(st_thread_t));
+    clock = ztick();
+    for(i = 0; i < callers_cnt; ++i){
+        callers[i] = zst_thread_create(tc_rpc_caller, &tc, ztrue, 0);
+    }
+    for(i = 0; i < callers_cnt; ++i){
+        zst_thread_join(callers[i]);
+    }
+    ztock(clock, &sec, &usec);
+    zinf("\ncalls:%d fails:%d max_inflight:%d frames_per_read:%.2f sec:%d usec:%d",
+         callers_cnt * tc.calls, tc.fails, tc.client->max_inflight,
+         tc.client->reads ? (double)tc.client->frames / tc.client->reads : .0, sec, usec);
+    if(tc.fails){
+        ret = ZEFAIL;
+    }
+
+    /* a frame larger than the cork */
+    if(ZEOK == ret){
+        char *big = malloc(TC_RPC_BIG);
+        char *rep = NULL;
+        int rep_len = 0;
+
+        for(i = 0; i < TC_RPC_BIG; ++i){
+            big[i] = (char)(i % 251);
+        }
+        if(ZEOK != zrpc_call(tc.client, TC_RPC_ECHO, big, TC_RPC_BIG, &rep, &rep_len, 5000000) ||
+           rep_len != TC_RPC_BIG || 0 != memcmp(big, rep, TC_RPC_BIG)){
+            zinf("%d byte echo failed", TC_RPC_BIG);
+            ret = ZEFAIL;
+        }
+        free(rep);
+        free(big);
+    }
+
+    /* two callers writing frames larger than the cork at once */
+    if(ZEOK == ret){
+        tc_rpc_t bigs[2];
+
+        for(i = 0; i < 2; ++i){
+            bigs[i].client = tc.client;
+            bigs[i].calls = 2;
+            bigs[i].payload = TC_RPC_BIG;
+            bigs[i].seed = 1 + i * 100;
+            bigs[i].fails = 0;
+            callers[i] = zst_thread_create(tc_rpc_caller, &bigs[i], ztrue, 0);
+        }
+        for(i = 0; i < 2; ++i){
+            zst_thread_join(callers[i]);
+            if(bigs[i].fails){
+                zinf("concurrent %d byte echo failed", TC_RPC_BIG);
+                ret = ZEFAIL;
+            }
+        }
+    }
+
+    zrpc_conn_destroy(tc.client);
+    zrpc_conn_destroy(server);
+    zcork_tick_fini(&tick);
+    ztimer_fini(&timer);
+    free(callers);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,291 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_schema.c
+ * @brief zero-copy schema messages test case and benchmark
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/app/schema.h>
+
+#define TC_SCHEMA_BUFS 1024
+
+#define TC_ORDER_V1(X, n)   \
+    X(n, u64, id)           \
+    X(n, u32, qty)          \
+    X(n, bytes, symbol)
+ZSCHEMA_DEFINE(tc_order_v1, 1, TC_ORDER_V1)
+
+/* v2 appends fields, v1 peers still read it and v2 reads v1 */
+#define TC_ORDER(X, n)      \
+    X(n, u64, id)           \
+    X(n, u32, qty)          \
+    X(n, bytes, symbol)     \
+    X(n, u16, side)         \
+    X(n, f64, price)        \
+    X(n, i64, ts)           \
+    X(n, bytes, account)
+ZSCHEMA_DEFINE(tc_order, 1, TC_ORDER)
+
+/* hand-rolled baseline: pack field by field, decode into a struct */
+typedef struct tc_naive_s{
+    uint64_t id;
+    uint32_t qty;
+    uint16_t side;
+    double price;
+    int64_t ts;
+    uint16_t symbol_len;
+    char symbol[32];
+    uint16_t account_len;
+    char account[32];
+}tc_naive_t;
+
+static int tc_naive_encode(const tc_naive_t *o, char *buf){
+    char *p = buf;
+    zschema_st_u64(p, o->id); p += 8;
+    zschema_st_u32(p, o->qty); p += 4;
+    zschema_st_u16(p, o->side); p += 2;
+    zschema_st_f64(p, o->price); p += 8;
+    zschema_st_i64(p, o->ts); p += 8;
+    zschema_st_u16(p, o->symbol_len); p += 2;
+    memcpy(p, o->symbol, o->symbol_len); p += o->symbol_len;
+    zschema_st_u16(p, o->account_len); p += 2;
+    memcpy(p, o->account, o->account_len); p += o->account_len;
+    return (int)(p - buf);
+}
+
+static zerr_t tc_naive_decode(const char *buf, int len, tc_naive_t *o){
+    const char *p = buf;
+    const char *end = buf + len;
+
+    if(len < 32){
+        return ZEFAIL;
+    }
+    o->id = zschema_ld_u64(p); p += 8;
+    o->qty = zschema_ld_u32(p); p += 4;
+    o->side = zschema_ld_u16(p); p += 2;
+    o->price = zschema_ld_f64(p); p += 8;
+    o->ts = zschema_ld_i64(p); p += 8;
+    o->symbol_len = zschema_ld_u16(p); p += 2;
+    if(o->symbol_len > sizeof(o->symbol) || p + o->symbol_len + 2 > end){
+        return ZEFAIL;
+    }
+    memcpy(o->symbol, p, o->symbol_len); p += o->symbol_len;
+    o->account_len = zschema_ld_u16(p); p += 2;
+    if(o->account_len > sizeof(o->account) || p + o->account_len > end){
+        return ZEFAIL;
+    }
+    memcpy(o->account, p, o->account_len);
+    return ZEOK;
+}
+
+static uint64_t tc_schema_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** @brief schema round trips must agree, evolve both ways and reject bad refs */
+static zerr_t tc_schema_check(zschema_pool_t *pool){
+    zschema_builder_t b;
+    const char *msg, *sym;
+    char *buf = zschema_pool_get(pool);
+    uint32_t sym_len;
+    zerr_t ret = ZEOK;
+    int len;
+
+    tc_order_build(&b, buf, pool->bufsize);
+    tc_order_set_id(&b, 0x1122334455667788ULL);
+    tc_order_set_qty(&b, 42);
+    tc_order_set_side(&b, 2);
+    tc_order_set_price(&b, 101.25);
+    tc_order_set_ts(&b, -5);
+    tc_order_set_symbol(&b, "ZNT", 3);
+    tc_order_set_account(&b, "acct-9", 6);
+    len = zschema_end(&b);
+    if(!(msg = tc_order_view(buf, len)) || 0x1122334455667788ULL != tc_order_id(msg) ||
+       42 != tc_order_qty(msg) || 2 != tc_order_side(msg) || 101.25 != tc_order_price(msg) ||
+       -5 != tc_order_ts(msg) || !(sym = tc_order_symbol(msg, &sym_len)) ||
+       3 != sym_len || memcmp(sym, "ZNT", 3)){
+        zinf("v2 round trip failed");
+        ret = ZEFAIL;
+    }
+    /* new message, old reader */
+    if(!(msg = tc_order_v1_view(buf, len)) || 42 != tc_order_v1_qty(msg) ||
+       !tc_order_v1_symbol(msg, &sym_len) || 3 != sym_len){
+        zinf("v1 reader of v2 failed");
+        ret = ZEFAIL;
+    }
+    /* old message, new reader: appended fields read as absent */
+    tc_order_v1_build(&b, buf, pool->bufsize);
+    tc_order_v1_set_qty(&b, 7);
+    len = zschema_end(&b);
+    if(!(msg = tc_order_view(buf, len)) || 7 != tc_order_qty(msg) ||
+       0 != tc_order_side(msg) || tc_order_account(msg, &sym_len) || sym_len){
+        zinf("v2 reader of v1 failed");
+        ret = ZEFAIL;
+    }
+    /* truncated frame and a slot pointing past the message */
+    if(tc_order_view(buf, len - 1)){
+        zinf("truncated message accepted");
+        ret = ZEFAIL;
+    }
+    zschema_st_u32(buf + offsetof(tc_order_v1_layout_t, symbol) + 4, 1000);
+    if(tc_order_v1_symbol(buf, &sym_len)){
+        zinf("out of bounds bytes slot accepted");
+        ret = ZEFAIL;
+    }
+    /* overflow is reported by zschema_end() */
+    tc_order_build(&b, buf, sizeof(tc_order_layout_t) + 2);
+    tc_order_set_symbol(&b, "ZNT", 3);
+    if(ZEMEM_INSUFFICIENT != zschema_end(&b)){
+        zinf("overflow not reported");
+        ret = ZEFAIL;
+    }
+    zschema_pool_put(pool, buf);
+    return ret;
+}
+
+zerr_t tu_schema(zop_arg){
+    printf("# schema <messages>\n");
+    return ZEOK;
+}
+
+/** @brief build a message of sequence <i> into <buf> */
+static int tc_schema_build(char *buf, uint32_t cap, int i){
+    zschema_builder_t b;
+
+    tc_order_build(&b, buf, cap);
+    tc_order_set_id(&b, i);
+    tc_order_set_qty(&b, i & 1023);
+    tc_order_set_side(&b, i & 1);
+    tc_order_set_price(&b, i * 0.5);
+    tc_order_set_ts(&b, i);
+    tc_order_set_symbol(&b, "ZNT-USD", 7);
+    tc_order_set_account(&b, "account-0001", 12);
+    return zschema_end(&b);
+}
+
+static int tc_naive_build(char *buf, int i){
+    tc_naive_t o;
+
+    o.id = i;
+    o.qty = i & 1023;
+    o.side = i & 1;
+    o.price = i * 0.5;
+    o.ts = i;
+    memcpy(o.symbol, "ZNT-USD", o.symbol_len = 7);
+    memcpy(o.account, "account-0001", o.account_len = 12);
+    return tc_naive_encode(&o, buf);
+}
+
+zerr_t tc_schema(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zschema_pool_t pool;
+    char *bufs[TC_SCHEMA_BUFS];
+    int lens[TC_SCHEMA_BUFS];
+    const char *msg;
+    tc_naive_t d;
+    uint64_t begin, build_ns[2], read_ns[2];
+    uint64_t sum[2] = {0, 0};
+    int bytes[2] = {0, 0};
+    uint32_t len;
+    zerr_t ret;
+    int i, k, msgs;
+
+    if(2 != argc || (msgs = atoi(argv[1])) <= 0){
+        tu_schema(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    zschema_pool_init(&pool, 256, TC_SCHEMA_BUFS);
+    ret = tc_schema_check(&pool);
+    for(k = 0; k < TC_SCHEMA_BUFS; ++k){
+        bufs[k] = zschema_pool_get(&pool);
+    }
+
+    /* schema: build into pooled buffers, read fields in place */
+    begin = tc_schema_ns();
+    for(i = 0; i < msgs; ++i){
+        k = i % TC_SCHEMA_BUFS;
+        bytes[0] = lens[k] = tc_schema_build(bufs[k], pool.bufsize, i);
+    }
+    build_ns[0] = tc_schema_ns() - begin;
+    begin = tc_schema_ns();
+    for(i = 0; i < msgs; ++i){
+        k = i % TC_SCHEMA_BUFS;
+        if((msg = tc_order_view(bufs[k], lens[k]))){
+            sum[0] += tc_order_id(msg) + tc_order_qty(msg) + tc_order_side(msg) +
+                (uint64_t)tc_order_price(msg) + (uint64_t)tc_order_ts(msg);
+            tc_order_symbol(msg, &len);
+            sum[0] += len;
+            tc_order_account(msg, &len);
+            sum[0] += len;
+        }
+    }
+    read_ns[0] = tc_schema_ns() - begin;
+
+    /* naive: pack field by field, decode into a struct before reading */
+    begin = tc_schema_ns();
+    for(i = 0; i < msgs; ++i){
+        k = i % TC_SCHEMA_BUFS;
+        bytes[1] = lens[k] = tc_naive_build(bufs[k], i);
+    }
+    build_ns[1] = tc_schema_ns() - begin;
+    begin = tc_schema_ns();
+    for(i = 0; i < msgs; ++i){
+        k = i % TC_SCHEMA_BUFS;
+        if(ZEOK == tc_naive_decode(bufs[k], lens[k], &d)){
+            sum[1] += d.id + d.qty + d.side + (uint64_t)d.price + (uint64_t)d.ts +
+                d.symbol_len + d.account_len;
+        }
+    }
+    read_ns[1] = tc_schema_ns() - begin;
+
+    zinf("\nschema build:%.1fns read:%.1fns %dB/msg"
+         "\nnaive  build:%.1fns read:%.1fns %dB/msg",
+         (double)build_ns[0] / msgs, (double)read_ns[0] / msgs, bytes[0],
+         (double)build_ns[1] / msgs, (double)read_ns[1] / msgs, bytes[1]);
+    /* every message of both runs read back the same values */
+    if(sum[0] != sum[1] || sum[0] < (uint64_t)msgs){
+        zinf("checksum mismatch %llu/%llu", (unsigned long long)sum[0], (unsigned long long)sum[1]);
+        ret = ZEFAIL;
+    }
+    for(k = 0; k < TC_SCHEMA_BUFS; ++k){
+        zschema_pool_put(&pool, bufs[k]);
+    }
+    zschema_pool_fini(&pool);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,147 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_shm_ring.c
+ * @brief shared-memory ring transport test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/base/time.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/shm_ring.h>
+
+static zerr_t tc_shm_consumer(zsock_t usock, int frames, int frame_size);
+
+zerr_t tu_shm_ring(zop_arg){
+    printf("# shm_ring <frames> <frame-size:Byte> <batch>\n");
+    return ZEOK;
+}
+
+zerr_t tc_shm_ring(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zshm_ring_t ring;
+    ztrans_t trans;
+    int sv[2];
+    int frames = 0;
+    int frame_size = 0;
+    int batch = 0;
+    int i = 0;
+    int len = 0;
+    int status = 0;
+    pid_t pid;
+    char *buf = NULL;
+    ztick_t tick = NULL;
+    int sec = 0;
+    int usec = 0;
+
+    if(4 != argc){
+        tu_shm_ring(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    frames = atoi(argv[1]);
+    frame_size = atoi(argv[2]);
+    batch = atoi(argv[3]);
+    if(frames <= 0 || frame_size < (int)sizeof(int) || batch <= 0){
+        tu_shm_ring(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+
+    if(0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sv)){
+        zerrno(errno);
+        return ZEFAIL;
+    }
+    if(ZEOK != zshm_ring_create(&ring, 1024 * 1024)){
+        close(sv[0]);
+        close(sv[1]);
+        return ZEFAIL;
+    }
+    if(0 == (pid = fork())){
+        close(sv[0]);
+        exit(ZEOK == tc_shm_consumer(sv[1], frames, frame_size) ? 0 : 1);
+    }
+    close(sv[1]);
+    zshm_ring_share(&ring, sv[0]);
+    zshm_ring_trans(&ring, &trans);
+
+    buf = calloc(1, frame_size);
+    tick = ztick();
+    for(i = 0; i < frames; ++i){
+        memcpy(buf, &i, sizeof(i));
+        do{
+            len = frame_size;
+        }while(ZEAGAIN == ztrans_send(&trans, buf, &len, (i + 1) % batch ? MSG_MORE : 0));
+    }
+    ztrans_flush(&trans);
+    waitpid(pid, &status, 0);
+    ztock(tick, &sec, &usec);
+    zthrouthput(sec, usec, (uint64_t)frames * frame_size, 0);
+    zinf("\nframes:%d publishes:%llu wakeups:%llu consumer:%s",
+         frames, (unsigned long long)ring.publishes, (unsigned long long)ring.wakeups,
+         0 == status ? "ok" : "fail");
+
+    free(buf);
+    ztrans_close(&trans);
+    close(sv[0]);
+    return 0 == status ? ZEOK : ZEFAIL;
+}
+
+static zerr_t tc_shm_consumer(zsock_t usock, int frames, int frame_size){
+    zshm_ring_t ring;
+    char *buf = NULL;
+    fd_set rset;
+    int expect = 0;
+    int ret = 0;
+
+    zsock_nonblock(usock, zfalse);
+    if(ZEOK != zshm_ring_attach(&ring, usock)){
+        return ZEFAIL;
+    }
+    buf = calloc(1, frame_size);
+    while(expect < frames){
+        if(ZEAGAIN == (ret = zshm_recv(&ring, buf, frame_size, 0))){
+            FD_ZERO(&rset);
+            FD_SET(zshm_fileno(&ring), &rset);
+            zselect(zshm_fileno(&ring) + 1, &rset, NULL, NULL, NULL);
+            continue;
+        }
+        if(ret != frame_size || 0 != memcmp(buf, &expect, sizeof(expect))){
+            zerrno(ZEFAIL);
+            break;
+        }
+        ++expect;
+    }
+    free(buf);
+    zshm_ring_destroy(&ring);
+    return expect == frames ? ZEOK : ZEFAIL;
+}
@@ -0,0 +1,149 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_stprof.c
+ * @brief find the st_thread that blocks the scheduler
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/stprof.h>
+
+typedef struct tc_stprof_s{
+    int hog_ms;
+    int rounds;
+    int hog_seen;
+    st_thread_t hog;
+}tc_stprof_t;
+
+typedef struct tc_stprof_arg_s{
+    tc_stprof_t *tc;
+    int id;
+}tc_stprof_arg_t;
+
+static void tc_stprof_spin(int us){
+    struct timespec ts, now;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    do{
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }while((now.tv_sec - ts.tv_sec) * 1000000 + (now.tv_nsec - ts.tv_nsec) / 1000 < us);
+}
+
+static void tc_stprof_on_hog(const zstprof_stat_t *stat, uint64_t slice_us, zptr_t hint){
+    tc_stprof_t *tc = (tc_stprof_t*)hint;
+
+    zinf("hog %s held the loop %lluus", stat->name, (unsigned long long)slice_us);
+    tc->hog_seen += stat->thr == tc->hog;
+}
+
+/** @brief a well behaved handler, 100us of work per wake up */
+static void *tc_stprof_worker(void *arg){
+    tc_stprof_arg_t *a = (tc_stprof_arg_t*)arg;
+    char name[ZSTPROF_NAME];
+    int i;
+
+    snprintf(name, sizeof(name), "conn %d", a->id);
+    zstprof_name(name);
+    for(i = 0; i < a->tc->rounds; ++i){
+        tc_stprof_spin(100);
+        st_usleep(1000);
+    }
+    return NULL;
+}
+
+/** @brief the handler that blocks the loop once in a while */
+static void *tc_stprof_hog(void *arg){
+    tc_stprof_t *tc = (tc_stprof_t*)arg;
+    int i;
+
+    zstprof_name("conn hog");
+    for(i = 0; i < tc->rounds; ++i){
+        tc_stprof_spin(i % 10 ? 100 : tc->hog_ms * 1000);
+        st_usleep(1000);
+    }
+    return NULL;
+}
+
+zerr_t tu_stprof(zop_arg){
+    printf("# stprof <conns> <hog_ms>\n");
+    return ZEOK;
+}
+
+zerr_t tc_stprof(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    tc_stprof_t tc;
+    tc_stprof_arg_t *args;
+    st_thread_t *thrs;
+    zstprof_stat_t top[5];
+    int conns, i, n;
+    zerr_t ret = ZEOK;
+
+    memset(&tc, 0, sizeof(tc));
+    if(3 != argc || (conns = atoi(argv[1])) <= 0 || (tc.hog_ms = atoi(argv[2])) <= 0){
+        tu_stprof(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    tc.rounds = 50;
+    zst_init(NULL, NULL);
+    if(ZEOK != zstprof_start(tc.hog_ms * 500, tc_stprof_on_hog, &tc)){
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    args = (tc_stprof_arg_t*)calloc(conns, sizeof(*args));
+    thrs = (st_thread_t*)calloc(conns, sizeof(*thrs));
+    for(i = 0; i < conns; ++i){
+        args[i].tc = &tc;
+        args[i].id = i;
+        thrs[i] = zst_thread_create(tc_stprof_worker, &args[i], ztrue, 0);
+    }
+    tc.hog = zst_thread_create(tc_stprof_hog, &tc, ztrue, 0);
+    /* report while the handlers are alive, their records go at exit */
+    st_usleep(tc.rounds * 1000);
+    zstprof_report(5);
+    n = zstprof_top(top, 5, ZSTPROF_BY_SLICE);
+    if(!n || top[0].thr != tc.hog || !tc.hog_seen){
+        ret = ZEFAIL;
+    }
+    zst_thread_join(tc.hog);
+    for(i = 0; i < conns; ++i){
+        zst_thread_join(thrs[i]);
+    }
+    zstprof_stop();
+    zinf("hog reported %d times", tc.hog_seen);
+    free(thrs);
+    free(args);
+    zerrno(ret);
+    return ret;
+}
@@ -0,0 +1,264 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_tls.c
+ * @brief kTLS vs software TLS loopback benchmark
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/tls.h>
+#ifdef ZNT_HAVE_OPENSSL
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <openssl/pem.h>
+
+#define TC_TLS_CERT "/tmp/znt_tst_tls.pem"
+#define TC_TLS_FILE "/tmp/znt_tst_tls.dat"
+
+typedef struct tc_tls_s{
+    ztls_ctx_t ctx;
+    zsock_t listener;
+    uint64_t expect;
+    uint64_t received;
+    zerr_t ret;
+}tc_tls_t;
+
+static uint64_t tc_tls_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/** @brief self-signed P-256 certificate and key in one PEM file */
+static zerr_t tc_tls_cert(void){
+    EVP_PKEY *pkey = EVP_EC_gen("P-256");
+    X509 *x = X509_new();
+    FILE *fp = NULL;
+    zerr_t ret = ZEFAIL;
+
+    if(pkey && x){
+        X509_set_version(x, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(x), 1);
+        X509_gmtime_adj(X509_getm_notBefore(x), 0);
+        X509_gmtime_adj(X509_getm_notAfter(x), 3600);
+        X509_set_pubkey(x, pkey);
+        X509_NAME_add_entry_by_txt(X509_get_subject_name(x), "CN", MBSTRING_ASC,
+                                   (const unsigned char*)"znt", -1, -1, 0);
+        X509_set_issuer_name(x, X509_get_subject_name(x));
+        if(X509_sign(x, pkey, EVP_sha256()) > 0 && (fp = fopen(TC_TLS_CERT, "w")) &&
+           PEM_write_X509(fp, x) && PEM_write_PrivateKey(fp, pkey, NULL, NULL, 0, NULL, NULL)){
+            ret = ZEOK;
+        }
+    }
+    if(fp){
+        fclose(fp);
+    }
+    X509_free(x);
+    EVP_PKEY_free(pkey);
+    return ret;
+}
+
+static void tc_tls_wait(ztls_t *tls){
+    struct pollfd pfd;
+
+    pfd.fd = tls->sock;
+    pfd.events = tls->want;
+    poll(&pfd, 1, 1000);
+}
+
+/** @brief accept one link and drain it */
+static void *tc_tls_server(void *arg){
+    tc_tls_t *tc = (tc_tls_t*)arg;
+    ztls_t tls;
+    zsock_t sock;
+    char *buf = malloc(256 * 1024);
+    int n;
+
+    tc->ret = ZEFAIL;
+    while(ZINVALID_SOCKET == (sock = accept(tc->listener, NULL, NULL))){
+        usleep(1000);
+    }
+    zsock_nonblock(sock, 1);
+    if(ZEOK == ztls_init(&tls, &tc->ctx, sock) && ZEOK == ztls_handshake_wait(&tls, 5000)){
+        while(tc->received < tc->expect){
+            if((n = ztls_recv(&tls, buf, 256 * 1024)) > 0){
+                tc->received += n;
+            }else if(ZEAGAIN == n){
+                tc_tls_wait(&tls);
+            }else{
+                break;
+            }
+        }
+        tc->ret = tc->received == tc->expect ? ZEOK : ZEFAIL;
+    }
+    ztls_fini(&tls);
+    free(buf);
+    return NULL;
+}
+
+/** @brief send <bytes> from the file or from memory over one link */
+static zerr_t tc_tls_run(const char *title, int ktls, int file, uint64_t bytes, uint16_t port){
+    ztls_cfg_t cfg;
+    ztls_ctx_t cctx;
+    ztls_t tls;
+    tc_tls_t tc;
+    pthread_t thr;
+    zsockaddr_t addr;
+    zsock_t sock;
+    char *buf = NULL;
+    uint64_t sent = 0, begin = 0;
+    ssize_t n;
+    int fd = -1, len;
+    zerr_t ret = ZEFAIL;
+
+    memset(&tc, 0, sizeof(tc));
+    tc.expect = bytes;
+    ztls_cfg_default(&cfg);
+    cfg.ktls = ktls;
+    cfg.cert = TC_TLS_CERT;
+    if(ZEOK != ztls_ctx_init(&tc.ctx, 1, &cfg)){
+        return ZEFAIL;
+    }
+    cfg.cert = NULL;
+    cfg.ca = TC_TLS_CERT;
+    ztls_ctx_init(&cctx, 0, &cfg);
+    tc.listener = zsocket(AF_INET, SOCK_STREAM, 0);
+    zinet_addrx(&addr, "127.0.0.1", port);
+    setsockopt(tc.listener, SOL_SOCKET, SO_REUSEADDR, &(int){1}, sizeof(int));
+    if(ZEOK != zbind(tc.listener, &addr.sa, zsockaddr_len(&addr)) || ZEOK != zlisten(tc.listener, 4)){
+        goto out;
+    }
+    pthread_create(&thr, NULL, tc_tls_server, &tc);
+    if(ZEOK != zconnect_race(&addr, 1, 0, 3000, &sock, NULL) ||
+       ZEOK != ztls_init(&tls, &cctx, sock) || ZEOK != ztls_handshake_wait(&tls, 5000)){
+        zinf("%s handshake failed", title);
+        pthread_cancel(thr);
+        pthread_join(thr, NULL);
+        goto out;
+    }
+    fd = open(TC_TLS_FILE, O_RDONLY);
+    buf = malloc(256 * 1024);
+    memset(buf, 'z', 256 * 1024);
+    begin = tc_tls_us();
+    while(sent < bytes){
+        if(file){
+            n = ztls_sendfile(&tls, fd, sent % (16 << 20), bytes - sent < (16 << 20) - sent % (16 << 20) ?
+                              bytes - sent : (16 << 20) - sent % (16 << 20));
+        }else{
+            len = bytes - sent < 256 * 1024 ? (int)(bytes - sent) : 256 * 1024;
+            n = ztls_send(&tls, buf, &len);
+            n = ZEOK == n || (ZEAGAIN == n && len) ? len : n;
+        }
+        if(n > 0){
+            sent += n;
+        }else if(ZEAGAIN == n){
+            tc_tls_wait(&tls);
+        }else{
+            break;
+        }
+    }
+    pthread_join(thr, NULL);
+    begin = tc_tls_us() - begin;
+    zinf("%-14s ktls tx:%d rx:%d %lluMB in %llums, %.1fMB/s", title, tls.ktls_tx, tls.ktls_rx,
+         (unsigned long long)(bytes >> 20), (unsigned long long)(begin / 1000),
+         (double)bytes / (begin ? begin : 1));
+    ret = tc.ret;
+    ztls_fini(&tls);
+ out:
+    if(fd >= 0){
+        close(fd);
+    }
+    free(buf);
+    zsockclose(tc.listener);
+    ztls_ctx_fini(&cctx);
+    ztls_ctx_fini(&tc.ctx);
+    return ret;
+}
+
+#endif /* ZNT_HAVE_OPENSSL */
+
+zerr_t tu_tls(zop_arg){
+    printf("# tls <MB> <port>\n");
+    return ZEOK;
+}
+
+#ifdef ZNT_HAVE_OPENSSL
+zerr_t tc_tls(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    char *chunk;
+    uint64_t bytes;
+    zerr_t ret = ZEOK;
+    int fd, i, port;
+
+    if(3 != argc || atoi(argv[1]) <= 0 || (port = atoi(argv[2])) <= 0){
+        tu_tls(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    bytes = (uint64_t)atoi(argv[1]) << 20;
+    /* a 16MB file, sent round and round from the page cache */
+    chunk = malloc(1 << 20);
+    memset(chunk, 'f', 1 << 20);
+    if(ZEOK != tc_tls_cert() || 0 > (fd = open(TC_TLS_FILE, O_CREAT | O_TRUNC | O_WRONLY, 0600))){
+        free(chunk);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+    for(i = 0; i < 16; ++i){
+        if(1 << 20 != write(fd, chunk, 1 << 20)){
+            ret = ZEFAIL;
+        }
+    }
+    close(fd);
+    free(chunk);
+    if(ZEOK != tc_tls_run("ktls sendfile", 1, 1, bytes, (uint16_t)port) ||
+       ZEOK != tc_tls_run("ktls write", 1, 0, bytes, (uint16_t)port) ||
+       ZEOK != tc_tls_run("soft sendfile", 0, 1, bytes, (uint16_t)port) ||
+       ZEOK != tc_tls_run("soft write", 0, 0, bytes, (uint16_t)port)){
+        ret = ZEFAIL;
+    }
+    unlink(TC_TLS_FILE);
+    unlink(TC_TLS_CERT);
+    zerrno(ret);
+    return ret;
+}
+#else
+zerr_t tc_tls(zop_arg){
+    zinf("tls needs -DZNT_HAVE_OPENSSL, skipped");
+    return ZEOK;
+}
+#endif /* ZNT_HAVE_OPENSSL */
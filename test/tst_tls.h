@@ -0,0 +1,47 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_TLS_H_
+#define _ZTST_TLS_H_
+
+/**
+ * @file tst_tls.h
+ * @brief kTLS vs software TLS loopback benchmark
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par tls
+ *      - tls <MB> <port>
+ *        sends <MB> over a loopback TLS link with a self-signed certificate,
+ *        by sendfile() and by write(), with kTLS offload and in software,
+ *        and reports throughput and whether the kernel took the keys
+ *        (needs the "tls" kernel module, else both runs are software);
+ *        skipped when built without ZNT_HAVE_OPENSSL.
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_tls(zop_arg);
+zerr_t tc_tls(zop_arg);
+
+#endif /*_ZTST_TLS_H_*/
@@ -0,0 +1,195 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+/**
+ * @file tst_wspool.c
+ * @brief work-stealing pool test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @zmake.app znt;
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <zsi/base/error.h>
+#include <zsi/base/trace.h>
+#include <zsi/app/interactive.h>
+#include <znt/com/wspool.h>
+
+#define TC_WSP_THREADS 64
+
+typedef struct tc_wsp_s{
+    zwsp_pool_t *pool;
+    zwsp_task_t *children;
+    int nchildren;
+    volatile int ran; /** tasks finished */
+    volatile int by[TC_WSP_THREADS]; /** tasks run per worker */
+    volatile int seen; /** workers that ran a task */
+}tc_wsp_t;
+
+static __thread int tc_wsp_id = -1;
+
+static void tc_wsp_spin(int us){
+    struct timespec ts, now;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    do{
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }while((now.tv_sec - ts.tv_sec) * 1000000 + (now.tv_nsec - ts.tv_nsec) / 1000 < us);
+}
+
+/** @brief count the task against the worker running it */
+static zerr_t tc_wsp_work(zop_arg){
+    tc_wsp_t *tc = (tc_wsp_t*)hint;
+
+    if(tc_wsp_id < 0){
+        tc_wsp_id = __atomic_fetch_add(&tc->seen, 1, __ATOMIC_RELAXED) % TC_WSP_THREADS;
+    }
+    tc_wsp_spin((int)(intptr_t)in);
+    __atomic_fetch_add(&tc->by[tc_wsp_id], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&tc->ran, 1, __ATOMIC_RELEASE);
+    return ZEOK;
+}
+
+/** @brief spawn the children on the local deque, then hold the worker */
+static zerr_t tc_wsp_parent(zop_arg){
+    tc_wsp_t *tc = (tc_wsp_t*)hint;
+    int i;
+
+    for(i = 0; i < tc->nchildren; ++i){
+        while(ZEOK != zwsp_submit(tc->pool, &tc->children[i])){
+            sched_yield();
+        }
+    }
+    tc_wsp_spin(20000);
+    return ZEOK;
+}
+
+static void tc_wsp_reset(tc_wsp_t *tc){
+    tc->ran = 0;
+    memset((void*)tc->by, 0, sizeof(tc->by));
+}
+
+static int tc_wsp_wait(tc_wsp_t *tc, int cnt, int timeout_ms){
+    while(__atomic_load_n(&tc->ran, __ATOMIC_ACQUIRE) < cnt && timeout_ms-- > 0){
+        usleep(1000);
+    }
+    return __atomic_load_n(&tc->ran, __ATOMIC_ACQUIRE);
+}
+
+static int tc_wsp_busy(tc_wsp_t *tc){
+    int i, cnt = 0;
+
+    for(i = 0; i < TC_WSP_THREADS; ++i){
+        cnt += tc->by[i] ? 1 : 0;
+    }
+    return cnt;
+}
+
+static void tc_wsp_tasks(zwsp_task_t *tasks, int cnt, int us, tc_wsp_t *tc){
+    int i;
+
+    memset(tasks, 0, cnt * sizeof(zwsp_task_t));
+    for(i = 0; i < cnt; ++i){
+        tasks[i].op = tc_wsp_work;
+        tasks[i].in = (zptr_t)(intptr_t)us;
+        tasks[i].hint = tc;
+    }
+}
+
+zerr_t tu_wspool(zop_arg){
+    printf("# wspool <workers> <tasks>\n");
+    return ZEOK;
+}
+
+zerr_t tc_wspool(zop_arg){
+    char **argv = ((zitac_arg_t *)in)->argv;
+    int argc = ((zitac_arg_t *)in)->argc;
+    zerr_t ret = ZEOK;
+    tc_wsp_t tc;
+    zwsp_task_t parent;
+    zwsp_task_t *tasks;
+    int workers, cnt, i, n;
+
+    if(3 != argc || (workers = atoi(argv[1])) < 2 || workers > TC_WSP_THREADS ||
+       (cnt = atoi(argv[2])) <= 0){
+        tu_wspool(in, out, hint);
+        return ZEPARAM_INVALID;
+    }
+    memset(&tc, 0, sizeof(tc));
+    tasks = (zwsp_task_t*)malloc(cnt * sizeof(zwsp_task_t));
+    if(!(tc.pool = zwsp_create(workers, cnt))){
+        free(tasks);
+        zerrno(ZEFAIL);
+        return ZEFAIL;
+    }
+
+    /* inbox handoff from a thread outside the pool */
+    tc_wsp_tasks(tasks, cnt, 10, &tc);
+    for(i = 0; i < cnt; ++i){
+        while(ZEOK != zwsp_submit(tc.pool, &tasks[i])){
+            usleep(100);
+        }
+    }
+    n = tc_wsp_wait(&tc, cnt, 10000);
+    printf("inbox: %d/%d tasks ran on %d workers\n", n, cnt, tc_wsp_busy(&tc));
+    if(n != cnt){
+        ret = ZEFAIL;
+    }
+
+    /* stealing, the parent's worker stays busy after spawning */
+    tc_wsp_reset(&tc);
+    tc_wsp_tasks(tasks, cnt, 50, &tc);
+    tc.children = tasks;
+    tc.nchildren = cnt;
+    memset(&parent, 0, sizeof(parent));
+    parent.op = tc_wsp_parent;
+    parent.hint = &tc;
+    zwsp_submit(tc.pool, &parent);
+    n = tc_wsp_wait(&tc, cnt, 10000);
+    printf("steal: %d/%d children ran on %d workers\n", n, cnt, tc_wsp_busy(&tc));
+    if(n != cnt || tc_wsp_busy(&tc) < 2){
+        ret = ZEFAIL;
+    }
+    /* the parent may still hold its worker */
+    usleep(50000);
+
+    /* shutdown drains what is queued */
+    tc_wsp_reset(&tc);
+    tc_wsp_tasks(tasks, cnt, 10, &tc);
+    for(i = 0; i < cnt && ZEOK == zwsp_submit(tc.pool, &tasks[i]); ++i){
+    }
+    zwsp_destroy(tc.pool);
+    printf("shutdown: %d/%d queued tasks ran before exit\n", tc.ran, i);
+    if(tc.ran != i){
+        ret = ZEFAIL;
+    }
+    free(tasks);
+    zerrno(ret);
+    return ret;
+}
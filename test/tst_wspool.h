@@ -0,0 +1,47 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2018 Z.Riemann
+ * https://github.com/ZRiemann/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the Software), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED AS IS, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM
+ * , OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef _ZTST_WSPOOL_H_
+#define _ZTST_WSPOOL_H_
+
+/**
+ * @file tst_wspool.h
+ * @brief work-stealing pool test case
+ * @author Z.Riemann https://github.com/ZRiemann/
+ * @date 2026-10-19 Z.Riemann found
+ *
+ * @par wspool
+ *      - wspool <workers> <tasks>
+ *        inbox: <tasks> submitted from the test thread land in the worker
+ *        inboxes and all run; steal: one task spawns <tasks> children on its
+ *        own deque and keeps its worker busy, the other workers must steal
+ *        them; shutdown: zwsp_destroy() right after a burst of submits runs
+ *        every queued task before the workers exit.
+ */
+#include <zsi/base/type.h>
+
+zerr_t tu_wspool(zop_arg);
+zerr_t tc_wspool(zop_arg);
+
+#endif /*_ZTST_WSPOOL_H_*/